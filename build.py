@@ -42,7 +42,8 @@ class BuildSystem:
             "-lglew32",
             "-lopengl32",
             "-static-libgcc",
-            "-static-libstdc++"
+            "-static-libstdc++",
+            "-pthread"  # JobSystem worker threads
         ]
     
     def verify_dependencies(self) -> bool:
@@ -160,6 +161,8 @@ class BuildSystem:
         targets = [
             ("main.cpp", "hiking.exe"),
             ("main_shaders.cpp", "shaders.exe"),
+            ("main_bench.cpp", "bench.exe"),
+            ("main_cook.cpp", "cook.exe"),
         ]
         
         success = True
@@ -174,6 +177,8 @@ class BuildSystem:
             print("\nRun executables:")
             print("  > hiking.exe         (main game)")
             print("  > shaders.exe        (shader development tool)")
+            print("  > bench.exe          (asset pipeline benchmarks)")
+            print("  > cook.exe           (cook models to .hmesh, textures to .htex)")
             print()
         
         return success
@@ -182,7 +187,7 @@ class BuildSystem:
         """Clean build artifacts"""
         print(f"\n[*] Cleaning build files...")
         
-        targets = ["hiking.exe", "shaders.exe", "SDL2.dll", "glew32.dll"]
+        targets = ["hiking.exe", "shaders.exe", "bench.exe", "cook.exe", "SDL2.dll", "glew32.dll"]
         for target in targets:
             path = self.project_root / target
             if path.exists():
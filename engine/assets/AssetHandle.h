@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+// Handle to an asset that may still be loading in the background. get()
+// returns the placeholder until the GL thread has made the real resource
+// resident, so callers can render with it right away.
+template <typename T>
+class AssetHandle {
+public:
+    enum class Status { Loading, Ready, Failed };
+
+    AssetHandle() = default;
+    explicit AssetHandle(std::shared_ptr<T> placeholder) : state(std::make_shared<State>()) {
+        state->placeholder = std::move(placeholder);
+    }
+
+    static AssetHandle ready(std::shared_ptr<T> resource) {
+        AssetHandle handle(nullptr);
+        handle.resolve(std::move(resource));
+        return handle;
+    }
+
+    bool valid() const { return state != nullptr; }
+    Status status() const { return state ? state->status.load(std::memory_order_acquire) : Status::Failed; }
+    bool isReady() const { return status() == Status::Ready; }
+    bool isFailed() const { return status() == Status::Failed; }
+
+    std::shared_ptr<T> get() const {
+        if (!state) return nullptr;
+        return isReady() ? state->resource : state->placeholder;
+    }
+
+    const std::string& error() const {
+        static const std::string none;
+        return state ? state->error : none;
+    }
+
+    // Completion is published from the GL thread once the resource is resident
+    void resolve(std::shared_ptr<T> resource) const {
+        state->resource = std::move(resource);
+        state->status.store(Status::Ready, std::memory_order_release);
+    }
+
+    void fail(const std::string& message) const {
+        state->error = message;
+        state->status.store(Status::Failed, std::memory_order_release);
+    }
+
+private:
+    struct State {
+        std::atomic<Status> status{Status::Loading};
+        std::shared_ptr<T> resource;
+        std::shared_ptr<T> placeholder;
+        std::string error;
+    };
+
+    std::shared_ptr<State> state;
+};
@@ -1,6 +1,13 @@
 #include "../assets/AssetManager.h"
 #include "ModelLoader.h"
+#include "ResourceRegistry.h"
 #include "TextureLoader.h"
+#include "../core/JobSystem.h"
+#include "../core/Logger.h"
+#include "../render/GLUploadQueue.h"
+#include "../render/Mesh.h"
+#include "../render/Shader.h"
+#include "../render/Texture.h"
 
 AssetManager* AssetManager::instance = nullptr;
 
@@ -15,45 +22,143 @@ AssetManager& AssetManager::getInstance() {
     return *instance;
 }
 
+uint64_t AssetManager::fileHash(const std::string& path) {
+    uint64_t hash = 0;
+    if (!ContentHash::hashFile(path, hash)) hash = ContentHash::hash(path);
+    return hash;
+}
+
 TexturePtr AssetManager::loadTexture(const std::string& path, const std::string& name) {
-    auto texture = TextureLoader::loadTexture(path);
+    uint64_t hash = fileHash(path);
+    auto texture = ResourceRegistry::getInstance().acquire<Texture>(hash, [&path]() {
+        return TextureLoader::loadTexture(path);
+    });
     if (texture) {
         std::string key = name.empty() ? path : name;
-        textures[key] = texture;
+        ResourceRegistry::getInstance().alias<Texture>(key, hash);
     }
     return texture;
 }
 
 ShaderPtr AssetManager::loadShader(const std::string& vertPath, const std::string& fragPath, const std::string& name) {
-    auto shader = std::make_shared<Shader>();
-    if (shader->loadFromFiles(vertPath, fragPath)) {
+    uint64_t hash = ContentHash::combine(fileHash(vertPath), fileHash(fragPath));
+    auto shader = ResourceRegistry::getInstance().acquire<Shader>(hash, [&vertPath, &fragPath]() {
+        auto shader = std::make_shared<Shader>();
+        return shader->loadFromFiles(vertPath, fragPath) ? shader : nullptr;
+    });
+    if (shader) {
         std::string key = name.empty() ? vertPath + fragPath : name;
-        shaders[key] = shader;
-        return shader;
+        ResourceRegistry::getInstance().alias<Shader>(key, hash);
     }
-    return nullptr;
+    return shader;
 }
 
 MeshPtr AssetManager::loadMesh(const std::string& path, const std::string& name) {
-    auto mesh = ModelLoader::loadModel(path);
+    uint64_t hash = fileHash(path);
+    auto mesh = ResourceRegistry::getInstance().acquire<Mesh>(hash, [&path]() {
+        return ModelLoader::loadModel(path);
+    });
     if (mesh) {
         std::string key = name.empty() ? path : name;
-        meshes[key] = mesh;
+        ResourceRegistry::getInstance().alias<Mesh>(key, hash);
     }
     return mesh;
 }
 
+AssetHandle<Texture> AssetManager::loadTextureAsync(const std::string& path, const std::string& name) {
+    std::string key = name.empty() ? path : name;
+    if (TexturePtr texture = getTexture(key)) return AssetHandle<Texture>::ready(texture);
+
+    auto pending = pendingTextures.find(key);
+    if (pending != pendingTextures.end()) return pending->second;
+
+    if (!placeholderTexture) placeholderTexture = TextureLoader::createWhiteTexture();
+    AssetHandle<Texture> handle(placeholderTexture);
+    pendingTextures[key] = handle;
+
+    JobSystem::getInstance().enqueue([this, path, key, handle]() {
+        // Identical content already on the GPU skips the decode. The worker
+        // only checks the hash: a handle it held might be the last one, and
+        // the texture would then be deleted without a GL context.
+        uint64_t hash = fileHash(path);
+        bool resident = ResourceRegistry::getInstance().contains<Texture>(hash);
+        auto data = std::make_shared<TextureData>();
+        bool decoded = !resident && TextureLoader::decodeFile(path, *data);
+
+        GLUploadQueue::getInstance().push([this, path, key, handle, hash, resident, data, decoded]() {
+            pendingTextures.erase(key);
+            TexturePtr texture = ResourceRegistry::getInstance().acquire<Texture>(hash, [&path, &data, resident, decoded]() {
+                // Unloaded since the worker looked: decode it here after all
+                if (resident) return TextureLoader::loadTexture(path);
+                return decoded ? TextureLoader::createTexture(*data) : nullptr;
+            });
+            if (!texture) {
+                LOG_ERROR("Failed to load texture: " + path);
+                handle.fail("could not decode " + path);
+                return;
+            }
+            ResourceRegistry::getInstance().alias<Texture>(key, hash);
+            handle.resolve(texture);
+        });
+    });
+    return handle;
+}
+
+AssetHandle<Mesh> AssetManager::loadMeshAsync(const std::string& path, const std::string& name) {
+    std::string key = name.empty() ? path : name;
+    if (MeshPtr mesh = getMesh(key)) return AssetHandle<Mesh>::ready(mesh);
+
+    auto pending = pendingMeshes.find(key);
+    if (pending != pendingMeshes.end()) return pending->second;
+
+    if (!placeholderMesh) placeholderMesh = ModelLoader::createCube();
+    AssetHandle<Mesh> handle(placeholderMesh);
+    pendingMeshes[key] = handle;
+
+    JobSystem::getInstance().enqueue([this, path, key, handle]() {
+        // Only the hash on the worker, as for textures
+        uint64_t hash = fileHash(path);
+        bool resident = ResourceRegistry::getInstance().contains<Mesh>(hash);
+        auto vertices = std::make_shared<std::vector<Vertex>>();
+        auto indices = std::make_shared<std::vector<unsigned int>>();
+        bool loaded = resident || ModelLoader::loadModelData(path, *vertices, *indices);
+        // The layout choice scans every vertex, so it is made here too
+        VertexFormat format = resident ? VERTEX_FLOAT32 : Mesh::chooseFormat(*vertices);
+
+        GLUploadQueue::getInstance().push([this, path, key, handle, hash, resident, vertices, indices, loaded, format]() {
+            pendingMeshes.erase(key);
+            if (!loaded) {
+                handle.fail("could not load " + path);
+                return;
+            }
+            MeshPtr mesh = ResourceRegistry::getInstance().acquire<Mesh>(hash, [&path, &vertices, &indices, resident, format]() {
+                // Unloaded since the worker looked: load it here after all
+                if (resident) return ModelLoader::loadModel(path);
+                auto mesh = std::make_shared<Mesh>();
+                mesh->setVertexFormat(format);
+                mesh->setVertices(std::move(*vertices));
+                mesh->setIndices(std::move(*indices));
+                return mesh;
+            });
+            if (!mesh) {
+                handle.fail("could not load " + path);
+                return;
+            }
+            ResourceRegistry::getInstance().alias<Mesh>(key, hash);
+            handle.resolve(mesh);
+        });
+    });
+    return handle;
+}
+
 TexturePtr AssetManager::getTexture(const std::string& name) const {
-    auto it = textures.find(name);
-    return it != textures.end() ? it->second : nullptr;
+    return ResourceRegistry::getInstance().findPath<Texture>(name);
 }
 
 ShaderPtr AssetManager::getShader(const std::string& name) const {
-    auto it = shaders.find(name);
-    return it != shaders.end() ? it->second : nullptr;
+    return ResourceRegistry::getInstance().findPath<Shader>(name);
 }
 
 MeshPtr AssetManager::getMesh(const std::string& name) const {
-    auto it = meshes.find(name);
-    return it != meshes.end() ? it->second : nullptr;
+    return ResourceRegistry::getInstance().findPath<Mesh>(name);
 }
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <unordered_map>
 #include <string>
 
+#include "AssetHandle.h"
+
 class Texture;
 class Shader;
 class Mesh;
@@ -12,15 +15,26 @@ using TexturePtr = std::shared_ptr<Texture>;
 using ShaderPtr = std::shared_ptr<Shader>;
 using MeshPtr = std::shared_ptr<Mesh>;
 
+// Loaded assets live in the ResourceRegistry under their file content hash
+// and stay resident only while callers hold them; names resolve through
+// registry path aliases.
 class AssetManager {
 private:
     static AssetManager* instance;
-    std::unordered_map<std::string, TexturePtr> textures;
-    std::unordered_map<std::string, ShaderPtr> shaders;
-    std::unordered_map<std::string, MeshPtr> meshes;
+
+    // In-flight async loads, so repeated requests share one handle
+    std::unordered_map<std::string, AssetHandle<Texture>> pendingTextures;
+    std::unordered_map<std::string, AssetHandle<Mesh>> pendingMeshes;
+
+    // Shown by async handles until the real asset is resident
+    TexturePtr placeholderTexture;
+    MeshPtr placeholderMesh;
 
     AssetManager();
 
+    // Content hash of a file, or of the path when it cannot be read
+    static uint64_t fileHash(const std::string& path);
+
 public:
     ~AssetManager();
     static AssetManager& getInstance();
@@ -29,6 +43,11 @@ public:
     ShaderPtr loadShader(const std::string& vertPath, const std::string& fragPath, const std::string& name = "");
     MeshPtr loadMesh(const std::string& path, const std::string& name = "");
 
+    // Decode/parse on the job system, upload through GLUploadQueue. Must be
+    // called from the GL thread; the GL work happens in GLUploadQueue::drain.
+    AssetHandle<Texture> loadTextureAsync(const std::string& path, const std::string& name = "");
+    AssetHandle<Mesh> loadMeshAsync(const std::string& path, const std::string& name = "");
+
     TexturePtr getTexture(const std::string& name) const;
     ShaderPtr getShader(const std::string& name) const;
     MeshPtr getMesh(const std::string& name) const;
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "../core/AssetFile.h"
+
+// Shared file handling for the asset cookers (MeshCooker, TextureCooker)
+class CookedAsset {
+public:
+    // A cooked file is used when it exists and is not older than its source.
+    // Mounted packs are built from fresh cooks, so a packed one always is
+    // (and costs no stat calls).
+    static bool isCurrent(const std::string& sourcePath, const std::string& cookedPath) {
+        if (AssetPacks::contains(cookedPath)) return true;
+        std::error_code ec;
+        if (!std::filesystem::exists(cookedPath, ec)) return false;
+        if (!std::filesystem::exists(sourcePath, ec)) return true;  // shipped without sources
+        auto cookedTime = std::filesystem::last_write_time(cookedPath, ec);
+        if (ec) return false;
+        auto sourceTime = std::filesystem::last_write_time(sourcePath, ec);
+        return !ec && cookedTime >= sourceTime;
+    }
+
+    static uint64_t fileSize(const std::string& path) {
+        std::error_code ec;
+        uint64_t size = std::filesystem::file_size(path, ec);
+        return ec ? 0 : size;
+    }
+
+    // Written next to the target and renamed, so a running game never maps a partial file
+    static bool write(const std::string& outputPath, const std::vector<uint8_t>& data, std::string& error) {
+        std::string tempPath = outputPath + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                error = "could not create " + tempPath;
+                return false;
+            }
+            file.write(reinterpret_cast<const char*>(data.data()), (std::streamsize)data.size());
+            if (!file) {
+                error = "could not write " + tempPath;
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, outputPath, ec);
+        if (ec) {
+            std::filesystem::remove(tempPath, ec);
+            error = "could not replace " + outputPath;
+            return false;
+        }
+        return true;
+    }
+
+    static uint64_t align(std::vector<uint8_t>& out, size_t alignment) {
+        out.resize((out.size() + alignment - 1) & ~(alignment - 1));
+        return out.size();
+    }
+
+    static void append(std::vector<uint8_t>& out, const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+};
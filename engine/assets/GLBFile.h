@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "../core/AssetFile.h"
+#include "../render/GLTFLoader.h"
+
+// Memory-mapped GLB container. The JSON and BIN chunks, bufferViews and
+// embedded images are exposed as non-owning spans into the mapping, so they
+// stay valid for as long as the GLBFile itself is alive.
+class GLBFile {
+private:
+    AssetFile mapping;  // mounted pack entry or loose file
+    ByteSpan jsonChunk;
+    ByteSpan binChunk;
+    GLTFDocument doc;
+
+public:
+    static constexpr uint32_t MAGIC = 0x46546C67;       // "glTF"
+    static constexpr uint32_t CHUNK_JSON = 0x4E4F534A;  // "JSON"
+    static constexpr uint32_t CHUNK_BIN = 0x004E4942;   // "BIN\0"
+
+    bool open(const std::string& path, std::string& error) {
+        jsonChunk = ByteSpan();
+        binChunk = ByteSpan();
+        doc = GLTFDocument();
+
+        if (!mapping.open(path)) {
+            error = "could not map " + path;
+            return false;
+        }
+        if (!splitChunks(mapping.span(), jsonChunk, binChunk, error)) return false;
+        return doc.parse(reinterpret_cast<const char*>(jsonChunk.data), jsonChunk.size,
+                         binChunk.data, binChunk.size, error);
+    }
+
+    bool isOpen() const { return mapping.isOpen(); }
+    size_t fileSize() const { return mapping.size(); }
+
+    ByteSpan json() const { return jsonChunk; }
+    ByteSpan bin() const { return binChunk; }
+    const GLTFDocument& document() const { return doc; }
+
+    ByteSpan bufferView(int index) const {
+        if (index < 0 || index >= (int)doc.bufferViews.size()) return ByteSpan();
+        const GLTFBufferView& view = doc.bufferViews[index];
+        return binChunk.subspan(view.byteOffset, view.byteLength);
+    }
+
+    ByteSpan image(int index) const {
+        if (index < 0 || index >= (int)doc.images.size()) return ByteSpan();
+        return bufferView(doc.images[index].bufferView);
+    }
+
+    // Maps a GLB and flattens it into a GLTFModel. The model's image refs
+    // point into the mapping, which the model keeps alive.
+    static bool loadModel(const std::string& path, GLTFModel& model, std::string& error) {
+        auto file = std::make_shared<GLBFile>();
+        if (!file->open(path, error)) return false;
+        if (!GLTFLoader::buildModel(file->document(), model, error)) return false;
+        model.storage = file;
+        return true;
+    }
+
+    // Splits a GLB container into its JSON and BIN chunks without copying
+    static bool splitChunks(ByteSpan file, ByteSpan& json, ByteSpan& bin, std::string& error) {
+        if (file.size < 12) {
+            error = "file too small to be a GLB";
+            return false;
+        }
+
+        uint32_t header[3];
+        std::memcpy(header, file.data, sizeof(header));
+        if (header[0] != MAGIC) {
+            error = "invalid GLB magic number";
+            return false;
+        }
+        if (header[1] != 2) {
+            error = "unsupported GLB version " + std::to_string(header[1]);
+            return false;
+        }
+        size_t total = header[2] < file.size ? header[2] : file.size;
+
+        size_t offset = 12;
+        while (offset + 8 <= total) {
+            uint32_t chunk[2];
+            std::memcpy(chunk, file.data + offset, sizeof(chunk));
+            offset += 8;
+            if (chunk[0] > total - offset) {
+                error = "GLB chunk exceeds file size";
+                return false;
+            }
+            if (chunk[1] == CHUNK_JSON && json.empty()) {
+                json = ByteSpan{file.data + offset, chunk[0]};
+            } else if (chunk[1] == CHUNK_BIN && bin.empty()) {
+                bin = ByteSpan{file.data + offset, chunk[0]};
+            }
+            offset += (chunk[0] + 3u) & ~size_t(3);
+        }
+
+        if (json.empty()) {
+            error = "GLB has no JSON chunk";
+            return false;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../core/AssetFile.h"
+#include "../render/VertexFormat.h"
+
+// Cooked mesh (.hmesh), written by MeshCooker and mapped at runtime. The
+// vertex and index sections are stored exactly as they are uploaded, so
+// loading is a header check plus glBufferData from the mapping.
+//
+//   HMeshHeader
+//   vertices   vertexCount * vertexStride bytes (a VertexFormat layout,
+//              dequantized with the header's quantization fields)
+//   indices    indexCount * indexSize bytes (u16 when every vertex fits,
+//              else u32), LODs are ranges of this buffer
+//   LOD table  lodCount * HMeshLOD, finest first
+//   materials  materialCount * HMeshMaterial
+//   blobs      material images referenced by HMeshMaterial: htex containers
+//              (see HTexFile.h), or PNG/JPEG in files cooked before those
+//
+// Sections start on HMESH_ALIGNMENT boundaries. All values are little-endian.
+
+static constexpr uint32_t HMESH_MAGIC = 0x48534D48;  // "HMSH"
+static constexpr uint32_t HMESH_VERSION = 4;
+static constexpr size_t HMESH_ALIGNMENT = 16;
+
+enum HMeshTextureSlot {
+    HMESH_TEXTURE_BASE_COLOR = 0,
+    HMESH_TEXTURE_METALLIC_ROUGHNESS = 1,
+    HMESH_TEXTURE_NORMAL = 2,
+    HMESH_TEXTURE_SLOTS = 3
+};
+
+struct HMeshHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexFormat;
+    uint32_t vertexStride;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t lodCount;
+    uint32_t materialCount;
+    float boundsMin[3];
+    float boundsMax[3];
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t lodOffset;
+    uint64_t materialOffset;
+    uint64_t sourceSize;  // size of the GLB it was cooked from
+    float positionScale[3];
+    float positionOffset[3];
+    float uvScale[2];
+    float uvOffset[2];
+    uint32_t octNormals;
+    uint32_t indexSize;   // 2 or 4
+    uint64_t tangentOffset;  // VertexPacker::packTangents stream, or 0 without tangents
+};
+
+struct HMeshLOD {
+    uint32_t indexOffset;  // in indices, not bytes
+    uint32_t indexCount;
+    float error;           // object-space error against LOD 0
+    uint32_t reserved;
+};
+
+// Byte range of a material image inside the file; size 0 = unused
+struct HMeshBlob {
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct HMeshMaterial {
+    HMeshBlob textures[HMESH_TEXTURE_SLOTS];
+};
+
+static_assert(sizeof(HMeshHeader) == 152, "HMeshHeader layout is part of the file format");
+static_assert(sizeof(HMeshLOD) == 16, "HMeshLOD layout is part of the file format");
+static_assert(sizeof(HMeshMaterial) == 48, "HMeshMaterial layout is part of the file format");
+
+class HMeshFile {
+private:
+    AssetFile mapping;  // mounted pack entry or loose file
+    HMeshHeader header = {};
+
+    bool rangeValid(uint64_t offset, uint64_t size) const {
+        return offset <= mapping.size() && size <= mapping.size() - offset;
+    }
+
+public:
+    bool open(const std::string& path, std::string& error) {
+        header = HMeshHeader();
+        if (!mapping.open(path)) {
+            error = "could not map " + path;
+            return false;
+        }
+        if (mapping.size() < sizeof(HMeshHeader)) {
+            error = "file too small to be an hmesh";
+            return false;
+        }
+
+        std::memcpy(&header, mapping.data(), sizeof(header));
+        if (header.magic != HMESH_MAGIC) {
+            error = "invalid hmesh magic number";
+            return false;
+        }
+        if (header.version != HMESH_VERSION) {
+            error = "hmesh version " + std::to_string(header.version) + " needs re-cooking";
+            return false;
+        }
+        if (header.vertexFormat > VERTEX_HALF16 ||
+            header.vertexStride != VertexPacker::stride((VertexFormat)header.vertexFormat)) {
+            error = "unknown hmesh vertex format";
+            return false;
+        }
+        if (header.indexSize != sizeof(uint16_t) && header.indexSize != sizeof(uint32_t)) {
+            error = "unknown hmesh index size";
+            return false;
+        }
+        if (header.lodCount == 0) {
+            error = "hmesh has no LODs";
+            return false;
+        }
+
+        // Sizes are checked here once; the sections are then read without checks
+        if (!rangeValid(header.vertexOffset, (uint64_t)header.vertexCount * header.vertexStride) ||
+            !rangeValid(header.indexOffset, (uint64_t)header.indexCount * header.indexSize) ||
+            !rangeValid(header.lodOffset, (uint64_t)header.lodCount * sizeof(HMeshLOD)) ||
+            !rangeValid(header.materialOffset, (uint64_t)header.materialCount * sizeof(HMeshMaterial)) ||
+            (header.tangentOffset && !rangeValid(header.tangentOffset, (uint64_t)header.vertexCount * VERTEX_TANGENT_STRIDE))) {
+            error = "hmesh section exceeds file size";
+            return false;
+        }
+        for (uint32_t i = 0; i < header.lodCount; ++i) {
+            HMeshLOD level = lod(i);
+            if (level.indexOffset > header.indexCount || level.indexCount > header.indexCount - level.indexOffset) {
+                error = "hmesh LOD range exceeds index buffer";
+                return false;
+            }
+        }
+        if (header.indexCount > 0 && maxIndex() >= header.vertexCount) {
+            error = "hmesh index exceeds vertex count";
+            return false;
+        }
+        for (uint32_t i = 0; i < header.materialCount; ++i) {
+            HMeshMaterial mat = material(i);
+            for (const HMeshBlob& blob : mat.textures) {
+                if (!rangeValid(blob.offset, blob.size)) {
+                    error = "hmesh texture blob exceeds file size";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool isOpen() const { return mapping.isOpen(); }
+    const HMeshHeader& getHeader() const { return header; }
+    VertexFormat vertexFormat() const { return (VertexFormat)header.vertexFormat; }
+
+    VertexQuantization quantization() const {
+        VertexQuantization q;
+        q.positionScale = glm::vec3(header.positionScale[0], header.positionScale[1], header.positionScale[2]);
+        q.positionOffset = glm::vec3(header.positionOffset[0], header.positionOffset[1], header.positionOffset[2]);
+        q.uvScale = glm::vec2(header.uvScale[0], header.uvScale[1]);
+        q.uvOffset = glm::vec2(header.uvOffset[0], header.uvOffset[1]);
+        q.octNormals = header.octNormals != 0;
+        return q;
+    }
+
+    ByteSpan vertices() const {
+        return mapping.span().subspan(header.vertexOffset, (size_t)header.vertexCount * header.vertexStride);
+    }
+
+    // Empty when the mesh was cooked without tangents
+    ByteSpan tangents() const {
+        if (!header.tangentOffset) return ByteSpan();
+        return mapping.span().subspan(header.tangentOffset, (size_t)header.vertexCount * VERTEX_TANGENT_STRIDE);
+    }
+
+    ByteSpan indices() const {
+        return mapping.span().subspan(header.indexOffset, (size_t)header.indexCount * header.indexSize);
+    }
+
+    // Indices of one LOD widened to u32, for CPU-side consumers
+    std::vector<uint32_t> lodIndices(uint32_t index) const {
+        HMeshLOD level = lod(index);
+        const uint8_t* data = indices().data + (size_t)level.indexOffset * header.indexSize;
+        std::vector<uint32_t> result(level.indexCount);
+        if (header.indexSize == sizeof(uint32_t)) {
+            std::memcpy(result.data(), data, result.size() * sizeof(uint32_t));
+        } else {
+            for (uint32_t i = 0; i < level.indexCount; ++i) {
+                uint16_t value;
+                std::memcpy(&value, data + i * sizeof(uint16_t), sizeof(value));
+                result[i] = value;
+            }
+        }
+        return result;
+    }
+
+    // Largest value in the index buffer, every LOD included
+    uint32_t maxIndex() const {
+        const uint8_t* data = mapping.data() + header.indexOffset;
+        uint32_t result = 0;
+        if (header.indexSize == sizeof(uint32_t)) {
+            for (uint32_t i = 0; i < header.indexCount; ++i) {
+                uint32_t value;
+                std::memcpy(&value, data + (size_t)i * sizeof(uint32_t), sizeof(value));
+                result = std::max(result, value);
+            }
+        } else {
+            for (uint32_t i = 0; i < header.indexCount; ++i) {
+                uint16_t value;
+                std::memcpy(&value, data + (size_t)i * sizeof(uint16_t), sizeof(value));
+                result = std::max(result, (uint32_t)value);
+            }
+        }
+        return result;
+    }
+
+    HMeshLOD lod(uint32_t index) const {
+        HMeshLOD level;
+        std::memcpy(&level, mapping.data() + header.lodOffset + index * sizeof(HMeshLOD), sizeof(level));
+        return level;
+    }
+
+    HMeshMaterial material(uint32_t index) const {
+        HMeshMaterial mat;
+        std::memcpy(&mat, mapping.data() + header.materialOffset + index * sizeof(HMeshMaterial), sizeof(mat));
+        return mat;
+    }
+
+    ByteSpan texture(uint32_t materialIndex, HMeshTextureSlot slot) const {
+        if (materialIndex >= header.materialCount) return ByteSpan();
+        HMeshBlob blob = material(materialIndex).textures[slot];
+        return mapping.span().subspan(blob.offset, blob.size);
+    }
+};
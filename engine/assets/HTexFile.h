@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstring>
+#include <string>
+
+#include "../core/AssetFile.h"
+
+// Cooked texture container (.htex), written by TextureCooker. Holds a full
+// mip chain, largest first, already in the GPU block format:
+//
+//   HTexHeader
+//   HTexLevel[levelCount]
+//   level data, each level on an HTEX_ALIGNMENT boundary
+//
+// Offsets are relative to the start of the container, so the same bytes
+// work as a standalone file or as a blob embedded in a .hmesh.
+
+static constexpr uint32_t HTEX_MAGIC = 0x58455448;  // "HTEX"
+static constexpr uint32_t HTEX_VERSION = 1;
+static constexpr size_t HTEX_ALIGNMENT = 16;
+
+enum HTexFormat : uint32_t {
+    HTEX_RGBA8 = 0,
+    HTEX_BC1 = 1,  // RGB, 8 bytes per 4x4 block
+    HTEX_BC3 = 2,  // RGBA, 16 bytes per block
+    HTEX_BC5 = 3,  // RG (normal maps), 16 bytes per block
+    HTEX_BC7 = 4,  // RGBA, 16 bytes per block
+};
+
+enum HTexFlags : uint32_t {
+    HTEX_FLAG_SRGB = 1,    // colour data (informational; sampled as UNORM)
+    HTEX_FLAG_NORMAL = 2,  // tangent-space normal map, z must be reconstructed for BC5
+};
+
+struct HTexHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t flags;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t reserved;
+};
+
+struct HTexLevel {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+
+static_assert(sizeof(HTexHeader) == 32, "HTexHeader layout is part of the file format");
+static_assert(sizeof(HTexLevel) == 24, "HTexLevel layout is part of the file format");
+
+// Validated, non-owning view of a container
+class HTexView {
+private:
+    ByteSpan bytes;
+    HTexHeader header = {};
+
+public:
+    static bool isContainer(ByteSpan data) {
+        uint32_t magic = 0;
+        if (data.size < sizeof(magic)) return false;
+        std::memcpy(&magic, data.data, sizeof(magic));
+        return magic == HTEX_MAGIC;
+    }
+
+    bool parse(ByteSpan data, std::string& error) {
+        bytes = ByteSpan();
+        if (data.size < sizeof(HTexHeader) || !isContainer(data)) {
+            error = "not an htex container";
+            return false;
+        }
+        std::memcpy(&header, data.data, sizeof(header));
+        if (header.version != HTEX_VERSION) {
+            error = "htex version " + std::to_string(header.version) + " needs re-cooking";
+            return false;
+        }
+        if (header.format > HTEX_BC7 || header.levelCount == 0 || header.levelCount > 32) {
+            error = "invalid htex header";
+            return false;
+        }
+        if (data.size - sizeof(HTexHeader) < header.levelCount * sizeof(HTexLevel)) {
+            error = "htex level table exceeds container";
+            return false;
+        }
+
+        bytes = data;
+        for (uint32_t i = 0; i < header.levelCount; ++i) {
+            HTexLevel info = level(i);
+            if (info.offset > data.size || info.size > data.size - info.offset ||
+                info.size < levelSize((HTexFormat)header.format, info.width, info.height)) {
+                bytes = ByteSpan();
+                error = "htex level exceeds container";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool valid() const { return !bytes.empty(); }
+    const HTexHeader& getHeader() const { return header; }
+    HTexFormat format() const { return (HTexFormat)header.format; }
+    uint32_t levelCount() const { return header.levelCount; }
+
+    HTexLevel level(uint32_t index) const {
+        HTexLevel info;
+        std::memcpy(&info, bytes.data + sizeof(HTexHeader) + index * sizeof(HTexLevel), sizeof(info));
+        return info;
+    }
+
+    ByteSpan levelData(uint32_t index) const {
+        HTexLevel info = level(index);
+        return bytes.subspan(info.offset, info.size);
+    }
+
+    static size_t blockBytes(HTexFormat format) {
+        return format == HTEX_BC1 ? 8 : 16;
+    }
+
+    static size_t levelSize(HTexFormat format, uint32_t width, uint32_t height) {
+        if (format == HTEX_RGBA8) return (size_t)width * height * 4;
+        return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+    }
+};
+
+// Standalone .htex file, mapped for its lifetime
+class HTexFile {
+private:
+    AssetFile mapping;  // mounted pack entry or loose file
+    HTexView view;
+
+public:
+    bool open(const std::string& path, std::string& error) {
+        if (!mapping.open(path)) {
+            error = "could not map " + path;
+            return false;
+        }
+        return view.parse(mapping.span(), error);
+    }
+
+    const HTexView& getView() const { return view; }
+};
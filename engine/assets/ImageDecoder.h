@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Declarations only; the including executable defines STB_IMAGE_IMPLEMENTATION
+#include "../../dependencies/stb_image.h"
+
+// How mip levels of an image are filtered
+enum class ImageColorSpace {
+    SRGB,    // colour data, averaged in linear light
+    LINEAR,  // data maps (metallic/roughness, masks)
+    NORMAL   // tangent-space normals, renormalised per texel
+};
+
+struct MipLevel {
+    int width = 0;
+    int height = 0;
+    size_t offset = 0;  // byte offset into DecodedImage::pixels
+};
+
+// RGBA8 image with its full mip chain stored back to back, largest first
+struct DecodedImage {
+    std::vector<uint8_t> pixels;
+    std::vector<MipLevel> levels;
+
+    bool valid() const { return !levels.empty(); }
+    const uint8_t* level(size_t index) const { return pixels.data() + levels[index].offset; }
+};
+
+// PNG/JPEG decoding from memory plus CPU mip generation. Pure CPU work with
+// no shared state, so any number of images can be decoded on worker threads.
+class ImageDecoder {
+public:
+    static bool decode(const uint8_t* data, size_t size, ImageColorSpace space,
+                       DecodedImage& out, std::string& error) {
+        out = DecodedImage();
+        if (!data || size == 0 || size > INT32_MAX) {
+            error = "empty image";
+            return false;
+        }
+
+        int width, height, channels;
+        stbi_uc* decoded = stbi_load_from_memory(data, (int)size, &width, &height, &channels, 4);
+        if (!decoded) {
+            error = stbi_failure_reason();
+            return false;
+        }
+
+        size_t total = 0;
+        for (int w = width, h = height;; w = std::max(1, w / 2), h = std::max(1, h / 2)) {
+            out.levels.push_back(MipLevel{w, h, total});
+            total += (size_t)w * h * 4;
+            if (w == 1 && h == 1) break;
+        }
+
+        out.pixels.resize(total);
+        std::copy(decoded, decoded + (size_t)width * height * 4, out.pixels.begin());
+        stbi_image_free(decoded);
+
+        for (size_t i = 1; i < out.levels.size(); ++i) {
+            downsample(out.pixels.data() + out.levels[i - 1].offset, out.levels[i - 1].width, out.levels[i - 1].height,
+                       out.pixels.data() + out.levels[i].offset, out.levels[i].width, out.levels[i].height, space);
+        }
+        return true;
+    }
+
+    // 2x2 box filter; odd edges reuse the last row/column
+    static void downsample(const uint8_t* src, int srcWidth, int srcHeight,
+                           uint8_t* dst, int dstWidth, int dstHeight, ImageColorSpace space) {
+        const float* toLinear = srgbToLinearTable();
+        for (int y = 0; y < dstHeight; ++y) {
+            int y0 = std::min(y * 2, srcHeight - 1), y1 = std::min(y * 2 + 1, srcHeight - 1);
+            for (int x = 0; x < dstWidth; ++x) {
+                int x0 = std::min(x * 2, srcWidth - 1), x1 = std::min(x * 2 + 1, srcWidth - 1);
+                const uint8_t* texels[4] = {
+                    src + ((size_t)y0 * srcWidth + x0) * 4, src + ((size_t)y0 * srcWidth + x1) * 4,
+                    src + ((size_t)y1 * srcWidth + x0) * 4, src + ((size_t)y1 * srcWidth + x1) * 4};
+                uint8_t* out = dst + ((size_t)y * dstWidth + x) * 4;
+
+                float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                for (const uint8_t* t : texels) {
+                    for (int c = 0; c < 3; ++c) {
+                        sum[c] += space == ImageColorSpace::SRGB ? toLinear[t[c]] : t[c] * (1.0f / 255.0f);
+                    }
+                    sum[3] += t[3] * (1.0f / 255.0f);
+                }
+                for (float& s : sum) s *= 0.25f;
+
+                if (space == ImageColorSpace::SRGB) {
+                    for (int c = 0; c < 3; ++c) out[c] = linearToSrgb(sum[c]);
+                } else if (space == ImageColorSpace::NORMAL) {
+                    float n[3] = {sum[0] * 2.0f - 1.0f, sum[1] * 2.0f - 1.0f, sum[2] * 2.0f - 1.0f};
+                    float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                    if (length < 1e-6f) { n[0] = 0.0f; n[1] = 0.0f; n[2] = 1.0f; length = 1.0f; }
+                    for (int c = 0; c < 3; ++c) out[c] = toByte((n[c] / length) * 0.5f + 0.5f);
+                } else {
+                    for (int c = 0; c < 3; ++c) out[c] = toByte(sum[c]);
+                }
+                out[3] = toByte(sum[3]);
+            }
+        }
+    }
+
+private:
+    static uint8_t toByte(float value) {
+        return (uint8_t)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+
+    static const float* srgbToLinearTable() {
+        struct Table {
+            float values[256];
+            Table() {
+                for (int i = 0; i < 256; ++i) {
+                    float c = i / 255.0f;
+                    values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                }
+            }
+        };
+        static const Table table;
+        return table.values;
+    }
+
+    static uint8_t linearToSrgb(float value) {
+        // 12-bit table keeps the dark end precise without a pow per texel
+        struct Table {
+            uint8_t values[4096];
+            Table() {
+                for (int i = 0; i < 4096; ++i) {
+                    float c = i / 4095.0f;
+                    float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+                    values[i] = (uint8_t)(std::min(std::max(s, 0.0f), 1.0f) * 255.0f + 0.5f);
+                }
+            }
+        };
+        static const Table table;
+        int index = (int)(std::min(std::max(value, 0.0f), 1.0f) * 4095.0f + 0.5f);
+        return table.values[index];
+    }
+};
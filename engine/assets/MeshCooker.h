@@ -0,0 +1,169 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "CookedAsset.h"
+#include "GLBFile.h"
+#include "HMeshFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "TextureCooker.h"
+
+// Offline GLB -> .hmesh conversion (run by cook.exe) and the freshness check
+// the runtime uses to decide between the cooked file and its source.
+class MeshCooker {
+public:
+    // "models/tv.glb" -> "models/tv.hmesh"
+    static std::string cookedPath(const std::string& sourcePath) {
+        return std::filesystem::path(sourcePath).replace_extension(".hmesh").string();
+    }
+
+    static bool isCookedCurrent(const std::string& sourcePath) {
+        return CookedAsset::isCurrent(sourcePath, cookedPath(sourcePath));
+    }
+
+    // Triangles and vertices are reordered by MeshOptimizer (its before/after
+    // statistics go to report when given) and a LOD chain is generated by
+    // MeshSimplifier. Material images are stored as compressed htex
+    // containers (see TextureCooker).
+    static bool cook(const std::string& sourcePath, const std::string& outputPath, bool preferBC7, std::string& error,
+                     MeshOptimizeReport* report = nullptr) {
+        GLTFModel model;
+        if (!GLBFile::loadModel(sourcePath, model, error)) return false;
+        if (model.positions.empty() || model.indices.empty()) {
+            error = "model has no triangles";
+            return false;
+        }
+
+        VertexFormat format = VertexPacker::chooseFormat(model.positions, model.texCoords);
+        MeshOptimizeReport optimized = MeshOptimizer::optimizeMesh(model.indices, model.positions, model.normals,
+                                                                   model.texCoords, model.tangents,
+                                                                   VertexPacker::stride(format));
+        if (report) *report = optimized;
+        std::vector<MeshLODLevel> lods = MeshSimplifier::buildLODChain(model.indices, model.positions);
+
+        std::vector<uint8_t> textures[HMESH_TEXTURE_SLOTS];
+        const GLTFImageRef* images[HMESH_TEXTURE_SLOTS] = {
+            &model.baseColorImage, &model.metallicRoughnessImage, &model.normalImage};
+        const ImageColorSpace spaces[HMESH_TEXTURE_SLOTS] = {
+            ImageColorSpace::SRGB, ImageColorSpace::LINEAR, ImageColorSpace::NORMAL};
+        for (int slot = 0; slot < HMESH_TEXTURE_SLOTS; ++slot) {
+            if (!images[slot]->valid()) continue;
+            if (!TextureCooker::cookImage(images[slot]->data, images[slot]->size, spaces[slot],
+                                          preferBC7, textures[slot], error)) {
+                error = "material image: " + error;
+                return false;
+            }
+        }
+
+        std::vector<uint8_t> data;
+        if (!serialize(model, lods, textures, CookedAsset::fileSize(sourcePath), data, error)) return false;
+        return CookedAsset::write(outputPath, data, error);
+    }
+
+    // lods[0] is the full mesh and every level indexes model's vertices;
+    // textures[slot] holds the blob for each material slot (empty = unused).
+    // The vertex layout is the most compact one that stays within tolerance.
+    static bool serialize(const GLTFModel& model, const std::vector<MeshLODLevel>& lods,
+                          const std::vector<uint8_t> textures[HMESH_TEXTURE_SLOTS],
+                          uint64_t sourceSize, std::vector<uint8_t>& out, std::string& error,
+                          const VertexTolerance& tolerance = VertexTolerance()) {
+        const size_t vertexCount = model.positions.size();
+        std::vector<uint32_t> indices;
+        for (const MeshLODLevel& level : lods) indices.insert(indices.end(), level.indices.begin(), level.indices.end());
+        if (lods.empty() || vertexCount > UINT32_MAX || indices.size() > UINT32_MAX) {
+            error = "model too large for hmesh";
+            return false;
+        }
+
+        HMeshHeader header = {};
+        header.magic = HMESH_MAGIC;
+        header.version = HMESH_VERSION;
+        VertexFormat format = VertexPacker::chooseFormat(model.positions, model.texCoords, tolerance);
+        VertexQuantization quantization;
+        std::vector<uint8_t> vertices;
+        VertexPacker::pack(format, model.positions, model.normals, model.texCoords, vertices, quantization);
+
+        header.vertexFormat = format;
+        header.vertexStride = (uint32_t)VertexPacker::stride(format);
+        header.vertexCount = (uint32_t)vertexCount;
+        header.indexCount = (uint32_t)indices.size();
+        header.lodCount = (uint32_t)lods.size();
+        header.materialCount = 1;
+        header.sourceSize = sourceSize;
+
+        glm::vec3 boundsMin = model.positions[0], boundsMax = model.positions[0];
+        for (const glm::vec3& p : model.positions) {
+            boundsMin = glm::min(boundsMin, p);
+            boundsMax = glm::max(boundsMax, p);
+        }
+        for (int i = 0; i < 3; ++i) {
+            header.boundsMin[i] = boundsMin[i];
+            header.boundsMax[i] = boundsMax[i];
+            header.positionScale[i] = quantization.positionScale[i];
+            header.positionOffset[i] = quantization.positionOffset[i];
+        }
+        for (int i = 0; i < 2; ++i) {
+            header.uvScale[i] = quantization.uvScale[i];
+            header.uvOffset[i] = quantization.uvOffset[i];
+        }
+        header.octNormals = quantization.octNormals ? 1 : 0;
+
+        out.clear();
+        out.resize(sizeof(HMeshHeader));
+
+        header.vertexOffset = align(out);
+        append(out, vertices.data(), vertices.size());
+
+        if (model.tangents.size() == vertexCount) {
+            std::vector<int16_t> tangents;
+            VertexPacker::packTangents(model.tangents, tangents);
+            header.tangentOffset = align(out);
+            append(out, tangents.data(), tangents.size() * sizeof(int16_t));
+        }
+
+        header.indexOffset = align(out);
+        if (MeshOptimizer::fitsShortIndices(vertexCount)) {
+            std::vector<uint16_t> shortIndices = MeshOptimizer::toShortIndices(indices);
+            header.indexSize = sizeof(uint16_t);
+            append(out, shortIndices.data(), shortIndices.size() * sizeof(uint16_t));
+        } else {
+            header.indexSize = sizeof(uint32_t);
+            append(out, indices.data(), indices.size() * sizeof(uint32_t));
+        }
+
+        header.lodOffset = align(out);
+        uint32_t lodStart = 0;
+        for (const MeshLODLevel& level : lods) {
+            HMeshLOD lod = {lodStart, (uint32_t)level.indices.size(), level.error, 0};
+            append(out, &lod, sizeof(lod));
+            lodStart += lod.indexCount;
+        }
+
+        header.materialOffset = align(out);
+        size_t materialPos = out.size();
+        HMeshMaterial material = {};
+        append(out, &material, sizeof(material));
+
+        for (int slot = 0; slot < HMESH_TEXTURE_SLOTS; ++slot) {
+            if (textures[slot].empty()) continue;
+            material.textures[slot].offset = align(out);
+            material.textures[slot].size = textures[slot].size();
+            append(out, textures[slot].data(), textures[slot].size());
+        }
+        std::memcpy(out.data() + materialPos, &material, sizeof(material));
+        std::memcpy(out.data(), &header, sizeof(header));
+        return true;
+    }
+
+private:
+    static uint64_t align(std::vector<uint8_t>& out) {
+        return CookedAsset::align(out, HMESH_ALIGNMENT);
+    }
+
+    static void append(std::vector<uint8_t>& out, const void* data, size_t size) {
+        CookedAsset::append(out, data, size);
+    }
+};
@@ -0,0 +1,423 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../core/JobSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MESH_GEOMETRY_SSE2 1
+#endif
+
+// Per-vertex normals and tangents for indexed triangle meshes.
+//
+// Triangles are split into fixed-size chunks. Each chunk scatters its face
+// vectors into a private buffer covering the vertices it touches; a second
+// pass, split by vertex range, adds the chunk buffers in chunk order.
+// Chunking depends only on the mesh, so results are bit-identical for any
+// thread count. With SSE2, normals take one triangle per step, the cross
+// product and each corner's accumulation being single vector ops; tangent
+// frames are computed for four triangles at a time, and their scatter into
+// the buffer stays scalar.
+class MeshGeometry {
+public:
+    // Area-weighted smooth normals for the vertices used by indices[indexBegin, indexEnd).
+    // Other vertices keep their normals. parallel spreads the work over the
+    // JobSystem; false keeps it on the calling thread.
+    static void computeNormals(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+                               size_t indexBegin, size_t indexEnd, std::vector<glm::vec3>& normals,
+                               bool parallel = true) {
+        Chunks chunks = splitChunks(indices, indexBegin, indexEnd, parallel);
+        if (chunks.count() == 0) return;
+
+        std::vector<std::vector<NormalSum>> sums(chunks.count());
+        parallelFor(chunks.count(), 1, parallel, [&](size_t first, size_t last) {
+            for (size_t k = first; k < last; ++k) scatterNormals(positions, indices, chunks, k, sums[k]);
+        });
+
+        mergeChunks(chunks, sums, parallel, [&](uint32_t vertex, const NormalSum& sum) {
+            glm::vec3 n(sum.n);
+            float len = glm::length(n);
+            normals[vertex] = len > 0.0f ? n / len : glm::vec3(0.0f, 1.0f, 0.0f);
+        });
+    }
+
+    // MikkTSpace-compatible tangents (w is the bitangent sign, as in glTF) for
+    // the vertices used by indices[indexBegin, indexEnd). Face tangents are
+    // projected onto each vertex normal and weighted by the corner angle, as
+    // MikkTSpace does; vertices are never split, so a vertex shared by mirrored
+    // UV islands gets the average. Needs normals for those vertices.
+    static void computeTangents(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+                                const std::vector<glm::vec2>& texCoords, const std::vector<uint32_t>& indices,
+                                size_t indexBegin, size_t indexEnd, std::vector<glm::vec4>& tangents,
+                                bool parallel = true) {
+        Chunks chunks = splitChunks(indices, indexBegin, indexEnd, parallel);
+        if (chunks.count() == 0) return;
+
+        // Without UVs every face is degenerate and tangents fall back to any perpendicular
+        std::vector<glm::vec2> noTexCoords;
+        const std::vector<glm::vec2>* uvs = &texCoords;
+        if (texCoords.size() < positions.size()) {
+            noTexCoords.assign(positions.size(), glm::vec2(0.0f));
+            uvs = &noTexCoords;
+        }
+
+        std::vector<std::vector<TangentSum>> sums(chunks.count());
+        parallelFor(chunks.count(), 1, parallel, [&](size_t first, size_t last) {
+            for (size_t k = first; k < last; ++k) scatterTangents(positions, normals, *uvs, indices, chunks, k, sums[k]);
+        });
+
+        mergeChunks(chunks, sums, parallel, [&](uint32_t vertex, const TangentSum& sum) {
+            glm::vec3 n = normals[vertex];
+            glm::vec3 t = safeNormalize(project(sum.s, n));
+            if (t == glm::vec3(0.0f)) t = perpendicular(n);
+            float w = glm::dot(glm::cross(n, t), sum.t) < 0.0f ? -1.0f : 1.0f;
+            tangents[vertex] = glm::vec4(t, w);
+        });
+    }
+
+    // Runs fn(begin, end) over [0, count) in blocks of grain, on the
+    // JobSystem's workers and the calling thread when parallel. Safe from
+    // inside a job: the caller runs whatever blocks the workers do not take.
+    template <typename Fn>
+    static void parallelFor(size_t count, size_t grain, bool parallel, Fn&& fn) {
+        size_t blocks = (count + grain - 1) / grain;
+        if (!parallel || blocks <= 1) {
+            if (count > 0) fn(0, count);
+            return;
+        }
+        JobSystem::getInstance().parallelFor(blocks, [&](size_t block) {
+            fn(block * grain, std::min(count, (block + 1) * grain));
+        });
+    }
+
+private:
+    static constexpr size_t TRIANGLE_GRAIN = 16384;  // multiple of 4 so SIMD groups never straddle chunks
+    static constexpr size_t VERTEX_GRAIN = 4096;     // small enough for the merge buffer to be recycled
+    static constexpr size_t WINDOW_BUDGET = 4;       // chunk buffers may total this many times the vertex range
+    static constexpr float DEGENERATE_UV_AREA = 1e-20f;
+
+    // xyz: summed face normals, w: corner count (exact below 2^24)
+    struct NormalSum {
+        glm::vec4 n = glm::vec4(0.0f);
+
+        void add(const NormalSum& other) { n += other.n; }
+        bool used() const { return n.w > 0.0f; }
+    };
+
+    struct TangentSum {
+        glm::vec3 s = glm::vec3(0.0f);  // angle-weighted dP/du
+        uint32_t corners = 0;
+        glm::vec3 t = glm::vec3(0.0f);  // angle-weighted dP/dv, only its side of the normal matters
+
+        void add(const TangentSum& other) {
+            s += other.s;
+            t += other.t;
+            corners += other.corners;
+        }
+        bool used() const { return corners > 0; }
+    };
+
+    // Triangle chunks and the vertex window [windowBegin, windowEnd) each one touches
+    struct Chunks {
+        size_t indexBegin = 0;
+        size_t triangleCount = 0;
+        size_t grain = TRIANGLE_GRAIN;
+        uint32_t vertexBegin = 0, vertexEnd = 0;
+        std::vector<uint32_t> windowBegin, windowEnd;
+
+        size_t count() const { return windowBegin.size(); }
+        size_t first(size_t k) const { return k * grain; }
+        size_t last(size_t k) const { return std::min(triangleCount, (k + 1) * grain); }
+    };
+
+    static Chunks splitChunks(const std::vector<uint32_t>& indices, size_t indexBegin, size_t indexEnd,
+                              bool parallel) {
+        Chunks chunks;
+        indexEnd = std::min(indexEnd, indices.size());
+        if (indexEnd <= indexBegin) return chunks;
+        chunks.indexBegin = indexBegin;
+        chunks.triangleCount = (indexEnd - indexBegin) / 3;
+        if (chunks.triangleCount == 0) return chunks;
+
+        auto measure = [&]() {
+            size_t count = (chunks.triangleCount + chunks.grain - 1) / chunks.grain;
+            chunks.windowBegin.assign(count, UINT32_MAX);
+            chunks.windowEnd.assign(count, 0);
+            parallelFor(count, 1, parallel, [&](size_t first, size_t last) {
+                for (size_t k = first; k < last; ++k) {
+                    uint32_t lo = UINT32_MAX, hi = 0;
+                    const uint32_t* end = indices.data() + indexBegin + chunks.last(k) * 3;
+                    for (const uint32_t* i = indices.data() + indexBegin + chunks.first(k) * 3; i < end; ++i) {
+                        lo = *i < lo ? *i : lo;
+                        hi = *i > hi ? *i : hi;
+                    }
+                    chunks.windowBegin[k] = lo;
+                    chunks.windowEnd[k] = hi + 1;
+                }
+            });
+            chunks.vertexBegin = *std::min_element(chunks.windowBegin.begin(), chunks.windowBegin.end());
+            chunks.vertexEnd = *std::max_element(chunks.windowEnd.begin(), chunks.windowEnd.end());
+        };
+        measure();
+
+        // Poorly ordered meshes would need a near-full buffer per chunk; use a single chunk instead
+        size_t total = 0;
+        for (size_t k = 0; k < chunks.count(); ++k) total += chunks.windowEnd[k] - chunks.windowBegin[k];
+        if (chunks.count() > 1 && total > WINDOW_BUDGET * (size_t)(chunks.vertexEnd - chunks.vertexBegin)) {
+            chunks.grain = chunks.triangleCount;
+            measure();
+        }
+        return chunks;
+    }
+
+    // Adds the chunk buffers covering each vertex, in chunk order, and hands
+    // every vertex some triangle used to fn(vertex, sum)
+    template <typename Sum, typename Fn>
+    static void mergeChunks(const Chunks& chunks, const std::vector<std::vector<Sum>>& sums,
+                            bool parallel, Fn&& fn) {
+        size_t vertexCount = chunks.vertexEnd - chunks.vertexBegin;
+        parallelFor(vertexCount, VERTEX_GRAIN, parallel, [&](size_t first, size_t last) {
+            uint32_t blockBegin = chunks.vertexBegin + (uint32_t)first;
+            uint32_t blockEnd = chunks.vertexBegin + (uint32_t)last;
+            std::vector<Sum> block(last - first);
+            for (size_t k = 0; k < chunks.count(); ++k) {
+                uint32_t begin = std::max(blockBegin, chunks.windowBegin[k]);
+                uint32_t end = std::min(blockEnd, chunks.windowEnd[k]);
+                for (uint32_t v = begin; v < end; ++v) {
+                    block[v - blockBegin].add(sums[k][v - chunks.windowBegin[k]]);
+                }
+            }
+            for (uint32_t v = blockBegin; v < blockEnd; ++v) {
+                if (block[v - blockBegin].used()) fn(v, block[v - blockBegin]);
+            }
+        });
+    }
+
+    // Unnormalized face normals (length is twice the area) added to each corner
+    static void scatterNormals(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+                               const Chunks& chunks, size_t k, std::vector<NormalSum>& sums) {
+        sums.assign(chunks.windowEnd[k] - chunks.windowBegin[k], NormalSum());
+        const uint32_t base = chunks.windowBegin[k];
+        const size_t first = chunks.first(k), last = chunks.last(k);
+
+#ifdef MESH_GEOMETRY_SSE2
+        // One triangle per step: the cross product runs on xyz lanes and w
+        // counts the corner, so each corner is a single vector add
+        const __m128 corner = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+        for (size_t t = first; t < last; ++t) {
+            const uint32_t* tri = &indices[chunks.indexBegin + t * 3];
+            __m128 p0 = load3(positions[tri[0]]);
+            __m128 e1 = _mm_sub_ps(load3(positions[tri[1]]), p0);
+            __m128 e2 = _mm_sub_ps(load3(positions[tri[2]]), p0);
+            __m128 face = _mm_add_ps(cross3(e1, e2), corner);
+            for (int c = 0; c < 3; ++c) {
+                float* sum = &sums[tri[c] - base].n.x;
+                _mm_storeu_ps(sum, _mm_add_ps(_mm_loadu_ps(sum), face));
+            }
+        }
+#else
+        for (size_t t = first; t < last; ++t) {
+            const uint32_t* tri = &indices[chunks.indexBegin + t * 3];
+            glm::vec3 normal = glm::cross(positions[tri[1]] - positions[tri[0]], positions[tri[2]] - positions[tri[0]]);
+            for (int c = 0; c < 3; ++c) sums[tri[c] - base].n += glm::vec4(normal, 1.0f);
+        }
+#endif
+    }
+
+    // Per face: unit dP/du and dP/dv, flipped on mirrored UVs the way
+    // MikkTSpace does and zero where the UV mapping is degenerate. Per corner:
+    // both projected onto the vertex normal and weighted by the corner angle.
+    static void scatterTangents(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+                                const std::vector<glm::vec2>& texCoords, const std::vector<uint32_t>& indices,
+                                const Chunks& chunks, size_t k, std::vector<TangentSum>& sums) {
+        sums.assign(chunks.windowEnd[k] - chunks.windowBegin[k], TangentSum());
+        const uint32_t base = chunks.windowBegin[k];
+        const size_t first = chunks.first(k), last = chunks.last(k);
+
+#ifdef MESH_GEOMETRY_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        const __m128 epsilon = _mm_set1_ps(DEGENERATE_UV_AREA);
+
+        for (size_t t = first; t < last; t += 4) {
+            const uint32_t* tri[4];
+            laneTriangles(indices, chunks.indexBegin, t, last, tri);
+            Vec4x3 p[3] = {gather(positions, tri, 0), gather(positions, tri, 1), gather(positions, tri, 2)};
+            __m128 u[3], v[3];
+            for (int c = 0; c < 3; ++c) gather(texCoords, tri, c, u[c], v[c]);
+
+            Vec4x3 d1 = sub(p[1], p[0]);
+            Vec4x3 d2 = sub(p[2], p[0]);
+            __m128 t21x = _mm_sub_ps(u[1], u[0]), t21y = _mm_sub_ps(v[1], v[0]);
+            __m128 t31x = _mm_sub_ps(u[2], u[0]), t31y = _mm_sub_ps(v[2], v[0]);
+
+            __m128 area = _mm_sub_ps(_mm_mul_ps(t21x, t31y), _mm_mul_ps(t21y, t31x));
+            __m128 valid = _mm_cmpgt_ps(_mm_andnot_ps(signMask, area), epsilon);
+            __m128 sign = _mm_or_ps(one, _mm_and_ps(area, signMask));
+
+            Vec4x3 faceS = sub(scale(d1, t31y), scale(d2, t21y));
+            Vec4x3 faceT = sub(scale(d2, t21x), scale(d1, t31x));
+            faceS = scale(faceS, _mm_and_ps(valid, _mm_mul_ps(sign, inverseLength(faceS, zero))));
+            faceT = scale(faceT, _mm_and_ps(valid, _mm_mul_ps(sign, inverseLength(faceT, zero))));
+
+            alignas(16) float out[3][6][4];
+            for (int c = 0; c < 3; ++c) {
+                Vec4x3 n = gather(normals, tri, c);
+                Vec4x3 e1 = normalize(project(sub(p[(c + 1) % 3], p[c]), n), zero);
+                Vec4x3 e2 = normalize(project(sub(p[(c + 2) % 3], p[c]), n), zero);
+                __m128 angle = acosApprox(dot(e1, e2));
+
+                store(&out[c][0], scale(normalize(project(faceS, n), zero), angle));
+                store(&out[c][3], scale(normalize(project(faceT, n), zero), angle));
+            }
+
+            size_t lanes = std::min<size_t>(4, last - t);
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                for (int c = 0; c < 3; ++c) {
+                    TangentSum& sum = sums[tri[lane][c] - base];
+                    sum.s += glm::vec3(out[c][0][lane], out[c][1][lane], out[c][2][lane]);
+                    sum.t += glm::vec3(out[c][3][lane], out[c][4][lane], out[c][5][lane]);
+                    ++sum.corners;
+                }
+            }
+        }
+#else
+        for (size_t t = first; t < last; ++t) {
+            const uint32_t* tri = &indices[chunks.indexBegin + t * 3];
+            glm::vec2 uv[3];
+            for (int c = 0; c < 3; ++c) uv[c] = texCoords[tri[c]];
+            glm::vec3 d1 = positions[tri[1]] - positions[tri[0]];
+            glm::vec3 d2 = positions[tri[2]] - positions[tri[0]];
+            glm::vec2 t21 = uv[1] - uv[0], t31 = uv[2] - uv[0];
+
+            float area = t21.x * t31.y - t21.y * t31.x;
+            bool valid = std::fabs(area) > DEGENERATE_UV_AREA;
+            float sign = area < 0.0f ? -1.0f : 1.0f;
+            glm::vec3 faceS = valid ? sign * safeNormalize(t31.y * d1 - t21.y * d2) : glm::vec3(0.0f);
+            glm::vec3 faceT = valid ? sign * safeNormalize(t21.x * d2 - t31.x * d1) : glm::vec3(0.0f);
+
+            for (int c = 0; c < 3; ++c) {
+                glm::vec3 n = normals[tri[c]];
+                glm::vec3 p0 = positions[tri[c]];
+                glm::vec3 e1 = safeNormalize(project(positions[tri[(c + 1) % 3]] - p0, n));
+                glm::vec3 e2 = safeNormalize(project(positions[tri[(c + 2) % 3]] - p0, n));
+                float angle = std::acos(std::min(std::max(glm::dot(e1, e2), -1.0f), 1.0f));
+
+                TangentSum& sum = sums[tri[c] - base];
+                sum.s += angle * safeNormalize(project(faceS, n));
+                sum.t += angle * safeNormalize(project(faceT, n));
+                ++sum.corners;
+            }
+        }
+#endif
+    }
+
+#ifdef MESH_GEOMETRY_SSE2
+    // Four vec3s in structure-of-arrays form
+    struct Vec4x3 {
+        __m128 x, y, z;
+    };
+
+    static void store(float (*p)[4], const Vec4x3& v) {
+        _mm_store_ps(p[0], v.x);
+        _mm_store_ps(p[1], v.y);
+        _mm_store_ps(p[2], v.z);
+    }
+    static Vec4x3 sub(const Vec4x3& a, const Vec4x3& b) {
+        return {_mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z)};
+    }
+    static Vec4x3 cross(const Vec4x3& a, const Vec4x3& b) {
+        return {_mm_sub_ps(_mm_mul_ps(a.y, b.z), _mm_mul_ps(a.z, b.y)),
+                _mm_sub_ps(_mm_mul_ps(a.z, b.x), _mm_mul_ps(a.x, b.z)),
+                _mm_sub_ps(_mm_mul_ps(a.x, b.y), _mm_mul_ps(a.y, b.x))};
+    }
+    static Vec4x3 scale(const Vec4x3& v, __m128 s) { return {_mm_mul_ps(v.x, s), _mm_mul_ps(v.y, s), _mm_mul_ps(v.z, s)}; }
+    static __m128 dot(const Vec4x3& a, const Vec4x3& b) {
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+    }
+    static Vec4x3 project(const Vec4x3& v, const Vec4x3& n) { return sub(v, scale(n, dot(n, v))); }
+
+    // 1 / |v|, or 0 for zero-length lanes
+    static __m128 inverseLength(const Vec4x3& v, __m128 zero) {
+        __m128 lenSq = dot(v, v);
+        __m128 nonZero = _mm_cmpgt_ps(lenSq, zero);
+        __m128 len = _mm_sqrt_ps(_mm_or_ps(lenSq, _mm_andnot_ps(nonZero, _mm_set1_ps(1.0f))));
+        return _mm_and_ps(nonZero, _mm_div_ps(_mm_set1_ps(1.0f), len));
+    }
+    static Vec4x3 normalize(const Vec4x3& v, __m128 zero) { return scale(v, inverseLength(v, zero)); }
+
+    // acos on [-1, 1] (Abramowitz & Stegun 4.4.46, error below 2e-8)
+    static __m128 acosApprox(__m128 x) {
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        __m128 a = _mm_min_ps(_mm_andnot_ps(signMask, x), one);
+        __m128 poly = _mm_set1_ps(-0.0012624911f);
+        const float coefficients[] = {0.0066700901f, -0.0170881256f, 0.0308918810f, -0.0501743046f,
+                                      0.0889789874f, -0.2145988016f, 1.5707963050f};
+        for (float c : coefficients) poly = _mm_add_ps(_mm_mul_ps(poly, a), _mm_set1_ps(c));
+        __m128 r = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(one, a)), poly);
+        __m128 negative = _mm_cmplt_ps(x, _mm_setzero_ps());
+        __m128 mirrored = _mm_sub_ps(_mm_set1_ps(3.14159265f), r);
+        return _mm_or_ps(_mm_and_ps(negative, mirrored), _mm_andnot_ps(negative, r));
+    }
+
+    static __m128 load3(const glm::vec3& v) { return _mm_setr_ps(v.x, v.y, v.z, 0.0f); }
+
+    // Cross product of the xyz lanes; w comes out zero when both w lanes are zero
+    static __m128 cross3(__m128 a, __m128 b) {
+        __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+        return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+
+    // Index triples of triangles [t, t + 4); lanes past last repeat the final
+    // triangle and are never scattered
+    static void laneTriangles(const std::vector<uint32_t>& indices, size_t indexBegin, size_t t, size_t last,
+                              const uint32_t* (&tri)[4]) {
+        for (size_t lane = 0; lane < 4; ++lane) tri[lane] = &indices[indexBegin + std::min(t + lane, last - 1) * 3];
+    }
+
+    // Corner c of each lane's triangle, built in registers so no store has to
+    // forward into a wider load
+    static Vec4x3 gather(const std::vector<glm::vec3>& values, const uint32_t* const (&tri)[4], int c) {
+        const glm::vec3& a = values[tri[0][c]];
+        const glm::vec3& b = values[tri[1][c]];
+        const glm::vec3& d = values[tri[2][c]];
+        const glm::vec3& e = values[tri[3][c]];
+        return {_mm_setr_ps(a.x, b.x, d.x, e.x), _mm_setr_ps(a.y, b.y, d.y, e.y), _mm_setr_ps(a.z, b.z, d.z, e.z)};
+    }
+
+    static void gather(const std::vector<glm::vec2>& values, const uint32_t* const (&tri)[4], int c,
+                       __m128& x, __m128& y) {
+        const glm::vec2& a = values[tri[0][c]];
+        const glm::vec2& b = values[tri[1][c]];
+        const glm::vec2& d = values[tri[2][c]];
+        const glm::vec2& e = values[tri[3][c]];
+        x = _mm_setr_ps(a.x, b.x, d.x, e.x);
+        y = _mm_setr_ps(a.y, b.y, d.y, e.y);
+    }
+#endif
+
+    static glm::vec3 project(const glm::vec3& v, const glm::vec3& n) {
+        return v - n * glm::dot(n, v);
+    }
+
+    static glm::vec3 safeNormalize(const glm::vec3& v) {
+        float len = glm::length(v);
+        return len > 0.0f ? v / len : glm::vec3(0.0f);
+    }
+
+    // Any unit vector perpendicular to n
+    static glm::vec3 perpendicular(const glm::vec3& n) {
+        glm::vec3 axis = std::fabs(n.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::vec3 t = safeNormalize(project(axis, n));
+        return t == glm::vec3(0.0f) ? axis : t;
+    }
+};
@@ -0,0 +1,397 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Import-time triangle and vertex reordering. All passes work on u32 triangle
+// lists and are deterministic, so cooked files are reproducible.
+//
+//   optimizeVertexCache   Forsyth-style greedy ordering for the post-transform cache
+//   optimizeOverdraw      groups the cache-ordered triangles into clusters and
+//                         draws outward-facing clusters first (Tipsify-style)
+//   optimizeVertexFetch   renumbers vertices in first-use order for fetch locality
+//
+// optimizeMesh runs all three in that order on a GLTFModel-style SoA mesh.
+
+// Post-transform cache efficiency of an index buffer, simulated with a FIFO
+struct VertexCacheStats {
+    float acmr = 0.0f;  // vertices transformed per triangle (0.5 is ideal for grids, 3 is worst)
+    float atvr = 0.0f;  // vertices transformed per referenced vertex (1 is ideal)
+};
+
+struct MeshOptimizeReport {
+    VertexCacheStats before;
+    VertexCacheStats after;
+    float overfetchBefore = 0.0f;  // bytes fetched / vertex buffer bytes, 64-byte lines
+    float overfetchAfter = 0.0f;
+
+    std::string summary() const {
+        char text[160];
+        std::snprintf(text, sizeof(text), "ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, overfetch %.2f -> %.2f",
+                      before.acmr, after.acmr, before.atvr, after.atvr, overfetchBefore, overfetchAfter);
+        return text;
+    }
+};
+
+class MeshOptimizer {
+public:
+    static constexpr uint32_t ANALYZE_CACHE_SIZE = 16;
+    static constexpr uint32_t NO_VERTEX = 0xFFFFFFFF;
+
+    // Whether every index of a mesh with this many vertices fits GL_UNSIGNED_SHORT.
+    // 0xFFFF is kept free so it can never collide with a primitive restart index.
+    static bool fitsShortIndices(size_t vertexCount) {
+        return vertexCount <= 0xFFFF;
+    }
+
+    static std::vector<uint16_t> toShortIndices(const std::vector<uint32_t>& indices) {
+        return std::vector<uint16_t>(indices.begin(), indices.end());
+    }
+
+    static VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount,
+                                               uint32_t cacheSize = ANALYZE_CACHE_SIZE) {
+        VertexCacheStats stats;
+        if (indices.size() < 3 || vertexCount == 0) return stats;
+
+        // timestamps[v] = miss counter when v entered the FIFO; it is still
+        // cached while fewer than cacheSize misses happened since
+        std::vector<uint32_t> timestamps(vertexCount, 0);
+        std::vector<uint8_t> referenced(vertexCount, 0);
+        uint32_t misses = 0;
+        for (uint32_t index : indices) {
+            if (index >= vertexCount) continue;
+            referenced[index] = 1;
+            if (timestamps[index] == 0 || misses + 1 - timestamps[index] > cacheSize) {
+                ++misses;
+                timestamps[index] = misses;
+            }
+        }
+
+        size_t used = 0;
+        for (uint8_t r : referenced) used += r;
+        stats.acmr = (float)misses / (float)(indices.size() / 3);
+        stats.atvr = used ? (float)misses / (float)used : 0.0f;
+        return stats;
+    }
+
+    // Fraction of the vertex buffer fetched per referenced byte, using a small
+    // direct-mapped model of the vertex fetch cache
+    static float analyzeVertexFetch(const std::vector<uint32_t>& indices, size_t vertexCount, size_t vertexSize) {
+        if (indices.empty() || vertexCount == 0 || vertexSize == 0) return 0.0f;
+        const size_t lineSize = 64;
+        const size_t lineCount = 64;
+        std::vector<size_t> lines(lineCount, SIZE_MAX);
+        std::vector<uint8_t> referenced(vertexCount, 0);
+        size_t fetched = 0;
+        for (uint32_t index : indices) {
+            if (index >= vertexCount) continue;
+            referenced[index] = 1;
+            size_t first = index * vertexSize / lineSize;
+            size_t last = (index * vertexSize + vertexSize - 1) / lineSize;
+            for (size_t line = first; line <= last; ++line) {
+                size_t& slot = lines[line % lineCount];
+                if (slot != line) {
+                    slot = line;
+                    fetched += lineSize;
+                }
+            }
+        }
+        size_t used = 0;
+        for (uint8_t r : referenced) used += r;
+        return used ? (float)fetched / (float)(used * vertexSize) : 0.0f;
+    }
+
+    // Greedy triangle ordering after Forsyth, "Linear-Speed Vertex Cache
+    // Optimisation": each step emits the best-scoring triangle touching the
+    // simulated LRU cache, favouring recently used and low-valence vertices.
+    static void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0 || vertexCount == 0) return;
+
+        // Vertex -> triangle adjacency (CSR)
+        std::vector<uint32_t> valence(vertexCount, 0);
+        for (size_t i = 0; i < triangleCount * 3; ++i) ++valence[indices[i]];
+        std::vector<uint32_t> adjacencyStart(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; ++v) adjacencyStart[v + 1] = adjacencyStart[v] + valence[v];
+        std::vector<uint32_t> adjacency(adjacencyStart[vertexCount]);
+        std::vector<uint32_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (int k = 0; k < 3; ++k) adjacency[fill[indices[t * 3 + k]]++] = (uint32_t)t;
+        }
+
+        std::vector<uint32_t> remaining = valence;
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v) vertexScore[v] = scoreVertex(-1, remaining[v]);
+
+        std::vector<float> triangleScore(triangleCount);
+        std::vector<uint8_t> emitted(triangleCount, 0);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] +
+                               vertexScore[indices[t * 3 + 2]];
+        }
+
+        std::vector<uint32_t> cache, nextCache;
+        cache.reserve(FORSYTH_CACHE_SIZE + 3);
+        nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+        std::vector<uint32_t> result;
+        result.reserve(triangleCount * 3);
+        size_t scanCursor = 0;
+
+        uint32_t best = bestUnemitted(triangleScore, emitted, scanCursor);
+        while (best != NO_VERTEX) {
+            emitted[best] = 1;
+            const uint32_t tri[3] = {indices[best * 3], indices[best * 3 + 1], indices[best * 3 + 2]};
+            result.insert(result.end(), tri, tri + 3);
+
+            // New LRU order: this triangle's vertices first, then the old cache
+            nextCache.clear();
+            for (uint32_t v : tri) {
+                if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end()) nextCache.push_back(v);
+            }
+            for (uint32_t v : cache) {
+                if (v != tri[0] && v != tri[1] && v != tri[2]) nextCache.push_back(v);
+            }
+
+            for (uint32_t v : tri) {
+                // Drop the emitted triangle from v's live adjacency
+                uint32_t* begin = &adjacency[adjacencyStart[v]];
+                uint32_t* end = begin + remaining[v];
+                uint32_t* found = std::find(begin, end, best);
+                if (found != end) {
+                    std::swap(*found, *(end - 1));
+                    --remaining[v];
+                }
+            }
+
+            // Rescore every vertex whose cache state changed, and its live triangles
+            for (size_t i = 0; i < nextCache.size(); ++i) {
+                uint32_t v = nextCache[i];
+                int position = i < FORSYTH_CACHE_SIZE ? (int)i : -1;
+                cachePosition[v] = position;
+                float score = scoreVertex(position, remaining[v]);
+                float delta = score - vertexScore[v];
+                vertexScore[v] = score;
+                for (uint32_t a = 0; a < remaining[v]; ++a) {
+                    triangleScore[adjacency[adjacencyStart[v] + a]] += delta;
+                }
+            }
+            if (nextCache.size() > FORSYTH_CACHE_SIZE) nextCache.resize(FORSYTH_CACHE_SIZE);
+            cache.swap(nextCache);
+
+            // Best candidate among triangles touching the cache, else restart elsewhere
+            best = NO_VERTEX;
+            float bestScore = -1.0f;
+            for (uint32_t v : cache) {
+                for (uint32_t a = 0; a < remaining[v]; ++a) {
+                    uint32_t t = adjacency[adjacencyStart[v] + a];
+                    if (triangleScore[t] > bestScore) {
+                        bestScore = triangleScore[t];
+                        best = t;
+                    }
+                }
+            }
+            if (best == NO_VERTEX) best = bestUnemitted(triangleScore, emitted, scanCursor);
+        }
+
+        std::copy(result.begin(), result.end(), indices.begin());
+    }
+
+    // Splits the cache-ordered list into clusters that are each about as
+    // cache-efficient as the whole mesh, then sorts the clusters so that those
+    // facing away from the mesh centre draw first. The input order is kept if
+    // the sorted one would exceed threshold times the input ACMR.
+    static void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+                                 float threshold = 1.05f) {
+        if (indices.size() < 6 || positions.empty()) return;
+
+        std::vector<size_t> clusterStarts = findClusters(indices, positions.size(), threshold);
+        std::vector<uint32_t> sorted = sortClusters(indices, positions, clusterStarts);
+        float limit = analyzeVertexCache(indices, positions.size()).acmr * threshold;
+        if (analyzeVertexCache(sorted, positions.size()).acmr <= limit) indices.swap(sorted);
+    }
+
+    // Renumbers vertices in order of first use and rewrites the indices.
+    // Returns old -> new (NO_VERTEX for unreferenced vertices) and the new count.
+    static std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t>& indices, size_t vertexCount,
+                                                     size_t& uniqueCount) {
+        std::vector<uint32_t> remap(vertexCount, NO_VERTEX);
+        uint32_t next = 0;
+        for (uint32_t& index : indices) {
+            if (remap[index] == NO_VERTEX) remap[index] = next++;
+            index = remap[index];
+        }
+        uniqueCount = next;
+        return remap;
+    }
+
+    // Applies an optimizeVertexFetch remap to one attribute array
+    template <typename T>
+    static void remapVertices(std::vector<T>& values, const std::vector<uint32_t>& remap, size_t uniqueCount) {
+        if (values.size() != remap.size()) return;
+        std::vector<T> result(uniqueCount);
+        for (size_t v = 0; v < remap.size(); ++v) {
+            if (remap[v] != NO_VERTEX) result[remap[v]] = values[v];
+        }
+        values.swap(result);
+    }
+
+    // All passes on a mesh whose attributes are parallel arrays; normals and
+    // texCoords may be empty. vertexSize is the GPU stride used for overfetch.
+    static MeshOptimizeReport optimizeMesh(std::vector<uint32_t>& indices, std::vector<glm::vec3>& positions,
+                                           std::vector<glm::vec3>& normals, std::vector<glm::vec2>& texCoords,
+                                           size_t vertexSize = 32) {
+        std::vector<glm::vec4> tangents;
+        return optimizeMesh(indices, positions, normals, texCoords, tangents, vertexSize);
+    }
+
+    // Same, keeping tangents (may be empty) in step with the other attributes
+    static MeshOptimizeReport optimizeMesh(std::vector<uint32_t>& indices, std::vector<glm::vec3>& positions,
+                                           std::vector<glm::vec3>& normals, std::vector<glm::vec2>& texCoords,
+                                           std::vector<glm::vec4>& tangents, size_t vertexSize = 32) {
+        MeshOptimizeReport report;
+        report.before = analyzeVertexCache(indices, positions.size());
+        report.overfetchBefore = analyzeVertexFetch(indices, positions.size(), vertexSize);
+        for (uint32_t index : indices) {
+            if (index >= positions.size()) return report;  // leave malformed meshes alone
+        }
+
+        optimizeVertexCache(indices, positions.size());
+        optimizeOverdraw(indices, positions);
+
+        size_t uniqueCount = 0;
+        std::vector<uint32_t> remap = optimizeVertexFetch(indices, positions.size(), uniqueCount);
+        remapVertices(positions, remap, uniqueCount);
+        remapVertices(normals, remap, uniqueCount);
+        remapVertices(texCoords, remap, uniqueCount);
+        remapVertices(tangents, remap, uniqueCount);
+
+        report.after = analyzeVertexCache(indices, positions.size());
+        report.overfetchAfter = analyzeVertexFetch(indices, positions.size(), vertexSize);
+        return report;
+    }
+
+private:
+    static constexpr size_t FORSYTH_CACHE_SIZE = 32;
+    static constexpr uint32_t FORSYTH_VALENCE_TABLE = 32;
+
+    // Forsyth's scoring function, tabulated once because it runs per cache slot per step
+    static float scoreVertex(int cachePosition, uint32_t remainingValence) {
+        struct Tables {
+            float cache[FORSYTH_CACHE_SIZE];
+            float valence[FORSYTH_VALENCE_TABLE];
+            Tables() {
+                for (size_t i = 0; i < FORSYTH_CACHE_SIZE; ++i) {
+                    // The last triangle's vertices score lower to discourage strips that fold back
+                    float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+                    cache[i] = i < 3 ? 0.75f : std::pow(1.0f - (i - 3) * scaler, 1.5f);
+                }
+                // Finish off vertices with few triangles left so they can leave the cache
+                for (uint32_t i = 0; i < FORSYTH_VALENCE_TABLE; ++i) {
+                    valence[i] = i == 0 ? 0.0f : 2.0f * std::pow((float)i, -0.5f);
+                }
+            }
+        };
+        static const Tables tables;
+
+        if (remainingValence == 0) return -1.0f;  // no triangles left to help
+        float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+        return score + (remainingValence < FORSYTH_VALENCE_TABLE ? tables.valence[remainingValence]
+                                                                 : 2.0f * std::pow((float)remainingValence, -0.5f));
+    }
+
+    // Highest-scoring unemitted triangle at or after the scan cursor's first
+    // unemitted entry. Only a window is searched to keep restarts linear.
+    static uint32_t bestUnemitted(const std::vector<float>& scores, const std::vector<uint8_t>& emitted, size_t& cursor) {
+        while (cursor < emitted.size() && emitted[cursor]) ++cursor;
+        if (cursor == emitted.size()) return NO_VERTEX;
+        uint32_t best = (uint32_t)cursor;
+        size_t end = std::min(emitted.size(), cursor + 64);
+        for (size_t t = cursor + 1; t < end; ++t) {
+            if (!emitted[t] && scores[t] > scores[best]) best = (uint32_t)t;
+        }
+        return best;
+    }
+
+    // Cluster order for optimizeOverdraw: by how far each cluster's centroid
+    // lies along its average normal from the mesh centroid, largest first
+    static std::vector<uint32_t> sortClusters(const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+                                              std::vector<size_t> clusterStarts) {
+        const size_t clusterCount = clusterStarts.size();
+        clusterStarts.push_back(indices.size() / 3);
+
+        glm::dvec3 meshCentroid(0.0);
+        double meshArea = 0.0;
+        std::vector<float> sortKeys(clusterCount);
+        std::vector<glm::dvec3> centroids(clusterCount), normals(clusterCount);
+        for (size_t c = 0; c < clusterCount; ++c) {
+            glm::dvec3 centroid(0.0), normal(0.0);
+            double area = 0.0;
+            for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t) {
+                glm::dvec3 a(positions[indices[t * 3]]), b(positions[indices[t * 3 + 1]]), p(positions[indices[t * 3 + 2]]);
+                glm::dvec3 cross = glm::cross(b - a, p - a);
+                double triangleArea = glm::length(cross);
+                centroid += (a + b + p) * (triangleArea / 3.0);
+                normal += cross;
+                area += triangleArea;
+            }
+            meshCentroid += centroid;
+            meshArea += area;
+            centroids[c] = area > 0.0 ? centroid / area : centroid;
+            normals[c] = normal;
+        }
+        if (meshArea > 0.0) meshCentroid /= meshArea;
+
+        for (size_t c = 0; c < clusterCount; ++c) {
+            double length = glm::length(normals[c]);
+            sortKeys[c] = length > 0.0 ? (float)glm::dot(centroids[c] - meshCentroid, normals[c] / length) : 0.0f;
+        }
+
+        std::vector<uint32_t> order(clusterCount);
+        for (size_t c = 0; c < clusterCount; ++c) order[c] = (uint32_t)c;
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        for (uint32_t c : order) {
+            result.insert(result.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+        }
+        return result;
+    }
+
+    // First triangle of each overdraw cluster. The cache is simulated cold
+    // from each cluster start and a cluster only ends once its ACMR, warm-up
+    // included, is within threshold of the mesh, so drawing the clusters in
+    // any order costs about threshold at most.
+    static std::vector<size_t> findClusters(const std::vector<uint32_t>& indices, size_t vertexCount, float threshold) {
+        const size_t triangleCount = indices.size() / 3;
+        const float limit = analyzeVertexCache(indices, vertexCount).acmr * threshold;
+
+        std::vector<uint32_t> timestamps(vertexCount, 0);
+        uint32_t misses = 0, clusterStartMisses = 0;
+        size_t clusterTriangles = 0;
+        std::vector<size_t> starts;
+        for (size_t t = 0; t < triangleCount; ++t) {
+            if (starts.empty() || (float)(misses - clusterStartMisses) / (float)clusterTriangles <= limit) {
+                starts.push_back(t);
+                clusterStartMisses = misses;
+                clusterTriangles = 0;
+            }
+            for (int k = 0; k < 3; ++k) simulateFIFO(timestamps, misses, clusterStartMisses, indices[t * 3 + k]);
+            ++clusterTriangles;
+        }
+        return starts;
+    }
+
+    // One FIFO cache access; entries stamped at or before `since` count as evicted
+    static bool simulateFIFO(std::vector<uint32_t>& timestamps, uint32_t& misses, uint32_t since, uint32_t v) {
+        if (timestamps[v] > since && misses - timestamps[v] < ANALYZE_CACHE_SIZE) return false;
+        timestamps[v] = ++misses;
+        return true;
+    }
+};
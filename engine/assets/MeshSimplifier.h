@@ -0,0 +1,394 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "MeshOptimizer.h"
+
+// Quadric-error edge-collapse simplification (Garland & Heckbert) that only
+// moves vertices onto existing vertices, so the simplified index buffers share
+// the original vertex buffer and its attributes.
+//
+// Vertices that share a position but not attributes (UV seams) collapse in
+// pairs along the seam, open borders only collapse along the border, and
+// anything more complex is locked, so seams and silhouettes stay intact.
+
+// One level of a LOD chain; error is the object-space distance to LOD 0
+struct MeshLODLevel {
+    std::vector<uint32_t> indices;
+    float error = 0.0f;
+};
+
+class MeshSimplifier {
+public:
+    // Reduces indices towards targetIndexCount without exceeding targetError
+    // (object-space distance). resultError receives the error reached.
+    static std::vector<uint32_t> simplify(const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+                                          size_t targetIndexCount, float targetError = FLT_MAX,
+                                          float* resultError = nullptr) {
+        Simplifier state(indices, positions);
+        return state.run(targetIndexCount, targetError, resultError);
+    }
+
+    // LOD 0 followed by levels of about ratio times the previous triangle
+    // count. Stops early once a level no longer shrinks meaningfully. Each
+    // level's indices are reordered for the vertex cache.
+    static std::vector<MeshLODLevel> buildLODChain(const std::vector<uint32_t>& indices,
+                                                   const std::vector<glm::vec3>& positions,
+                                                   size_t maxLevels = 4, float ratio = 0.5f) {
+        std::vector<MeshLODLevel> chain(1);
+        chain[0].indices = indices;
+
+        size_t target = indices.size();
+        while (chain.size() < maxLevels) {
+            target = (size_t)(target * ratio) / 3 * 3;
+            if (target < 3) break;
+
+            // Always simplify from LOD 0 so each level's error is measured against it
+            MeshLODLevel level;
+            level.indices = simplify(indices, positions, target, FLT_MAX, &level.error);
+            if (level.indices.empty() || level.indices.size() > chain.back().indices.size() * 9 / 10) break;
+
+            MeshOptimizer::optimizeVertexCache(level.indices, positions.size());
+            level.error = std::max(level.error, chain.back().error);
+            chain.push_back(std::move(level));
+            target = chain.back().indices.size();
+        }
+        return chain;
+    }
+
+private:
+    enum VertexKind : uint8_t { KIND_MANIFOLD, KIND_BORDER, KIND_SEAM, KIND_LOCKED };
+
+    static constexpr uint32_t NONE = 0xFFFFFFFF;
+    static constexpr uint32_t MULTIPLE = 0xFFFFFFFE;
+    static constexpr float BOUNDARY_WEIGHT = 10.0f;
+
+    // Sum of squared distances to a set of planes, weighted by area
+    struct Quadric {
+        double a00 = 0, a11 = 0, a22 = 0, a01 = 0, a02 = 0, a12 = 0;
+        double b0 = 0, b1 = 0, b2 = 0, c = 0;
+        double weight = 0;
+
+        void addPlane(const glm::dvec3& n, double d, double w) {
+            a00 += w * n.x * n.x; a11 += w * n.y * n.y; a22 += w * n.z * n.z;
+            a01 += w * n.x * n.y; a02 += w * n.x * n.z; a12 += w * n.y * n.z;
+            b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+            c += w * d * d;
+        }
+
+        void add(const Quadric& q) {
+            a00 += q.a00; a11 += q.a11; a22 += q.a22; a01 += q.a01; a02 += q.a02; a12 += q.a12;
+            b0 += q.b0; b1 += q.b1; b2 += q.b2; c += q.c;
+            weight += q.weight;
+        }
+
+        // Mean squared distance at p
+        double error(const glm::dvec3& p) const {
+            double e = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z +
+                       2.0 * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z) +
+                       2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+            return std::max(e, 0.0) / std::max(weight, 1e-20);
+        }
+    };
+
+    struct Collapse {
+        uint32_t vertex;
+        uint32_t target;
+        double cost;
+    };
+
+    class Simplifier {
+    public:
+        Simplifier(const std::vector<uint32_t>& input, const std::vector<glm::vec3>& positions)
+            : indices(input), positions(positions) {
+            buildPositionRemap();
+            classifyVertices();
+
+            quadrics.resize(positions.size());
+            for (size_t t = 0; t + 2 < indices.size(); t += 3) addTriangleQuadrics(t);
+        }
+
+        std::vector<uint32_t> run(size_t targetIndexCount, float targetError, float* resultError) {
+            double maxError = 0.0;
+            double errorLimit = targetError == FLT_MAX ? DBL_MAX : (double)targetError * targetError;
+
+            while (indices.size() > targetIndexCount) {
+                std::vector<Collapse> candidates = collectCollapses();
+                if (candidates.empty()) break;
+                std::sort(candidates.begin(), candidates.end(),
+                          [](const Collapse& a, const Collapse& b) {
+                              return a.cost < b.cost || (a.cost == b.cost && a.vertex < b.vertex);
+                          });
+
+                size_t applied = applyCollapses(candidates, targetIndexCount, errorLimit, maxError);
+                if (applied == 0) break;
+                removeDegenerates();
+            }
+
+            if (resultError) *resultError = (float)std::sqrt(maxError);
+            return indices;
+        }
+
+    private:
+        std::vector<uint32_t> indices;
+        const std::vector<glm::vec3>& positions;
+        std::vector<uint32_t> remap;      // vertex -> first vertex with the same position
+        std::vector<uint32_t> wedge;      // circular list of vertices sharing a position
+        std::vector<uint32_t> openOut;    // border/seam neighbours (NONE, a vertex, or MULTIPLE)
+        std::vector<uint32_t> openIn;
+        std::vector<uint8_t> kind;
+        std::vector<Quadric> quadrics;    // per position (indexed by remap)
+        std::vector<uint32_t> collapse;   // vertex -> vertex it was merged into (current pass)
+        std::vector<uint32_t> adjacencyStart;
+        std::vector<uint32_t> adjacency;  // position -> triangles (current pass)
+        std::unordered_set<uint64_t> edges;  // directed edges of the input
+
+        void buildPositionRemap() {
+            const size_t n = positions.size();
+            remap.resize(n);
+            wedge.resize(n);
+            struct Hash {
+                size_t operator()(const glm::vec3& p) const {
+                    uint32_t bits[3];
+                    std::memcpy(bits, &p, sizeof(bits));
+                    return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+                }
+            };
+            std::unordered_map<glm::vec3, uint32_t, Hash> first;
+            first.reserve(n);
+            for (uint32_t v = 0; v < n; ++v) {
+                auto inserted = first.emplace(positions[v], v);
+                remap[v] = inserted.first->second;
+                if (inserted.second) {
+                    wedge[v] = v;
+                } else {
+                    uint32_t head = remap[v];
+                    wedge[v] = wedge[head];
+                    wedge[head] = v;
+                }
+            }
+        }
+
+        void classifyVertices() {
+            const size_t n = positions.size();
+            edges.reserve(indices.size());
+            for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+                for (int k = 0; k < 3; ++k) edges.insert(edgeKey(indices[t + k], indices[t + (k + 1) % 3]));
+            }
+
+            openOut.assign(n, NONE);
+            openIn.assign(n, NONE);
+            for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+                for (int k = 0; k < 3; ++k) {
+                    uint32_t a = indices[t + k], b = indices[t + (k + 1) % 3];
+                    if (edges.count(edgeKey(b, a))) continue;
+                    openOut[a] = openOut[a] == NONE ? b : MULTIPLE;
+                    openIn[b] = openIn[b] == NONE ? a : MULTIPLE;
+                }
+            }
+
+            kind.assign(n, KIND_LOCKED);
+            for (uint32_t v = 0; v < n; ++v) {
+                if (wedge[v] == v) {
+                    if (openOut[v] == NONE && openIn[v] == NONE) kind[v] = KIND_MANIFOLD;
+                    else if (isSingle(openOut[v]) && isSingle(openIn[v])) kind[v] = KIND_BORDER;
+                } else if (wedge[wedge[v]] == v) {
+                    // Exactly two copies whose open edges run along the same positions in opposite directions
+                    uint32_t w = wedge[v];
+                    if (isSingle(openOut[v]) && isSingle(openIn[v]) && isSingle(openOut[w]) && isSingle(openIn[w]) &&
+                        remap[openOut[v]] == remap[openIn[w]] && remap[openIn[v]] == remap[openOut[w]]) {
+                        kind[v] = KIND_SEAM;
+                    }
+                }
+            }
+        }
+
+        void addTriangleQuadrics(size_t t) {
+            uint32_t i0 = indices[t], i1 = indices[t + 1], i2 = indices[t + 2];
+            glm::dvec3 p0(positions[i0]), p1(positions[i1]), p2(positions[i2]);
+            glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+            double length = glm::length(normal);
+            if (length <= 0.0) return;
+            normal /= length;
+
+            Quadric q;
+            q.addPlane(normal, -glm::dot(normal, p0), length * 0.5);
+            q.weight = length * 0.5;
+            quadrics[remap[i0]].add(q);
+            quadrics[remap[i1]].add(q);
+            quadrics[remap[i2]].add(q);
+
+            // Open edges also get a plane through the edge, perpendicular to the
+            // triangle, so collapses that would pull a border or seam inwards are costly
+            const uint32_t corners[3] = {i0, i1, i2};
+            for (int k = 0; k < 3; ++k) {
+                uint32_t a = corners[k], b = corners[(k + 1) % 3];
+                if (edges.count(edgeKey(b, a))) continue;
+                glm::dvec3 pa(positions[a]), pb(positions[b]);
+                glm::dvec3 edge = pb - pa;
+                double edgeLength = glm::length(edge);
+                if (edgeLength <= 0.0) continue;
+                glm::dvec3 edgeNormal = glm::normalize(glm::cross(edge, normal));
+                Quadric border;
+                border.addPlane(edgeNormal, -glm::dot(edgeNormal, pa), edgeLength * edgeLength * BOUNDARY_WEIGHT);
+                border.weight = edgeLength * edgeLength * BOUNDARY_WEIGHT;
+                quadrics[remap[a]].add(border);
+                quadrics[remap[b]].add(border);
+            }
+        }
+
+        std::vector<Collapse> collectCollapses() const {
+            std::vector<Collapse> candidates;
+            candidates.reserve(indices.size());
+            for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+                for (int k = 0; k < 3; ++k) {
+                    uint32_t a = indices[t + k], b = indices[t + (k + 1) % 3];
+                    // Each undirected edge appears twice in closed meshes; consider it once
+                    bool closedEdge = kind[a] == KIND_MANIFOLD && kind[b] == KIND_MANIFOLD;
+                    if (closedEdge && remap[a] > remap[b]) continue;
+                    addCandidate(candidates, a, b);
+                    addCandidate(candidates, b, a);
+                }
+            }
+            return candidates;
+        }
+
+        void addCandidate(std::vector<Collapse>& candidates, uint32_t v, uint32_t t) const {
+            if (remap[v] == remap[t] || !canCollapse(v, t)) return;
+            Quadric q = quadrics[remap[v]];
+            q.add(quadrics[remap[t]]);
+            candidates.push_back({v, t, q.error(glm::dvec3(positions[t]))});
+        }
+
+        bool canCollapse(uint32_t v, uint32_t t) const {
+            switch (kind[v]) {
+                case KIND_MANIFOLD: return true;
+                case KIND_BORDER: return kind[t] == KIND_BORDER && (openOut[v] == t || openIn[v] == t);
+                case KIND_SEAM: return kind[t] == KIND_SEAM && (openOut[v] == t || openIn[v] == t) &&
+                                       seamTarget(v, t) != NONE;
+                default: return false;
+            }
+        }
+
+        // Where v's seam sibling goes when v collapses into t along the seam
+        uint32_t seamTarget(uint32_t v, uint32_t t) const {
+            uint32_t w = wedge[v];
+            uint32_t sibling = openOut[v] == t ? openIn[w] : openOut[w];
+            return isSingle(sibling) && remap[sibling] == remap[t] ? sibling : NONE;
+        }
+
+        size_t applyCollapses(const std::vector<Collapse>& candidates, size_t targetIndexCount, double errorLimit,
+                              double& maxError) {
+            const size_t n = positions.size();
+            buildAdjacency();
+            collapse.resize(n);
+            for (uint32_t v = 0; v < n; ++v) collapse[v] = v;
+            std::vector<uint8_t> locked(n, 0);
+
+            size_t triangles = indices.size() / 3;
+            const size_t targetTriangles = targetIndexCount / 3;
+            size_t applied = 0;
+            for (const Collapse& c : candidates) {
+                if (triangles <= targetTriangles) break;
+                if (c.cost > errorLimit) break;
+                uint32_t pv = remap[c.vertex], pt = remap[c.target];
+                if (locked[pv] || locked[pt]) continue;
+                if (flips(pv, c.target)) continue;
+
+                collapse[c.vertex] = c.target;
+                if (kind[c.vertex] == KIND_SEAM) {
+                    uint32_t sibling = wedge[c.vertex], siblingTarget = seamTarget(c.vertex, c.target);
+                    collapse[sibling] = siblingTarget;
+                    followOpenEdge(sibling, siblingTarget);
+                }
+                followOpenEdge(c.vertex, c.target);
+                quadrics[pt].add(quadrics[pv]);
+                maxError = std::max(maxError, c.cost);
+
+                // Lock the one-ring so the flip checks of later collapses stay valid
+                for (uint32_t a = adjacencyStart[pv]; a < adjacencyStart[pv + 1]; ++a) {
+                    size_t tri = adjacency[a] * 3;
+                    for (int k = 0; k < 3; ++k) locked[remap[indices[tri + k]]] = 1;
+                }
+                locked[pt] = 1;
+
+                // An interior collapse removes two triangles, a border or seam one
+                triangles -= kind[c.vertex] == KIND_MANIFOLD ? 2 : 1;
+                ++applied;
+            }
+            return applied;
+        }
+
+        // Border and seam links skip over v once it has merged into its
+        // neighbour t, so the chain can keep collapsing in later passes
+        void followOpenEdge(uint32_t v, uint32_t t) {
+            if (openOut[v] == t) {
+                uint32_t before = openIn[v];
+                openIn[t] = before;
+                if (isSingle(before) && openOut[before] == v) openOut[before] = t;
+            } else if (openIn[v] == t) {
+                uint32_t after = openOut[v];
+                openOut[t] = after;
+                if (isSingle(after) && openIn[after] == v) openIn[after] = t;
+            }
+        }
+
+        // Whether moving position p to the target vertex would flip any
+        // triangle around p that survives the collapse
+        bool flips(uint32_t p, uint32_t target) const {
+            glm::dvec3 moved(positions[target]);
+            for (uint32_t a = adjacencyStart[p]; a < adjacencyStart[p + 1]; ++a) {
+                size_t tri = adjacency[a] * 3;
+                uint32_t corners[3] = {indices[tri], indices[tri + 1], indices[tri + 2]};
+                if (remap[corners[0]] == remap[target] || remap[corners[1]] == remap[target] ||
+                    remap[corners[2]] == remap[target]) {
+                    continue;  // becomes degenerate and is removed
+                }
+
+                glm::dvec3 before[3], after[3];
+                for (int k = 0; k < 3; ++k) {
+                    before[k] = glm::dvec3(positions[corners[k]]);
+                    after[k] = remap[corners[k]] == p ? moved : before[k];
+                }
+                glm::dvec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+                glm::dvec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+                if (glm::dot(n0, n1) <= 0.25 * glm::length(n0) * glm::length(n1)) return true;
+            }
+            return false;
+        }
+
+        // Position -> triangles (CSR over remap ids)
+        void buildAdjacency() {
+            const size_t n = positions.size();
+            adjacencyStart.assign(n + 1, 0);
+            for (uint32_t index : indices) ++adjacencyStart[remap[index] + 1];
+            for (size_t v = 0; v < n; ++v) adjacencyStart[v + 1] += adjacencyStart[v];
+            adjacency.resize(indices.size());
+            std::vector<uint32_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+            for (size_t i = 0; i < indices.size(); ++i) adjacency[fill[remap[indices[i]]]++] = (uint32_t)(i / 3);
+        }
+
+        void removeDegenerates() {
+            size_t write = 0;
+            for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+                uint32_t a = collapse[indices[t]], b = collapse[indices[t + 1]], c = collapse[indices[t + 2]];
+                if (remap[a] == remap[b] || remap[b] == remap[c] || remap[a] == remap[c]) continue;
+                indices[write++] = a;
+                indices[write++] = b;
+                indices[write++] = c;
+            }
+            indices.resize(write);
+        }
+
+        static bool isSingle(uint32_t v) { return v != NONE && v != MULTIPLE; }
+        static uint64_t edgeKey(uint32_t a, uint32_t b) { return ((uint64_t)a << 32) | b; }
+    };
+};
@@ -1,10 +1,72 @@
 #include "../assets/ModelLoader.h"
 #include "../render/Mesh.h"
+#include "GLBFile.h"
+#include "MeshCooker.h"
+#include "MeshOptimizer.h"
+#include <cstring>
 #include "../core/Logger.h"
 
+static_assert(sizeof(Vertex) == 32, "Vertex must match the hmesh float32 vertex layout");
+
 MeshPtr ModelLoader::loadModel(const std::string& path) {
     LOG_INFO("Loading model: " + path);
-    return nullptr;
+
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    if (!loadModelData(path, vertices, indices)) return nullptr;
+
+    auto mesh = std::make_shared<Mesh>();
+    mesh->setVertexFormat(Mesh::chooseFormat(vertices));
+    mesh->setVertices(std::move(vertices));
+    mesh->setIndices(std::move(indices));
+    return mesh;
+}
+
+bool ModelLoader::loadModelData(const std::string& path, std::vector<Vertex>& vertices,
+                                std::vector<unsigned int>& indices) {
+    std::string error;
+    if (MeshCooker::isCookedCurrent(path)) {
+        HMeshFile cooked;
+        if (cooked.open(MeshCooker::cookedPath(path), error)) {
+            ByteSpan vertexData = cooked.vertices();
+            vertices.resize(cooked.getHeader().vertexCount);
+            indices = cooked.lodIndices(0);
+            if (cooked.vertexFormat() == VERTEX_FLOAT32) {
+                // The float layout is exactly Vertex, so this is a bulk copy
+                std::memcpy(vertices.data(), vertexData.data, vertexData.size);
+            } else {
+                std::vector<Vec3> positions, normals;
+                std::vector<Vec2> texCoords;
+                VertexPacker::unpack(cooked.vertexFormat(), vertexData.data, vertices.size(), cooked.quantization(),
+                                     positions, normals, texCoords);
+                for (size_t i = 0; i < vertices.size(); i++) {
+                    vertices[i] = {positions[i], normals[i], texCoords[i]};
+                }
+            }
+            return true;
+        }
+        LOG_WARNING("Ignoring cooked mesh for " + path + ": " + error);
+    }
+
+    GLTFModel model;
+    if (!GLBFile::loadModel(path, model, error)) {
+        LOG_ERROR("Failed to load model " + path + ": " + error);
+        return false;
+    }
+
+    // Cooked meshes were optimized by cook.exe; do the same for raw imports
+    MeshOptimizeReport report = MeshOptimizer::optimizeMesh(model.indices, model.positions, model.normals,
+                                                            model.texCoords, model.tangents);
+    LOG_INFO("Optimized " + path + ": " + report.summary());
+
+    vertices.resize(model.positions.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        vertices[i].position = model.positions[i];
+        vertices[i].normal = model.normals[i];
+        vertices[i].texCoord = model.texCoords[i];
+    }
+    indices = std::move(model.indices);
+    return true;
 }
 
 MeshPtr ModelLoader::createQuad(float size) {
@@ -2,14 +2,19 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 // Forward declare Mesh for ModelLoader
 class Mesh;
+struct Vertex;
 using MeshPtr = std::shared_ptr<Mesh>;
 
 class ModelLoader {
 public:
     static MeshPtr loadModel(const std::string& path);
+    // CPU half of loadModel (no GL calls), safe to call from worker threads
+    static bool loadModelData(const std::string& path, std::vector<Vertex>& vertices,
+                              std::vector<unsigned int>& indices);
     static MeshPtr createQuad(float size = 1.0f);
     static MeshPtr createCube(float size = 1.0f);
     static MeshPtr createPlane(float width, float height, int subdivisions = 1);
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CookedAsset.h"
+#include "../core/PackFile.h"
+
+struct PackReport {
+    size_t entries = 0;
+    size_t compressedEntries = 0;
+    uint64_t sourceBytes = 0;
+    uint64_t packBytes = 0;
+
+    std::string summary() const {
+        std::ostringstream out;
+        out << entries << " files (" << compressedEntries << " LZ4), " << sourceBytes / 1024 << " KB -> "
+            << packBytes / 1024 << " KB";
+        return out.str();
+    }
+};
+
+// Writes an asset pack (see engine/core/PackFile.h) from loose files.
+// Entries are LZ4 compressed only when that saves at least 1/8 of their
+// size; data that is already compressed (BC blocks, PNG, JPEG) stays stored
+// so it is read straight from the mapping.
+class PackCooker {
+public:
+    struct Input {
+        std::string sourcePath;  // file on disk
+        std::string name;        // path inside the pack, relative to its mount point
+    };
+
+    static bool cook(const std::vector<Input>& inputs, const std::string& outputPath, std::string& error,
+                     PackReport* report = nullptr) {
+        struct Pending {
+            PackEntry entry;
+            std::string name;
+            std::vector<uint8_t> stored;
+        };
+
+        std::vector<Pending> files;
+        files.reserve(inputs.size());
+        for (const Input& input : inputs) {
+            MappedFile source;
+            if (!source.open(input.sourcePath) && !isEmptyFile(input.sourcePath)) {
+                error = "could not map " + input.sourcePath;
+                return false;
+            }
+            if (source.size() > PACK_MAX_ENTRY_SIZE) {
+                error = input.sourcePath + " is too large for a pack entry";
+                return false;
+            }
+
+            Pending file;
+            file.name = PackFile::normalizePath(input.name);
+            file.entry = PackEntry();
+            file.entry.pathHash = PackFile::hashPath(file.name);
+            file.entry.size = source.size();
+            file.entry.compression = PACK_STORED;
+            if (source.size() > 0) {
+                LZ4::compress(source.data(), source.size(), file.stored);
+                if (file.stored.size() <= source.size() - source.size() / 8 &&
+                    source.size() <= file.stored.size() * PACK_MAX_LZ4_RATIO) {
+                    file.entry.compression = PACK_LZ4;
+                } else {
+                    file.stored.assign(source.data(), source.data() + source.size());
+                }
+            }
+            file.entry.storedSize = file.stored.size();
+            files.push_back(std::move(file));
+        }
+
+        std::sort(files.begin(), files.end(), [](const Pending& a, const Pending& b) {
+            return a.entry.pathHash != b.entry.pathHash ? a.entry.pathHash < b.entry.pathHash : a.name < b.name;
+        });
+        for (size_t i = 1; i < files.size(); ++i) {
+            if (files[i].name == files[i - 1].name) {
+                error = "duplicate pack entry " + files[i].name;
+                return false;
+            }
+        }
+
+        std::vector<uint8_t> names;
+        for (Pending& file : files) {
+            file.entry.nameOffset = (uint32_t)names.size();
+            file.entry.nameLength = (uint32_t)file.name.size();
+            CookedAsset::append(names, file.name.data(), file.name.size());
+        }
+
+        PackHeader header = {};
+        header.magic = PACK_MAGIC;
+        header.version = PACK_VERSION;
+        header.entryCount = (uint32_t)files.size();
+        header.entryOffset = sizeof(PackHeader);
+        header.nameOffset = header.entryOffset + files.size() * sizeof(PackEntry);
+        header.nameSize = names.size();
+
+        // Data goes after the table; entries are patched in once placed
+        std::vector<uint8_t> out(header.nameOffset);
+        CookedAsset::append(out, names.data(), names.size());
+        header.dataOffset = CookedAsset::align(out, PACK_ALIGNMENT);
+        for (Pending& file : files) {
+            file.entry.offset = CookedAsset::align(out, PACK_ALIGNMENT);
+            CookedAsset::append(out, file.stored.data(), file.stored.size());
+        }
+
+        std::memcpy(out.data(), &header, sizeof(header));
+        for (size_t i = 0; i < files.size(); ++i) {
+            std::memcpy(out.data() + header.entryOffset + i * sizeof(PackEntry), &files[i].entry, sizeof(PackEntry));
+        }
+
+        if (report) {
+            *report = PackReport();
+            report->entries = files.size();
+            for (const Pending& file : files) {
+                report->sourceBytes += file.entry.size;
+                if (file.entry.compression != PACK_STORED) ++report->compressedEntries;
+            }
+            report->packBytes = out.size();
+        }
+        return CookedAsset::write(outputPath, out, error);
+    }
+
+private:
+    // Empty files cannot be mapped but still get an (empty) entry
+    static bool isEmptyFile(const std::string& path) {
+        std::error_code ec;
+        return std::filesystem::is_regular_file(path, ec) && std::filesystem::file_size(path, ec) == 0 && !ec;
+    }
+};
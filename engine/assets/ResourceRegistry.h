@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+
+#include "../core/AssetFile.h"
+
+// 64-bit hash of an asset's bytes (MurmurHash64A). Not cryptographic: two
+// different assets of the same type hashing alike is treated as impossible.
+class ContentHash {
+public:
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = 0) {
+        const uint64_t m = 0xc6a4a7935bd1e995ull;
+        const int r = 47;
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        uint64_t h = seed ^ (size * m);
+
+        size_t blocks = size / 8;
+        for (size_t i = 0; i < blocks; ++i) {
+            uint64_t k;
+            std::memcpy(&k, bytes + i * 8, 8);
+            k *= m;
+            k ^= k >> r;
+            k *= m;
+            h ^= k;
+            h *= m;
+        }
+
+        const uint8_t* tail = bytes + blocks * 8;
+        switch (size & 7) {
+            case 7: h ^= uint64_t(tail[6]) << 48; [[fallthrough]];
+            case 6: h ^= uint64_t(tail[5]) << 40; [[fallthrough]];
+            case 5: h ^= uint64_t(tail[4]) << 32; [[fallthrough]];
+            case 4: h ^= uint64_t(tail[3]) << 24; [[fallthrough]];
+            case 3: h ^= uint64_t(tail[2]) << 16; [[fallthrough]];
+            case 2: h ^= uint64_t(tail[1]) << 8; [[fallthrough]];
+            case 1: h ^= uint64_t(tail[0]); h *= m;
+        }
+
+        h ^= h >> r;
+        h *= m;
+        h ^= h >> r;
+        return h;
+    }
+
+    static uint64_t hash(ByteSpan span, uint64_t seed = 0) {
+        return hash(span.data, span.size, seed);
+    }
+
+    static uint64_t hash(const std::string& text, uint64_t seed = 0) {
+        return hash(text.data(), text.size(), seed);
+    }
+
+    // Hashes a whole file (packed or loose); false if it cannot be opened
+    static bool hashFile(const std::string& path, uint64_t& result, uint64_t seed = 0) {
+        AssetFile file;
+        if (!file.open(path)) return false;
+        result = hash(file.span(), seed);
+        return true;
+    }
+
+    static uint64_t combine(uint64_t a, uint64_t b) {
+        return a ^ (b + 0x9e3779b97f4a7c15ull + (a << 6) + (a >> 2));
+    }
+};
+
+// Process-wide table of resident resources, keyed by type and content hash,
+// so identical data loaded through different paths or containers ends up as
+// one object. Entries are weak: owners keep resources alive through their
+// shared_ptr and the resource (and its GL objects) goes with the last one.
+// Thread-safe; resources that own GL objects are still created and released
+// on the GL thread by their owners.
+class ResourceRegistry {
+public:
+    struct Stats {
+        size_t resident = 0;  // entries whose resource is still alive
+        size_t hits = 0;      // lookups answered by a resident resource
+        size_t misses = 0;
+    };
+
+    static ResourceRegistry& getInstance() {
+        static ResourceRegistry instance;
+        return instance;
+    }
+
+    template <typename T>
+    std::shared_ptr<T> find(uint64_t hash) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return findLocked<T>(hash);
+    }
+
+    // Whether the hash is resident, without taking a reference: safe on
+    // threads that must not end up holding the last one
+    template <typename T>
+    bool contains(uint64_t hash) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(Key{std::type_index(typeid(T)), hash});
+        bool resident = it != entries.end() && !it->second.expired();
+        ++(resident ? counters.hits : counters.misses);
+        return resident;
+    }
+
+    // Resident resource a path was last loaded as, if it is still alive
+    template <typename T>
+    std::shared_ptr<T> findPath(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto alias = aliases.find(PathKey{std::type_index(typeid(T)), path});
+        if (alias == aliases.end()) return nullptr;
+        return findLocked<T>(alias->second);
+    }
+
+    // Registers a resource under its hash. If an identical one became
+    // resident in the meantime that one is returned and the caller's copy
+    // should be dropped.
+    template <typename T>
+    std::shared_ptr<T> insert(uint64_t hash, const std::shared_ptr<T>& resource) {
+        if (!resource) return resource;
+        std::lock_guard<std::mutex> lock(mutex);
+        std::weak_ptr<void>& entry = entries[Key{std::type_index(typeid(T)), hash}];
+        if (std::shared_ptr<void> existing = entry.lock()) return std::static_pointer_cast<T>(existing);
+        entry = std::const_pointer_cast<void>(std::static_pointer_cast<const void>(resource));
+        if (entries.size() >= nextCollect) collectLocked();
+        return resource;
+    }
+
+    // Resident resource for the hash, or the one create() makes (which is
+    // registered unless it is null). create runs without the lock held.
+    template <typename T, typename Create>
+    std::shared_ptr<T> acquire(uint64_t hash, Create&& create) {
+        if (std::shared_ptr<T> resident = find<T>(hash)) return resident;
+        return insert<T>(hash, std::shared_ptr<T>(create()));
+    }
+
+    // Points a path at the content it currently holds
+    template <typename T>
+    void alias(const std::string& path, uint64_t hash) {
+        std::lock_guard<std::mutex> lock(mutex);
+        aliases[PathKey{std::type_index(typeid(T)), path}] = hash;
+    }
+
+    // Drops entries whose resources are gone, and aliases pointing at them
+    size_t collect() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return collectLocked();
+    }
+
+    Stats stats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        Stats result = counters;
+        for (const auto& entry : entries) {
+            if (!entry.second.expired()) ++result.resident;
+        }
+        return result;
+    }
+
+private:
+    struct Key {
+        std::type_index type;
+        uint64_t hash;
+        bool operator==(const Key& other) const { return type == other.type && hash == other.hash; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return (size_t)ContentHash::combine(key.type.hash_code(), key.hash);
+        }
+    };
+    struct PathKey {
+        std::type_index type;
+        std::string path;
+        bool operator==(const PathKey& other) const { return type == other.type && path == other.path; }
+    };
+    struct PathKeyHash {
+        size_t operator()(const PathKey& key) const {
+            return (size_t)ContentHash::combine(key.type.hash_code(), std::hash<std::string>()(key.path));
+        }
+    };
+
+    // Expired entries are swept once the table doubles since the last sweep
+    static constexpr size_t MIN_COLLECT = 64;
+
+    std::mutex mutex;
+    std::unordered_map<Key, std::weak_ptr<void>, KeyHash> entries;
+    std::unordered_map<PathKey, uint64_t, PathKeyHash> aliases;
+    size_t nextCollect = MIN_COLLECT;
+    Stats counters;
+
+    ResourceRegistry() = default;
+
+    template <typename T>
+    std::shared_ptr<T> findLocked(uint64_t hash) {
+        auto it = entries.find(Key{std::type_index(typeid(T)), hash});
+        std::shared_ptr<void> resident = it != entries.end() ? it->second.lock() : nullptr;
+        if (!resident) {
+            ++counters.misses;
+            return nullptr;
+        }
+        ++counters.hits;
+        return std::static_pointer_cast<T>(resident);
+    }
+
+    size_t collectLocked() {
+        size_t removed = 0;
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->second.expired()) {
+                it = entries.erase(it);
+                ++removed;
+            } else {
+                ++it;
+            }
+        }
+        for (auto it = aliases.begin(); it != aliases.end();) {
+            if (entries.count(Key{it->first.type, it->second})) {
+                ++it;
+            } else {
+                it = aliases.erase(it);
+            }
+        }
+        nextCollect = std::max(MIN_COLLECT, entries.size() * 2);
+        return removed;
+    }
+};
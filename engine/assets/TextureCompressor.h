@@ -0,0 +1,344 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "HTexFile.h"
+
+// CPU block compression for the texture cooker, and the matching decoders
+// used when the GPU cannot sample a format. Encoders favour speed over
+// quality: endpoints come from the colour bounding box (oriented by the
+// channel covariance), then every texel picks its nearest palette entry.
+// BC7 uses mode 6 only (one subset, RGBA endpoints, 4-bit indices).
+class TextureCompressor {
+public:
+    // Compresses an RGBA8 image; edge blocks repeat the last row/column
+    static void compress(HTexFormat format, const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out) {
+        if (format == HTEX_RGBA8) {
+            out.assign(rgba, rgba + (size_t)width * height * 4);
+            return;
+        }
+
+        int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+        size_t blockSize = HTexView::blockBytes(format);
+        out.resize((size_t)blocksX * blocksY * blockSize);
+
+        uint8_t block[64];
+        for (int by = 0; by < blocksY; ++by) {
+            for (int bx = 0; bx < blocksX; ++bx) {
+                for (int y = 0; y < 4; ++y) {
+                    int sy = std::min(by * 4 + y, height - 1);
+                    for (int x = 0; x < 4; ++x) {
+                        int sx = std::min(bx * 4 + x, width - 1);
+                        std::memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+                    }
+                }
+                uint8_t* dst = out.data() + ((size_t)by * blocksX + bx) * blockSize;
+                switch (format) {
+                    case HTEX_BC1: encodeBC1(block, dst); break;
+                    case HTEX_BC3: encodeBC4(block, 3, dst); encodeBC1(block, dst + 8); break;
+                    case HTEX_BC5: encodeBC4(block, 0, dst); encodeBC4(block, 1, dst + 8); break;
+                    case HTEX_BC7: encodeBC7(block, dst); break;
+                    default: break;
+                }
+            }
+        }
+    }
+
+    // Expands compressed data back to RGBA8 (fallback upload path)
+    static void decompress(HTexFormat format, const uint8_t* data, int width, int height, std::vector<uint8_t>& rgba) {
+        rgba.resize((size_t)width * height * 4);
+        if (format == HTEX_RGBA8) {
+            std::memcpy(rgba.data(), data, rgba.size());
+            return;
+        }
+
+        int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+        size_t blockSize = HTexView::blockBytes(format);
+        uint8_t block[64];
+        for (int by = 0; by < blocksY; ++by) {
+            for (int bx = 0; bx < blocksX; ++bx) {
+                const uint8_t* src = data + ((size_t)by * blocksX + bx) * blockSize;
+                switch (format) {
+                    case HTEX_BC1: decodeBC1(src, block); break;
+                    case HTEX_BC3: decodeBC1(src + 8, block); decodeBC4(src, 3, block); break;
+                    case HTEX_BC5:
+                        decodeBC4(src, 0, block);
+                        decodeBC4(src + 8, 1, block);
+                        for (int i = 0; i < 16; ++i) { block[i * 4 + 2] = 0; block[i * 4 + 3] = 255; }
+                        break;
+                    case HTEX_BC7: decodeBC7(src, block); break;
+                    default: break;
+                }
+                for (int y = 0; y < 4 && by * 4 + y < height; ++y) {
+                    for (int x = 0; x < 4 && bx * 4 + x < width; ++x) {
+                        std::memcpy(&rgba[((size_t)(by * 4 + y) * width + bx * 4 + x) * 4], block + (y * 4 + x) * 4, 4);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    static int colorDistance(const uint8_t* a, const uint8_t* b) {
+        int dr = a[0] - b[0], dg = a[1] - b[1], db = a[2] - b[2];
+        return dr * dr + dg * dg + db * db;
+    }
+
+    static uint16_t to565(const uint8_t* c) {
+        return (uint16_t)(((c[0] * 31 + 127) / 255) << 11 | ((c[1] * 63 + 127) / 255) << 5 | ((c[2] * 31 + 127) / 255));
+    }
+
+    static void from565(uint16_t v, uint8_t* c) {
+        int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+        c[0] = (uint8_t)((r << 3) | (r >> 2));
+        c[1] = (uint8_t)((g << 2) | (g >> 4));
+        c[2] = (uint8_t)((b << 3) | (b >> 2));
+        c[3] = 255;
+    }
+
+    // Bounding-box endpoints, with the diagonal flipped for channels that
+    // run against the dominant one so gradients like red->green stay on the line
+    static void boxEndpoints(const uint8_t* block, int channels, uint8_t* lo, uint8_t* hi) {
+        float mean[4] = {0, 0, 0, 0};
+        for (int i = 0; i < 16; ++i) {
+            for (int c = 0; c < channels; ++c) mean[c] += block[i * 4 + c] / 16.0f;
+        }
+        float cov[4][4] = {};
+        for (int i = 0; i < 16; ++i) {
+            for (int a = 0; a < channels; ++a) {
+                for (int b = 0; b < channels; ++b) {
+                    cov[a][b] += (block[i * 4 + a] - mean[a]) * (block[i * 4 + b] - mean[b]);
+                }
+            }
+        }
+        int dominant = 0;
+        for (int c = 1; c < channels; ++c) {
+            if (cov[c][c] > cov[dominant][dominant]) dominant = c;
+        }
+
+        for (int c = 0; c < channels; ++c) {
+            uint8_t minV = 255, maxV = 0;
+            for (int i = 0; i < 16; ++i) {
+                minV = std::min(minV, block[i * 4 + c]);
+                maxV = std::max(maxV, block[i * 4 + c]);
+            }
+            // Inset by 1/16 of the range to reduce the error of the extremes
+            int inset = (maxV - minV) >> 4;
+            minV = (uint8_t)std::min(255, minV + inset);
+            maxV = (uint8_t)std::max(0, maxV - inset);
+            bool flip = cov[dominant][c] < 0.0f;
+            lo[c] = flip ? maxV : minV;
+            hi[c] = flip ? minV : maxV;
+        }
+    }
+
+    static void encodeBC1(const uint8_t* block, uint8_t* dst) {
+        uint8_t lo[4], hi[4];
+        boxEndpoints(block, 3, lo, hi);
+        uint16_t c0 = to565(hi), c1 = to565(lo);
+        if (c0 < c1) std::swap(c0, c1);
+
+        uint32_t indices = 0;
+        if (c0 != c1) {
+            uint8_t palette[4][4];
+            from565(c0, palette[0]);
+            from565(c1, palette[1]);
+            for (int c = 0; c < 3; ++c) {
+                palette[2][c] = (uint8_t)((2 * palette[0][c] + palette[1][c]) / 3);
+                palette[3][c] = (uint8_t)((palette[0][c] + 2 * palette[1][c]) / 3);
+            }
+            for (int i = 0; i < 16; ++i) {
+                int best = 0, bestDist = colorDistance(block + i * 4, palette[0]);
+                for (int p = 1; p < 4; ++p) {
+                    int dist = colorDistance(block + i * 4, palette[p]);
+                    if (dist < bestDist) { best = p; bestDist = dist; }
+                }
+                indices |= (uint32_t)best << (i * 2);
+            }
+        }
+        std::memcpy(dst, &c0, 2);
+        std::memcpy(dst + 2, &c1, 2);
+        std::memcpy(dst + 4, &indices, 4);
+    }
+
+    static void decodeBC1(const uint8_t* src, uint8_t* block) {
+        uint16_t c0, c1;
+        uint32_t indices;
+        std::memcpy(&c0, src, 2);
+        std::memcpy(&c1, src + 2, 2);
+        std::memcpy(&indices, src + 4, 4);
+
+        uint8_t palette[4][4];
+        from565(c0, palette[0]);
+        from565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            if (c0 > c1) {
+                palette[2][c] = (uint8_t)((2 * palette[0][c] + palette[1][c]) / 3);
+                palette[3][c] = (uint8_t)((palette[0][c] + 2 * palette[1][c]) / 3);
+            } else {
+                palette[2][c] = (uint8_t)((palette[0][c] + palette[1][c]) / 2);
+                palette[3][c] = 0;
+            }
+        }
+        palette[2][3] = 255;
+        palette[3][3] = c0 > c1 ? 255 : 0;
+        for (int i = 0; i < 16; ++i) std::memcpy(block + i * 4, palette[(indices >> (i * 2)) & 3], 4);
+    }
+
+    // Single channel block (BC3 alpha, BC5 red/green), 8-value mode
+    static void encodeBC4(const uint8_t* block, int channel, uint8_t* dst) {
+        uint8_t a0 = 0, a1 = 255;
+        for (int i = 0; i < 16; ++i) {
+            a0 = std::max(a0, block[i * 4 + channel]);
+            a1 = std::min(a1, block[i * 4 + channel]);
+        }
+
+        uint64_t indices = 0;
+        if (a0 != a1) {
+            int palette[8] = {a0, a1};
+            for (int k = 2; k < 8; ++k) palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+            for (int i = 0; i < 16; ++i) {
+                int value = block[i * 4 + channel];
+                int best = 0, bestDist = 256;
+                for (int p = 0; p < 8; ++p) {
+                    int dist = std::abs(value - palette[p]);
+                    if (dist < bestDist) { best = p; bestDist = dist; }
+                }
+                indices |= (uint64_t)best << (i * 3);
+            }
+        }
+        dst[0] = a0;
+        dst[1] = a1;
+        for (int b = 0; b < 6; ++b) dst[2 + b] = (uint8_t)(indices >> (b * 8));
+    }
+
+    static void decodeBC4(const uint8_t* src, int channel, uint8_t* block) {
+        int a0 = src[0], a1 = src[1];
+        int palette[8] = {a0, a1};
+        if (a0 > a1) {
+            for (int k = 2; k < 8; ++k) palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+        } else {
+            for (int k = 2; k < 6; ++k) palette[k] = ((6 - k) * a0 + (k - 1) * a1) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+        uint64_t indices = 0;
+        for (int b = 0; b < 6; ++b) indices |= (uint64_t)src[2 + b] << (b * 8);
+        for (int i = 0; i < 16; ++i) block[i * 4 + channel] = (uint8_t)palette[(indices >> (i * 3)) & 7];
+    }
+
+    // Little-endian bit writer/reader for BC7's 128-bit blocks
+    static void putBits(uint8_t* dst, int& pos, uint32_t value, int count) {
+        for (int i = 0; i < count; ++i, ++pos) {
+            if (value & (1u << i)) dst[pos >> 3] |= (uint8_t)(1u << (pos & 7));
+        }
+    }
+
+    static uint32_t getBits(const uint8_t* src, int& pos, int count) {
+        uint32_t value = 0;
+        for (int i = 0; i < count; ++i, ++pos) {
+            value |= (uint32_t)((src[pos >> 3] >> (pos & 7)) & 1) << i;
+        }
+        return value;
+    }
+
+    static constexpr int BC7_WEIGHTS4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    // Mode 6 endpoint: 7 bits per channel plus a shared p-bit, picked to
+    // minimise the rounding error of the 8-bit endpoint
+    static void quantizeBC7Endpoint(const uint8_t* color, uint8_t* c7, uint8_t& pbit) {
+        int bestError = 1 << 30;
+        for (int p = 0; p < 2; ++p) {
+            uint8_t candidate[4];
+            int error = 0;
+            for (int c = 0; c < 4; ++c) {
+                int q = std::min(127, std::max(0, (color[c] - p + 1) >> 1));
+                candidate[c] = (uint8_t)q;
+                int diff = color[c] - ((q << 1) | p);
+                error += diff * diff;
+            }
+            if (error < bestError) {
+                bestError = error;
+                pbit = (uint8_t)p;
+                std::memcpy(c7, candidate, 4);
+            }
+        }
+    }
+
+    static void encodeBC7(const uint8_t* block, uint8_t* dst) {
+        uint8_t lo[4], hi[4];
+        boxEndpoints(block, 4, lo, hi);
+
+        uint8_t e7[2][4], pbits[2] = {0, 0};
+        quantizeBC7Endpoint(lo, e7[0], pbits[0]);
+        quantizeBC7Endpoint(hi, e7[1], pbits[1]);
+
+        uint8_t endpoints[2][4];
+        for (int e = 0; e < 2; ++e) {
+            for (int c = 0; c < 4; ++c) endpoints[e][c] = (uint8_t)((e7[e][c] << 1) | pbits[e]);
+        }
+        uint8_t palette[16][4];
+        for (int k = 0; k < 16; ++k) {
+            for (int c = 0; c < 4; ++c) {
+                palette[k][c] = (uint8_t)(((64 - BC7_WEIGHTS4[k]) * endpoints[0][c] + BC7_WEIGHTS4[k] * endpoints[1][c] + 32) >> 6);
+            }
+        }
+
+        uint8_t indices[16];
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestDist = 1 << 30;
+            for (int k = 0; k < 16; ++k) {
+                int da = block[i * 4 + 3] - palette[k][3];
+                int dist = colorDistance(block + i * 4, palette[k]) + da * da;
+                if (dist < bestDist) { best = k; bestDist = dist; }
+            }
+            indices[i] = (uint8_t)best;
+        }
+
+        // The first index is stored with an implicit zero MSB; swap endpoints if needed
+        if (indices[0] & 8) {
+            std::swap(e7[0], e7[1]);
+            std::swap(pbits[0], pbits[1]);
+            for (uint8_t& index : indices) index = (uint8_t)(15 - index);
+        }
+
+        std::memset(dst, 0, 16);
+        int pos = 0;
+        putBits(dst, pos, 1u << 6, 7);  // mode 6
+        for (int c = 0; c < 4; ++c) {
+            putBits(dst, pos, e7[0][c], 7);
+            putBits(dst, pos, e7[1][c], 7);
+        }
+        putBits(dst, pos, pbits[0], 1);
+        putBits(dst, pos, pbits[1], 1);
+        putBits(dst, pos, indices[0], 3);
+        for (int i = 1; i < 16; ++i) putBits(dst, pos, indices[i], 4);
+    }
+
+    // Decodes the mode 6 blocks written above; other modes decode to magenta
+    static void decodeBC7(const uint8_t* src, uint8_t* block) {
+        int pos = 0;
+        if (getBits(src, pos, 7) != (1u << 6)) {
+            for (int i = 0; i < 16; ++i) {
+                block[i * 4] = 255; block[i * 4 + 1] = 0; block[i * 4 + 2] = 255; block[i * 4 + 3] = 255;
+            }
+            return;
+        }
+        uint8_t e7[2][4];
+        for (int c = 0; c < 4; ++c) {
+            e7[0][c] = (uint8_t)getBits(src, pos, 7);
+            e7[1][c] = (uint8_t)getBits(src, pos, 7);
+        }
+        uint32_t p0 = getBits(src, pos, 1), p1 = getBits(src, pos, 1);
+        for (int i = 0; i < 16; ++i) {
+            int index = (int)getBits(src, pos, i == 0 ? 3 : 4);
+            for (int c = 0; c < 4; ++c) {
+                int a = (e7[0][c] << 1) | (int)p0, b = (e7[1][c] << 1) | (int)p1;
+                block[i * 4 + c] = (uint8_t)(((64 - BC7_WEIGHTS4[index]) * a + BC7_WEIGHTS4[index] * b + 32) >> 6);
+            }
+        }
+    }
+};
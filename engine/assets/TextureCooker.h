@@ -0,0 +1,91 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "CookedAsset.h"
+#include "HTexFile.h"
+#include "ImageDecoder.h"
+#include "TextureCompressor.h"
+
+// Offline PNG/JPEG -> .htex conversion: decode, build the mip chain and
+// block-compress every level. Also used by MeshCooker for material images.
+class TextureCooker {
+public:
+    // "sky/sun.png" -> "sky/sun.htex"
+    static std::string cookedPath(const std::string& sourcePath) {
+        return std::filesystem::path(sourcePath).replace_extension(".htex").string();
+    }
+
+    static bool isCookedCurrent(const std::string& sourcePath) {
+        return CookedAsset::isCurrent(sourcePath, cookedPath(sourcePath));
+    }
+
+    // BC1 for opaque colour and data maps, BC3 when alpha is used, BC5 for
+    // normals. preferBC7 trades the BC1/BC3 choice for BC7 quality.
+    static HTexFormat chooseFormat(const DecodedImage& image, ImageColorSpace space, bool preferBC7) {
+        if (space == ImageColorSpace::NORMAL) return HTEX_BC5;
+        if (preferBC7) return HTEX_BC7;
+        if (space == ImageColorSpace::LINEAR) return HTEX_BC1;
+
+        const MipLevel& base = image.levels[0];
+        const uint8_t* pixels = image.level(0);
+        for (size_t i = 0; i < (size_t)base.width * base.height; ++i) {
+            if (pixels[i * 4 + 3] != 255) return HTEX_BC3;
+        }
+        return HTEX_BC1;
+    }
+
+    static void serialize(const DecodedImage& image, ImageColorSpace space, HTexFormat format,
+                          std::vector<uint8_t>& out) {
+        HTexHeader header = {};
+        header.magic = HTEX_MAGIC;
+        header.version = HTEX_VERSION;
+        header.format = format;
+        header.flags = (space == ImageColorSpace::SRGB ? HTEX_FLAG_SRGB : 0) |
+                       (space == ImageColorSpace::NORMAL ? HTEX_FLAG_NORMAL : 0);
+        header.width = (uint32_t)image.levels[0].width;
+        header.height = (uint32_t)image.levels[0].height;
+        header.levelCount = (uint32_t)image.levels.size();
+
+        out.clear();
+        CookedAsset::append(out, &header, sizeof(header));
+        size_t tablePos = out.size();
+        out.resize(out.size() + image.levels.size() * sizeof(HTexLevel));
+
+        std::vector<uint8_t> blocks;
+        for (size_t i = 0; i < image.levels.size(); ++i) {
+            const MipLevel& mip = image.levels[i];
+            TextureCompressor::compress(format, image.level(i), mip.width, mip.height, blocks);
+
+            HTexLevel level = {(uint32_t)mip.width, (uint32_t)mip.height, 0, blocks.size()};
+            level.offset = CookedAsset::align(out, HTEX_ALIGNMENT);
+            CookedAsset::append(out, blocks.data(), blocks.size());
+            std::memcpy(out.data() + tablePos + i * sizeof(HTexLevel), &level, sizeof(level));
+        }
+    }
+
+    // Encoded image bytes (e.g. a GLB-embedded PNG) -> htex container
+    static bool cookImage(const uint8_t* data, size_t size, ImageColorSpace space, bool preferBC7,
+                          std::vector<uint8_t>& out, std::string& error) {
+        DecodedImage image;
+        if (!ImageDecoder::decode(data, size, space, image, error)) return false;
+        serialize(image, space, chooseFormat(image, space, preferBC7), out);
+        return true;
+    }
+
+    static bool cook(const std::string& sourcePath, const std::string& outputPath, ImageColorSpace space,
+                     bool preferBC7, std::string& error) {
+        MappedFile source;
+        if (!source.open(sourcePath)) {
+            error = "could not map " + sourcePath;
+            return false;
+        }
+
+        std::vector<uint8_t> data;
+        if (!cookImage(source.data(), source.size(), space, preferBC7, data, error)) return false;
+        source.close();
+        return CookedAsset::write(outputPath, data, error);
+    }
+};
@@ -1,6 +1,8 @@
 #include "../assets/TextureLoader.h"
 #include "../render/Texture.h"
+#include "../core/AssetFile.h"
 #include <GL/glew.h>
+#include <stb_image.h>
 
 TexturePtr TextureLoader::loadTexture(const std::string& path) {
     auto texture = std::make_shared<Texture>();
@@ -10,14 +12,35 @@ TexturePtr TextureLoader::loadTexture(const std::string& path) {
     return nullptr;
 }
 
+bool TextureLoader::decodeFile(const std::string& path, TextureData& data) {
+    AssetFile file;
+    if (!file.open(path)) return false;
+
+    int width, height, channels;
+    unsigned char* pixels = stbi_load_from_memory(file.data(), (int)file.size(), &width, &height, &channels, 0);
+    if (!pixels) return false;
+
+    data.pixels.assign(pixels, pixels + (size_t)width * height * channels);
+    data.width = width;
+    data.height = height;
+    data.channels = channels;
+    stbi_image_free(pixels);
+    return true;
+}
+
+TexturePtr TextureLoader::createTexture(const TextureData& data) {
+    auto texture = std::make_shared<Texture>();
+    if (texture->loadFromPixels(data.pixels.data(), data.width, data.height, data.channels)) {
+        return texture;
+    }
+    return nullptr;
+}
+
 TexturePtr TextureLoader::createWhiteTexture() {
     auto texture = std::make_shared<Texture>();
 
     unsigned char white[] = {255, 255, 255, 255};
-    unsigned int handle;
-    glGenTextures(1, &handle);
-    glBindTexture(GL_TEXTURE_2D, handle);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    texture->loadFromPixels(white, 1, 1, 4);
 
     return texture;
 }
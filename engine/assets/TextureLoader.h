@@ -2,13 +2,25 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 class Texture;
 using TexturePtr = std::shared_ptr<Texture>;
 
+// Decoded pixels waiting for upload; produced off the GL thread
+struct TextureData {
+    std::vector<unsigned char> pixels;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+};
+
 class TextureLoader {
 public:
     static TexturePtr loadTexture(const std::string& path);
+    // CPU-only decode, safe to call from worker threads
+    static bool decodeFile(const std::string& path, TextureData& data);
+    static TexturePtr createTexture(const TextureData& data);
     static TexturePtr createWhiteTexture();
     static TexturePtr createCheckerTexture(int size = 8);
 };
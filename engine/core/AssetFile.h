@@ -0,0 +1,135 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "PackFile.h"
+
+// Packs mounted over directories of the loose asset tree. A path under a
+// mount point resolves to the newest pack holding it, and falls back to the
+// loose file only when no pack does.
+class AssetPacks {
+public:
+    // Pack entries are named relative to mountPoint ("game/assets")
+    static bool mount(const std::string& packPath, const std::string& mountPoint, std::string& error) {
+        auto pack = std::make_shared<PackFile>();
+        if (!pack->open(packPath, error)) return false;
+
+        std::string prefix = PackFile::normalizePath(mountPoint);
+        if (prefix == ".") prefix.clear();
+        else if (!prefix.empty() && prefix.back() != '/') prefix += '/';
+
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.mounts.push_back({pack, prefix});
+        return true;
+    }
+
+    static void unmountAll() {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.mounts.clear();
+    }
+
+    static size_t mountedCount() {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        return s.mounts.size();
+    }
+
+    // Pack holding the path and its entry, or null when the path is loose
+    static std::shared_ptr<const PackFile> find(const std::string& path, const PackEntry*& entry) {
+        entry = nullptr;
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.mounts.empty()) return nullptr;
+
+        std::string normal = PackFile::normalizePath(path);
+        for (auto it = s.mounts.rbegin(); it != s.mounts.rend(); ++it) {
+            if (normal.compare(0, it->prefix.size(), it->prefix) != 0) continue;
+            entry = it->pack->find(normal.substr(it->prefix.size()));
+            if (entry) return it->pack;
+        }
+        return nullptr;
+    }
+
+    static bool contains(const std::string& path) {
+        const PackEntry* entry = nullptr;
+        return find(path, entry) != nullptr;
+    }
+
+private:
+    struct Mount {
+        std::shared_ptr<const PackFile> pack;
+        std::string prefix;
+    };
+    struct State {
+        std::mutex mutex;
+        std::vector<Mount> mounts;
+    };
+
+    static State& state() {
+        static State instance;
+        return instance;
+    }
+};
+
+// Read-only bytes of one asset: a slice of a mounted pack's mapping (or the
+// inflated copy of a compressed entry), else the loose file mapped on its own.
+// Loaders use this wherever they would map a file directly.
+class AssetFile {
+private:
+    MappedFile loose;
+    std::shared_ptr<const PackFile> pack;  // keeps the pack mapped
+    std::vector<uint8_t> inflated;
+    ByteSpan bytes;
+
+public:
+    AssetFile() = default;
+    AssetFile(const AssetFile&) = delete;
+    AssetFile& operator=(const AssetFile&) = delete;
+    AssetFile(AssetFile&&) = default;
+    AssetFile& operator=(AssetFile&&) = default;
+
+    bool open(const std::string& path) {
+        close();
+        const PackEntry* entry = nullptr;
+        if (std::shared_ptr<const PackFile> packed = AssetPacks::find(path, entry)) {
+            if (entry->compression == PACK_STORED) {
+                bytes = packed->stored(*entry);
+            } else {
+                if (!packed->inflate(*entry, inflated)) return false;
+                bytes = ByteSpan{inflated.data(), inflated.size()};
+            }
+            pack = packed;
+            return true;
+        }
+        if (!loose.open(path)) return false;
+        bytes = loose.span();
+        return true;
+    }
+
+    void close() {
+        loose.close();
+        pack.reset();
+        std::vector<uint8_t>().swap(inflated);
+        bytes = ByteSpan();
+    }
+
+    bool isOpen() const { return pack != nullptr || loose.isOpen(); }
+    bool fromPack() const { return pack != nullptr; }
+    const uint8_t* data() const { return bytes.data; }
+    size_t size() const { return bytes.size; }
+    ByteSpan span() const { return bytes; }
+
+    // Whether open() would find the path, without mapping loose files
+    static bool exists(const std::string& path) {
+        if (AssetPacks::contains(path)) return true;
+        std::error_code ec;
+        return std::filesystem::is_regular_file(path, ec);
+    }
+};
@@ -1,11 +1,28 @@
 #include "FileSystem.h"
+#include "AssetFile.h"
+#include "Logger.h"
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 
 namespace fs = std::filesystem;
 
+bool FileSystem::mountPack(const std::string& packPath, const std::string& mountPoint) {
+    std::string error;
+    if (!AssetPacks::mount(packPath, mountPoint, error)) {
+        LOG_ERROR("Failed to mount pack " + packPath + ": " + error);
+        return false;
+    }
+    LOG_INFO("Mounted pack " + packPath + " at " + mountPoint);
+    return true;
+}
+
+void FileSystem::unmountPacks() {
+    AssetPacks::unmountAll();
+}
+
 bool FileSystem::fileExists(const std::string& path) {
-    return fs::exists(path) && fs::is_regular_file(path);
+    return AssetFile::exists(path);
 }
 
 bool FileSystem::dirExists(const std::string& path) {
@@ -13,12 +30,20 @@ bool FileSystem::dirExists(const std::string& path) {
 }
 
 std::string FileSystem::readTextFile(const std::string& path) {
-    if (!fileExists(path)) return "";
+    AssetFile file;
+    if (!file.open(path)) return "";
+
+    // Same result as a text-mode stream: CRLF line endings become LF
+    std::string text(reinterpret_cast<const char*>(file.data()), file.size());
+    text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
+    return text;
+}
 
-    std::ifstream file(path);
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+bool FileSystem::readFile(const std::string& path, std::vector<uint8_t>& data) {
+    AssetFile file;
+    if (!file.open(path)) return false;
+    data.assign(file.data(), file.data() + file.size());
+    return true;
 }
 
 bool FileSystem::writeTextFile(const std::string& path, const std::string& content) {
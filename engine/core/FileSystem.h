@@ -1,13 +1,20 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 class FileSystem {
 public:
+    // Asset packs (.hpak) mounted over a directory are searched, newest
+    // first, before the loose files for every path under mountPoint
+    static bool mountPack(const std::string& packPath, const std::string& mountPoint);
+    static void unmountPacks();
+
     static bool fileExists(const std::string& path);
     static bool dirExists(const std::string& path);
     static std::string readTextFile(const std::string& path);
+    static bool readFile(const std::string& path, std::vector<uint8_t>& data);
     static bool writeTextFile(const std::string& path, const std::string& content);
     static std::vector<std::string> listDirectory(const std::string& path);
     static std::string getDirectory(const std::string& path);
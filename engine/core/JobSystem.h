@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads for CPU-side work (file I/O, parsing,
+// decoding). Jobs must not touch GL; hand results to GLUploadQueue instead.
+class JobSystem {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stopping = false;
+
+    explicit JobSystem(unsigned int threadCount) {
+        for (unsigned int i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    void workerLoop() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeup.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                if (stopping && jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+public:
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // One worker per hardware thread, leaving one for the render thread
+    static JobSystem& getInstance() {
+        static JobSystem instance(defaultThreadCount());
+        return instance;
+    }
+
+    static unsigned int defaultThreadCount() {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        return hardware > 1 ? hardware - 1 : 1;
+    }
+
+    void enqueue(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        wakeup.notify_one();
+    }
+
+    // Runs the jobs in parallel, then calls done() on whichever worker
+    // finishes last. Nothing blocks, so it is safe to call from a job.
+    void enqueueBatch(std::vector<std::function<void()>> batch, std::function<void()> done) {
+        if (batch.empty()) {
+            enqueue(std::move(done));
+            return;
+        }
+        auto remaining = std::make_shared<std::atomic<size_t>>(batch.size());
+        auto finish = std::make_shared<std::function<void()>>(std::move(done));
+        for (auto& job : batch) {
+            enqueue([job = std::move(job), remaining, finish]() {
+                job();
+                if (remaining->fetch_sub(1) == 1) (*finish)();
+            });
+        }
+    }
+
+    template <typename Fn>
+    auto submit(Fn&& fn) -> std::future<decltype(fn())> {
+        using Result = decltype(fn());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+        std::future<Result> future = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+    // Calls fn(i) for every i in [0, count) on the workers and the calling
+    // thread, returning once all calls are done. Indices are claimed one at
+    // a time, so if the workers are busy with other jobs the caller simply
+    // runs the rest itself instead of waiting for them. fn must not block on
+    // other jobs.
+    template <typename Fn>
+    void parallelFor(size_t count, Fn&& fn) {
+        if (count == 0) return;
+        if (count == 1 || workers.empty()) {
+            for (size_t i = 0; i < count; ++i) fn(i);
+            return;
+        }
+
+        // Helpers that start late find nothing to claim and never touch fn
+        struct State {
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> done{0};
+            size_t count = 0;
+            std::function<void(size_t)> body;
+            std::mutex mutex;
+            std::condition_variable finished;
+
+            void run() {
+                for (size_t i = next++; i < count; i = next++) {
+                    body(i);
+                    if (++done == count) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        finished.notify_all();
+                    }
+                }
+            }
+        };
+        auto state = std::make_shared<State>();
+        state->count = count;
+        state->body = [&fn](size_t i) { fn(i); };
+
+        size_t helpers = std::min(count - 1, workers.size());
+        for (size_t i = 0; i < helpers; ++i) enqueue([state]() { state->run(); });
+        state->run();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&state]() { return state->done == state->count; });
+    }
+
+    size_t workerCount() const { return workers.size(); }
+};
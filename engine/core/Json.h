@@ -0,0 +1,310 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal read-only JSON DOM used by the asset importers and data definitions.
+// Objects keep their members in document order; lookups are linear, which is
+// fine for the small objects found in glTF and game definition files.
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolValue = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    bool isNull() const { return type == Type::Null; }
+    bool isNumber() const { return type == Type::Number; }
+    bool isString() const { return type == Type::String; }
+    bool isArray() const { return type == Type::Array; }
+    bool isObject() const { return type == Type::Object; }
+
+    size_t size() const {
+        return type == Type::Array ? items.size() : (type == Type::Object ? members.size() : 0);
+    }
+
+    bool has(const char* key) const {
+        return find(key) != nullptr;
+    }
+
+    const JsonValue* find(const char* key) const {
+        if (type != Type::Object) return nullptr;
+        for (const auto& member : members) {
+            if (member.first == key) return &member.second;
+        }
+        return nullptr;
+    }
+
+    // Missing keys and out-of-range indices yield a shared null value
+    const JsonValue& operator[](const char* key) const {
+        const JsonValue* value = find(key);
+        return value ? *value : null();
+    }
+
+    const JsonValue& operator[](size_t index) const {
+        return (type == Type::Array && index < items.size()) ? items[index] : null();
+    }
+
+    // Keeps literal indices like value[0] from being ambiguous with the key lookup
+    const JsonValue& operator[](int index) const {
+        return index >= 0 ? (*this)[static_cast<size_t>(index)] : null();
+    }
+
+    double asNumber(double defaultValue = 0.0) const {
+        return type == Type::Number ? number : defaultValue;
+    }
+
+    float asFloat(float defaultValue = 0.0f) const {
+        return type == Type::Number ? static_cast<float>(number) : defaultValue;
+    }
+
+    int asInt(int defaultValue = 0) const {
+        return type == Type::Number ? static_cast<int>(number) : defaultValue;
+    }
+
+    size_t asSize(size_t defaultValue = 0) const {
+        return (type == Type::Number && number >= 0.0) ? static_cast<size_t>(number) : defaultValue;
+    }
+
+    bool asBool(bool defaultValue = false) const {
+        return type == Type::Bool ? boolValue : defaultValue;
+    }
+
+    const std::string& asString() const {
+        static const std::string empty;
+        return type == Type::String ? string : empty;
+    }
+
+    static const JsonValue& null() {
+        static const JsonValue value;
+        return value;
+    }
+
+    static bool parse(const char* data, size_t length, JsonValue& out, std::string* error = nullptr) {
+        Parser parser{data, data + length, ""};
+        out = JsonValue();
+        bool ok = parser.parseValue(out, 0);
+        if (ok) {
+            parser.skipWhitespace();
+            if (parser.cur != parser.end && *parser.cur != '\0') {
+                ok = parser.fail("trailing characters after JSON document");
+            }
+        }
+        if (!ok && error) *error = parser.error;
+        return ok;
+    }
+
+    static bool parse(const std::string& text, JsonValue& out, std::string* error = nullptr) {
+        return parse(text.data(), text.size(), out, error);
+    }
+
+private:
+    struct Parser {
+        const char* cur;
+        const char* end;
+        std::string error;
+
+        static constexpr int MAX_DEPTH = 256;
+
+        bool fail(const char* message) {
+            if (error.empty()) error = message;
+            return false;
+        }
+
+        void skipWhitespace() {
+            while (cur < end && (*cur == ' ' || *cur == '\t' || *cur == '\n' || *cur == '\r')) ++cur;
+        }
+
+        bool match(const char* literal) {
+            size_t len = std::strlen(literal);
+            if (static_cast<size_t>(end - cur) < len || std::memcmp(cur, literal, len) != 0) return false;
+            cur += len;
+            return true;
+        }
+
+        bool parseValue(JsonValue& out, int depth) {
+            if (depth > MAX_DEPTH) return fail("JSON nesting too deep");
+            skipWhitespace();
+            if (cur >= end) return fail("unexpected end of JSON");
+
+            switch (*cur) {
+                case '{': return parseObject(out, depth);
+                case '[': return parseArray(out, depth);
+                case '"':
+                    out.type = Type::String;
+                    return parseString(out.string);
+                case 't':
+                    if (!match("true")) return fail("invalid literal");
+                    out.type = Type::Bool;
+                    out.boolValue = true;
+                    return true;
+                case 'f':
+                    if (!match("false")) return fail("invalid literal");
+                    out.type = Type::Bool;
+                    out.boolValue = false;
+                    return true;
+                case 'n':
+                    if (!match("null")) return fail("invalid literal");
+                    out.type = Type::Null;
+                    return true;
+                default:
+                    return parseNumber(out);
+            }
+        }
+
+        bool parseObject(JsonValue& out, int depth) {
+            out.type = Type::Object;
+            ++cur;
+            skipWhitespace();
+            if (cur < end && *cur == '}') { ++cur; return true; }
+
+            while (true) {
+                skipWhitespace();
+                if (cur >= end || *cur != '"') return fail("expected object key");
+                out.members.emplace_back();
+                if (!parseString(out.members.back().first)) return false;
+
+                skipWhitespace();
+                if (cur >= end || *cur != ':') return fail("expected ':' after object key");
+                ++cur;
+                if (!parseValue(out.members.back().second, depth + 1)) return false;
+
+                skipWhitespace();
+                if (cur < end && *cur == ',') { ++cur; continue; }
+                if (cur < end && *cur == '}') { ++cur; return true; }
+                return fail("expected ',' or '}' in object");
+            }
+        }
+
+        bool parseArray(JsonValue& out, int depth) {
+            out.type = Type::Array;
+            ++cur;
+            skipWhitespace();
+            if (cur < end && *cur == ']') { ++cur; return true; }
+
+            while (true) {
+                out.items.emplace_back();
+                if (!parseValue(out.items.back(), depth + 1)) return false;
+
+                skipWhitespace();
+                if (cur < end && *cur == ',') { ++cur; continue; }
+                if (cur < end && *cur == ']') { ++cur; return true; }
+                return fail("expected ',' or ']' in array");
+            }
+        }
+
+        static int hexDigit(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        bool parseHex4(unsigned int& code) {
+            if (end - cur < 4) return fail("truncated unicode escape");
+            code = 0;
+            for (int i = 0; i < 4; ++i) {
+                int digit = hexDigit(cur[i]);
+                if (digit < 0) return fail("invalid unicode escape");
+                code = (code << 4) | static_cast<unsigned int>(digit);
+            }
+            cur += 4;
+            return true;
+        }
+
+        static void appendUtf8(std::string& out, unsigned int code) {
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        bool parseString(std::string& out) {
+            ++cur;  // opening quote
+            const char* runStart = cur;
+            while (cur < end) {
+                char c = *cur;
+                if (c == '"') {
+                    out.append(runStart, cur);
+                    ++cur;
+                    return true;
+                }
+                if (c != '\\') {
+                    ++cur;
+                    continue;
+                }
+
+                out.append(runStart, cur);
+                ++cur;
+                if (cur >= end) break;
+                char esc = *cur++;
+                switch (esc) {
+                    case '"': out += '"'; break;
+                    case '\\': out += '\\'; break;
+                    case '/': out += '/'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'n': out += '\n'; break;
+                    case 'r': out += '\r'; break;
+                    case 't': out += '\t'; break;
+                    case 'u': {
+                        unsigned int code;
+                        if (!parseHex4(code)) return false;
+                        if (code >= 0xD800 && code <= 0xDBFF && end - cur >= 6 && cur[0] == '\\' && cur[1] == 'u') {
+                            cur += 2;
+                            unsigned int low;
+                            if (!parseHex4(low)) return false;
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        appendUtf8(out, code);
+                        break;
+                    }
+                    default:
+                        return fail("invalid escape sequence");
+                }
+                runStart = cur;
+            }
+            return fail("unterminated string");
+        }
+
+        bool parseNumber(JsonValue& out) {
+            const char* start = cur;
+            while (cur < end && ((*cur >= '0' && *cur <= '9') || *cur == '+' || *cur == '-' || *cur == '.' ||
+                                 *cur == 'e' || *cur == 'E')) {
+                ++cur;
+            }
+            if (cur == start) return fail("unexpected character");
+
+            // Token is copied so strtod never reads past a non-terminated buffer
+            char buffer[64];
+            size_t len = static_cast<size_t>(cur - start);
+            if (len >= sizeof(buffer)) return fail("number too long");
+            std::memcpy(buffer, start, len);
+            buffer[len] = '\0';
+
+            char* parsedEnd = nullptr;
+            out.type = Type::Number;
+            out.number = std::strtod(buffer, &parsedEnd);
+            if (parsedEnd != buffer + len) return fail("invalid number");
+            return true;
+        }
+    };
+};
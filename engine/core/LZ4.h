@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// LZ4 block format (no frame header): byte-aligned LZ77 that decodes at
+// close to memcpy speed. The compressor is the greedy single-probe variant,
+// which is all pack entries need since they are compressed once offline.
+class LZ4 {
+public:
+    static size_t maxCompressedSize(size_t size) {
+        return size + size / 255 + 16;
+    }
+
+    static void compress(const uint8_t* src, size_t size, std::vector<uint8_t>& out) {
+        out.resize(maxCompressedSize(size));
+        uint8_t* op = out.data();
+        const uint8_t* ip = src;
+        const uint8_t* anchor = src;
+        const uint8_t* end = src + size;
+
+        if (size >= MF_LIMIT + 1) {
+            const uint8_t* matchLimit = end - LAST_LITERALS;
+            const uint8_t* lastMatchStart = end - MF_LIMIT;
+            std::vector<uint32_t> table(size_t(1) << HASH_LOG, 0);
+
+            while (ip < lastMatchStart) {
+                uint32_t sequence = read32(ip);
+                uint32_t& slot = table[hash(sequence)];
+                const uint8_t* ref = src + slot;
+                slot = (uint32_t)(ip - src);
+
+                if (ref >= ip || ip - ref > MAX_OFFSET || read32(ref) != sequence) {
+                    // Skip ahead faster the longer nothing has matched, so
+                    // incompressible data (BC blocks, PNG) costs little
+                    ip = std::min(ip + 1 + ((ip - anchor) >> SKIP_SHIFT), lastMatchStart);
+                    continue;
+                }
+
+                const uint8_t* matchEnd = ip + MIN_MATCH;
+                const uint8_t* refEnd = ref + MIN_MATCH;
+                while (matchEnd < matchLimit && *matchEnd == *refEnd) {
+                    ++matchEnd;
+                    ++refEnd;
+                }
+                op = writeSequence(op, anchor, (size_t)(ip - anchor), (uint16_t)(ip - ref),
+                                   (size_t)(matchEnd - ip) - MIN_MATCH);
+                ip = matchEnd;
+                anchor = ip;
+                table[hash(read32(ip - 2))] = (uint32_t)(ip - 2 - src);
+            }
+        }
+
+        // Last literals
+        size_t literals = (size_t)(end - anchor);
+        uint8_t* token = op++;
+        *token = (uint8_t)(std::min<size_t>(literals, 15) << 4);
+        if (literals >= 15) op = writeLength(op, literals - 15);
+        std::memcpy(op, anchor, literals);
+        op += literals;
+        out.resize((size_t)(op - out.data()));
+    }
+
+    // Decodes exactly dstSize bytes; false on malformed or truncated input
+    static bool decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+        const uint8_t* ip = src;
+        const uint8_t* inEnd = src + srcSize;
+        uint8_t* op = dst;
+        uint8_t* outEnd = dst + dstSize;
+
+        while (ip < inEnd) {
+            uint8_t token = *ip++;
+
+            size_t literals = token >> 4;
+            if (literals == 15 && !readLength(ip, inEnd, literals)) return false;
+            if (literals > (size_t)(inEnd - ip) || literals > (size_t)(outEnd - op)) return false;
+            if (literals <= WILD_COPY && inEnd - ip >= (ptrdiff_t)WILD_COPY && outEnd - op >= (ptrdiff_t)WILD_COPY) {
+                // Short runs copy a fixed 16 bytes; the excess is overwritten next
+                std::memcpy(op, ip, WILD_COPY);
+            } else {
+                std::memcpy(op, ip, literals);
+            }
+            op += literals;
+            ip += literals;
+            if (ip == inEnd) break;  // the last sequence has no match
+
+            if (inEnd - ip < 2) return false;
+            size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+            ip += 2;
+            if (offset == 0 || offset > (size_t)(op - dst)) return false;
+
+            size_t length = token & 15;
+            if (length == 15 && !readLength(ip, inEnd, length)) return false;
+            length += MIN_MATCH;
+            if (length > (size_t)(outEnd - op)) return false;
+
+            // Matches may overlap their own output (offset < length), which
+            // repeats the last offset bytes. 8-byte steps are safe from
+            // offset 8 up since each step only reads bytes already written;
+            // with room left they may also run past the end of the match.
+            const uint8_t* match = op - offset;
+            uint8_t* matchEnd = op + length;
+            if (offset >= 8 && (size_t)(outEnd - matchEnd) >= 8) {
+                do {
+                    std::memcpy(op, match, 8);
+                    op += 8;
+                    match += 8;
+                } while (op < matchEnd);
+                op = matchEnd;
+            } else {
+                while (op < matchEnd) *op++ = *match++;
+            }
+        }
+        return op == outEnd;
+    }
+
+private:
+    static constexpr size_t MIN_MATCH = 4;
+    static constexpr size_t LAST_LITERALS = 5;  // the block always ends in literals
+    static constexpr size_t MF_LIMIT = 12;      // no match may start closer to the end
+    static constexpr ptrdiff_t MAX_OFFSET = 65535;
+    static constexpr int HASH_LOG = 16;
+    static constexpr int SKIP_SHIFT = 6;
+    static constexpr size_t WILD_COPY = 16;
+
+    static uint32_t read32(const uint8_t* p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    static uint32_t hash(uint32_t sequence) {
+        return (sequence * 2654435761u) >> (32 - HASH_LOG);
+    }
+
+    static uint8_t* writeLength(uint8_t* op, size_t length) {
+        while (length >= 255) {
+            *op++ = 255;
+            length -= 255;
+        }
+        *op++ = (uint8_t)length;
+        return op;
+    }
+
+    static bool readLength(const uint8_t*& ip, const uint8_t* inEnd, size_t& length) {
+        uint8_t byte;
+        do {
+            if (ip == inEnd) return false;
+            byte = *ip++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    static uint8_t* writeSequence(uint8_t* op, const uint8_t* literals, size_t literalCount,
+                                  uint16_t offset, size_t matchLength) {
+        uint8_t* token = op++;
+        *token = (uint8_t)((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchLength, 15));
+        if (literalCount >= 15) op = writeLength(op, literalCount - 15);
+        std::memcpy(op, literals, literalCount);
+        op += literalCount;
+        *op++ = (uint8_t)(offset & 0xFF);
+        *op++ = (uint8_t)(offset >> 8);
+        if (matchLength >= 15) op = writeLength(op, matchLength - 15);
+        return op;
+    }
+};
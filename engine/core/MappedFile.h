@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+// windef.h leaves these behind and they collide with near/far parameter names
+#undef near
+#undef far
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Non-owning view of a byte range (e.g. a chunk inside a mapped file)
+struct ByteSpan {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    bool empty() const { return data == nullptr || size == 0; }
+    ByteSpan subspan(size_t offset, size_t length) const {
+        if (offset > size) return ByteSpan();
+        if (length > size - offset) length = size - offset;
+        return ByteSpan{data + offset, length};
+    }
+};
+
+// Read-only memory mapping of a whole file. Pages are faulted in on first
+// access, so only the bytes that are actually touched are ever read.
+class MappedFile {
+private:
+    const uint8_t* mappedData = nullptr;
+    size_t mappedSize = 0;
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            mappedData = other.mappedData;
+            mappedSize = other.mappedSize;
+            other.mappedData = nullptr;
+            other.mappedSize = 0;
+#ifdef _WIN32
+            fileHandle = other.fileHandle;
+            mappingHandle = other.mappingHandle;
+            other.fileHandle = INVALID_HANDLE_VALUE;
+            other.mappingHandle = nullptr;
+#endif
+        }
+        return *this;
+    }
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0) {
+            close();
+            return false;
+        }
+
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mappingHandle) {
+            close();
+            return false;
+        }
+
+        mappedData = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if (!mappedData) {
+            close();
+            return false;
+        }
+        mappedSize = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+
+        void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // the mapping keeps its own reference to the file
+        if (addr == MAP_FAILED) return false;
+
+        mappedData = static_cast<const uint8_t*>(addr);
+        mappedSize = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (mappedData) UnmapViewOfFile(mappedData);
+        if (mappingHandle) CloseHandle(mappingHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (mappedData) munmap(const_cast<uint8_t*>(mappedData), mappedSize);
+#endif
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+
+    bool isOpen() const { return mappedData != nullptr; }
+    const uint8_t* data() const { return mappedData; }
+    size_t size() const { return mappedSize; }
+    ByteSpan span() const { return ByteSpan{mappedData, mappedSize}; }
+};
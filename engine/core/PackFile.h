@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "LZ4.h"
+#include "MappedFile.h"
+
+// Asset pack (.hpak): many asset files in one, mapped once, so a cold start
+// costs a single open instead of one per file. Written by PackCooker.
+//
+//   PackHeader
+//   entries    entryCount * PackEntry, sorted by pathHash
+//   names      entry paths relative to the mount point, '/' separated,
+//              not NUL-terminated
+//   data       entry contents, each starting on a PACK_ALIGNMENT boundary,
+//              stored as-is or as an LZ4 block
+//
+// Stored entries are read straight from the mapping; compressed ones are
+// inflated into memory on open. All values are little-endian.
+
+static constexpr uint32_t PACK_MAGIC = 0x4B415048;  // "HPAK"
+static constexpr uint32_t PACK_VERSION = 1;
+static constexpr size_t PACK_ALIGNMENT = 64;
+static constexpr uint64_t PACK_MAX_ENTRY_SIZE = 1ull << 31;  // inflated, per entry
+// An LZ4 block expands at most ~255x, so anything claiming more is corrupt
+static constexpr uint64_t PACK_MAX_LZ4_RATIO = 255;
+
+enum PackCompression {
+    PACK_STORED = 0,
+    PACK_LZ4 = 1
+};
+
+struct PackHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t entryOffset;
+    uint64_t nameOffset;
+    uint64_t nameSize;
+    uint64_t dataOffset;
+};
+
+struct PackEntry {
+    uint64_t pathHash;     // PackFile::hashPath of the name
+    uint64_t offset;       // of the stored bytes
+    uint64_t storedSize;
+    uint64_t size;         // once decompressed
+    uint32_t nameOffset;   // into the name table
+    uint32_t nameLength;
+    uint32_t compression;  // PackCompression
+    uint32_t reserved;
+};
+
+static_assert(sizeof(PackHeader) == 48, "PackHeader layout is part of the file format");
+static_assert(sizeof(PackEntry) == 48, "PackEntry layout is part of the file format");
+
+class PackFile {
+private:
+    MappedFile mapping;
+    PackHeader header = {};
+    const PackEntry* entries = nullptr;
+    const char* names = nullptr;
+
+    bool rangeValid(uint64_t offset, uint64_t size) const {
+        return offset <= mapping.size() && size <= mapping.size() - offset;
+    }
+
+    // Bounds the allocation inflate makes from the file-supplied size
+    static bool sizeValid(const PackEntry& entry) {
+        if (entry.size > PACK_MAX_ENTRY_SIZE) return false;
+        return entry.compression == PACK_STORED || entry.size <= entry.storedSize * PACK_MAX_LZ4_RATIO;
+    }
+
+public:
+    bool open(const std::string& path, std::string& error) {
+        header = PackHeader();
+        entries = nullptr;
+        names = nullptr;
+        if (!mapping.open(path)) {
+            error = "could not map " + path;
+            return false;
+        }
+        if (mapping.size() < sizeof(PackHeader)) {
+            error = "file too small to be a pack";
+            return false;
+        }
+
+        std::memcpy(&header, mapping.data(), sizeof(header));
+        if (header.magic != PACK_MAGIC) {
+            error = "invalid pack magic number";
+            return false;
+        }
+        if (header.version != PACK_VERSION) {
+            error = "pack version " + std::to_string(header.version) + " needs rebuilding";
+            return false;
+        }
+        if (header.entryOffset % alignof(PackEntry) != 0 ||
+            !rangeValid(header.entryOffset, (uint64_t)header.entryCount * sizeof(PackEntry)) ||
+            !rangeValid(header.nameOffset, header.nameSize)) {
+            error = "pack table of contents is truncated";
+            return false;
+        }
+        entries = reinterpret_cast<const PackEntry*>(mapping.data() + header.entryOffset);
+        names = reinterpret_cast<const char*>(mapping.data() + header.nameOffset);
+
+        // Every entry is checked here once; lookups and reads then trust the table
+        for (uint32_t i = 0; i < header.entryCount; ++i) {
+            const PackEntry& entry = entries[i];
+            if ((uint64_t)entry.nameOffset + entry.nameLength > header.nameSize ||
+                !rangeValid(entry.offset, entry.storedSize) ||
+                (entry.compression == PACK_STORED && entry.storedSize != entry.size) ||
+                entry.compression > PACK_LZ4 || !sizeValid(entry) ||
+                (i > 0 && entries[i - 1].pathHash > entry.pathHash)) {
+                error = "pack entry " + std::to_string(i) + " is invalid";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool isOpen() const { return mapping.isOpen(); }
+    uint32_t entryCount() const { return header.entryCount; }
+    const PackEntry& entry(uint32_t index) const { return entries[index]; }
+
+    std::string name(const PackEntry& entry) const {
+        return std::string(names + entry.nameOffset, entry.nameLength);
+    }
+
+    // Entry for a path relative to the mount point (see normalizePath)
+    const PackEntry* find(const std::string& relativePath) const {
+        uint64_t hash = hashPath(relativePath);
+        const PackEntry* end = entries + header.entryCount;
+        const PackEntry* it = std::lower_bound(entries, end, hash,
+            [](const PackEntry& entry, uint64_t value) { return entry.pathHash < value; });
+        for (; it != end && it->pathHash == hash; ++it) {
+            if (it->nameLength == relativePath.size() &&
+                std::memcmp(names + it->nameOffset, relativePath.data(), relativePath.size()) == 0) {
+                return it;
+            }
+        }
+        return nullptr;
+    }
+
+    // Bytes as stored in the pack (compressed or not)
+    ByteSpan stored(const PackEntry& entry) const {
+        return mapping.span().subspan(entry.offset, entry.storedSize);
+    }
+
+    bool inflate(const PackEntry& entry, std::vector<uint8_t>& out) const {
+        if (!sizeValid(entry)) return false;
+        ByteSpan bytes = stored(entry);
+        out.resize(entry.size);
+        if (entry.compression == PACK_STORED) {
+            if (bytes.size) std::memcpy(out.data(), bytes.data, bytes.size);
+            return true;
+        }
+        return LZ4::decompress(bytes.data, bytes.size, out.data(), out.size());
+    }
+
+    // FNV-1a; names are short and only need to spread across the table
+    static uint64_t hashPath(const std::string& path) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (char c : path) {
+            hash ^= (uint8_t)c;
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    // '/' separated, without empty, "." or ".." segments, so "a\\b/../c.png"
+    // and "a/c.png" name the same entry. Runs on every asset open, hence
+    // the hand-rolled loop instead of std::filesystem.
+    static std::string normalizePath(const std::string& path) {
+        std::string normal;
+        normal.reserve(path.size());
+        size_t begin = 0;
+        while (begin <= path.size()) {
+            size_t end = path.find_first_of("/\\", begin);
+            if (end == std::string::npos) end = path.size();
+            size_t length = end - begin;
+            if (length == 2 && path.compare(begin, 2, "..") == 0) {
+                size_t parent = normal.find_last_of('/');
+                bool canPop = !normal.empty() && normal.compare(parent == std::string::npos ? 0 : parent + 1,
+                                                                std::string::npos, "..") != 0;
+                if (canPop) normal.resize(parent == std::string::npos ? 0 : parent);
+                else normal += normal.empty() ? ".." : "/..";
+            } else if (length > 0 && !(length == 1 && path[begin] == '.')) {
+                if (!normal.empty()) normal += '/';
+                normal.append(path, begin, length);
+            }
+            begin = end + 1;
+        }
+        return normal;
+    }
+};
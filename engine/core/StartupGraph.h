@@ -0,0 +1,286 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "JobSystem.h"
+
+// Application startup as a dependency graph. MAIN tasks run on the thread
+// calling run() (the one that owns the window and GL context), earliest
+// added first among those whose dependencies are done; WORKER tasks go to the
+// JobSystem, so file reads, decoding and CPU generation overlap window,
+// context and shader setup. A failed task skips everything depending on it.
+//
+// Every task is timed; the report gives wall time, the critical path (the
+// chain of dependent tasks that bounds the wall time however many workers
+// there are) and, once markFirstFrame() is called, time to first frame.
+class StartupGraph {
+public:
+    enum class Thread { MAIN, WORKER };
+    using TaskId = size_t;
+
+    StartupGraph() : origin(Clock::now()) {}
+
+    StartupGraph(const StartupGraph&) = delete;
+    StartupGraph& operator=(const StartupGraph&) = delete;
+
+    // Dependencies must already be in the graph, which keeps it acyclic
+    TaskId add(const std::string& name, Thread thread, std::function<bool()> fn,
+               const std::vector<TaskId>& dependencies = {}) {
+        TaskId id = tasks.size();
+        Task task;
+        task.name = name;
+        task.thread = thread;
+        task.fn = std::move(fn);
+        for (TaskId dependency : dependencies) {
+            if (dependency >= id) continue;
+            task.dependencies.push_back(dependency);
+            tasks[dependency].dependents.push_back(id);
+        }
+        task.waitingOn = task.dependencies.size();
+        tasks.push_back(std::move(task));
+        return id;
+    }
+
+    // Runs every task; false if any failed or was skipped
+    bool run() {
+        runStart = elapsedMs();
+        remaining = tasks.size();
+        for (TaskId id = 0; id < tasks.size(); ++id) {
+            if (tasks[id].waitingOn == 0) schedule(id);
+        }
+
+        while (remaining > 0) {
+            std::vector<std::pair<TaskId, bool>> done;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (mainReady.empty()) {
+                    finished.wait(lock, [this]() { return !completions.empty(); });
+                }
+                done.swap(completions);
+            }
+            for (const auto& completion : done) complete(completion.first, completion.second);
+
+            if (!mainReady.empty()) {
+                TaskId id = *mainReady.begin();
+                mainReady.erase(mainReady.begin());
+                complete(id, execute(tasks[id]));
+            }
+        }
+        runEnd = elapsedMs();
+
+        for (const Task& task : tasks) {
+            if (task.state != State::DONE) return false;
+        }
+        return true;
+    }
+
+    // Call after the first swap; returns ms since the graph was created
+    double markFirstFrame() {
+        if (firstFrameMs < 0.0) firstFrameMs = elapsedMs();
+        return firstFrameMs;
+    }
+
+    double wallMs() const { return runEnd - runStart; }
+
+    // Tasks on the longest duration-weighted dependency chain, first to last
+    std::vector<TaskId> criticalPath() const {
+        std::vector<double> pathMs(tasks.size(), 0.0);
+        std::vector<TaskId> previous(tasks.size(), tasks.size());
+        TaskId last = tasks.size();
+        for (TaskId id = 0; id < tasks.size(); ++id) {
+            for (TaskId dependency : tasks[id].dependencies) {
+                if (pathMs[dependency] > pathMs[id]) {
+                    pathMs[id] = pathMs[dependency];
+                    previous[id] = dependency;
+                }
+            }
+            pathMs[id] += tasks[id].durationMs();
+            if (last == tasks.size() || pathMs[id] > pathMs[last]) last = id;
+        }
+
+        std::vector<TaskId> path;
+        for (TaskId id = last; id < tasks.size(); id = previous[id]) path.push_back(id);
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    double criticalPathMs() const {
+        double total = 0.0;
+        for (TaskId id : criticalPath()) total += tasks[id].durationMs();
+        return total;
+    }
+
+    void printReport(std::ostream& out) const {
+        std::vector<TaskId> path = criticalPath();
+        out << std::fixed << std::setprecision(1);
+        out << "[INFO] Startup: " << wallMs() << " ms wall, critical path " << criticalPathMs() << " ms (";
+        for (size_t i = 0; i < path.size(); ++i) out << (i ? " > " : "") << tasks[path[i]].name;
+        out << ")\n";
+        out << "    start     time  thread  task\n";
+        for (const Task& task : tasks) {
+            out << std::setw(9) << task.startMs - runStart << std::setw(9) << task.durationMs() << "  "
+                << std::left << std::setw(6) << threadName(task.thread) << "  " << task.name << std::right;
+            if (task.state != State::DONE) out << " (" << stateName(task.state) << ")";
+            out << "\n";
+        }
+        out << std::defaultfloat << std::setprecision(6);
+    }
+
+    // Same report as JSON, for comparing startups across builds and machines
+    bool writeReport(const std::string& path) const {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) return false;
+
+        out << "{\n";
+        out << "  \"wallMs\": " << number(wallMs()) << ",\n";
+        out << "  \"criticalPathMs\": " << number(criticalPathMs()) << ",\n";
+        out << "  \"firstFrameMs\": " << (firstFrameMs < 0.0 ? "null" : number(firstFrameMs)) << ",\n";
+        out << "  \"criticalPath\": [";
+        std::vector<TaskId> critical = criticalPath();
+        for (size_t i = 0; i < critical.size(); ++i) {
+            out << (i ? ", " : "") << quoted(tasks[critical[i]].name);
+        }
+        out << "],\n";
+        out << "  \"tasks\": [\n";
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            const Task& task = tasks[i];
+            out << "    {\"name\": " << quoted(task.name)
+                << ", \"thread\": " << quoted(threadName(task.thread))
+                << ", \"status\": " << quoted(stateName(task.state))
+                << ", \"startMs\": " << number(task.startMs - runStart)
+                << ", \"durationMs\": " << number(task.durationMs())
+                << ", \"dependencies\": [";
+            for (size_t d = 0; d < task.dependencies.size(); ++d) {
+                out << (d ? ", " : "") << quoted(tasks[task.dependencies[d]].name);
+            }
+            out << "]}" << (i + 1 < tasks.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n";
+        out << "}\n";
+        return (bool)out;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum class State { PENDING, RUNNING, DONE, FAILED, SKIPPED };
+
+    struct Task {
+        std::string name;
+        Thread thread = Thread::MAIN;
+        std::function<bool()> fn;
+        std::vector<TaskId> dependencies;
+        std::vector<TaskId> dependents;
+        size_t waitingOn = 0;
+        bool blocked = false;  // a dependency failed
+        State state = State::PENDING;
+        double startMs = 0.0;
+        double endMs = 0.0;
+
+        double durationMs() const { return endMs - startMs; }
+    };
+
+    Clock::time_point origin;
+    std::vector<Task> tasks;
+    std::set<TaskId> mainReady;
+    size_t remaining = 0;
+    double runStart = 0.0;
+    double runEnd = 0.0;
+    double firstFrameMs = -1.0;
+
+    // Worker tasks hand their result back to the main thread here
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::vector<std::pair<TaskId, bool>> completions;
+
+    double elapsedMs() const {
+        return std::chrono::duration<double, std::milli>(Clock::now() - origin).count();
+    }
+
+    bool execute(Task& task) {
+        task.state = State::RUNNING;
+        task.startMs = elapsedMs();
+        bool ok = task.fn();
+        task.endMs = elapsedMs();
+        return ok;
+    }
+
+    void schedule(TaskId id) {
+        Task& task = tasks[id];
+        if (task.blocked) {
+            task.state = State::SKIPPED;
+            task.startMs = task.endMs = elapsedMs();
+            complete(id, false);
+        } else if (task.thread == Thread::MAIN) {
+            mainReady.insert(id);
+        } else {
+            // Only this job touches the task until its completion is handed back
+            JobSystem::getInstance().enqueue([this, id]() {
+                bool ok = execute(tasks[id]);
+                // Notified under the lock: run() may return, and the graph go
+                // away, as soon as this completion is seen
+                std::lock_guard<std::mutex> lock(mutex);
+                completions.emplace_back(id, ok);
+                finished.notify_one();
+            });
+        }
+    }
+
+    void complete(TaskId id, bool ok) {
+        Task& task = tasks[id];
+        if (task.state != State::SKIPPED) task.state = ok ? State::DONE : State::FAILED;
+        --remaining;
+        for (TaskId dependent : task.dependents) {
+            if (!ok) tasks[dependent].blocked = true;
+            if (--tasks[dependent].waitingOn == 0) schedule(dependent);
+        }
+    }
+
+    static const char* threadName(Thread thread) {
+        return thread == Thread::MAIN ? "main" : "worker";
+    }
+
+    static const char* stateName(State state) {
+        switch (state) {
+            case State::PENDING: return "pending";
+            case State::RUNNING: return "running";
+            case State::DONE: return "done";
+            case State::FAILED: return "failed";
+            case State::SKIPPED: return "skipped";
+        }
+        return "unknown";
+    }
+
+    static std::string number(double value) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+        return buffer;
+    }
+
+    static std::string quoted(const std::string& text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            if ((unsigned char)c < 0x20) {
+                char escape[8];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", (unsigned char)c);
+                out += escape;
+            } else {
+                out += c;
+            }
+        }
+        return out + "\"";
+    }
+};
@@ -28,6 +28,8 @@ public:
     Vec3 getForward() const { return forward; }
     Vec3 getRight() const { return glm::cross(forward, up); }
     Vec3 getUp() const { return up; }
+    float getNearPlane() const { return nearPlane; }
+    float getFarPlane() const { return farPlane; }
 
     void setPosition(const Vec3& pos) { position = pos; }
     void setForward(const Vec3& dir) { forward = glm::normalize(dir); }
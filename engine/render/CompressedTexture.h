@@ -0,0 +1,62 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+
+#include "../assets/HTexFile.h"
+#include "../assets/TextureCompressor.h"
+
+// Uploads cooked .htex mip chains. Block formats go through
+// glCompressedTexImage2D when the driver exposes them; otherwise each level
+// is expanded to RGBA8 on the CPU and uploaded uncompressed.
+class CompressedTexture {
+public:
+    static bool isSupported(HTexFormat format) {
+        switch (format) {
+            case HTEX_RGBA8: return true;
+            case HTEX_BC1:
+            case HTEX_BC3: return GLEW_EXT_texture_compression_s3tc != 0;
+            case HTEX_BC5: return GLEW_ARB_texture_compression_rgtc != 0 || GLEW_VERSION_3_0 != 0;
+            case HTEX_BC7: return GLEW_ARB_texture_compression_bptc != 0 || GLEW_VERSION_4_2 != 0;
+        }
+        return false;
+    }
+
+    static GLenum internalFormat(HTexFormat format) {
+        switch (format) {
+            case HTEX_BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            case HTEX_BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case HTEX_BC5: return GL_COMPRESSED_RG_RGTC2;
+            case HTEX_BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+            default: return GL_RGBA8;
+        }
+    }
+
+    // Fills the bound GL_TEXTURE_2D with every level of the container
+    static void upload(const HTexView& view) {
+        HTexFormat format = view.format();
+        bool native = isSupported(format);
+        std::vector<uint8_t> expanded;
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)view.levelCount() - 1);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (uint32_t i = 0; i < view.levelCount(); ++i) {
+            HTexLevel level = view.level(i);
+            ByteSpan data = view.levelData(i);
+            if (format == HTEX_RGBA8 || !native) {
+                const uint8_t* pixels = data.data;
+                if (format != HTEX_RGBA8) {
+                    TextureCompressor::decompress(format, data.data, (int)level.width, (int)level.height, expanded);
+                    pixels = expanded.data();
+                }
+                glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_RGBA, (GLsizei)level.width, (GLsizei)level.height, 0,
+                             GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            } else {
+                glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, internalFormat(format),
+                                       (GLsizei)level.width, (GLsizei)level.height, 0,
+                                       (GLsizei)HTexView::levelSize(format, level.width, level.height), data.data);
+            }
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+};
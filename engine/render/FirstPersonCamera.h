@@ -3,6 +3,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "Frustum.h"
+
 class FirstPersonCamera {
 public:
     glm::vec3 position;
@@ -84,6 +86,11 @@ public:
         return glm::perspective(glm::radians(fov), aspect, near, far);
     }
     
+    // Planes of the view volume for getProjectionMatrix() with the same arguments
+    Frustum getFrustum(float fov, float aspect, float near, float far) const {
+        return Frustum::fromViewProjection(getProjectionMatrix(fov, aspect, near, far) * getViewMatrix());
+    }
+    
     // Getters
     glm::vec3 getPosition() const { return position; }
     glm::vec3 getFront() const { return front; }
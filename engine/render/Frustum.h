@@ -0,0 +1,194 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FRUSTUM_SSE2 1
+#endif
+
+// Axis-aligned box; its bounding sphere is centered on the box
+struct Bounds {
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 extent() const { return (max - min) * 0.5f; }
+    float radius() const { return glm::length(extent()); }
+
+    bool overlaps(const Bounds& other) const {
+        return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::greaterThanEqual(max, other.min));
+    }
+
+    // Slab test against a ray given as origin and 1 / direction. entry is
+    // the distance at which the ray enters (0 when it starts inside).
+    bool intersectsRay(const glm::vec3& origin, const glm::vec3& invDir, float maxDistance, float& entry) const {
+        glm::vec3 t1 = (min - origin) * invDir;
+        glm::vec3 t2 = (max - origin) * invDir;
+        glm::vec3 tNear = glm::min(t1, t2);
+        glm::vec3 tFar = glm::max(t1, t2);
+        entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+        return entry <= exit;
+    }
+
+    static Bounds fromPoints(const glm::vec3* points, size_t count) {
+        Bounds bounds;
+        if (count == 0) return bounds;
+        bounds.min = bounds.max = points[0];
+        for (size_t i = 1; i < count; ++i) {
+            bounds.min = glm::min(bounds.min, points[i]);
+            bounds.max = glm::max(bounds.max, points[i]);
+        }
+        return bounds;
+    }
+
+    // Box around this one after an affine transform (Arvo's method)
+    Bounds transformed(const glm::mat4& m) const {
+        glm::vec3 c = glm::vec3(m * glm::vec4(center(), 1.0f));
+        glm::vec3 e = extent();
+        glm::vec3 worldExtent;
+        for (int i = 0; i < 3; ++i) {
+            worldExtent[i] = std::abs(m[0][i]) * e.x + std::abs(m[1][i]) * e.y + std::abs(m[2][i]) * e.z;
+        }
+        Bounds out;
+        out.min = c - worldExtent;
+        out.max = c + worldExtent;
+        return out;
+    }
+};
+
+// Six planes with normals pointing inside, extracted from a view-projection
+// matrix (Gribb/Hartmann) and normalized, so plane distances are in world units
+struct Frustum {
+    glm::vec4 planes[6];  // left, right, bottom, top, near, far
+
+    static Frustum fromViewProjection(const glm::mat4& m) {
+        glm::vec4 rows[4];
+        for (int i = 0; i < 4; ++i) rows[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+
+        Frustum frustum;
+        frustum.planes[0] = rows[3] + rows[0];
+        frustum.planes[1] = rows[3] - rows[0];
+        frustum.planes[2] = rows[3] + rows[1];
+        frustum.planes[3] = rows[3] - rows[1];
+        frustum.planes[4] = rows[3] + rows[2];
+        frustum.planes[5] = rows[3] - rows[2];
+        for (glm::vec4& plane : frustum.planes) plane /= glm::length(glm::vec3(plane));
+        return frustum;
+    }
+
+    bool intersectsSphere(const glm::vec3& center, float radius) const {
+        for (const glm::vec4& plane : planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+        }
+        return true;
+    }
+
+    enum Containment { OUTSIDE, INTERSECTS, INSIDE };
+
+    // INSIDE when the whole box is in the frustum, which lets hierarchies
+    // accept a subtree without testing what is in it
+    Containment classifyBox(const Bounds& box) const {
+        Containment result = INSIDE;
+        for (const glm::vec4& plane : planes) {
+            glm::vec3 outer(plane.x >= 0.0f ? box.max.x : box.min.x,
+                            plane.y >= 0.0f ? box.max.y : box.min.y,
+                            plane.z >= 0.0f ? box.max.z : box.min.z);
+            if (glm::dot(glm::vec3(plane), outer) + plane.w < 0.0f) return OUTSIDE;
+            glm::vec3 inner(plane.x >= 0.0f ? box.min.x : box.max.x,
+                            plane.y >= 0.0f ? box.min.y : box.max.y,
+                            plane.z >= 0.0f ? box.min.z : box.max.z);
+            if (glm::dot(glm::vec3(plane), inner) + plane.w < 0.0f) result = INTERSECTS;
+        }
+        return result;
+    }
+
+    // Tests the box corner furthest along each plane's normal
+    bool intersectsBox(const Bounds& box) const {
+        for (const glm::vec4& plane : planes) {
+            glm::vec3 corner(plane.x >= 0.0f ? box.max.x : box.min.x,
+                             plane.y >= 0.0f ? box.max.y : box.min.y,
+                             plane.z >= 0.0f ? box.max.z : box.min.z);
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) return false;
+        }
+        return true;
+    }
+};
+
+// Bounding spheres kept as separate x/y/z/radius arrays so cull() can test
+// four per step with SSE2. Refill it each frame (or when objects move) and
+// refine the survivors with Frustum::intersectsBox where boxes are tighter.
+class FrustumCuller {
+public:
+    void clear() {
+        xs.clear();
+        ys.clear();
+        zs.clear();
+        radii.clear();
+    }
+
+    void reserve(size_t count) {
+        xs.reserve(count);
+        ys.reserve(count);
+        zs.reserve(count);
+        radii.reserve(count);
+    }
+
+    // Spheres are numbered in the order they are added
+    void add(const glm::vec3& center, float radius) {
+        xs.push_back(center.x);
+        ys.push_back(center.y);
+        zs.push_back(center.z);
+        radii.push_back(radius);
+    }
+
+    size_t size() const { return xs.size(); }
+
+    // Appends the numbers of the spheres that touch the frustum, in order
+    void cull(const Frustum& frustum, std::vector<uint32_t>& visible) const {
+        size_t count = xs.size();
+        size_t i = 0;
+#ifdef FRUSTUM_SSE2
+        __m128 nx[6], ny[6], nz[6], nw[6];
+        for (int p = 0; p < 6; ++p) {
+            nx[p] = _mm_set1_ps(frustum.planes[p].x);
+            ny[p] = _mm_set1_ps(frustum.planes[p].y);
+            nz[p] = _mm_set1_ps(frustum.planes[p].z);
+            nw[p] = _mm_set1_ps(frustum.planes[p].w);
+        }
+        for (; i + 4 <= count; i += 4) {
+            __m128 x = _mm_loadu_ps(&xs[i]);
+            __m128 y = _mm_loadu_ps(&ys[i]);
+            __m128 z = _mm_loadu_ps(&zs[i]);
+            __m128 r = _mm_loadu_ps(&radii[i]);
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int p = 0; p < 6; ++p) {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], x), _mm_mul_ps(ny[p], y)),
+                                             _mm_add_ps(_mm_mul_ps(nz[p], z), nw[p]));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, r), _mm_setzero_ps()));
+            }
+            int mask = _mm_movemask_ps(inside);
+            for (int lane = 0; lane < 4; ++lane) {
+                if (mask & (1 << lane)) visible.push_back((uint32_t)(i + lane));
+            }
+        }
+#endif
+        for (; i < count; ++i) {
+            if (frustum.intersectsSphere(glm::vec3(xs[i], ys[i], zs[i]), radii[i])) visible.push_back((uint32_t)i);
+        }
+    }
+
+private:
+    std::vector<float> xs, ys, zs, radii;
+};
+
+// Objects a culling pass kept and dropped
+struct CullStats {
+    size_t visible = 0;
+    size_t culled = 0;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// Move-only owner of one GL object name; the name is deleted with its owner.
+// Owners must be destroyed on the GL thread while the context is current.
+template <typename Traits>
+class GLHandle {
+private:
+    GLuint id = 0;
+
+public:
+    GLHandle() = default;
+    explicit GLHandle(GLuint name) : id(name) {}
+    ~GLHandle() { reset(); }
+
+    GLHandle(const GLHandle&) = delete;
+    GLHandle& operator=(const GLHandle&) = delete;
+
+    GLHandle(GLHandle&& other) noexcept : id(other.release()) {}
+    GLHandle& operator=(GLHandle&& other) noexcept {
+        if (this != &other) reset(other.release());
+        return *this;
+    }
+
+    static GLHandle create() {
+        GLuint name = 0;
+        Traits::create(name);
+        return GLHandle(name);
+    }
+
+    GLuint get() const { return id; }
+    explicit operator bool() const { return id != 0; }
+
+    // Gives up ownership without deleting the name
+    GLuint release() {
+        GLuint name = id;
+        id = 0;
+        return name;
+    }
+
+    void reset(GLuint name = 0) {
+        if (id) Traits::destroy(id);
+        id = name;
+    }
+};
+
+struct GLBufferTraits {
+    static void create(GLuint& id) { glGenBuffers(1, &id); }
+    static void destroy(GLuint id) { glDeleteBuffers(1, &id); }
+};
+
+struct GLVertexArrayTraits {
+    static void create(GLuint& id) { glGenVertexArrays(1, &id); }
+    static void destroy(GLuint id) { glDeleteVertexArrays(1, &id); }
+};
+
+struct GLTextureTraits {
+    static void create(GLuint& id) { glGenTextures(1, &id); }
+    static void destroy(GLuint id) { glDeleteTextures(1, &id); }
+};
+
+using GLBuffer = GLHandle<GLBufferTraits>;
+using GLVertexArray = GLHandle<GLVertexArrayTraits>;
+using GLTexture = GLHandle<GLTextureTraits>;
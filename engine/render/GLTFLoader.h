@@ -0,0 +1,726 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../assets/MeshGeometry.h"
+#include "../core/Json.h"
+
+// glTF 2.0 accessor component types (same values as the matching GL enums)
+enum GLTFComponentType {
+    GLTF_BYTE = 5120,
+    GLTF_UNSIGNED_BYTE = 5121,
+    GLTF_SHORT = 5122,
+    GLTF_UNSIGNED_SHORT = 5123,
+    GLTF_UNSIGNED_INT = 5125,
+    GLTF_FLOAT = 5126
+};
+
+enum GLTFPrimitiveMode {
+    GLTF_MODE_TRIANGLES = 4
+};
+
+struct GLTFBufferView {
+    int buffer = 0;
+    size_t byteOffset = 0;
+    size_t byteLength = 0;
+    size_t byteStride = 0;  // 0 = tightly packed
+};
+
+struct GLTFSparse {
+    size_t count = 0;
+    int indicesBufferView = -1;
+    size_t indicesByteOffset = 0;
+    int indicesComponentType = GLTF_UNSIGNED_INT;
+    int valuesBufferView = -1;
+    size_t valuesByteOffset = 0;
+};
+
+struct GLTFAccessor {
+    int bufferView = -1;  // -1 = all zeros (sparse-only accessor)
+    size_t byteOffset = 0;
+    int componentType = GLTF_FLOAT;
+    bool normalized = false;
+    size_t count = 0;
+    int components = 1;
+    GLTFSparse sparse;
+};
+
+struct GLTFImage {
+    int bufferView = -1;
+    std::string mimeType;
+    std::string uri;
+};
+
+struct GLTFMaterial {
+    std::string name;
+    glm::vec4 baseColorFactor = glm::vec4(1.0f);
+    float metallicFactor = 1.0f;
+    float roughnessFactor = 1.0f;
+    int baseColorTexture = -1;
+    int metallicRoughnessTexture = -1;
+    int normalTexture = -1;
+    int occlusionTexture = -1;
+    bool doubleSided = false;
+};
+
+struct GLTFPrimitive {
+    int position = -1;
+    int normal = -1;
+    int tangent = -1;
+    int texCoord0 = -1;
+    int indices = -1;
+    int material = -1;
+    int mode = GLTF_MODE_TRIANGLES;
+};
+
+struct GLTFNode {
+    int mesh = -1;
+    std::vector<int> children;
+    glm::mat4 matrix = glm::mat4(1.0f);
+};
+
+// Encoded image bytes living inside the GLB binary chunk
+struct GLTFImageRef {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    std::string mimeType;
+
+    bool valid() const { return data != nullptr && size > 0; }
+};
+
+// Parsed glTF JSON plus a view of the binary chunk. Accessors are decoded
+// straight from the binary chunk into caller-provided storage.
+class GLTFDocument {
+public:
+    std::vector<GLTFBufferView> bufferViews;
+    std::vector<GLTFAccessor> accessors;
+    std::vector<GLTFImage> images;
+    std::vector<int> textures;  // texture index -> image index
+    std::vector<GLTFMaterial> materials;
+    std::vector<std::vector<GLTFPrimitive>> meshes;
+    std::vector<GLTFNode> nodes;
+    std::vector<int> sceneNodes;
+
+    const uint8_t* bin = nullptr;
+    size_t binSize = 0;
+
+    static size_t componentSize(int componentType) {
+        switch (componentType) {
+            case GLTF_BYTE:
+            case GLTF_UNSIGNED_BYTE: return 1;
+            case GLTF_SHORT:
+            case GLTF_UNSIGNED_SHORT: return 2;
+            case GLTF_UNSIGNED_INT:
+            case GLTF_FLOAT: return 4;
+            default: return 0;
+        }
+    }
+
+    static int typeComponents(const std::string& type) {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        if (type == "MAT2") return 4;
+        if (type == "MAT3") return 9;
+        if (type == "MAT4") return 16;
+        return 0;
+    }
+
+    bool parse(const char* json, size_t jsonLength, const uint8_t* binData, size_t binLength, std::string& error) {
+        JsonValue root;
+        if (!JsonValue::parse(json, jsonLength, root, &error)) {
+            error = "invalid glTF JSON: " + error;
+            return false;
+        }
+
+        bin = binData;
+        binSize = binLength;
+
+        const JsonValue& views = root["bufferViews"];
+        bufferViews.resize(views.size());
+        for (size_t i = 0; i < views.size(); ++i) {
+            const JsonValue& v = views[i];
+            GLTFBufferView& view = bufferViews[i];
+            view.buffer = v["buffer"].asInt(0);
+            view.byteOffset = v["byteOffset"].asSize(0);
+            view.byteLength = v["byteLength"].asSize(0);
+            view.byteStride = v["byteStride"].asSize(0);
+            if (view.buffer != 0) {
+                error = "bufferView " + std::to_string(i) + " references an external buffer";
+                return false;
+            }
+            if (view.byteOffset + view.byteLength > binSize) {
+                error = "bufferView " + std::to_string(i) + " exceeds the binary chunk";
+                return false;
+            }
+        }
+
+        const JsonValue& accs = root["accessors"];
+        accessors.resize(accs.size());
+        for (size_t i = 0; i < accs.size(); ++i) {
+            const JsonValue& a = accs[i];
+            GLTFAccessor& acc = accessors[i];
+            acc.bufferView = a["bufferView"].asInt(-1);
+            acc.byteOffset = a["byteOffset"].asSize(0);
+            acc.componentType = a["componentType"].asInt(GLTF_FLOAT);
+            acc.normalized = a["normalized"].asBool(false);
+            acc.count = a["count"].asSize(0);
+            acc.components = typeComponents(a["type"].asString());
+            if (acc.components == 0 || componentSize(acc.componentType) == 0) {
+                error = "accessor " + std::to_string(i) + " has an unsupported type";
+                return false;
+            }
+
+            const JsonValue& sparse = a["sparse"];
+            if (sparse.isObject()) {
+                acc.sparse.count = sparse["count"].asSize(0);
+                acc.sparse.indicesBufferView = sparse["indices"]["bufferView"].asInt(-1);
+                acc.sparse.indicesByteOffset = sparse["indices"]["byteOffset"].asSize(0);
+                acc.sparse.indicesComponentType = sparse["indices"]["componentType"].asInt(GLTF_UNSIGNED_INT);
+                acc.sparse.valuesBufferView = sparse["values"]["bufferView"].asInt(-1);
+                acc.sparse.valuesByteOffset = sparse["values"]["byteOffset"].asSize(0);
+            }
+        }
+
+        const JsonValue& imgs = root["images"];
+        images.resize(imgs.size());
+        for (size_t i = 0; i < imgs.size(); ++i) {
+            images[i].bufferView = imgs[i]["bufferView"].asInt(-1);
+            images[i].mimeType = imgs[i]["mimeType"].asString();
+            images[i].uri = imgs[i]["uri"].asString();
+        }
+
+        const JsonValue& texs = root["textures"];
+        textures.resize(texs.size());
+        for (size_t i = 0; i < texs.size(); ++i) {
+            textures[i] = texs[i]["source"].asInt(-1);
+        }
+
+        const JsonValue& mats = root["materials"];
+        materials.resize(mats.size());
+        for (size_t i = 0; i < mats.size(); ++i) {
+            const JsonValue& m = mats[i];
+            const JsonValue& pbr = m["pbrMetallicRoughness"];
+            GLTFMaterial& mat = materials[i];
+            mat.name = m["name"].asString();
+            const JsonValue& factor = pbr["baseColorFactor"];
+            if (factor.size() == 4) {
+                mat.baseColorFactor = glm::vec4(factor[0].asFloat(), factor[1].asFloat(),
+                                                factor[2].asFloat(), factor[3].asFloat());
+            }
+            mat.metallicFactor = pbr["metallicFactor"].asFloat(1.0f);
+            mat.roughnessFactor = pbr["roughnessFactor"].asFloat(1.0f);
+            mat.baseColorTexture = pbr["baseColorTexture"]["index"].asInt(-1);
+            mat.metallicRoughnessTexture = pbr["metallicRoughnessTexture"]["index"].asInt(-1);
+            mat.normalTexture = m["normalTexture"]["index"].asInt(-1);
+            mat.occlusionTexture = m["occlusionTexture"]["index"].asInt(-1);
+            mat.doubleSided = m["doubleSided"].asBool(false);
+        }
+
+        const JsonValue& meshArray = root["meshes"];
+        meshes.resize(meshArray.size());
+        for (size_t i = 0; i < meshArray.size(); ++i) {
+            const JsonValue& prims = meshArray[i]["primitives"];
+            meshes[i].resize(prims.size());
+            for (size_t p = 0; p < prims.size(); ++p) {
+                const JsonValue& attrs = prims[p]["attributes"];
+                GLTFPrimitive& prim = meshes[i][p];
+                prim.position = attrs["POSITION"].asInt(-1);
+                prim.normal = attrs["NORMAL"].asInt(-1);
+                prim.tangent = attrs["TANGENT"].asInt(-1);
+                prim.texCoord0 = attrs["TEXCOORD_0"].asInt(-1);
+                prim.indices = prims[p]["indices"].asInt(-1);
+                prim.material = prims[p]["material"].asInt(-1);
+                prim.mode = prims[p]["mode"].asInt(GLTF_MODE_TRIANGLES);
+            }
+        }
+
+        const JsonValue& nodeArray = root["nodes"];
+        nodes.resize(nodeArray.size());
+        std::vector<bool> isChild(nodeArray.size(), false);
+        for (size_t i = 0; i < nodeArray.size(); ++i) {
+            const JsonValue& n = nodeArray[i];
+            GLTFNode& node = nodes[i];
+            node.mesh = n["mesh"].asInt(-1);
+            const JsonValue& children = n["children"];
+            for (size_t c = 0; c < children.size(); ++c) {
+                int child = children[c].asInt(-1);
+                if (child >= 0 && child < (int)nodeArray.size()) {
+                    node.children.push_back(child);
+                    isChild[child] = true;
+                }
+            }
+            node.matrix = parseNodeMatrix(n);
+        }
+
+        // Default scene, or every root node when the file declares no scenes
+        const JsonValue& scenes = root["scenes"];
+        const JsonValue& scene = scenes[root["scene"].asSize(0)];
+        if (scene.isObject()) {
+            const JsonValue& roots = scene["nodes"];
+            for (size_t i = 0; i < roots.size(); ++i) {
+                int nodeIdx = roots[i].asInt(-1);
+                if (nodeIdx >= 0 && nodeIdx < (int)nodes.size()) sceneNodes.push_back(nodeIdx);
+            }
+        } else {
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                if (!isChild[i]) sceneNodes.push_back((int)i);
+            }
+        }
+
+        return true;
+    }
+
+    int textureImage(int textureIndex) const {
+        if (textureIndex < 0 || textureIndex >= (int)textures.size()) return -1;
+        int image = textures[textureIndex];
+        return (image >= 0 && image < (int)images.size()) ? image : -1;
+    }
+
+    GLTFImageRef imageRef(int imageIndex) const {
+        GLTFImageRef ref;
+        if (imageIndex < 0 || imageIndex >= (int)images.size()) return ref;
+        const GLTFImage& image = images[imageIndex];
+        if (image.bufferView < 0 || image.bufferView >= (int)bufferViews.size()) return ref;
+        const GLTFBufferView& view = bufferViews[image.bufferView];
+        ref.data = bin + view.byteOffset;
+        ref.size = view.byteLength;
+        ref.mimeType = image.mimeType;
+        return ref;
+    }
+
+    // Decodes an accessor into `out`, writing min(accessor components, outComponents)
+    // floats per element with an element stride of outComponents floats.
+    // Integer components are converted (and normalized when flagged).
+    bool readFloats(int accessorIndex, float* out, int outComponents, std::string& error) const {
+        const GLTFAccessor* accPtr = accessor(accessorIndex, error);
+        if (!accPtr) return false;
+        const GLTFAccessor& acc = *accPtr;
+
+        int copyComponents = acc.components < outComponents ? acc.components : outComponents;
+        size_t compSize = componentSize(acc.componentType);
+
+        if (acc.bufferView < 0) {
+            for (size_t i = 0; i < acc.count; ++i) {
+                for (int c = 0; c < copyComponents; ++c) out[i * outComponents + c] = 0.0f;
+            }
+        } else {
+            const uint8_t* src;
+            size_t stride;
+            if (!elementRange(acc, src, stride, error)) return false;
+
+            size_t elementSize = compSize * acc.components;
+            if (acc.componentType == GLTF_FLOAT && stride == elementSize && acc.components == outComponents) {
+                std::memcpy(out, src, acc.count * elementSize);
+            } else {
+                for (size_t i = 0; i < acc.count; ++i) {
+                    const uint8_t* element = src + i * stride;
+                    float* dst = out + i * outComponents;
+                    for (int c = 0; c < copyComponents; ++c) {
+                        dst[c] = readComponent(element + c * compSize, acc.componentType, acc.normalized);
+                    }
+                }
+            }
+        }
+
+        return applySparse(acc, error, [&](size_t index, const uint8_t* value) {
+            float* dst = out + index * outComponents;
+            for (int c = 0; c < copyComponents; ++c) {
+                dst[c] = readComponent(value + c * compSize, acc.componentType, acc.normalized);
+            }
+        });
+    }
+
+    // Decodes an u8/u16/u32 scalar accessor into 32-bit indices
+    bool readIndices(int accessorIndex, uint32_t* out, std::string& error) const {
+        const GLTFAccessor* accPtr = accessor(accessorIndex, error);
+        if (!accPtr) return false;
+        const GLTFAccessor& acc = *accPtr;
+
+        if (acc.components != 1 || acc.componentType == GLTF_FLOAT ||
+            acc.componentType == GLTF_BYTE || acc.componentType == GLTF_SHORT) {
+            error = "accessor " + std::to_string(accessorIndex) + " is not a valid index accessor";
+            return false;
+        }
+
+        if (acc.bufferView < 0) {
+            std::memset(out, 0, acc.count * sizeof(uint32_t));
+        } else {
+            const uint8_t* src;
+            size_t stride;
+            if (!elementRange(acc, src, stride, error)) return false;
+
+            if (acc.componentType == GLTF_UNSIGNED_INT && stride == 4) {
+                std::memcpy(out, src, acc.count * sizeof(uint32_t));
+            } else {
+                for (size_t i = 0; i < acc.count; ++i) {
+                    out[i] = readIndex(src + i * stride, acc.componentType);
+                }
+            }
+        }
+
+        return applySparse(acc, error, [&](size_t index, const uint8_t* value) {
+            out[index] = readIndex(value, acc.componentType);
+        });
+    }
+
+    // True when every element of a non-sparse accessor lies inside its bufferView
+    bool validateAccessor(int accessorIndex, std::string& error) const {
+        const GLTFAccessor* acc = accessor(accessorIndex, error);
+        if (!acc) return false;
+        if (acc->bufferView < 0 || acc->sparse.count > 0) {
+            error = "accessor " + std::to_string(accessorIndex) + " has no plain bufferView data";
+            return false;
+        }
+        const uint8_t* src;
+        size_t stride;
+        return elementRange(*acc, src, stride, error);
+    }
+
+    // The accessor at index, or null with error set when out of range
+    const GLTFAccessor* accessor(int index, std::string& error) const {
+        if (index < 0 || index >= (int)accessors.size()) {
+            error = "accessor index " + std::to_string(index) + " out of range";
+            return nullptr;
+        }
+        return &accessors[index];
+    }
+
+private:
+    static glm::mat4 parseNodeMatrix(const JsonValue& node) {
+        const JsonValue& m = node["matrix"];
+        if (m.size() == 16) {
+            float values[16];
+            for (size_t i = 0; i < 16; ++i) values[i] = m[i].asFloat();
+            return glm::make_mat4(values);  // glTF matrices are column-major like glm
+        }
+
+        glm::mat4 result(1.0f);
+        const JsonValue& t = node["translation"];
+        if (t.size() == 3) {
+            result = glm::translate(result, glm::vec3(t[0].asFloat(), t[1].asFloat(), t[2].asFloat()));
+        }
+        const JsonValue& r = node["rotation"];
+        if (r.size() == 4) {
+            glm::quat q(r[3].asFloat(1.0f), r[0].asFloat(), r[1].asFloat(), r[2].asFloat());
+            result *= glm::mat4_cast(q);
+        }
+        const JsonValue& s = node["scale"];
+        if (s.size() == 3) {
+            result = glm::scale(result, glm::vec3(s[0].asFloat(1.0f), s[1].asFloat(1.0f), s[2].asFloat(1.0f)));
+        }
+        return result;
+    }
+
+    // Validates that every element of the accessor lies inside its bufferView
+    bool elementRange(const GLTFAccessor& acc, const uint8_t*& src, size_t& stride, std::string& error) const {
+        if (acc.bufferView >= (int)bufferViews.size()) {
+            error = "accessor references missing bufferView " + std::to_string(acc.bufferView);
+            return false;
+        }
+        const GLTFBufferView& view = bufferViews[acc.bufferView];
+        size_t elementSize = componentSize(acc.componentType) * acc.components;
+        stride = view.byteStride ? view.byteStride : elementSize;
+
+        if (acc.count > 0 && acc.byteOffset + stride * (acc.count - 1) + elementSize > view.byteLength) {
+            error = "accessor data exceeds bufferView " + std::to_string(acc.bufferView);
+            return false;
+        }
+        src = bin + view.byteOffset + acc.byteOffset;
+        return true;
+    }
+
+    template <typename WriteFn>
+    bool applySparse(const GLTFAccessor& acc, std::string& error, WriteFn write) const {
+        const GLTFSparse& sparse = acc.sparse;
+        if (sparse.count == 0) return true;
+
+        if (sparse.indicesBufferView < 0 || sparse.indicesBufferView >= (int)bufferViews.size() ||
+            sparse.valuesBufferView < 0 || sparse.valuesBufferView >= (int)bufferViews.size()) {
+            error = "sparse accessor references a missing bufferView";
+            return false;
+        }
+
+        const GLTFBufferView& indexView = bufferViews[sparse.indicesBufferView];
+        const GLTFBufferView& valueView = bufferViews[sparse.valuesBufferView];
+        size_t indexSize = componentSize(sparse.indicesComponentType);
+        size_t valueSize = componentSize(acc.componentType) * acc.components;
+
+        if (indexSize == 0 ||
+            sparse.indicesByteOffset + sparse.count * indexSize > indexView.byteLength ||
+            sparse.valuesByteOffset + sparse.count * valueSize > valueView.byteLength) {
+            error = "sparse accessor data exceeds its bufferView";
+            return false;
+        }
+
+        const uint8_t* indices = bin + indexView.byteOffset + sparse.indicesByteOffset;
+        const uint8_t* values = bin + valueView.byteOffset + sparse.valuesByteOffset;
+        for (size_t i = 0; i < sparse.count; ++i) {
+            uint32_t target = readIndex(indices + i * indexSize, sparse.indicesComponentType);
+            if (target >= acc.count) {
+                error = "sparse accessor index out of range";
+                return false;
+            }
+            write(target, values + i * valueSize);
+        }
+        return true;
+    }
+
+    static uint32_t readIndex(const uint8_t* p, int componentType) {
+        switch (componentType) {
+            case GLTF_UNSIGNED_BYTE: return p[0];
+            case GLTF_UNSIGNED_SHORT: { uint16_t v; std::memcpy(&v, p, 2); return v; }
+            default: { uint32_t v; std::memcpy(&v, p, 4); return v; }
+        }
+    }
+
+    static float readComponent(const uint8_t* p, int componentType, bool normalized) {
+        switch (componentType) {
+            case GLTF_FLOAT: { float v; std::memcpy(&v, p, 4); return v; }
+            case GLTF_UNSIGNED_BYTE: return normalized ? p[0] / 255.0f : (float)p[0];
+            case GLTF_BYTE: {
+                float v = (float)(int8_t)p[0];
+                return normalized ? glm::max(v / 127.0f, -1.0f) : v;
+            }
+            case GLTF_UNSIGNED_SHORT: {
+                uint16_t v; std::memcpy(&v, p, 2);
+                return normalized ? v / 65535.0f : (float)v;
+            }
+            case GLTF_SHORT: {
+                int16_t v; std::memcpy(&v, p, 2);
+                return normalized ? glm::max(v / 32767.0f, -1.0f) : (float)v;
+            }
+            case GLTF_UNSIGNED_INT: { uint32_t v; std::memcpy(&v, p, 4); return (float)v; }
+            default: return 0.0f;
+        }
+    }
+};
+
+// Flattened, render-ready geometry of every triangle primitive in the default
+// scene, with node transforms baked in. Image refs point into `storage`.
+struct GLTFModel {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<glm::vec4> tangents;  // provided or generated when the material has a normal map, else empty
+    std::vector<unsigned int> indices;
+
+    GLTFImageRef baseColorImage;
+    GLTFImageRef metallicRoughnessImage;
+    GLTFImageRef normalImage;
+
+    std::shared_ptr<const void> storage;  // keeps the bytes behind the image refs alive
+};
+
+class GLTFLoader {
+public:
+    static bool buildModel(const GLTFDocument& doc, GLTFModel& model, std::string& error) {
+        model.positions.clear();
+        model.normals.clear();
+        model.texCoords.clear();
+        model.tangents.clear();
+        model.indices.clear();
+
+        Builder builder{doc, model, error};
+        for (int root : doc.sceneNodes) {
+            if (!builder.visit(root, glm::mat4(1.0f), 0)) return false;
+        }
+
+        if (model.positions.empty() || model.indices.empty()) {
+            error = "model contains no triangle geometry";
+            return false;
+        }
+
+        // Normals the file provides are kept; only primitives without them are generated
+        for (const auto& range : builder.missingNormals) {
+            MeshGeometry::computeNormals(model.positions, model.indices, range.first, range.second, model.normals);
+        }
+        // Tangents are only worth generating when the material has a normal map
+        if (normalMapped(doc, builder.firstMaterial)) {
+            for (const auto& range : builder.missingTangents) {
+                MeshGeometry::computeTangents(model.positions, model.normals, model.texCoords, model.indices,
+                                              range.first, range.second, model.tangents);
+            }
+        } else if (!builder.missingTangents.empty()) {
+            model.tangents.clear();
+        }
+
+        materialImages(doc, builder.firstMaterial, model.baseColorImage,
+                       model.metallicRoughnessImage, model.normalImage);
+        return true;
+    }
+
+    static bool normalMapped(const GLTFDocument& doc, int material) {
+        return material >= 0 && material < (int)doc.materials.size() && doc.materials[material].normalTexture >= 0;
+    }
+
+    static void materialImages(const GLTFDocument& doc, int material, GLTFImageRef& baseColor,
+                               GLTFImageRef& metallicRoughness, GLTFImageRef& normal) {
+        if (material < 0 || material >= (int)doc.materials.size()) return;
+        const GLTFMaterial& mat = doc.materials[material];
+        baseColor = doc.imageRef(doc.textureImage(mat.baseColorTexture));
+        metallicRoughness = doc.imageRef(doc.textureImage(mat.metallicRoughnessTexture));
+        normal = doc.imageRef(doc.textureImage(mat.normalTexture));
+    }
+
+    // Finds the only triangle primitive instanced by the default scene.
+    // Returns false when there are none or several.
+    static bool singlePrimitive(const GLTFDocument& doc, const GLTFPrimitive*& primitive, glm::mat4& world) {
+        int found = 0;
+        primitive = nullptr;
+        for (int root : doc.sceneNodes) {
+            findPrimitives(doc, root, glm::mat4(1.0f), 0, found, primitive, world);
+        }
+        return found == 1;
+    }
+
+private:
+    static void findPrimitives(const GLTFDocument& doc, int nodeIndex, const glm::mat4& parent, int depth,
+                               int& found, const GLTFPrimitive*& primitive, glm::mat4& world) {
+        if (depth > Builder::MAX_NODE_DEPTH || found > 1) return;
+        const GLTFNode& node = doc.nodes[nodeIndex];
+        glm::mat4 nodeWorld = parent * node.matrix;
+
+        if (node.mesh >= 0 && node.mesh < (int)doc.meshes.size()) {
+            for (const GLTFPrimitive& prim : doc.meshes[node.mesh]) {
+                if (prim.mode != GLTF_MODE_TRIANGLES || prim.position < 0) continue;
+                if (++found == 1) {
+                    primitive = &prim;
+                    world = nodeWorld;
+                }
+            }
+        }
+        for (int child : node.children) {
+            findPrimitives(doc, child, nodeWorld, depth + 1, found, primitive, world);
+        }
+    }
+
+    struct Builder {
+        const GLTFDocument& doc;
+        GLTFModel& model;
+        std::string& error;
+        std::vector<std::pair<size_t, size_t>> missingNormals;   // index ranges
+        std::vector<std::pair<size_t, size_t>> missingTangents;  // index ranges
+        int firstMaterial = -1;
+
+        static constexpr int MAX_NODE_DEPTH = 64;
+
+        bool visit(int nodeIndex, const glm::mat4& parent, int depth) {
+            if (depth > MAX_NODE_DEPTH) {
+                error = "node hierarchy too deep (cycle?)";
+                return false;
+            }
+            const GLTFNode& node = doc.nodes[nodeIndex];
+            glm::mat4 world = parent * node.matrix;
+
+            if (node.mesh >= 0 && node.mesh < (int)doc.meshes.size()) {
+                for (const GLTFPrimitive& prim : doc.meshes[node.mesh]) {
+                    if (prim.mode != GLTF_MODE_TRIANGLES || prim.position < 0) continue;
+                    if (!appendPrimitive(prim, world)) return false;
+                }
+            }
+            for (int child : node.children) {
+                if (!visit(child, world, depth + 1)) return false;
+            }
+            return true;
+        }
+
+        bool appendPrimitive(const GLTFPrimitive& prim, const glm::mat4& world) {
+            const GLTFAccessor* positions = doc.accessor(prim.position, error);
+            if (!positions) return false;
+            size_t count = positions->count;
+            if (count == 0) {
+                error = "empty POSITION accessor " + std::to_string(prim.position);
+                return false;
+            }
+
+            // Every attribute is read into the POSITION-sized range, so a
+            // longer accessor would write past it
+            const int attributes[] = {prim.normal, prim.texCoord0, prim.tangent};
+            for (int attribute : attributes) {
+                if (attribute < 0) continue;
+                const GLTFAccessor* acc = doc.accessor(attribute, error);
+                if (!acc) return false;
+                if (acc->count != count) {
+                    error = "accessor " + std::to_string(attribute) + " has " + std::to_string(acc->count) +
+                            " elements, POSITION has " + std::to_string(count);
+                    return false;
+                }
+            }
+            size_t base = model.positions.size();
+
+            model.positions.resize(base + count);
+            if (!doc.readFloats(prim.position, &model.positions[base].x, 3, error)) return false;
+
+            model.normals.resize(base + count, glm::vec3(0.0f));
+            if (prim.normal >= 0 && !doc.readFloats(prim.normal, &model.normals[base].x, 3, error)) return false;
+
+            model.texCoords.resize(base + count, glm::vec2(0.0f));
+            if (prim.texCoord0 >= 0 && !doc.readFloats(prim.texCoord0, &model.texCoords[base].x, 2, error)) return false;
+
+            model.tangents.resize(base + count, glm::vec4(0.0f));
+            if (prim.tangent >= 0 && !doc.readFloats(prim.tangent, &model.tangents[base].x, 4, error)) return false;
+
+            size_t indexBase = model.indices.size();
+            if (prim.indices >= 0) {
+                const GLTFAccessor* indexAccessor = doc.accessor(prim.indices, error);
+                if (!indexAccessor) return false;
+                model.indices.resize(indexBase + indexAccessor->count);
+                if (!doc.readIndices(prim.indices, &model.indices[indexBase], error)) return false;
+                for (size_t i = indexBase; i < model.indices.size(); ++i) {
+                    if (model.indices[i] >= count) {
+                        error = "index out of range in accessor " + std::to_string(prim.indices);
+                        return false;
+                    }
+                    model.indices[i] += static_cast<unsigned int>(base);
+                }
+            } else {
+                model.indices.resize(indexBase + count);
+                for (size_t i = 0; i < count; ++i) model.indices[indexBase + i] = static_cast<unsigned int>(base + i);
+            }
+            // Drop a trailing partial triangle
+            model.indices.resize(indexBase + (model.indices.size() - indexBase) / 3 * 3);
+
+            if (world != glm::mat4(1.0f)) {
+                transformRange(world, base, base + count, prim.tangent >= 0);
+                if (glm::determinant(glm::mat3(world)) < 0.0f) {
+                    for (size_t i = indexBase; i + 2 < model.indices.size(); i += 3) {
+                        std::swap(model.indices[i + 1], model.indices[i + 2]);
+                    }
+                }
+            }
+
+            if (prim.normal < 0) missingNormals.emplace_back(indexBase, model.indices.size());
+            if (prim.tangent < 0) missingTangents.emplace_back(indexBase, model.indices.size());
+            if (firstMaterial < 0) firstMaterial = prim.material;
+            return true;
+        }
+
+        void transformRange(const glm::mat4& world, size_t begin, size_t end, bool hasTangents) {
+            glm::mat3 linear(world);
+            glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+            for (size_t i = begin; i < end; ++i) {
+                model.positions[i] = glm::vec3(world * glm::vec4(model.positions[i], 1.0f));
+                glm::vec3 n = normalMatrix * model.normals[i];
+                float len = glm::length(n);
+                model.normals[i] = len > 0.0f ? n / len : n;
+                if (hasTangents) {
+                    glm::vec3 t = linear * glm::vec3(model.tangents[i]);
+                    float tlen = glm::length(t);
+                    if (tlen > 0.0f) t /= tlen;
+                    model.tangents[i] = glm::vec4(t, model.tangents[i].w);
+                }
+            }
+        }
+    };
+};
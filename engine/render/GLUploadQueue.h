@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// Work that has to run on the thread owning the GL context, typically the
+// buffer/texture upload for an asset prepared on a worker thread. Workers
+// push tasks; the render loop calls drain() once per frame with a time
+// budget, so streaming costs at most one upload past the budget per frame.
+class GLUploadQueue {
+private:
+    std::deque<std::function<void()>> tasks;
+    mutable std::mutex mutex;
+
+    GLUploadQueue() = default;
+
+    bool popFront(std::function<void()>& task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty()) return false;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+        return true;
+    }
+
+public:
+    static GLUploadQueue& getInstance() {
+        static GLUploadQueue instance;
+        return instance;
+    }
+
+    void push(std::function<void()> task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+
+    // Runs queued tasks until budgetMs has elapsed; always runs at least one
+    // so progress is guaranteed. Returns the number of tasks executed.
+    size_t drain(double budgetMs = 2.0) {
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t executed = 0;
+        std::function<void()> task;
+        while (popFront(task)) {
+            task();
+            ++executed;
+            auto elapsed = std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - start).count();
+            if (elapsed >= budgetMs) break;
+        }
+        return executed;
+    }
+
+    // Runs everything that is queued (loading screens, shutdown)
+    size_t flush() {
+        size_t executed = 0;
+        std::function<void()> task;
+        while (popFront(task)) {
+            task();
+            ++executed;
+        }
+        return executed;
+    }
+
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return tasks.size();
+    }
+};
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "GLHandle.h"
+
+// Stream for per-frame GPU data (instance transforms; later debug lines, UI
+// vertices): one buffer cut into FRAMES regions used in turn, so the CPU
+// writes one region while the GPU still reads the others. Each frame
+// sub-allocates from its region; beginFrame() waits on the fence endFrame()
+// placed after the region's last use, which has normally long signalled.
+//
+//   PERSISTENT      glBufferStorage, mapped once, coherent, for the buffer's
+//                   life (GL 4.4 or ARB_buffer_storage, plus sync objects)
+//   UNSYNCHRONIZED  glMapBufferRange per allocation with the unsynchronized
+//                   bit; the fences replace the driver's implicit sync
+//   ORPHAN          no sync objects: writes go to a CPU copy and are sent
+//                   with glBufferSubData, the buffer orphaned every frame
+//
+// A region that runs out refuses allocations for the rest of the frame and
+// is grown at the next beginFrame(). GL thread only.
+class GPURingBuffer {
+public:
+    enum class Mode { PERSISTENT, UNSYNCHRONIZED, ORPHAN };
+
+    static constexpr size_t FRAMES = 3;
+    static constexpr size_t DEFAULT_FRAME_SIZE = 4u << 20;
+
+    // data is where to write size bytes; bind buffer and read at offset.
+    // Empty when the frame's region is full.
+    struct Allocation {
+        void* data = nullptr;
+        GLuint buffer = 0;
+        size_t offset = 0;
+        size_t size = 0;
+
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    struct Stats {
+        size_t frameBytes = 0;   // allocated this frame
+        size_t allocations = 0;  // this frame
+        size_t stalls = 0;       // beginFrame calls that had to wait for the GPU
+        size_t overflows = 0;    // allocations refused for lack of space
+    };
+
+    GPURingBuffer() = default;
+    ~GPURingBuffer() { destroy(); }
+
+    GPURingBuffer(const GPURingBuffer&) = delete;
+    GPURingBuffer& operator=(const GPURingBuffer&) = delete;
+
+    // The one stream every per-frame writer shares
+    static GPURingBuffer& getInstance() {
+        static GPURingBuffer instance;
+        return instance;
+    }
+
+    // Picks the best mode the driver has and allocates FRAMES regions of
+    // frameSize bytes. Needs a current context.
+    void create(size_t frameSize) {
+        destroy();
+        bool sync = GLEW_VERSION_3_2 || GLEW_ARB_sync;
+        if (sync && (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)) mode = Mode::PERSISTENT;
+        else if (sync && (GLEW_VERSION_3_0 || GLEW_ARB_map_buffer_range)) mode = Mode::UNSYNCHRONIZED;
+        else mode = Mode::ORPHAN;
+
+        regionSize = frameSize;
+        buffer = GLBuffer::create();
+        glBindBuffer(GL_ARRAY_BUFFER, buffer.get());
+        if (mode == Mode::PERSISTENT) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_ARRAY_BUFFER, totalSize(), nullptr, flags);
+            mapped = static_cast<uint8_t*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, totalSize(), flags));
+        } else {
+            glBufferData(GL_ARRAY_BUFFER, totalSize(), nullptr, GL_STREAM_DRAW);
+            if (mode == Mode::ORPHAN) staging.resize(totalSize());
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        // The first beginFrame() moves to region 0
+        region = FRAMES - 1;
+        cursor = regionSize;
+    }
+
+    void destroy() {
+        for (GLsync& fence : fences) {
+            if (fence) glDeleteSync(fence);
+            fence = nullptr;
+        }
+        if (mapped) {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer.get());
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            mapped = nullptr;
+        }
+        buffer.reset();
+        std::vector<uint8_t>().swap(staging);
+        regionSize = 0;
+        cursor = 0;
+    }
+
+    // Moves to the next region, waiting until the GPU is done with it.
+    // Creates the buffer on first use and grows it after an overflow.
+    void beginFrame() {
+        size_t wanted = std::max(regionSize, DEFAULT_FRAME_SIZE);
+        while (wanted < requiredSize) wanted *= 2;
+        if (!buffer || wanted > regionSize) {
+            for (size_t i = 0; i < FRAMES; ++i) waitFence(i);
+            create(wanted);
+        }
+        requiredSize = 0;
+
+        region = (region + 1) % FRAMES;
+        waitFence(region);
+        cursor = 0;
+        stats.frameBytes = 0;
+        stats.allocations = 0;
+        if (mode == Mode::ORPHAN) {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer.get());
+            glBufferData(GL_ARRAY_BUFFER, totalSize(), nullptr, GL_STREAM_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+    }
+
+    // Fences the region after the frame's draws; call before swapping
+    void endFrame() {
+        if (!buffer || mode == Mode::ORPHAN) return;
+        if (fences[region]) glDeleteSync(fences[region]);
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    // Space for size bytes, offset a multiple of alignment. Write it, then
+    // commit() it before the next allocate() and before drawing from it.
+    Allocation allocate(size_t size, size_t alignment = 16) {
+        Allocation allocation;
+        if (size == 0) return allocation;
+        size_t start = (cursor + alignment - 1) / alignment * alignment;
+        if (!buffer || start + size > regionSize) {
+            ++stats.overflows;
+            requiredSize = std::max(requiredSize, cursor) + size + alignment;
+            return allocation;
+        }
+        cursor = start + size;
+
+        allocation.buffer = buffer.get();
+        allocation.offset = region * regionSize + start;
+        allocation.size = size;
+        if (mode == Mode::PERSISTENT) {
+            allocation.data = mapped + allocation.offset;
+        } else if (mode == Mode::UNSYNCHRONIZED) {
+            glBindBuffer(GL_ARRAY_BUFFER, allocation.buffer);
+            allocation.data = glMapBufferRange(GL_ARRAY_BUFFER, allocation.offset, size,
+                                               GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        } else {
+            allocation.data = staging.data() + allocation.offset;
+        }
+        if (allocation) {
+            stats.frameBytes += size;
+            ++stats.allocations;
+        }
+        return allocation;
+    }
+
+    // Makes the written bytes visible to the GPU
+    void commit(const Allocation& allocation) {
+        if (!allocation || mode == Mode::PERSISTENT) return;
+        glBindBuffer(GL_ARRAY_BUFFER, allocation.buffer);
+        if (mode == Mode::UNSYNCHRONIZED) glUnmapBuffer(GL_ARRAY_BUFFER);
+        else glBufferSubData(GL_ARRAY_BUFFER, allocation.offset, allocation.size, allocation.data);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // allocate(), copy and commit() in one; the returned data pointer is
+    // no longer writable
+    Allocation upload(const void* data, size_t size, size_t alignment = 16) {
+        Allocation allocation = allocate(size, alignment);
+        if (!allocation) return allocation;
+        std::memcpy(allocation.data, data, size);
+        commit(allocation);
+        return allocation;
+    }
+
+    Mode getMode() const { return mode; }
+    size_t getFrameSize() const { return regionSize; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    GLBuffer buffer;
+    Mode mode = Mode::ORPHAN;
+    uint8_t* mapped = nullptr;      // PERSISTENT
+    std::vector<uint8_t> staging;   // ORPHAN
+    GLsync fences[FRAMES] = {};
+    size_t regionSize = 0;
+    size_t region = 0;
+    size_t cursor = 0;
+    size_t requiredSize = 0;        // what this frame would have needed
+    Stats stats;
+
+    size_t totalSize() const { return regionSize * FRAMES; }
+
+    void waitFence(size_t index) {
+        GLsync& fence = fences[index];
+        if (!fence) return;
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            ++stats.stalls;
+            while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+};
@@ -1,7 +1,8 @@
 #include "../render/Mesh.h"
 #include <GL/glew.h>
+#include "../assets/MeshOptimizer.h"
 
-Mesh::Mesh() : VAO(0), VBO(0), EBO(0) {}
+Mesh::Mesh() : VAO(0), VBO(0), EBO(0), vertexFormat(VERTEX_FLOAT32), indexType(GL_UNSIGNED_INT) {}
 
 Mesh::~Mesh() {
     if (VAO) glDeleteVertexArrays(1, &VAO);
@@ -13,12 +14,40 @@ void Mesh::setVertices(const std::vector<Vertex>& verts) {
     vertices = verts;
 }
 
+void Mesh::setVertices(std::vector<Vertex>&& verts) {
+    vertices = std::move(verts);
+}
+
 void Mesh::setIndices(const std::vector<unsigned int>& inds) {
     indices = inds;
     setupMesh();
 }
 
+void Mesh::setIndices(std::vector<unsigned int>&& inds) {
+    indices = std::move(inds);
+    setupMesh();
+}
+
+VertexFormat Mesh::chooseFormat(const std::vector<Vertex>& verts, const VertexTolerance& tolerance) {
+    std::vector<Vec3> positions(verts.size());
+    std::vector<Vec2> texCoords(verts.size());
+    for (size_t i = 0; i < verts.size(); i++) {
+        positions[i] = verts[i].position;
+        texCoords[i] = verts[i].texCoord;
+    }
+    return VertexPacker::chooseFormat(positions, texCoords, tolerance);
+}
+
 void Mesh::setupMesh() {
+    bounds = Bounds();
+    if (!vertices.empty()) {
+        bounds.min = bounds.max = vertices[0].position;
+        for (const Vertex& v : vertices) {
+            bounds.min = glm::min(bounds.min, v.position);
+            bounds.max = glm::max(bounds.max, v.position);
+        }
+    }
+
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
@@ -26,25 +55,39 @@ void Mesh::setupMesh() {
     glBindVertexArray(VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+    if (vertexFormat == VERTEX_FLOAT32) {
+        quantization = VertexQuantization();
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+    } else {
+        std::vector<Vec3> positions(vertices.size()), normals(vertices.size());
+        std::vector<Vec2> texCoords(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            positions[i] = vertices[i].position;
+            normals[i] = vertices[i].normal;
+            texCoords[i] = vertices[i].texCoord;
+        }
+        std::vector<uint8_t> packed;
+        VertexPacker::pack(vertexFormat, positions, normals, texCoords, packed, quantization);
+        glBufferData(GL_ARRAY_BUFFER, packed.size(), packed.data(), GL_STATIC_DRAW);
+    }
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+    if (MeshOptimizer::fitsShortIndices(vertices.size())) {
+        std::vector<uint16_t> shortIndices = MeshOptimizer::toShortIndices(indices);
+        indexType = GL_UNSIGNED_SHORT;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+    } else {
+        indexType = GL_UNSIGNED_INT;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    }
 
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));
+    VertexPacker::setupAttributes(vertexFormat);
 
     glBindVertexArray(0);
 }
 
 void Mesh::render() const {
     glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, indices.size(), indexType, 0);
     glBindVertexArray(0);
 }
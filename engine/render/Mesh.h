@@ -3,6 +3,8 @@
 #include <vector>
 #include <memory>
 #include "../math/MathTypes.h"
+#include "VertexFormat.h"
+#include "Frustum.h"
 
 struct Vertex {
     Vec3 position;
@@ -15,17 +17,32 @@ private:
     unsigned int VAO, VBO, EBO;
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
+    VertexFormat vertexFormat;
+    VertexQuantization quantization;
+    GLenum indexType;  // GL_UNSIGNED_SHORT when every vertex fits
+    Bounds bounds;     // object space, set by setupMesh()
 
 public:
     Mesh();
     ~Mesh();
 
     void setVertices(const std::vector<Vertex>& verts);
+    void setVertices(std::vector<Vertex>&& verts);
     void setIndices(const std::vector<unsigned int>& inds);
+    void setIndices(std::vector<unsigned int>&& inds);
     void setupMesh();
 
+    // GPU layout used by setupMesh(); the CPU-side vertices stay float
+    void setVertexFormat(VertexFormat format) { vertexFormat = format; }
+    VertexFormat getVertexFormat() const { return vertexFormat; }
+    const VertexQuantization& getQuantization() const { return quantization; }
+    static VertexFormat chooseFormat(const std::vector<Vertex>& verts,
+                                     const VertexTolerance& tolerance = VertexTolerance());
+
     void render() const;
 
+    const Bounds& getBounds() const { return bounds; }
+
     const std::vector<Vertex>& getVertices() const { return vertices; }
     const std::vector<unsigned int>& getIndices() const { return indices; }
 };
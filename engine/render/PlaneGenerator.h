@@ -3,6 +3,8 @@
 #include <vector>
 #include <glm/glm.hpp>
 
+#include "../assets/MeshOptimizer.h"
+
 struct Vertex {
     glm::vec3 position;
     glm::vec3 color;
@@ -40,7 +42,8 @@ public:
         return vertices;
     }
     
-    static std::vector<unsigned int> generatePlaneIndices(int subdivisions = 10) {
+    // Row-by-row grid triangles, reordered for the vertex cache unless optimize is false
+    static std::vector<unsigned int> generatePlaneIndices(int subdivisions = 10, bool optimize = true) {
         std::vector<unsigned int> indices;
         
         int verticesPerRow = subdivisions + 1;
@@ -65,6 +68,7 @@ public:
             }
         }
         
+        if (optimize) MeshOptimizer::optimizeVertexCache(indices, (size_t)verticesPerRow * verticesPerRow);
         return indices;
     }
 };
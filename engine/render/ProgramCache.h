@@ -0,0 +1,312 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "../assets/CookedAsset.h"
+#include "../assets/ResourceRegistry.h"
+#include "ShaderReflection.h"
+
+// Sources of one vertex + fragment program. Each stage is a list of strings
+// handed to glShaderSource as they are; defines ("NAME" or "NAME value")
+// are inserted right after the stage's #version line.
+struct ProgramSource {
+    std::string name;  // for log messages
+    std::vector<std::string> vertex;
+    std::vector<std::string> fragment;
+    std::vector<std::string> defines;
+    std::vector<std::pair<GLuint, std::string>> attributes;  // bound before linking
+};
+
+// A program whose compile and link were issued but not yet checked
+struct PendingProgram {
+    std::string name;
+    uint64_t key = 0;
+    GLuint program = 0;
+    GLuint vertexShader = 0;
+    GLuint fragmentShader = 0;
+    bool fromCache = false;
+};
+
+// On-disk header of a cached program binary
+struct ProgramBinaryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;  // as returned by glGetProgramBinary
+    uint32_t size;
+};
+
+static constexpr uint32_t PROGRAM_BINARY_MAGIC = 0x47525048;  // "HPRG"
+static constexpr uint32_t PROGRAM_BINARY_VERSION = 1;
+
+// Linked programs saved with glGetProgramBinary and reloaded with
+// glProgramBinary, so only the first run on a machine pays for compiling.
+// Entries are keyed by the final sources, defines, attribute bindings and the
+// driver's vendor/renderer/version strings; a binary the driver refuses
+// (after an update it did not announce in its version string) is deleted
+// and the program compiled again.
+//
+// begin() only issues work; finish() checks it. Beginning every program
+// before finishing any lets drivers with KHR_parallel_shader_compile build
+// them on their own threads. GL thread only.
+class ProgramCache {
+public:
+    struct Stats {
+        size_t loaded = 0;    // programs read from the cache
+        size_t compiled = 0;  // programs built from source
+        size_t rejected = 0;  // cached binaries the driver refused
+    };
+
+    static ProgramCache& getInstance() {
+        static ProgramCache instance;
+        return instance;
+    }
+
+    void setDirectory(const std::string& path) { directory = path; }
+
+    PendingProgram begin(const ProgramSource& source) {
+        initialize();
+        std::vector<std::string> vertex = withDefines(source.vertex, source.defines);
+        std::vector<std::string> fragment = withDefines(source.fragment, source.defines);
+
+        PendingProgram pending;
+        pending.name = source.name;
+        pending.key = programKey(vertex, fragment, source.attributes);
+        pending.program = glCreateProgram();
+        if (loadBinary(pending.key, pending.program)) {
+            pending.fromCache = true;
+            ++counters.loaded;
+            return pending;
+        }
+
+        pending.vertexShader = compileStage(GL_VERTEX_SHADER, vertex);
+        pending.fragmentShader = compileStage(GL_FRAGMENT_SHADER, fragment);
+        glAttachShader(pending.program, pending.vertexShader);
+        glAttachShader(pending.program, pending.fragmentShader);
+        for (const auto& attribute : source.attributes) {
+            glBindAttribLocation(pending.program, attribute.first, attribute.second.c_str());
+        }
+        if (binarySupported) glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(pending.program);
+        ++counters.compiled;
+        return pending;
+    }
+
+    // Whether finish() would return without waiting on the driver
+    bool isReady(const PendingProgram& pending) const {
+        if (!parallelCompile || pending.fromCache || !pending.program) return true;
+        GLint done = GL_TRUE;
+        glGetProgramiv(pending.program, GL_COMPLETION_STATUS_KHR, &done);
+        return done == GL_TRUE;
+    }
+
+    // The linked program (owned by the caller), or 0 with the compile or link
+    // log in error. Its uniforms and attributes are reflected here, so the
+    // caller should ShaderReflection::forget() it when deleting it.
+    GLuint finish(PendingProgram& pending, std::string& error) {
+        GLuint program = pending.program;
+        GLuint shaders[] = {pending.vertexShader, pending.fragmentShader};
+        bool fromCache = pending.fromCache;
+        uint64_t key = pending.key;
+        std::string name = pending.name;
+        pending = PendingProgram();
+        if (!program) {
+            error = name + ": nothing to finish";
+            return 0;
+        }
+        if (fromCache) {
+            ShaderReflection::getInstance().reflect(program);
+            return program;
+        }
+
+        GLint success = GL_FALSE;
+        std::string failure;
+        const char* stageNames[] = {"vertex", "fragment"};
+        for (int stage = 0; stage < 2 && failure.empty(); ++stage) {
+            glGetShaderiv(shaders[stage], GL_COMPILE_STATUS, &success);
+            if (!success) failure = name + " " + stageNames[stage] + " shader: " + infoLog(shaders[stage], false);
+        }
+        if (failure.empty()) {
+            glGetProgramiv(program, GL_LINK_STATUS, &success);
+            if (!success) failure = name + " link: " + infoLog(program, true);
+        }
+
+        for (GLuint shader : shaders) {
+            glDetachShader(program, shader);
+            glDeleteShader(shader);
+        }
+        if (!failure.empty()) {
+            error = failure;
+            glDeleteProgram(program);
+            return 0;
+        }
+        storeBinary(key, program);
+        ShaderReflection::getInstance().reflect(program);
+        return program;
+    }
+
+    GLuint build(const ProgramSource& source, std::string& error) {
+        PendingProgram pending = begin(source);
+        return finish(pending, error);
+    }
+
+    Stats stats() const { return counters; }
+
+private:
+    std::string directory = "cache/shaders";
+    bool initialized = false;
+    bool binarySupported = false;
+    bool parallelCompile = false;
+    uint64_t driverHash = 0;
+    Stats counters;
+
+    ProgramCache() = default;
+
+    // Needs a current context, hence done on first use
+    void initialize() {
+        if (initialized) return;
+        initialized = true;
+
+        GLint formats = 0;
+        if (GLEW_ARB_get_program_binary) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        binarySupported = formats > 0;
+
+        if (GLEW_KHR_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);  // as many as the driver likes
+            parallelCompile = true;
+        } else if (GLEW_ARB_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+            parallelCompile = true;
+        }
+
+        std::string driver;
+        for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+            const GLubyte* value = glGetString(name);
+            driver += value ? reinterpret_cast<const char*>(value) : "";
+            driver += '\n';
+        }
+        driverHash = ContentHash::hash(driver);
+    }
+
+    static std::vector<std::string> withDefines(const std::vector<std::string>& stage,
+                                                const std::vector<std::string>& defines) {
+        if (defines.empty()) return stage;
+        std::string block;
+        for (const std::string& define : defines) block += "#define " + define + "\n";
+
+        // #version has to stay the first directive
+        std::vector<std::string> out = stage;
+        if (!out.empty()) {
+            std::string& first = out.front();
+            size_t version = first.find("#version");
+            if (version != std::string::npos && first.find_first_not_of(" \t\r\n") == version) {
+                size_t lineEnd = first.find('\n', version);
+                if (lineEnd == std::string::npos) {
+                    first += '\n';
+                    lineEnd = first.size() - 1;
+                }
+                first.insert(lineEnd + 1, block);
+                return out;
+            }
+        }
+        out.insert(out.begin(), block);
+        return out;
+    }
+
+    uint64_t programKey(const std::vector<std::string>& vertex, const std::vector<std::string>& fragment,
+                        const std::vector<std::pair<GLuint, std::string>>& attributes) const {
+        uint64_t key = driverHash;
+        for (const std::string& part : vertex) key = ContentHash::combine(key, ContentHash::hash(part, 1));
+        for (const std::string& part : fragment) key = ContentHash::combine(key, ContentHash::hash(part, 2));
+        for (const auto& attribute : attributes) {
+            key = ContentHash::combine(key, ContentHash::hash(attribute.second, 3 + attribute.first));
+        }
+        return key;
+    }
+
+    static GLuint compileStage(GLenum type, const std::vector<std::string>& parts) {
+        std::vector<const char*> strings;
+        for (const std::string& part : parts) strings.push_back(part.c_str());
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, (GLsizei)strings.size(), strings.data(), nullptr);
+        glCompileShader(shader);
+        return shader;
+    }
+
+    static std::string infoLog(GLuint object, bool isProgram) {
+        GLint length = 0;
+        if (isProgram) glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length);
+        else glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+        if (length <= 1) return "(no log)";
+        std::string log((size_t)length, '\0');
+        if (isProgram) glGetProgramInfoLog(object, length, nullptr, &log[0]);
+        else glGetShaderInfoLog(object, length, nullptr, &log[0]);
+        log.resize(std::strlen(log.c_str()));
+        return log;
+    }
+
+    std::string binaryPath(uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return directory + "/" + name;
+    }
+
+    bool loadBinary(uint64_t key, GLuint program) {
+        if (!binarySupported) return false;
+        std::string path = binaryPath(key);
+        {
+            MappedFile file;
+            if (!file.open(path)) return false;
+
+            ProgramBinaryHeader header = {};
+            if (file.size() >= sizeof(header)) std::memcpy(&header, file.data(), sizeof(header));
+            if (header.magic == PROGRAM_BINARY_MAGIC && header.version == PROGRAM_BINARY_VERSION &&
+                header.key == key && header.size == file.size() - sizeof(header)) {
+                glProgramBinary(program, header.format, file.data() + sizeof(header), (GLsizei)header.size);
+                GLint success = GL_FALSE;
+                glGetProgramiv(program, GL_LINK_STATUS, &success);
+                if (success) return true;
+            }
+        }
+
+        // Stale or corrupt; the recompile writes a fresh one
+        ++counters.rejected;
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return false;
+    }
+
+    void storeBinary(uint64_t key, GLuint program) {
+        if (!binarySupported) return;
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+
+        std::vector<uint8_t> out(sizeof(ProgramBinaryHeader) + (size_t)length);
+        GLsizei written = 0;
+        GLenum format = 0;
+        glGetProgramBinary(program, length, &written, &format, out.data() + sizeof(ProgramBinaryHeader));
+        if (written <= 0) return;
+        out.resize(sizeof(ProgramBinaryHeader) + (size_t)written);
+
+        ProgramBinaryHeader header = {};
+        header.magic = PROGRAM_BINARY_MAGIC;
+        header.version = PROGRAM_BINARY_VERSION;
+        header.key = key;
+        header.format = format;
+        header.size = (uint32_t)written;
+        std::memcpy(out.data(), &header, sizeof(header));
+
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        std::string error;
+        CookedAsset::write(binaryPath(key), out, error);  // a failed write only costs the next startup
+    }
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Passes in draw order; blended geometry goes last, over the solid scene
+enum class RenderPass : uint8_t {
+    SOLID = 0,
+    TRANSLUCENT = 1
+};
+
+// 64-bit draw keys: sorting them groups commands by the state they need.
+// Solid commands sort by state first and then front to back; translucent
+// ones back to front first, with state only breaking ties.
+//
+//   SOLID        pass:2 | shader:12 | material:12 | instance:12 | mesh:12 | depth:14
+//   TRANSLUCENT  pass:2 | ~depth:14 | shader:12 | material:12 | instance:12 | mesh:12
+//
+// State ids are small per-frame numbers; ids past 12 bits wrap, which only
+// costs grouping, never correctness.
+struct RenderSortKey {
+    static constexpr int STATE_BITS = 12;
+    static constexpr int DEPTH_BITS = 14;
+    static constexpr uint64_t STATE_MASK = (1ull << STATE_BITS) - 1;
+    static constexpr uint64_t DEPTH_MAX = (1ull << DEPTH_BITS) - 1;
+
+    // depth is 0 at the near plane and 1 at the far plane
+    static uint64_t make(RenderPass pass, uint32_t shader, uint32_t material, uint32_t instance,
+                         uint32_t mesh, float depth) {
+        uint64_t quantized = (uint64_t)(std::min(std::max(depth, 0.0f), 1.0f) * DEPTH_MAX);
+        uint64_t state = ((shader & STATE_MASK) << (3 * STATE_BITS)) | ((material & STATE_MASK) << (2 * STATE_BITS)) |
+                         ((instance & STATE_MASK) << STATE_BITS) | (mesh & STATE_MASK);
+        uint64_t key = (uint64_t)pass << 62;
+        if (pass == RenderPass::TRANSLUCENT) return key | ((DEPTH_MAX - quantized) << (4 * STATE_BITS)) | state;
+        return key | (state << DEPTH_BITS) | quantized;
+    }
+
+    static RenderPass pass(uint64_t key) { return (RenderPass)(key >> 62); }
+};
+
+// Commands of one frame as (key, command index) pairs, sorted with an LSD
+// radix sort over 8-bit digits. Digits every key shares are skipped, so a
+// frame that uses few states only pays for the bytes that differ.
+class RenderQueue {
+public:
+    struct Entry {
+        uint64_t key;
+        uint32_t command;
+    };
+
+    void clear() { entries.clear(); }
+    void reserve(size_t count) { entries.reserve(count); }
+    void push(uint64_t key, uint32_t command) { entries.push_back({key, command}); }
+
+    size_t size() const { return entries.size(); }
+    const std::vector<Entry>& getEntries() const { return entries; }
+
+    // Stable, so equal keys keep submission order
+    void sort() {
+        size_t count = entries.size();
+        if (count < 2) return;
+
+        uint32_t histograms[8][256];
+        std::memset(histograms, 0, sizeof(histograms));
+        for (const Entry& entry : entries) {
+            for (int digit = 0; digit < 8; ++digit) ++histograms[digit][(entry.key >> (digit * 8)) & 0xFF];
+        }
+
+        scratch.resize(count);
+        for (int digit = 0; digit < 8; ++digit) {
+            uint32_t* histogram = histograms[digit];
+            if (histogram[(entries[0].key >> (digit * 8)) & 0xFF] == count) continue;
+
+            uint32_t offset = 0;
+            for (int bucket = 0; bucket < 256; ++bucket) {
+                uint32_t bucketCount = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += bucketCount;
+            }
+            for (const Entry& entry : entries) scratch[histogram[(entry.key >> (digit * 8)) & 0xFF]++] = entry;
+            entries.swap(scratch);
+        }
+    }
+
+private:
+    std::vector<Entry> entries;
+    std::vector<Entry> scratch;
+};
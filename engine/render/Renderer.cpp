@@ -24,19 +24,120 @@ void Renderer::submit(MeshPtr mesh, const Mat4& transform, std::shared_ptr<Mater
 void Renderer::render() {
     if (!camera) return;
 
+    // Spheres are culled four at a time, then boxes refine the survivors
+    Frustum frustum = Frustum::fromViewProjection(camera->getViewProjectionMatrix());
+    culler.clear();
+    worldBounds.clear();
     for (const auto& cmd : commands) {
-        if (cmd.material) {
-            cmd.material->bind();
-        }
+        Bounds box = cmd.mesh ? cmd.mesh->getBounds().transformed(cmd.transform) : Bounds();
+        worldBounds.push_back(box);
+        culler.add(box.center(), box.radius());
+    }
+    visible.clear();
+    culler.cull(frustum, visible);
+
+    // Visible commands are keyed by pass, state and view depth, then sorted
+    Vec3 eye = camera->getPosition();
+    Vec3 forward = camera->getForward();
+    float depthStart = camera->getNearPlane();
+    float depthRange = std::max(camera->getFarPlane() - depthStart, 1e-3f);
+    cullStats = CullStats();
+    queue.clear();
+    for (auto& ids : stateIds) ids.clear();
+    for (uint32_t index : visible) {
+        const RenderCommand& cmd = commands[index];
+        if (!cmd.mesh || !frustum.intersectsBox(worldBounds[index])) continue;
+        ++cullStats.visible;
+        float depth = (glm::dot(worldBounds[index].center() - eye, forward) - depthStart) / depthRange;
+        queue.push(sortKey(cmd, depth), index);
+    }
+    cullStats.culled = commands.size() - cullStats.visible;
+    queue.sort();
 
-        if (cmd.mesh) {
-            cmd.mesh->render();
+    // Only what differs from the previous draw is bound
+    renderStats = RenderStats();
+    size_t materialDraws = 0;
+    const Shader* boundShader = nullptr;
+    const Material* boundMaterial = nullptr;
+    const MaterialInstance* boundInstance = nullptr;
+    const Mesh* boundMesh = nullptr;
+    bool blending = false;
+    for (const RenderQueue::Entry& entry : queue.getEntries()) {
+        const RenderCommand& cmd = commands[entry.command];
+        if (!blending && RenderSortKey::pass(entry.key) == RenderPass::TRANSLUCENT) {
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glDepthMask(GL_FALSE);
+            blending = true;
         }
 
-        if (cmd.material) {
-            cmd.material->unbind();
+        const MaterialInstance* instance = cmd.material.get();
+        std::shared_ptr<Material> material = instance ? instance->getMaterial() : nullptr;
+        ShaderPtr shader = material ? material->getShader() : nullptr;
+        if (instance) ++materialDraws;
+
+        bool shaderChanged = shader.get() != boundShader;
+        if (shaderChanged) {
+            if (shader) {
+                shader->use();
+                ++renderStats.shaderChanges;
+            }
+            boundShader = shader.get();
+        }
+        if (material.get() != boundMaterial) {
+            if (material) {
+                material->applyParameters();
+                ++renderStats.materialChanges;
+            }
+            boundMaterial = material.get();
+        }
+        if (instance != boundInstance) {
+            if (instance) {
+                instance->bindTextures();
+                ++renderStats.textureChanges;
+            } else {
+                boundInstance->unbindTextures();
+            }
+            boundInstance = instance;
+        }
+        if (cmd.mesh.get() != boundMesh || shaderChanged) {
+            if (shader) {
+                ParameterBlock& params = ShaderReflection::getInstance().parameters(shader->getProgram());
+                VertexPacker::applyQuantization(params, cmd.mesh->getQuantization());
+                params.apply();
+            }
+            if (cmd.mesh.get() != boundMesh) ++renderStats.meshChanges;
+            boundMesh = cmd.mesh.get();
         }
+
+        cmd.mesh->render();
+        ++renderStats.draws;
+    }
+
+    if (boundInstance) boundInstance->unbind();
+    if (blending) {
+        glDepthMask(GL_TRUE);
+        glDisable(GL_BLEND);
     }
+    renderStats.avoided = materialDraws * 3 - renderStats.shaderChanges - renderStats.materialChanges -
+                          renderStats.textureChanges;
+}
+
+// Solid draws group by state, then front to back; translucent ones go
+// back to front
+uint64_t Renderer::sortKey(const RenderCommand& cmd, float depth) {
+    const MaterialInstance* instance = cmd.material.get();
+    std::shared_ptr<Material> material = instance ? instance->getMaterial() : nullptr;
+    ShaderPtr shader = material ? material->getShader() : nullptr;
+    RenderPass pass = material && material->isTranslucent() ? RenderPass::TRANSLUCENT : RenderPass::SOLID;
+    return RenderSortKey::make(pass, stateId(stateIds[0], shader.get()), stateId(stateIds[1], material.get()),
+                               stateId(stateIds[2], instance), stateId(stateIds[3], cmd.mesh.get()), depth);
+}
+
+// Numbers state objects in the order the frame first uses them; null is 0
+uint32_t Renderer::stateId(std::unordered_map<const void*, uint32_t>& ids, const void* state) {
+    if (!state) return 0;
+    return ids.emplace(state, (uint32_t)ids.size() + 1).first->second;
 }
 
 void Renderer::clear() {
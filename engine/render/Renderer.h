@@ -4,8 +4,11 @@
 #include "Mesh.h"
 #include "Shader.h"
 #include "Camera.h"
+#include "Frustum.h"
+#include "RenderQueue.h"
 #include "materials/MaterialInstance.h"
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 struct RenderCommand {
@@ -14,14 +17,41 @@ struct RenderCommand {
     std::shared_ptr<MaterialInstance> material;
 };
 
+// State changes made by the last render(). avoided counts the shader,
+// material and texture binds that replaying commands in submission order,
+// rebinding everything per draw, would have added.
+struct RenderStats {
+    size_t draws = 0;
+    size_t shaderChanges = 0;
+    size_t materialChanges = 0;
+    size_t textureChanges = 0;
+    size_t meshChanges = 0;
+    size_t avoided = 0;
+};
+
 class Renderer {
 private:
     static Renderer* instance;
     CameraPtr camera;
     std::vector<RenderCommand> commands;
 
+    // Culling scratch, reused across frames
+    FrustumCuller culler;
+    std::vector<Bounds> worldBounds;
+    std::vector<uint32_t> visible;
+    CullStats cullStats;
+
+    // Sorting scratch: visible commands keyed by pass, state and depth, and
+    // the per-frame ids their state objects got
+    RenderQueue queue;
+    std::unordered_map<const void*, uint32_t> stateIds[4];  // shader, material, instance, mesh
+    RenderStats renderStats;
+
     Renderer();
 
+    uint64_t sortKey(const RenderCommand& cmd, float depth);
+    static uint32_t stateId(std::unordered_map<const void*, uint32_t>& ids, const void* state);
+
 public:
     ~Renderer();
     static Renderer& getInstance();
@@ -34,4 +64,8 @@ public:
     void clear();
 
     CameraPtr getCamera() const { return camera; }
+
+    // Commands drawn and frustum-culled by the last render()
+    CullStats getCullStats() const { return cullStats; }
+    RenderStats getRenderStats() const { return renderStats; }
 };
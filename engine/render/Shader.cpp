@@ -1,42 +1,50 @@
 #include "../render/Shader.h"
-#include "../core/FileSystem.h"
+#include "../render/ShaderLibrary.h"
 #include "../core/Logger.h"
 #include <GL/glew.h>
 #include <glm/gtc/type_ptr.hpp>
 
-Shader::Shader() : program(0), vertexShader(0), fragmentShader(0) {}
+Shader::Shader() : program(0) {}
 
 Shader::~Shader() {
-    if (program) glDeleteProgram(program);
-    if (vertexShader) glDeleteShader(vertexShader);
-    if (fragmentShader) glDeleteShader(fragmentShader);
+    release();
 }
 
-bool Shader::loadFromFiles(const std::string& vertexPath, const std::string& fragmentPath) {
-    std::string vertexCode = FileSystem::readTextFile(vertexPath);
-    std::string fragmentCode = FileSystem::readTextFile(fragmentPath);
-    return loadFromStrings(vertexCode, fragmentCode);
+void Shader::release() {
+    if (!program) return;
+    ShaderReflection::getInstance().forget(program);
+    glDeleteProgram(program);
+    program = 0;
 }
 
-bool Shader::loadFromStrings(const std::string& vertexCode, const std::string& fragmentCode) {
-    vertexShader = compileShader(vertexCode, GL_VERTEX_SHADER);
-    if (!vertexShader) {
-        LOG_ERROR("Failed to compile vertex shader");
+bool Shader::loadFromFiles(const std::string& vertexPath, const std::string& fragmentPath) {
+    // Shader files may #include others (see ShaderPreprocessor)
+    std::vector<std::string> files;
+    std::string vertexCode, fragmentCode, error;
+    if (!ShaderPreprocessor::load(vertexPath, vertexCode, files, error) ||
+        !ShaderPreprocessor::load(fragmentPath, fragmentCode, files, error)) {
+        LOG_ERROR("Failed to read shader: " + error);
         return false;
     }
+    return loadFromStrings(vertexCode, fragmentCode);
+}
 
-    fragmentShader = compileShader(fragmentCode, GL_FRAGMENT_SHADER);
-    if (!fragmentShader) {
-        LOG_ERROR("Failed to compile fragment shader");
-        glDeleteShader(vertexShader);
+bool Shader::loadFromStrings(const std::string& vertexCode, const std::string& fragmentCode) {
+    // Linked programs come from the binary cache after the first run
+    ProgramSource source;
+    source.name = "shader";
+    source.vertex = {vertexCode};
+    source.fragment = {fragmentCode};
+
+    std::string error;
+    unsigned int linked = ProgramCache::getInstance().build(source, error);
+    if (!linked) {
+        LOG_ERROR("Shader program failed: " + error);
         return false;
     }
 
-    program = glCreateProgram();
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    linkProgram();
-
+    release();
+    program = linked;
     return true;
 }
 
@@ -44,63 +52,61 @@ void Shader::use() const {
     glUseProgram(program);
 }
 
-unsigned int Shader::compileShader(const std::string& code, unsigned int type) {
-    unsigned int shader = glCreateShader(type);
-    const char* codePtr = code.c_str();
-    glShaderSource(shader, 1, &codePtr, nullptr);
-    glCompileShader(shader);
-
-    int success;
-    char infoLog[512];
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-        LOG_ERROR("Shader compilation failed: " + std::string(infoLog));
-        glDeleteShader(shader);
-        return 0;
-    }
+// Setters go through the program's parameter block: locations come from the
+// table reflected at link, and values the program already holds are not
+// uploaded again. The program must be bound.
+template <typename T>
+void Shader::set(UniformId id, const T& value) const {
+    if (!program) return;
+    ParameterBlock& params = ShaderReflection::getInstance().parameters(program);
+    params.set(id, value);
+    params.apply();
+}
 
-    return shader;
+void Shader::setMat4(UniformId id, const Mat4& value) const {
+    set(id, value);
 }
 
-void Shader::linkProgram() {
-    glLinkProgram(program);
+void Shader::setMat3(UniformId id, const Mat3& value) const {
+    set(id, value);
+}
 
-    int success;
-    char infoLog[512];
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(program, 512, nullptr, infoLog);
-        LOG_ERROR("Shader linking failed: " + std::string(infoLog));
-    }
+void Shader::setVec3(UniformId id, const Vec3& value) const {
+    set(id, value);
+}
+
+void Shader::setVec4(UniformId id, const Vec4& value) const {
+    set(id, value);
+}
+
+void Shader::setFloat(UniformId id, float value) const {
+    set(id, value);
+}
+
+void Shader::setInt(UniformId id, int value) const {
+    set(id, value);
 }
 
 void Shader::setMat4(const std::string& name, const Mat4& value) const {
-    GLint loc = glGetUniformLocation(program, name.c_str());
-    glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value));
+    setMat4(UniformNames::id(name), value);
 }
 
 void Shader::setMat3(const std::string& name, const Mat3& value) const {
-    GLint loc = glGetUniformLocation(program, name.c_str());
-    glUniformMatrix3fv(loc, 1, GL_FALSE, glm::value_ptr(value));
+    setMat3(UniformNames::id(name), value);
 }
 
 void Shader::setVec3(const std::string& name, const Vec3& value) const {
-    GLint loc = glGetUniformLocation(program, name.c_str());
-    glUniform3fv(loc, 1, glm::value_ptr(value));
+    setVec3(UniformNames::id(name), value);
 }
 
 void Shader::setVec4(const std::string& name, const Vec4& value) const {
-    GLint loc = glGetUniformLocation(program, name.c_str());
-    glUniform4fv(loc, 1, glm::value_ptr(value));
+    setVec4(UniformNames::id(name), value);
 }
 
 void Shader::setFloat(const std::string& name, float value) const {
-    GLint loc = glGetUniformLocation(program, name.c_str());
-    glUniform1f(loc, value);
+    setFloat(UniformNames::id(name), value);
 }
 
 void Shader::setInt(const std::string& name, int value) const {
-    GLint loc = glGetUniformLocation(program, name.c_str());
-    glUniform1i(loc, value);
+    setInt(UniformNames::id(name), value);
 }
@@ -1,14 +1,20 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <memory>
 #include "../math/MathTypes.h"
 
+using UniformId = uint32_t;  // see ShaderReflection.h
+
 class Shader {
 private:
     unsigned int program;
-    unsigned int vertexShader;
-    unsigned int fragmentShader;
+
+    void release();
+
+    template <typename T>
+    void set(UniformId id, const T& value) const;
 
 public:
     Shader();
@@ -20,16 +26,21 @@ public:
     void use() const;
     unsigned int getProgram() const { return program; }
 
+    // Ids from UniformNames::id(), looked up once; the string overloads
+    // look the id up on every call
+    void setMat4(UniformId id, const Mat4& value) const;
+    void setMat3(UniformId id, const Mat3& value) const;
+    void setVec3(UniformId id, const Vec3& value) const;
+    void setVec4(UniformId id, const Vec4& value) const;
+    void setFloat(UniformId id, float value) const;
+    void setInt(UniformId id, int value) const;
+
     void setMat4(const std::string& name, const Mat4& value) const;
     void setMat3(const std::string& name, const Mat3& value) const;
     void setVec3(const std::string& name, const Vec3& value) const;
     void setVec4(const std::string& name, const Vec4& value) const;
     void setFloat(const std::string& name, float value) const;
     void setInt(const std::string& name, int value) const;
-
-private:
-    unsigned int compileShader(const std::string& code, unsigned int type);
-    void linkProgram();
 };
 
 using ShaderPtr = std::shared_ptr<Shader>;
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "ProgramCache.h"
+#include "VertexFormat.h"
+#include "../core/AssetFile.h"
+
+// Expands #include "name" in shader files. Names resolve against the
+// built-in includes first (GLSL that lives next to the C++ feeding it, such
+// as VERTEX_DEQUANTIZE_GLSL), then relative to the including file. Each file
+// is pasted once per stage however often it is included, so includes need
+// no guards. Includes are expanded whatever #if block they sit in; GLSL's own
+// preprocessor then drops the disabled ones.
+class ShaderPreprocessor {
+public:
+    // files receives every file read, for hot reload
+    static bool load(const std::string& path, std::string& source, std::vector<std::string>& files,
+                     std::string& error) {
+        source.clear();
+        std::string text;
+        if (!readFile(path, text)) {
+            error = "cannot open " + path;
+            return false;
+        }
+        std::set<std::string> included = {path};
+        files.push_back(path);
+        return expand(text, path, parentOf(path), source, files, included, error);
+    }
+
+private:
+    static const std::map<std::string, std::string>& builtins() {
+        static const std::map<std::string, std::string> includes = {
+            {"dequantize.glsl", VERTEX_DEQUANTIZE_GLSL},
+        };
+        return includes;
+    }
+
+    static bool readFile(const std::string& path, std::string& text) {
+        AssetFile file;
+        if (!file.open(path)) return false;
+        text.assign(reinterpret_cast<const char*>(file.data()), file.size());
+        text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
+        return true;
+    }
+
+    static std::string parentOf(const std::string& path) {
+        return std::filesystem::path(path).parent_path().generic_string();
+    }
+
+    static bool expand(const std::string& text, const std::string& origin, const std::string& directory,
+                       std::string& out, std::vector<std::string>& files, std::set<std::string>& included,
+                       std::string& error) {
+        size_t lineNumber = 0;
+        size_t begin = 0;
+        while (begin < text.size()) {
+            size_t end = text.find('\n', begin);
+            if (end == std::string::npos) end = text.size();
+            std::string line = text.substr(begin, end - begin);
+            begin = end + 1;
+            ++lineNumber;
+
+            size_t start = line.find_first_not_of(" \t");
+            if (start == std::string::npos || line.compare(start, 8, "#include") != 0) {
+                out += line;
+                out += '\n';
+                continue;
+            }
+
+            std::string where = origin + ":" + std::to_string(lineNumber);
+            size_t open = line.find('"', start + 8);
+            size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+            if (close == std::string::npos) {
+                error = where + ": expected #include \"file\"";
+                return false;
+            }
+            std::string name = line.substr(open + 1, close - open - 1);
+
+            auto builtin = builtins().find(name);
+            if (builtin != builtins().end()) {
+                if (included.insert("<builtin>/" + name).second &&
+                    !expand(builtin->second, name, directory, out, files, included, error)) {
+                    return false;
+                }
+                continue;
+            }
+
+            std::string path = (std::filesystem::path(directory) / name).lexically_normal().generic_string();
+            if (!included.insert(path).second) continue;
+            std::string includedText;
+            if (!readFile(path, includedText)) {
+                error = where + ": cannot open include \"" + name + "\"";
+                return false;
+            }
+            files.push_back(path);
+            if (!expand(includedText, path, parentOf(path), out, files, included, error)) return false;
+        }
+        return true;
+    }
+};
+
+// A program in the library: its files and the keywords its variants choose from
+struct ShaderProgramDesc {
+    std::string name;
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::vector<std::string> keywords;  // bit i of a variant mask defines keywords[i]
+    std::vector<std::pair<GLuint, std::string>> attributes;
+};
+
+// Shader programs kept as keyword permutations. A variant is compiled with
+// only its own keywords defined, so a disabled feature is absent from the
+// program rather than a branch in one uber-shader. Variants are built the
+// first time they are asked for, or prewarmed a few at a time by update();
+// reload() rebuilds just the variants of programs whose files changed.
+// Programs are owned by the library. GL thread only.
+class ShaderLibrary {
+public:
+    using ShaderId = size_t;
+
+    static ShaderLibrary& getInstance() {
+        static ShaderLibrary instance;
+        return instance;
+    }
+
+    ShaderId add(const ShaderProgramDesc& desc) {
+        Program program;
+        program.desc = desc;
+        programs.push_back(std::move(program));
+        return programs.size() - 1;
+    }
+
+    // Mask for a set of keywords; unknown ones are reported and left out
+    uint32_t mask(ShaderId id, const std::vector<std::string>& keywords) const {
+        const ShaderProgramDesc& desc = programs[id].desc;
+        uint32_t result = 0;
+        for (const std::string& keyword : keywords) {
+            auto it = std::find(desc.keywords.begin(), desc.keywords.end(), keyword);
+            if (it == desc.keywords.end()) {
+                std::cerr << "[ERROR] Shader " << desc.name << " has no keyword " << keyword << "\n";
+                continue;
+            }
+            result |= 1u << (it - desc.keywords.begin());
+        }
+        return result;
+    }
+
+    // The variant's program, built now if it is not yet; 0 if it does not compile
+    GLuint variant(ShaderId id, uint32_t mask) {
+        Program& program = programs[id];
+        Variant& variant = program.variants[mask];
+        if (variant.pending.program) finishVariant(program, variant);
+        if (!variant.program && !variant.failed) {
+            beginVariant(program, mask, variant);
+            finishVariant(program, variant);
+        }
+        return variant.program;
+    }
+
+    // Queues variants to be built ahead of use, so switching to them later does not stall
+    void prewarm(ShaderId id, const std::vector<uint32_t>& masks) {
+        for (uint32_t mask : masks) warmQueue.push_back({id, mask});
+    }
+
+    // Once per frame: finishes variants the driver is done with and starts
+    // the next prewarmed one
+    void update() {
+        ProgramCache& cache = ProgramCache::getInstance();
+        for (Program& program : programs) {
+            for (auto& entry : program.variants) {
+                Variant& variant = entry.second;
+                if (variant.pending.program && cache.isReady(variant.pending)) finishVariant(program, variant);
+            }
+        }
+
+        while (!warmQueue.empty()) {
+            std::pair<ShaderId, uint32_t> next = warmQueue.front();
+            warmQueue.pop_front();
+            Program& program = programs[next.first];
+            Variant& variant = program.variants[next.second];
+            if (variant.program || variant.failed || variant.pending.program) continue;
+            beginVariant(program, next.second, variant);
+            break;
+        }
+    }
+
+    // Rebuilds the variants of programs whose files changed since they were
+    // read. A variant that no longer compiles keeps its previous program.
+    // Returns the number of variants rebuilt.
+    size_t reload() {
+        size_t rebuilt = 0;
+        for (Program& program : programs) {
+            if (!program.loaded || !filesChanged(program)) continue;
+            if (!loadSources(program)) continue;
+
+            // All variants are issued before any is checked
+            for (auto& entry : program.variants) {
+                Variant& variant = entry.second;
+                if (variant.pending.program) finishVariant(program, variant);
+                variant.failed = false;
+                beginVariant(program, entry.first, variant);
+            }
+            size_t built = 0;
+            for (auto& entry : program.variants) {
+                if (finishVariant(program, entry.second)) ++built;
+            }
+            std::cout << "[OK] Reloaded shader " << program.desc.name << " (" << built << "/"
+                      << program.variants.size() << " variants)\n";
+            rebuilt += built;
+        }
+        return rebuilt;
+    }
+
+    // Deletes every program; call while the context is still current
+    void clear() {
+        for (Program& program : programs) {
+            for (auto& entry : program.variants) {
+                Variant& variant = entry.second;
+                if (variant.pending.program) finishVariant(program, variant);
+                if (variant.program) deleteProgram(variant.program);
+            }
+        }
+        programs.clear();
+        warmQueue.clear();
+    }
+
+private:
+    struct Variant {
+        GLuint program = 0;
+        PendingProgram pending;
+        bool failed = false;  // never compiled; not retried until the next reload
+    };
+
+    struct Program {
+        ShaderProgramDesc desc;
+        bool loaded = false;  // sources were read, successfully or not
+        bool sourcesValid = false;
+        std::string vertexSource;
+        std::string fragmentSource;
+        std::vector<std::pair<std::string, std::filesystem::file_time_type>> files;
+        std::map<uint32_t, Variant> variants;
+    };
+
+    std::vector<Program> programs;
+    std::deque<std::pair<ShaderId, uint32_t>> warmQueue;
+
+    ShaderLibrary() = default;
+
+    static std::filesystem::file_time_type modifiedTime(const std::string& path) {
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(path, ec);
+        return ec ? std::filesystem::file_time_type::min() : time;
+    }
+
+    // Packed files never change, and neither do files that cannot be stat'ed
+    static bool filesChanged(const Program& program) {
+        for (const auto& file : program.files) {
+            std::filesystem::file_time_type time = modifiedTime(file.first);
+            if (time != std::filesystem::file_time_type::min() && time != file.second) return true;
+        }
+        return false;
+    }
+
+    static bool loadSources(Program& program) {
+        program.loaded = true;
+        std::vector<std::string> paths;
+        std::string vertex, fragment, error;
+        bool ok = ShaderPreprocessor::load(program.desc.vertexPath, vertex, paths, error) &&
+                  ShaderPreprocessor::load(program.desc.fragmentPath, fragment, paths, error);
+
+        // Times are taken after reading, so a failed reload is retried once
+        // the files are touched again
+        program.files.clear();
+        for (const std::string& path : paths) program.files.push_back({path, modifiedTime(path)});
+        if (!ok) {
+            std::cerr << "[ERROR] Shader " << program.desc.name << ": " << error << "\n";
+            return false;
+        }
+        program.vertexSource = std::move(vertex);
+        program.fragmentSource = std::move(fragment);
+        program.sourcesValid = true;
+        return true;
+    }
+
+    static void beginVariant(Program& program, uint32_t mask, Variant& variant) {
+        if (!program.loaded) loadSources(program);
+        if (!program.sourcesValid) {
+            variant.failed = !variant.program;
+            return;
+        }
+
+        ProgramSource source;
+        source.name = program.desc.name;
+        source.vertex = {program.vertexSource};
+        source.fragment = {program.fragmentSource};
+        source.attributes = program.desc.attributes;
+        for (size_t bit = 0; bit < program.desc.keywords.size(); ++bit) {
+            if (mask & (1u << bit)) source.defines.push_back(program.desc.keywords[bit]);
+        }
+        variant.pending = ProgramCache::getInstance().begin(source);
+    }
+
+    static void deleteProgram(GLuint program) {
+        ShaderReflection::getInstance().forget(program);
+        glDeleteProgram(program);
+    }
+
+    // Swaps in the finished program; on failure the previous one stays
+    static bool finishVariant(const Program& program, Variant& variant) {
+        if (!variant.pending.program) return false;
+        std::string error;
+        GLuint built = ProgramCache::getInstance().finish(variant.pending, error);
+        if (!built) {
+            std::cerr << "[ERROR] Shader " << program.desc.name << " failed:\n" << error << "\n";
+            variant.failed = !variant.program;
+            return false;
+        }
+        if (variant.program) deleteProgram(variant.program);
+        variant.program = built;
+        return true;
+    }
+};
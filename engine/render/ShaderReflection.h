@@ -0,0 +1,315 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Process-wide ids for uniform and attribute names, so hot paths address
+// them by a small integer instead of a string. Look ids up once (e.g. into a
+// static) and keep them.
+using UniformId = uint32_t;
+
+class UniformNames {
+public:
+    static UniformId id(const std::string& name) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.ids.find(name);
+        if (it != s.ids.end()) return it->second;
+        UniformId id = (UniformId)s.names.size();
+        s.ids.emplace(name, id);
+        s.names.push_back(name);
+        return id;
+    }
+
+    static std::string name(UniformId id) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        return id < s.names.size() ? s.names[id] : std::string();
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::unordered_map<std::string, UniformId> ids;
+        std::vector<std::string> names;
+    };
+
+    static State& state() {
+        static State instance;
+        return instance;
+    }
+};
+
+// Active uniforms and attributes of a linked program, read once after link
+// into flat tables indexed through UniformId
+class ProgramInterface {
+public:
+    enum class Kind { FLOAT, INT, MATRIX, UNSUPPORTED };
+
+    struct Uniform {
+        UniformId id;
+        GLint location;
+        GLenum type;
+        GLint count;        // array elements
+        Kind kind;
+        uint32_t components;  // per element: floats, ints or matrix floats
+        uint32_t offset;      // of its value in a ParameterBlock
+    };
+
+    struct Attribute {
+        UniformId id;
+        GLint location;
+        GLenum type;
+    };
+
+    void reflect(GLuint linkedProgram) {
+        program = linkedProgram;
+        uniforms.clear();
+        attributes.clear();
+        uniformSlots.clear();
+        attributeSlots.clear();
+        storageSize = 0;
+
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<char> name((size_t)std::max(maxLength, 1));
+        for (GLint i = 0; i < count; ++i) {
+            GLsizei length = 0;
+            Uniform uniform = {};
+            glGetActiveUniform(program, (GLuint)i, (GLsizei)name.size(), &length, &uniform.count, &uniform.type, name.data());
+            std::string uniformName = baseName(std::string(name.data(), (size_t)length));
+            uniform.location = glGetUniformLocation(program, uniformName.c_str());
+            if (uniform.location < 0) continue;  // built-ins and block members
+            uniform.id = UniformNames::id(uniformName);
+            describe(uniform.type, uniform.kind, uniform.components);
+            uniform.offset = storageSize;
+            storageSize += uniform.components * (uint32_t)uniform.count * 4;
+            setSlot(uniformSlots, uniform.id, uniforms.size());
+            uniforms.push_back(uniform);
+        }
+
+        glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+        glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+        name.assign((size_t)std::max(maxLength, 1), '\0');
+        for (GLint i = 0; i < count; ++i) {
+            GLsizei length = 0;
+            GLint size = 0;
+            Attribute attribute = {};
+            glGetActiveAttrib(program, (GLuint)i, (GLsizei)name.size(), &length, &size, &attribute.type, name.data());
+            std::string attributeName(name.data(), (size_t)length);
+            attribute.location = glGetAttribLocation(program, attributeName.c_str());
+            if (attribute.location < 0) continue;  // gl_ built-ins
+            attribute.id = UniformNames::id(attributeName);
+            setSlot(attributeSlots, attribute.id, attributes.size());
+            attributes.push_back(attribute);
+        }
+    }
+
+    GLuint getProgram() const { return program; }
+    const std::vector<Uniform>& getUniforms() const { return uniforms; }
+    const std::vector<Attribute>& getAttributes() const { return attributes; }
+    uint32_t getStorageSize() const { return storageSize; }
+
+    // Null when the program has no such active uniform (e.g. compiled out of this variant)
+    const Uniform* uniform(UniformId id) const {
+        int32_t slot = id < uniformSlots.size() ? uniformSlots[id] : -1;
+        return slot >= 0 ? &uniforms[(size_t)slot] : nullptr;
+    }
+
+    GLint location(UniformId id) const {
+        const Uniform* found = uniform(id);
+        return found ? found->location : -1;
+    }
+
+    GLint attributeLocation(UniformId id) const {
+        int32_t slot = id < attributeSlots.size() ? attributeSlots[id] : -1;
+        return slot >= 0 ? attributes[(size_t)slot].location : -1;
+    }
+
+private:
+    GLuint program = 0;
+    std::vector<Uniform> uniforms;
+    std::vector<Attribute> attributes;
+    std::vector<int32_t> uniformSlots;    // UniformId -> index in uniforms, or -1
+    std::vector<int32_t> attributeSlots;  // UniformId -> index in attributes, or -1
+    uint32_t storageSize = 0;
+
+    static void setSlot(std::vector<int32_t>& slots, UniformId id, size_t index) {
+        if (slots.size() <= id) slots.resize((size_t)id + 1, -1);
+        slots[id] = (int32_t)index;
+    }
+
+    // "lights[0]" -> "lights"; arrays are addressed by their first element
+    static std::string baseName(const std::string& name) {
+        size_t bracket = name.find('[');
+        return bracket == std::string::npos ? name : name.substr(0, bracket);
+    }
+
+    static void describe(GLenum type, Kind& kind, uint32_t& components) {
+        switch (type) {
+            case GL_FLOAT: kind = Kind::FLOAT; components = 1; return;
+            case GL_FLOAT_VEC2: kind = Kind::FLOAT; components = 2; return;
+            case GL_FLOAT_VEC3: kind = Kind::FLOAT; components = 3; return;
+            case GL_FLOAT_VEC4: kind = Kind::FLOAT; components = 4; return;
+            case GL_FLOAT_MAT2: kind = Kind::MATRIX; components = 4; return;
+            case GL_FLOAT_MAT3: kind = Kind::MATRIX; components = 9; return;
+            case GL_FLOAT_MAT4: kind = Kind::MATRIX; components = 16; return;
+            case GL_INT: case GL_BOOL: kind = Kind::INT; components = 1; return;
+            case GL_INT_VEC2: case GL_BOOL_VEC2: kind = Kind::INT; components = 2; return;
+            case GL_INT_VEC3: case GL_BOOL_VEC3: kind = Kind::INT; components = 3; return;
+            case GL_INT_VEC4: case GL_BOOL_VEC4: kind = Kind::INT; components = 4; return;
+            case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+            case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW:
+                kind = Kind::INT; components = 1; return;
+            default: kind = Kind::UNSUPPORTED; components = 0; return;
+        }
+    }
+};
+
+// Shadow of one program's uniform values. set() compares against what the
+// program already holds and only marks changed uniforms dirty; apply()
+// uploads just those, with the program bound. All writes to a reflected
+// program's uniforms should go through its block, or the shadow goes stale.
+class ParameterBlock {
+public:
+    void reset(const ProgramInterface* programLayout) {
+        layout = programLayout;
+        values.assign(layout ? layout->getStorageSize() : 0, 0);
+        flags.assign(layout ? layout->getUniforms().size() : 0, 0);
+        lengths.assign(flags.size(), 0);
+        dirty.clear();
+    }
+
+    void set(UniformId id, float value) { write(id, ProgramInterface::Kind::FLOAT, &value, 1); }
+    void set(UniformId id, const glm::vec2& value) { write(id, ProgramInterface::Kind::FLOAT, &value[0], 2); }
+    void set(UniformId id, const glm::vec3& value) { write(id, ProgramInterface::Kind::FLOAT, &value[0], 3); }
+    void set(UniformId id, const glm::vec4& value) { write(id, ProgramInterface::Kind::FLOAT, &value[0], 4); }
+    void set(UniformId id, const glm::mat3& value) { write(id, ProgramInterface::Kind::MATRIX, &value[0][0], 9); }
+    void set(UniformId id, const glm::mat4& value) { write(id, ProgramInterface::Kind::MATRIX, &value[0][0], 16); }
+    void set(UniformId id, int value) { write(id, ProgramInterface::Kind::INT, &value, 1); }  // also samplers and bools
+
+    // Leading elements of an array uniform; the ones after keep their values
+    void set(UniformId id, const float* value, uint32_t count) { write(id, ProgramInterface::Kind::FLOAT, value, 1, count); }
+    void set(UniformId id, const glm::vec3* value, uint32_t count) { write(id, ProgramInterface::Kind::FLOAT, &value[0][0], 3, count); }
+    void set(UniformId id, const glm::vec4* value, uint32_t count) { write(id, ProgramInterface::Kind::FLOAT, &value[0][0], 4, count); }
+    void set(UniformId id, const glm::mat4* value, uint32_t count) { write(id, ProgramInterface::Kind::MATRIX, &value[0][0][0], 16, count); }
+
+    bool has(UniformId id) const { return layout && layout->uniform(id); }
+    bool isDirty() const { return !dirty.empty(); }
+
+    // Uploads the uniforms changed since the last apply, arrays up to the
+    // last element ever set; the program must be bound
+    void apply() {
+        for (uint32_t index : dirty) {
+            flags[index] &= ~DIRTY;
+            const ProgramInterface::Uniform& uniform = layout->getUniforms()[index];
+            const uint8_t* data = values.data() + uniform.offset;
+            GLsizei count = (GLsizei)lengths[index];
+            const GLfloat* floats = reinterpret_cast<const GLfloat*>(data);
+            const GLint* ints = reinterpret_cast<const GLint*>(data);
+            switch (uniform.type) {
+                case GL_FLOAT: glUniform1fv(uniform.location, count, floats); break;
+                case GL_FLOAT_VEC2: glUniform2fv(uniform.location, count, floats); break;
+                case GL_FLOAT_VEC3: glUniform3fv(uniform.location, count, floats); break;
+                case GL_FLOAT_VEC4: glUniform4fv(uniform.location, count, floats); break;
+                case GL_FLOAT_MAT2: glUniformMatrix2fv(uniform.location, count, GL_FALSE, floats); break;
+                case GL_FLOAT_MAT3: glUniformMatrix3fv(uniform.location, count, GL_FALSE, floats); break;
+                case GL_FLOAT_MAT4: glUniformMatrix4fv(uniform.location, count, GL_FALSE, floats); break;
+                default:
+                    if (uniform.components == 1) glUniform1iv(uniform.location, count, ints);
+                    else if (uniform.components == 2) glUniform2iv(uniform.location, count, ints);
+                    else if (uniform.components == 3) glUniform3iv(uniform.location, count, ints);
+                    else glUniform4iv(uniform.location, count, ints);
+                    break;
+            }
+        }
+        dirty.clear();
+    }
+
+private:
+    const ProgramInterface* layout = nullptr;
+    std::vector<uint8_t> values;
+    std::vector<uint8_t> flags;    // per uniform: KNOWN once a value was set, DIRTY until applied
+    std::vector<uint32_t> lengths; // per uniform: array elements set so far
+    std::vector<uint32_t> dirty;  // uniforms to upload, in the order first changed
+
+    static constexpr uint8_t KNOWN = 1;
+    static constexpr uint8_t DIRTY = 2;
+
+    // Mismatched types are ignored rather than uploaded as garbage, as are
+    // uniforms the program does not have; elements past the array are dropped
+    void write(UniformId id, ProgramInterface::Kind kind, const void* value, uint32_t components, uint32_t elements = 1) {
+        const ProgramInterface::Uniform* uniform = layout ? layout->uniform(id) : nullptr;
+        if (!uniform || uniform->kind != kind || uniform->components != components) return;
+        elements = std::min(elements, (uint32_t)uniform->count);
+        if (elements == 0) return;
+
+        uint32_t index = (uint32_t)(uniform - layout->getUniforms().data());
+        uint8_t* slot = values.data() + uniform->offset;
+        size_t size = components * elements * 4;
+        if ((flags[index] & KNOWN) && lengths[index] >= elements && std::memcmp(slot, value, size) == 0) return;
+
+        std::memcpy(slot, value, size);
+        lengths[index] = std::max(lengths[index], elements);
+        if (!(flags[index] & DIRTY)) dirty.push_back(index);
+        flags[index] = KNOWN | DIRTY;
+    }
+};
+
+// Interface and parameter block of every program in use, keyed by program
+// name. Programs built through ProgramCache are reflected when they link;
+// others on first use. Call forget() when deleting a program, since GL
+// reuses names. GL thread only.
+class ShaderReflection {
+public:
+    static ShaderReflection& getInstance() {
+        static ShaderReflection instance;
+        return instance;
+    }
+
+    const ProgramInterface& reflect(GLuint program) {
+        Entry& entry = programs[program];
+        entry.layout.reflect(program);
+        entry.parameters.reset(&entry.layout);
+        return entry.layout;
+    }
+
+    const ProgramInterface& get(GLuint program) {
+        return entry(program).layout;
+    }
+
+    ParameterBlock& parameters(GLuint program) {
+        return entry(program).parameters;
+    }
+
+    void forget(GLuint program) {
+        programs.erase(program);
+    }
+
+private:
+    struct Entry {
+        ProgramInterface layout;
+        ParameterBlock parameters;
+    };
+
+    std::unordered_map<GLuint, Entry> programs;
+
+    ShaderReflection() = default;
+
+    Entry& entry(GLuint program) {
+        auto it = programs.find(program);
+        if (it == programs.end()) {
+            reflect(program);
+            it = programs.find(program);
+        }
+        return it->second;
+    }
+};
@@ -1,4 +1,7 @@
 #include "../render/Texture.h"
+#include "../render/CompressedTexture.h"
+#include "../assets/TextureCooker.h"
+#include "../core/AssetFile.h"
 #include "../core/Logger.h"
 #include <GL/glew.h>
 #include <stb_image.h>
@@ -10,17 +13,45 @@ Texture::~Texture() {
 }
 
 bool Texture::loadFromFile(const std::string& path) {
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+    // Prefer the cooked .htex next to the source image
+    if (TextureCooker::isCookedCurrent(path)) {
+        HTexFile cooked;
+        std::string error;
+        if (cooked.open(TextureCooker::cookedPath(path), error) && loadCompressed(cooked.getView())) {
+            LOG_INFO("Texture loaded (cooked): " + path);
+            return true;
+        }
+        LOG_WARNING("Ignoring cooked texture for " + path + ": " + error);
+    }
+
+    AssetFile file;
+    int w, h, n;
+    unsigned char* data = file.open(path) ? stbi_load_from_memory(file.data(), (int)file.size(), &w, &h, &n, 0) : nullptr;
     if (!data) {
         LOG_ERROR("Failed to load texture: " + path);
         return false;
     }
 
-    glGenTextures(1, &handle);
+    bool ok = loadFromPixels(data, w, h, n);
+    stbi_image_free(data);
+    if (ok) LOG_INFO("Texture loaded: " + path);
+    return ok;
+}
+
+bool Texture::loadFromPixels(const unsigned char* pixels, int w, int h, int channelCount) {
+    static const GLenum formats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    if (!pixels || w <= 0 || h <= 0 || channelCount < 1 || channelCount > 4) return false;
+    width = w;
+    height = h;
+    channels = channelCount;
+
+    if (!handle) glGenTextures(1, &handle);
     glBindTexture(GL_TEXTURE_2D, handle);
 
-    GLenum format = channels == 4 ? GL_RGBA : GL_RGB;
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+    GLenum format = formats[channels - 1];
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -29,9 +60,23 @@ bool Texture::loadFromFile(const std::string& path) {
 
     glGenerateMipmap(GL_TEXTURE_2D);
     glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
 
-    stbi_image_free(data);
-    LOG_INFO("Texture loaded: " + path);
+bool Texture::loadCompressed(const HTexView& view) {
+    if (!view.valid()) return false;
+    width = (int)view.getHeader().width;
+    height = (int)view.getHeader().height;
+    channels = 4;
+
+    if (!handle) glGenTextures(1, &handle);
+    glBindTexture(GL_TEXTURE_2D, handle);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    CompressedTexture::upload(view);
+    glBindTexture(GL_TEXTURE_2D, 0);
     return true;
 }
 
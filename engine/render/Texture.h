@@ -3,6 +3,8 @@
 #include <string>
 #include <memory>
 
+class HTexView;
+
 class Texture {
 private:
     unsigned int handle;
@@ -14,6 +16,10 @@ public:
     ~Texture();
 
     bool loadFromFile(const std::string& path);
+    // Uploads already-decoded 8-bit pixels (1-4 channels); GL thread only
+    bool loadFromPixels(const unsigned char* pixels, int w, int h, int channelCount);
+    // Uploads a cooked block-compressed mip chain (RGBA8 fallback if unsupported)
+    bool loadCompressed(const HTexView& view);
     void bind(unsigned int slot = 0) const;
     void unbind() const;
 
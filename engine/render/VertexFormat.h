@@ -0,0 +1,331 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "ShaderReflection.h"
+
+// Vertex layouts shared by GLBMeshData, Mesh and the .hmesh cooker.
+// Attribute locations are always 0 = position, 1 = normal, 2 = uv.
+// Normal-mapped meshes add tangents (w = bitangent sign) as a separate
+// snorm16[4] stream at VERTEX_TANGENT_ATTRIBUTE, whatever the layout.
+//
+//   FLOAT32      float pos[3], float normal[3], float uv[2]             32 bytes
+//   QUANTIZED16  unorm16 pos[4] (in mesh bounds), snorm16 octNormal[2],
+//                unorm16 uv[2] (in uv bounds)                            16 bytes
+//   HALF16       half pos[4], snorm16 octNormal[2], unorm16 uv[2]        16 bytes
+//
+// Values are stored little-endian. The fourth position component is padding.
+//
+// chooseFormat never picks HALF16: a half keeps 11 significant bits of the
+// coordinate's distance from the origin, which is at least half the mesh's
+// extent, so at the same stride QUANTIZED16 is always at least 16 times
+// finer. HALF16 is only written when a caller asks for it, and still loads.
+enum VertexFormat : uint32_t {
+    VERTEX_FLOAT32 = 0,
+    VERTEX_QUANTIZED16 = 1,
+    VERTEX_HALF16 = 2,
+};
+
+static constexpr GLuint VERTEX_TANGENT_ATTRIBUTE = 6;
+static constexpr size_t VERTEX_TANGENT_STRIDE = 4 * sizeof(int16_t);
+
+// Dequantization applied by the vertex shader:
+//   position = a_position.xyz * positionScale + positionOffset
+//   uv       = a_uv * uvScale + uvOffset
+//   normal   = octNormals ? octDecode(a_normal.xy) : a_normal
+struct VertexQuantization {
+    glm::vec3 positionScale = glm::vec3(1.0f);
+    glm::vec3 positionOffset = glm::vec3(0.0f);
+    glm::vec2 uvScale = glm::vec2(1.0f);
+    glm::vec2 uvOffset = glm::vec2(0.0f);
+    bool octNormals = false;
+};
+
+// Maximum acceptable reconstruction error when choosing a layout, both
+// absolute: position in world units (metres), uv in texture space. 16-bit
+// positions step extent / 65535, so the default quantizes meshes up to
+// about 65 m across and keeps larger ones in floats.
+struct VertexTolerance {
+    float position = 0.0005f;
+    float uv = 1.0f / 8192.0f;
+};
+
+// GLSL 1.20 helpers for shaders that read these layouts. The defaults are the
+// identity, so FLOAT32 meshes draw correctly without setting anything.
+static const char* const VERTEX_DEQUANTIZE_GLSL = R"(
+    uniform vec3 positionScale = vec3(1.0);
+    uniform vec3 positionOffset = vec3(0.0);
+    uniform vec4 uvTransform = vec4(1.0, 1.0, 0.0, 0.0);   // xy = scale, zw = offset
+    uniform float octNormals = 0.0;
+
+    vec3 octDecode(vec2 e) {
+        vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+        if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        return normalize(n);
+    }
+
+    vec3 dequantizePosition(vec4 p) { return p.xyz * positionScale + positionOffset; }
+    vec3 dequantizeNormal(vec3 n) { return octNormals > 0.5 ? octDecode(n.xy) : n; }
+    vec2 dequantizeUV(vec2 uv) { return uv * uvTransform.xy + uvTransform.zw; }
+)";
+
+class VertexPacker {
+public:
+    static size_t stride(VertexFormat format) {
+        return format == VERTEX_FLOAT32 ? 32 : 16;
+    }
+
+    // Smallest layout whose reconstruction error stays within tolerance:
+    // QUANTIZED16, or FLOAT32 when the mesh's extent or uv range is too large
+    static VertexFormat chooseFormat(const std::vector<glm::vec3>& positions, const std::vector<glm::vec2>& uvs,
+                                     const VertexTolerance& tolerance = VertexTolerance()) {
+        if (positions.empty()) return VERTEX_FLOAT32;
+
+        glm::vec2 uvMin(0.0f), uvMax(0.0f);
+        bounds(uvs, uvMin, uvMax);
+        float uvError = maxComponent(uvMax - uvMin) / 65535.0f * 0.5f;
+        if (uvError > tolerance.uv) return VERTEX_FLOAT32;
+
+        glm::vec3 posMin, posMax;
+        bounds(positions, posMin, posMax);
+        float unormError = maxComponent(posMax - posMin) / 65535.0f * 0.5f;
+        return unormError <= tolerance.position ? VERTEX_QUANTIZED16 : VERTEX_FLOAT32;
+    }
+
+    // Interleaves the attributes in the given layout; missing normals/uvs are zero-filled
+    static void pack(VertexFormat format, const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+                     const std::vector<glm::vec2>& uvs, std::vector<uint8_t>& out, VertexQuantization& quantization) {
+        const size_t count = positions.size();
+        const size_t vertexStride = stride(format);
+        out.assign(count * vertexStride, 0);
+        quantization = VertexQuantization();
+
+        if (format == VERTEX_FLOAT32) {
+            for (size_t i = 0; i < count; ++i) {
+                float v[8] = {positions[i].x, positions[i].y, positions[i].z, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+                if (i < normals.size()) { v[3] = normals[i].x; v[4] = normals[i].y; v[5] = normals[i].z; }
+                if (i < uvs.size()) { v[6] = uvs[i].x; v[7] = uvs[i].y; }
+                std::memcpy(&out[i * vertexStride], v, sizeof(v));
+            }
+            return;
+        }
+
+        glm::vec3 posMin(0.0f), posMax(0.0f);
+        glm::vec2 uvMin(0.0f), uvMax(0.0f);
+        bounds(positions, posMin, posMax);
+        bounds(uvs, uvMin, uvMax);
+        glm::vec3 posRange = glm::max(posMax - posMin, glm::vec3(1e-20f));
+        glm::vec2 uvRange = glm::max(uvMax - uvMin, glm::vec2(1e-20f));
+
+        quantization.octNormals = true;
+        quantization.uvScale = uvRange;
+        quantization.uvOffset = uvMin;
+        if (format == VERTEX_QUANTIZED16) {
+            quantization.positionScale = posRange;
+            quantization.positionOffset = posMin;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            uint16_t v[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+            if (format == VERTEX_QUANTIZED16) {
+                glm::vec3 t = (positions[i] - posMin) / posRange;
+                for (int c = 0; c < 3; ++c) v[c] = toUnorm16(t[c]);
+            } else {
+                for (int c = 0; c < 3; ++c) v[c] = floatToHalf(positions[i][c]);
+            }
+
+            glm::vec3 n = i < normals.size() ? normals[i] : glm::vec3(0.0f, 1.0f, 0.0f);
+            int16_t oct[2];
+            octEncode(n, oct);
+            std::memcpy(&v[4], oct, sizeof(oct));
+
+            if (i < uvs.size()) {
+                glm::vec2 t = (uvs[i] - uvMin) / uvRange;
+                v[6] = toUnorm16(t.x);
+                v[7] = toUnorm16(t.y);
+            }
+            std::memcpy(&out[i * vertexStride], v, sizeof(v));
+        }
+    }
+
+    // Inverse of pack(), for CPU-side consumers of cooked vertex data
+    static void unpack(VertexFormat format, const uint8_t* data, size_t count, const VertexQuantization& q,
+                       std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals, std::vector<glm::vec2>& uvs) {
+        const size_t vertexStride = stride(format);
+        positions.resize(count);
+        normals.resize(count);
+        uvs.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t* src = data + i * vertexStride;
+            if (format == VERTEX_FLOAT32) {
+                float v[8];
+                std::memcpy(v, src, sizeof(v));
+                positions[i] = glm::vec3(v[0], v[1], v[2]);
+                normals[i] = glm::vec3(v[3], v[4], v[5]);
+                uvs[i] = glm::vec2(v[6], v[7]);
+                continue;
+            }
+
+            uint16_t v[8];
+            std::memcpy(v, src, sizeof(v));
+            for (int c = 0; c < 3; ++c) {
+                positions[i][c] = format == VERTEX_QUANTIZED16 ? v[c] / 65535.0f : halfToFloat(v[c]);
+            }
+            positions[i] = positions[i] * q.positionScale + q.positionOffset;
+
+            int16_t oct[2];
+            std::memcpy(oct, &v[4], sizeof(oct));
+            normals[i] = octDecode(oct);
+            uvs[i] = glm::vec2(v[6] / 65535.0f, v[7] / 65535.0f) * q.uvScale + q.uvOffset;
+        }
+    }
+
+    // Attribute pointers for the VBO bound to GL_ARRAY_BUFFER
+    static void setupAttributes(VertexFormat format) {
+        GLsizei vertexStride = (GLsizei)stride(format);
+        if (format == VERTEX_FLOAT32) {
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertexStride, (void*)0);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, vertexStride, (void*)(3 * sizeof(float)));
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, vertexStride, (void*)(6 * sizeof(float)));
+        } else {
+            GLenum positionType = format == VERTEX_QUANTIZED16 ? GL_UNSIGNED_SHORT : GL_HALF_FLOAT;
+            GLboolean positionNormalized = format == VERTEX_QUANTIZED16 ? GL_TRUE : GL_FALSE;
+            glVertexAttribPointer(0, 3, positionType, positionNormalized, vertexStride, (void*)0);
+            glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, vertexStride, (void*)8);
+            glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, vertexStride, (void*)12);
+        }
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glEnableVertexAttribArray(2);
+    }
+
+    // The tangent stream: xyz and the bitangent sign, each snorm16
+    static void packTangents(const std::vector<glm::vec4>& tangents, std::vector<int16_t>& out) {
+        out.resize(tangents.size() * 4);
+        for (size_t i = 0; i < tangents.size(); ++i) {
+            for (int c = 0; c < 3; ++c) out[i * 4 + c] = toSnorm16(tangents[i][c]);
+            out[i * 4 + 3] = tangents[i].w < 0.0f ? -32767 : 32767;
+        }
+    }
+
+    // Points VERTEX_TANGENT_ATTRIBUTE at a packTangents stream in the bound buffer
+    static void setupTangentAttribute() {
+        glVertexAttribPointer(VERTEX_TANGENT_ATTRIBUTE, 4, GL_SHORT, GL_TRUE, (GLsizei)VERTEX_TANGENT_STRIDE, (void*)0);
+        glEnableVertexAttribArray(VERTEX_TANGENT_ATTRIBUTE);
+    }
+
+    // Sets the VERTEX_DEQUANTIZE_GLSL uniforms in a program's parameters;
+    // meshes sharing a quantization upload nothing on apply()
+    static void applyQuantization(ParameterBlock& params, const VertexQuantization& q) {
+        static const UniformId positionScale = UniformNames::id("positionScale");
+        static const UniformId positionOffset = UniformNames::id("positionOffset");
+        static const UniformId uvTransform = UniformNames::id("uvTransform");
+        static const UniformId octNormals = UniformNames::id("octNormals");
+        params.set(positionScale, q.positionScale);
+        params.set(positionOffset, q.positionOffset);
+        params.set(uvTransform, glm::vec4(q.uvScale, q.uvOffset));
+        params.set(octNormals, q.octNormals ? 1.0f : 0.0f);
+    }
+
+    // Octahedral mapping of a unit vector to two snorm16 values
+    static void octEncode(glm::vec3 n, int16_t out[2]) {
+        float sum = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        if (sum < 1e-20f) { out[0] = 0; out[1] = 0; return; }
+        n /= sum;
+        glm::vec2 e(n.x, n.y);
+        if (n.z < 0.0f) {
+            e = glm::vec2((1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                          (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+        }
+        out[0] = toSnorm16(e.x);
+        out[1] = toSnorm16(e.y);
+    }
+
+    static glm::vec3 octDecode(const int16_t in[2]) {
+        glm::vec2 e(std::max(in[0] / 32767.0f, -1.0f), std::max(in[1] / 32767.0f, -1.0f));
+        glm::vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+        if (n.z < 0.0f) {
+            float x = n.x;
+            n.x = (1.0f - std::abs(n.y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            n.y = (1.0f - std::abs(x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+        }
+        return glm::normalize(n);
+    }
+
+    static uint16_t floatToHalf(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        uint32_t sign = (bits >> 16) & 0x8000;
+        int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+        uint32_t mantissa = bits & 0x7FFFFF;
+
+        if (exponent >= 31) return (uint16_t)(sign | 0x7C00);  // overflow -> inf
+        if (exponent <= 0) {
+            if (exponent < -10) return (uint16_t)sign;  // underflow -> zero
+            mantissa |= 0x800000;
+            uint32_t shift = (uint32_t)(14 - exponent);
+            uint32_t half = mantissa >> shift;
+            if ((mantissa >> (shift - 1)) & 1) ++half;  // round half up
+            return (uint16_t)(sign | half);
+        }
+        uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+        if (mantissa & 0x1000) ++half;  // carries into the exponent correctly
+        return (uint16_t)half;
+    }
+
+    static float halfToFloat(uint16_t half) {
+        uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+        uint32_t exponent = (half >> 10) & 0x1F;
+        uint32_t mantissa = half & 0x3FF;
+        uint32_t bits;
+        if (exponent == 0) {
+            if (mantissa == 0) {
+                bits = sign;
+            } else {
+                // Subnormal: normalize into a float exponent
+                exponent = 127 - 15 + 1;
+                while (!(mantissa & 0x400)) { mantissa <<= 1; --exponent; }
+                bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+            }
+        } else if (exponent == 31) {
+            bits = sign | 0x7F800000 | (mantissa << 13);
+        } else {
+            bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+        }
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+private:
+    static uint16_t toUnorm16(float t) {
+        return (uint16_t)(std::min(std::max(t, 0.0f), 1.0f) * 65535.0f + 0.5f);
+    }
+
+    static int16_t toSnorm16(float t) {
+        return (int16_t)std::lround(std::min(std::max(t, -1.0f), 1.0f) * 32767.0f);
+    }
+
+    template <typename Vec>
+    static void bounds(const std::vector<Vec>& values, Vec& lo, Vec& hi) {
+        if (values.empty()) return;
+        lo = hi = values[0];
+        for (const Vec& v : values) {
+            lo = glm::min(lo, v);
+            hi = glm::max(hi, v);
+        }
+    }
+
+    template <typename Vec>
+    static float maxComponent(const Vec& v) {
+        float m = v[0];
+        for (int i = 1; i < Vec::length(); ++i) m = std::max(m, v[i]);
+        return m;
+    }
+};
@@ -1,16 +1,28 @@
 #include "../render/materials/Material.h"
+#include "../render/ShaderReflection.h"
 
 Material::Material(const std::string& matName)
     : name(matName), shader(nullptr),
-      albedo(0.8f), metallic(0.0f), roughness(0.5f), aoIntensity(1.0f) {}
+      albedo(0.8f), metallic(0.0f), roughness(0.5f), aoIntensity(1.0f), translucent(false) {}
 
 void Material::bind() const {
     if (shader) {
         shader->use();
-        shader->setVec3("uAlbedo", albedo);
-        shader->setFloat("uMetallic", metallic);
-        shader->setFloat("uRoughness", roughness);
-        shader->setFloat("uAOIntensity", aoIntensity);
+        applyParameters();
+    }
+}
+
+void Material::applyParameters() const {
+    static const UniformId albedoId = UniformNames::id("uAlbedo");
+    static const UniformId metallicId = UniformNames::id("uMetallic");
+    static const UniformId roughnessId = UniformNames::id("uRoughness");
+    static const UniformId aoIntensityId = UniformNames::id("uAOIntensity");
+
+    if (shader) {
+        shader->setVec3(albedoId, albedo);
+        shader->setFloat(metallicId, metallic);
+        shader->setFloat(roughnessId, roughness);
+        shader->setFloat(aoIntensityId, aoIntensity);
     }
 }
 
@@ -12,20 +12,27 @@ protected:
     float metallic;
     float roughness;
     float aoIntensity;
+    bool translucent;
 
 public:
     Material(const std::string& matName);
     virtual ~Material() = default;
 
+    // bind() uses the shader and applies the parameters; applyParameters()
+    // only sets the uniforms, for when the shader is already in use
     virtual void bind() const;
     virtual void unbind() const;
+    virtual void applyParameters() const;
 
     void setShader(ShaderPtr shd) { shader = shd; }
     void setAlbedo(const Vec3& col) { albedo = col; }
     void setMetallic(float m) { metallic = m; }
     void setRoughness(float r) { roughness = r; }
     void setAOIntensity(float ao) { aoIntensity = ao; }
+    // Translucent materials are drawn blended, after the solid ones
+    void setTranslucent(bool value) { translucent = value; }
 
     const std::string& getName() const { return name; }
     ShaderPtr getShader() const { return shader; }
+    bool isTranslucent() const { return translucent; }
 };
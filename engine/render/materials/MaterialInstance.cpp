@@ -6,7 +6,17 @@ void MaterialInstance::bind() const {
     if (material) {
         material->bind();
     }
+    bindTextures();
+}
+
+void MaterialInstance::unbind() const {
+    if (material) {
+        material->unbind();
+    }
+    unbindTextures();
+}
 
+void MaterialInstance::bindTextures() const {
     for (const auto& pair : textures) {
         if (pair.second) {
             pair.second->bind();
@@ -14,11 +24,7 @@ void MaterialInstance::bind() const {
     }
 }
 
-void MaterialInstance::unbind() const {
-    if (material) {
-        material->unbind();
-    }
-
+void MaterialInstance::unbindTextures() const {
     for (const auto& pair : textures) {
         if (pair.second) {
             pair.second->unbind();
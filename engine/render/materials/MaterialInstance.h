@@ -13,6 +13,9 @@ public:
 
     void bind() const;
     void unbind() const;
+    // Just the textures, for when the material is already bound
+    void bindTextures() const;
+    void unbindTextures() const;
 
     void setTexture(const std::string& slot, TexturePtr texture);
     TexturePtr getTexture(const std::string& slot) const;
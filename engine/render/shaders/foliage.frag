@@ -1,5 +1,7 @@
 #version 330 core
 
+// Keywords: ALPHA_TEST (leaf cutouts), FOG
+
 in vec3 vFragPos;
 in vec3 vNormal;
 in vec2 vTexCoord;
@@ -10,10 +12,24 @@ uniform vec3 uSunColor;
 uniform float uAmbientLight;
 uniform vec3 uWindForce;
 
+#ifdef ALPHA_TEST
+uniform float uAlphaCutoff = 0.5;
+#endif
+
+#ifdef FOG
+in float vViewDepth;
+#include "include/fog.glsl"
+#endif
+
 out vec4 FragColor;
 
 void main()
 {
+    vec4 texColor = texture(uTexture, vTexCoord);
+#ifdef ALPHA_TEST
+    if (texColor.a < uAlphaCutoff) discard;
+#endif
+
     vec3 norm = normalize(vNormal);
     vec3 lightDir = normalize(uSunDirection);
     float diff = max(dot(norm, lightDir), 0.0);
@@ -21,8 +37,10 @@ void main()
     
     vec3 ambient = uAmbientLight * vec3(0.2, 0.6, 0.2);
     
-    vec4 texColor = texture(uTexture, vTexCoord);
     vec3 result = (ambient + diffuse) * texColor.rgb;
+#ifdef FOG
+    result = applyFog(result, vViewDepth);
+#endif
     
     FragColor = vec4(result, texColor.a);
 }
@@ -1,5 +1,7 @@
 #version 330 core
 
+// Keywords: FOG
+
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
@@ -11,11 +13,23 @@ uniform mat4 uProjection;
 out vec3 vFragPos;
 out vec3 vNormal;
 out vec2 vTexCoord;
+#ifdef FOG
+out float vViewDepth;
+#endif
+
+// Vertex dequantization (see VertexFormat.h); identity for float meshes
+#include "dequantize.glsl"
 
 void main()
 {
-    vFragPos = vec3(uModel * vec4(aPosition, 1.0));
-    vNormal = mat3(transpose(inverse(uModel))) * aNormal;
-    vTexCoord = aTexCoord;
-    gl_Position = uProjection * uView * vec4(vFragPos, 1.0);
+    vec3 position = dequantizePosition(vec4(aPosition, 1.0));
+    vec3 normal = dequantizeNormal(aNormal);
+    vFragPos = vec3(uModel * vec4(position, 1.0));
+    vNormal = mat3(transpose(inverse(uModel))) * normal;
+    vTexCoord = dequantizeUV(aTexCoord);
+    vec4 viewPos = uView * vec4(vFragPos, 1.0);
+#ifdef FOG
+    vViewDepth = -viewPos.z;
+#endif
+    gl_Position = uProjection * viewPos;
 }
@@ -0,0 +1,10 @@
+// Exponential-squared distance fog (FOG keyword); viewDepth is the
+// fragment's distance along the view axis
+
+uniform vec3 fogColor = vec3(0.1, 0.1, 0.15);
+uniform float fogDensity = 0.005;
+
+vec3 applyFog(vec3 color, float viewDepth) {
+    float amount = fogDensity * viewDepth;
+    return mix(color, fogColor, clamp(1.0 - exp(-amount * amount), 0.0, 1.0));
+}
@@ -0,0 +1,29 @@
+// Tangent-space normal mapping (NORMAL_MAP keyword). The frame comes from the
+// mesh's tangent attribute (xyz, w = bitangent sign); meshes without one pass
+// a zero xyz and fall back to a frame built from screen-space derivatives.
+// Only the map's red and green are read: cooked normal maps are BC5 (RG),
+// so z is rebuilt from the unit length.
+
+vec3 perturbNormal(vec3 N, vec4 tangent, vec3 position, vec2 uv, vec2 sampled) {
+    vec2 xy = sampled * 2.0 - 1.0;
+    vec3 mapped = vec3(xy, sqrt(max(0.0, 1.0 - dot(xy, xy))));
+
+    vec3 T = tangent.xyz - N * dot(N, tangent.xyz);
+    if (dot(T, T) > 1e-8) {
+        T = normalize(T);
+        vec3 B = cross(N, T) * (tangent.w < 0.0 ? -1.0 : 1.0);
+        return normalize(mat3(T, B, N) * mapped);
+    }
+
+    vec3 dp1 = dFdx(position);
+    vec3 dp2 = dFdy(position);
+    vec2 duv1 = dFdx(uv);
+    vec2 duv2 = dFdy(uv);
+
+    vec3 dp2perp = cross(dp2, N);
+    vec3 dp1perp = cross(N, dp1);
+    T = dp2perp * duv1.x + dp1perp * duv2.x;
+    vec3 B = dp2perp * duv1.y + dp1perp * duv2.y;
+    float invScale = inversesqrt(max(max(dot(T, T), dot(B, B)), 1e-20));
+    return normalize(mat3(T * invScale, B * invScale, N) * mapped);
+}
@@ -0,0 +1,95 @@
+#version 120
+
+// PBR shading for scene objects. Keywords: NORMAL_MAP, ALPHA_TEST, FOG, and
+// the DEBUG_NORMALS / DEBUG_UV / DEBUG_BASE_COLOR views of shaders.exe
+
+uniform float time;
+uniform sampler2D baseColorTex;
+uniform sampler2D metallicRoughnessTex;
+
+varying vec3 fragPos;
+varying vec3 fragNormal;
+varying vec2 fragTexCoord;
+
+#include "include/pbr.glsl"
+
+#ifdef NORMAL_MAP
+uniform sampler2D normalTex;
+varying vec4 fragTangent;
+#include "include/normal_map.glsl"
+#endif
+
+#ifdef ALPHA_TEST
+uniform float alphaCutoff = 0.5;
+#endif
+
+#ifdef FOG
+varying float fragViewDepth;
+#include "include/fog.glsl"
+#endif
+
+vec3 shade(vec3 baseColor, vec3 norm) {
+    vec4 mrTex = texture2D(metallicRoughnessTex, fragTexCoord);
+    vec3 viewDir = normalize(-fragPos);
+
+    float metallic = mrTex.b;
+    float roughness = mrTex.g;
+
+    vec3 F0 = mix(vec3(0.04), baseColor, metallic);
+
+    vec3 lightDir = normalize(vec3(1.0, 1.0, 1.0));
+    vec3 H = normalize(viewDir + lightDir);
+
+    float distance = 1.0;
+    float attenuation = 1.0 / (distance * distance);
+    vec3 radiance = vec3(1.0) * attenuation;
+
+    vec3 F = fresnelSchlick(max(dot(H, viewDir), 0.0), F0);
+    float NDF = DistributionGGX(norm, H, roughness);
+    float G = GeometrySchlickGGX(max(dot(norm, viewDir), 0.0), roughness) *
+              GeometrySchlickGGX(max(dot(norm, lightDir), 0.0), roughness);
+
+    vec3 kS = F;
+    vec3 kD = (vec3(1.0) - kS) * (1.0 - metallic);
+
+    float NdotL = max(dot(norm, lightDir), 0.0);
+    vec3 numerator = NDF * G * F;
+    float denominator = 4.0 * max(dot(norm, viewDir), 0.0) * max(dot(norm, lightDir), 0.0);
+    vec3 specular = numerator / max(denominator, 0.001);
+
+    vec3 color = (kD * baseColor / 3.14159 + specular) * radiance * NdotL;
+
+    // Add ambient
+    color += baseColor * 0.1;
+
+    // Add time animation
+    color += 0.1 * sin(time) * vec3(0.5, 0.2, 0.1);
+    return color;
+}
+
+void main() {
+    vec4 baseColor = texture2D(baseColorTex, fragTexCoord);
+#ifdef ALPHA_TEST
+    if (baseColor.a < alphaCutoff) discard;
+#endif
+
+    vec3 norm = normalize(fragNormal);
+#ifdef NORMAL_MAP
+    norm = perturbNormal(norm, fragTangent, fragPos, fragTexCoord, texture2D(normalTex, fragTexCoord).rg);
+#endif
+
+#if defined(DEBUG_NORMALS)
+    vec3 color = norm * 0.5 + 0.5;
+#elif defined(DEBUG_UV)
+    vec3 color = vec3(fract(fragTexCoord), 0.0);
+#elif defined(DEBUG_BASE_COLOR)
+    vec3 color = baseColor.rgb;
+#else
+    vec3 color = shade(baseColor.rgb, norm);
+#ifdef FOG
+    color = applyFog(color, fragViewDepth);
+#endif
+#endif
+
+    gl_FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,58 @@
+#version 120
+
+// Scene objects drawn by SceneManager::renderAll. Meshes may use any
+// VertexFormat layout, so it reads generic attributes and dequantizes them.
+// Keywords: INSTANCING (model matrix per instance, see InstanceTransform), FOG,
+// NORMAL_MAP (passes the snorm16 tangent stream through, see packTangents)
+
+#include "dequantize.glsl"
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+
+#ifdef INSTANCING
+// Top three rows of the affine model matrix
+attribute vec4 aModel0;
+attribute vec4 aModel1;
+attribute vec4 aModel2;
+#else
+uniform mat4 model;
+#endif
+
+attribute vec4 aPosition;
+attribute vec3 aNormal;
+attribute vec2 aTexCoord;
+
+varying vec3 fragPos;
+varying vec3 fragNormal;
+varying vec2 fragTexCoord;
+#ifdef NORMAL_MAP
+// (0,0,0,1) when the mesh has no tangent stream
+attribute vec4 aTangent;
+varying vec4 fragTangent;
+#endif
+#ifdef FOG
+varying float fragViewDepth;
+#endif
+
+void main() {
+#ifdef INSTANCING
+    mat4 model = mat4(aModel0.x, aModel1.x, aModel2.x, 0.0,
+                      aModel0.y, aModel1.y, aModel2.y, 0.0,
+                      aModel0.z, aModel1.z, aModel2.z, 0.0,
+                      aModel0.w, aModel1.w, aModel2.w, 1.0);
+#endif
+    fragPos = vec3(model * vec4(dequantizePosition(aPosition), 1.0));
+    fragNormal = normalize(mat3(model) * dequantizeNormal(aNormal));
+    fragTexCoord = dequantizeUV(aTexCoord);
+#ifdef NORMAL_MAP
+    fragTangent = vec4(mat3(model) * aTangent.xyz, aTangent.w);
+#endif
+
+    vec4 viewPos = view * vec4(fragPos, 1.0);
+#ifdef FOG
+    fragViewDepth = -viewPos.z;
+#endif
+    gl_Position = projection * viewPos;
+}
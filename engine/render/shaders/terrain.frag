@@ -0,0 +1,29 @@
+#version 120
+
+// Terrain shading: grass on gentle slopes, rock on steep ones, one sun.
+// Keywords: FOG
+
+varying vec3 fragPos;
+varying vec3 fragNormal;
+
+#ifdef FOG
+varying float fragViewDepth;
+#include "include/fog.glsl"
+#endif
+
+void main() {
+    vec3 norm = normalize(fragNormal);
+    vec3 grass = vec3(0.25, 0.42, 0.18);
+    vec3 rock = vec3(0.42, 0.39, 0.36);
+    float steepness = smoothstep(0.2, 0.4, 1.0 - norm.y);
+    vec3 albedo = mix(grass, rock, steepness);
+
+    vec3 lightDir = normalize(vec3(1.0, 1.0, 1.0));
+    float diffuse = max(dot(norm, lightDir), 0.0);
+    vec3 color = albedo * (0.3 + 0.7 * diffuse);
+#ifdef FOG
+    color = applyFog(color, fragViewDepth);
+#endif
+
+    gl_FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,82 @@
+#version 120
+
+// CDLOD terrain nodes (see Terrain.h): one grid mesh scaled to each node,
+// heights and normals read from the chunk's textures, and vertices morphed
+// onto the next coarser grid over the outer part of the node's LOD range.
+// The normals were taken across chunk edges when the chunk was built, so
+// lighting matches where chunks meet.
+// Keywords: FOG, CPU_HEIGHTS (heights and normals come as attributes, for
+// drivers without float vertex textures; see Terrain::vertexTexturesSupported)
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 cameraPos;
+uniform float gridSize;     // quads per node edge
+uniform vec3 node;          // world origin xz, size
+uniform vec2 morph;         // end / (end - start), 1 / (end - start) of the node's range
+
+attribute vec2 aGrid;       // 0..1 across the node
+
+#ifdef CPU_HEIGHTS
+// At the vertex, then where it ends up once fully morphed
+attribute vec2 aHeight;
+attribute vec4 aNormal;      // xyz * 0.5 + 0.5
+attribute vec4 aMorphNormal;
+#else
+uniform vec4 chunk;         // world origin xz, 1 / chunk size, samples per edge
+uniform sampler2D heightMap;
+uniform sampler2D normalMap; // xyz * 0.5 + 0.5
+#endif
+
+varying vec3 fragPos;
+varying vec3 fragNormal;
+#ifdef FOG
+varying float fragViewDepth;
+#endif
+
+#ifndef CPU_HEIGHTS
+// Sample centres, so texel i is exactly the i-th sample
+vec2 chunkUV(vec2 world) {
+    vec2 local = (world - chunk.xy) * chunk.z;
+    return (local * (chunk.w - 1.0) + 0.5) / chunk.w;
+}
+
+float sampleHeight(vec2 world) {
+    return texture2DLod(heightMap, chunkUV(world), 0.0).r;
+}
+#endif
+
+// Odd grid vertices slide onto their lower even neighbour, the coarser
+// grid's vertex, collapsing the triangles between; at k = 1 the node
+// matches the coarser level's grid exactly
+vec2 morphVertex(vec2 grid, vec2 world, float k) {
+    vec2 fraction = fract(grid * gridSize * 0.5) * 2.0 / gridSize;
+    return world - fraction * node.z * k;
+}
+
+void main() {
+    vec2 world = node.xy + aGrid * node.z;
+#ifdef CPU_HEIGHTS
+    float height = aHeight.x;
+#else
+    float height = sampleHeight(world);
+#endif
+    float distanceToCamera = distance(cameraPos, vec3(world.x, height, world.y));
+    float k = clamp(distanceToCamera * morph.y - (morph.x - 1.0), 0.0, 1.0);
+    world = morphVertex(aGrid, world, k);
+
+#ifdef CPU_HEIGHTS
+    // Straight towards the coarser vertex, rather than along the surface
+    fragPos = vec3(world.x, mix(aHeight.x, aHeight.y, k), world.y);
+    fragNormal = normalize(mix(aNormal.xyz, aMorphNormal.xyz, k) * 2.0 - 1.0);
+#else
+    fragPos = vec3(world.x, sampleHeight(world), world.y);
+    fragNormal = normalize(texture2DLod(normalMap, chunkUV(world), 0.0).xyz * 2.0 - 1.0);
+#endif
+
+    vec4 viewPos = view * vec4(fragPos, 1.0);
+#ifdef FOG
+    fragViewDepth = -viewPos.z;
+#endif
+    gl_Position = projection * viewPos;
+}
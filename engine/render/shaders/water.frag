@@ -1,12 +1,22 @@
 #version 330 core
 
+// Keywords: FOG
+
 uniform vec3 uWaterColor;
 uniform vec3 uSunColor;
 
+#ifdef FOG
+in float vViewDepth;
+#include "include/fog.glsl"
+#endif
+
 out vec4 FragColor;
 
 void main()
 {
     vec3 waterColor = mix(uWaterColor, uSunColor, 0.3);
+#ifdef FOG
+    waterColor = applyFog(waterColor, vViewDepth);
+#endif
     FragColor = vec4(waterColor, 0.6);
 }
@@ -1,5 +1,7 @@
 #version 330 core
 
+// Keywords: FOG
+
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
@@ -9,10 +11,21 @@ uniform mat4 uView;
 uniform mat4 uProjection;
 uniform float uTime;
 
+#ifdef FOG
+out float vViewDepth;
+#endif
+
+// Vertex dequantization (see VertexFormat.h); identity for float meshes
+#include "dequantize.glsl"
+
 void main()
 {
-    vec3 pos = aPosition;
+    vec3 pos = dequantizePosition(vec4(aPosition, 1.0));
     pos.y += sin(uTime + pos.x) * 0.05;
     
-    gl_Position = uProjection * uView * uModel * vec4(pos, 1.0);
+    vec4 viewPos = uView * uModel * vec4(pos, 1.0);
+#ifdef FOG
+    vViewDepth = -viewPos.z;
+#endif
+    gl_Position = uProjection * viewPos;
 }
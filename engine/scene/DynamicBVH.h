@@ -0,0 +1,719 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <vector>
+
+#include "../core/JobSystem.h"
+#include "../render/Frustum.h"
+
+// Dynamic AABB tree over loose ("fat") boxes, in the style of Box2D's
+// b2DynamicTree. Each proxy owns a leaf whose box is a little larger than
+// what was inserted, so small moves cost nothing; bigger ones reinsert the
+// leaf, choosing its sibling by surface area and rebalancing with rotations
+// on the way up, all O(log n). Queries skip whole subtrees that miss.
+//
+// Incremental edits slowly degrade the tree, so update() measures its SAH
+// cost and, past REBUILD_RATIO times the cost of the last full build, builds
+// a fresh tree from a snapshot on a worker. Edits made meanwhile are replayed
+// onto the new tree when it is adopted. Edits and the queries that use the
+// tree's own scratch stack belong to one thread; the part-wise frustum query
+// may run on several threads at once while nothing edits the tree.
+class DynamicBVH {
+public:
+    using ProxyId = int32_t;
+    static constexpr int32_t NONE = -1;
+
+    // A subtree left to test against the frustum, or known to be inside it
+    struct FrustumPart {
+        int32_t node;
+        bool inside;
+    };
+
+    // Fat boxes grow by this much plus FAT_FRACTION of their half size per axis
+    static constexpr float FAT_MARGIN = 0.1f;
+    static constexpr float FAT_FRACTION = 0.1f;
+    // A leaf more than this many times the area it needs is shrunk on move()
+    static constexpr float FAT_SHRINK_RATIO = 4.0f;
+    // Trees smaller than this are not worth rebuilding off-thread
+    static constexpr size_t REBUILD_MIN_LEAVES = 256;
+    static constexpr double REBUILD_RATIO = 1.5;
+
+    DynamicBVH() = default;
+    DynamicBVH(const DynamicBVH&) = delete;
+    DynamicBVH& operator=(const DynamicBVH&) = delete;
+
+    ProxyId insert(const Bounds& box, uint32_t userData) {
+        ProxyId id;
+        if (freeProxy != NONE) {
+            id = freeProxy;
+            freeProxy = proxies[id].nextFree;
+        } else {
+            id = (ProxyId)proxies.size();
+            proxies.emplace_back();
+        }
+        Proxy& proxy = proxies[id];
+        proxy.userData = userData;
+        proxy.alive = true;
+        proxy.nextFree = NONE;
+        proxy.leaf = allocateLeaf(fatten(box), id);
+        insertLeaf(proxy.leaf);
+        ++leafCount;
+        noteChange(id);
+        return id;
+    }
+
+    void remove(ProxyId id) {
+        Proxy& proxy = proxies[id];
+        removeLeaf(proxy.leaf);
+        freeNode(proxy.leaf);
+        proxy.leaf = NONE;
+        proxy.alive = false;
+        proxy.nextFree = freeProxy;
+        freeProxy = id;
+        --leafCount;
+        noteChange(id);
+    }
+
+    // Returns true if the leaf had to be reinserted
+    bool move(ProxyId id, const Bounds& box) {
+        int32_t leaf = proxies[id].leaf;
+        const Bounds& fat = nodes[leaf].box;
+        Bounds needed = fatten(box);
+        if (contains(fat, box) && area(fat) <= area(needed) * FAT_SHRINK_RATIO) return false;
+        removeLeaf(leaf);
+        nodes[leaf].box = needed;
+        insertLeaf(leaf);
+        noteChange(id);
+        return true;
+    }
+
+    uint32_t getUserData(ProxyId id) const { return proxies[id].userData; }
+    void setUserData(ProxyId id, uint32_t userData) { proxies[id].userData = userData; }
+    const Bounds& getFatBounds(ProxyId id) const { return nodes[proxies[id].leaf].box; }
+
+    // visit(userData, fullyInside) for every proxy whose fat box touches the
+    // frustum. fullyInside is true when the box is entirely inside, in which
+    // case the object needs no further test; whole subtrees inside or
+    // outside are decided with one box test.
+    template <typename Visit>
+    void queryFrustum(const Frustum& frustum, Visit&& visit) const {
+        if (root == NONE) return;
+        queryFrustum(frustum, FrustumPart{root, false}, stack, visit);
+    }
+
+    // Cuts a frustum query into independent parts, at least count of them
+    // when the tree is big enough, for queryFrustum(frustum, part, ...) to
+    // run on several threads. Subtrees outside are dropped here; those
+    // inside are split as well, since their objects still cost the caller.
+    void splitFrustumQuery(const Frustum& frustum, size_t count, std::vector<FrustumPart>& parts) const {
+        parts.clear();
+        if (root == NONE) return;
+        Frustum::Containment containment = frustum.classifyBox(nodes[root].box);
+        if (containment == Frustum::OUTSIDE) return;
+        parts.push_back({root, containment == Frustum::INSIDE});
+
+        // Breadth first, so the parts end up of similar size; leaves cannot
+        // be split and move to the front
+        size_t head = 0;
+        size_t leaves = 0;
+        while (head < parts.size() && parts.size() - head + leaves < count) {
+            FrustumPart part = parts[head++];
+            const Node& node = nodes[part.node];
+            if (node.isLeaf()) {
+                parts[leaves++] = part;
+                continue;
+            }
+            for (int32_t child : {node.child1, node.child2}) {
+                if (part.inside) {
+                    parts.push_back({child, true});
+                    continue;
+                }
+                containment = frustum.classifyBox(nodes[child].box);
+                if (containment != Frustum::OUTSIDE) parts.push_back({child, containment == Frustum::INSIDE});
+            }
+        }
+        parts.erase(parts.begin() + leaves, parts.begin() + head);
+    }
+
+    // queryFrustum over one part, with a caller-owned stack so parts can
+    // run concurrently
+    template <typename Visit>
+    void queryFrustum(const Frustum& frustum, const FrustumPart& part, std::vector<int32_t>& scratch, Visit&& visit) const {
+        scratch.clear();
+        if (part.inside) {
+            visitSubtree(part.node, scratch, visit);
+            return;
+        }
+        scratch.push_back(part.node);
+        while (!scratch.empty()) {
+            int32_t index = scratch.back();
+            const Node& node = nodes[index];
+            scratch.pop_back();
+            Frustum::Containment containment = frustum.classifyBox(node.box);
+            if (containment == Frustum::OUTSIDE) continue;
+            if (containment == Frustum::INSIDE) {
+                visitSubtree(index, scratch, visit);
+            } else if (node.isLeaf()) {
+                visit(proxies[node.proxy].userData, false);
+            } else {
+                scratch.push_back(node.child1);
+                scratch.push_back(node.child2);
+            }
+        }
+    }
+
+    // visit(userData) for every proxy whose fat box overlaps box
+    template <typename Visit>
+    void queryBox(const Bounds& box, Visit&& visit) const {
+        if (root == NONE) return;
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const Node& node = nodes[stack.back()];
+            stack.pop_back();
+            if (!node.box.overlaps(box)) continue;
+            if (node.isLeaf()) {
+                visit(proxies[node.proxy].userData);
+            } else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    // visit(userData, entryDistance) for every proxy whose fat box the ray
+    // enters before maxDistance, nearest subtrees first. visit returns the
+    // new maximum distance: the hit distance to keep only closer objects,
+    // maxDistance to go on, or 0 to stop.
+    template <typename Visit>
+    void raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Visit&& visit) const {
+        if (root == NONE) return;
+        glm::vec3 invDir = 1.0f / direction;
+        float entry;
+        rayStack.clear();
+        if (nodes[root].box.intersectsRay(origin, invDir, maxDistance, entry)) rayStack.push_back({root, entry});
+        while (!rayStack.empty()) {
+            RayEntry top = rayStack.back();
+            rayStack.pop_back();
+            if (top.distance > maxDistance) continue;
+            const Node& node = nodes[top.node];
+            if (node.isLeaf()) {
+                maxDistance = visit(proxies[node.proxy].userData, top.distance);
+                if (maxDistance <= 0.0f) return;
+                continue;
+            }
+            float entry1, entry2;
+            bool hit1 = nodes[node.child1].box.intersectsRay(origin, invDir, maxDistance, entry1);
+            bool hit2 = nodes[node.child2].box.intersectsRay(origin, invDir, maxDistance, entry2);
+            // The nearer child goes on top of the stack
+            if (hit1 && hit2 && entry1 < entry2) {
+                rayStack.push_back({node.child2, entry2});
+                rayStack.push_back({node.child1, entry1});
+            } else {
+                if (hit1) rayStack.push_back({node.child1, entry1});
+                if (hit2) rayStack.push_back({node.child2, entry2});
+            }
+        }
+    }
+
+    // Adopts a finished background build, or starts one once the tree has
+    // degraded. Call once per frame.
+    void update() {
+        if (rebuild.valid()) {
+            if (rebuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready) adopt(rebuild.get());
+            return;
+        }
+        if (leafCount < REBUILD_MIN_LEAVES) return;
+        if (builtCost > 0.0 && getCost() <= builtCost * REBUILD_RATIO) return;
+
+        std::vector<BuildItem> items = snapshot();
+        changedDuringBuild.clear();
+        rebuild = JobSystem::getInstance().submit([items]() mutable { return build(items); });
+    }
+
+    // Rebuilds on the calling thread, discarding any background build
+    void rebuildNow() {
+        rebuild = std::future<BuildResult>();
+        for (ProxyId id : changedDuringBuild) proxies[id].changed = false;
+        changedDuringBuild.clear();
+        std::vector<BuildItem> items = snapshot();
+        adopt(build(items));
+    }
+
+    void clear() {
+        rebuild = std::future<BuildResult>();
+        nodes.clear();
+        proxies.clear();
+        changedDuringBuild.clear();
+        root = NONE;
+        freeNodes = NONE;
+        freeProxy = NONE;
+        leafCount = 0;
+        internalArea = 0.0;
+        builtCost = 0.0;
+    }
+
+    size_t size() const { return leafCount; }
+    int32_t getHeight() const { return root == NONE ? 0 : nodes[root].height; }
+    bool isRebuilding() const { return rebuild.valid(); }
+    size_t getRebuildCount() const { return rebuildCount; }
+
+    // SAH cost: total surface area of internal nodes over the root's. Lower
+    // means fewer boxes visited per query.
+    double getCost() const {
+        if (root == NONE || nodes[root].isLeaf()) return 0.0;
+        double rootArea = area(nodes[root].box);
+        return rootArea > 0.0 ? internalArea / rootArea : 0.0;
+    }
+
+private:
+    struct Node {
+        Bounds box;
+        int32_t parent = NONE;  // next free node while on the free list
+        int32_t child1 = NONE;
+        int32_t child2 = NONE;
+        int32_t height = 0;     // 0 for leaves
+        ProxyId proxy = NONE;
+
+        bool isLeaf() const { return child1 == NONE; }
+    };
+
+    struct Proxy {
+        uint32_t userData = 0;
+        int32_t leaf = NONE;
+        ProxyId nextFree = NONE;
+        bool alive = false;
+        bool changed = false;  // recorded in changedDuringBuild
+    };
+
+    struct BuildItem {
+        Bounds box;
+        glm::vec3 centroid;
+        ProxyId proxy;
+    };
+
+    struct BuildResult {
+        std::vector<Node> nodes;
+        int32_t root = NONE;
+    };
+
+    struct RayEntry {
+        int32_t node;
+        float distance;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Proxy> proxies;
+    int32_t root = NONE;
+    int32_t freeNodes = NONE;
+    ProxyId freeProxy = NONE;
+    size_t leafCount = 0;
+    double internalArea = 0.0;  // kept up to date by setBox
+    double builtCost = 0.0;     // getCost() right after the last full build
+    size_t rebuildCount = 0;
+
+    std::future<BuildResult> rebuild;
+    std::vector<ProxyId> changedDuringBuild;
+
+    // Traversal scratch, reused across queries
+    mutable std::vector<int32_t> stack;
+    mutable std::vector<RayEntry> rayStack;
+
+    static double area(const Bounds& box) {
+        glm::vec3 d = box.max - box.min;
+        return 2.0 * ((double)d.x * d.y + (double)d.y * d.z + (double)d.z * d.x);
+    }
+
+    static Bounds merge(const Bounds& a, const Bounds& b) {
+        Bounds out;
+        out.min = glm::min(a.min, b.min);
+        out.max = glm::max(a.max, b.max);
+        return out;
+    }
+
+    static bool contains(const Bounds& outer, const Bounds& inner) {
+        return glm::all(glm::lessThanEqual(outer.min, inner.min)) && glm::all(glm::greaterThanEqual(outer.max, inner.max));
+    }
+
+    static Bounds fatten(const Bounds& box) {
+        glm::vec3 margin = box.extent() * FAT_FRACTION + glm::vec3(FAT_MARGIN);
+        Bounds out;
+        out.min = box.min - margin;
+        out.max = box.max + margin;
+        return out;
+    }
+
+    // Visits every leaf under top, using the stack above its current size
+    template <typename Visit>
+    void visitSubtree(int32_t top, std::vector<int32_t>& stack, Visit& visit) const {
+        size_t base = stack.size();
+        stack.push_back(top);
+        while (stack.size() > base) {
+            const Node& node = nodes[stack.back()];
+            stack.pop_back();
+            if (node.isLeaf()) {
+                visit(proxies[node.proxy].userData, true);
+            } else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    void noteChange(ProxyId id) {
+        if (!rebuild.valid() || proxies[id].changed) return;
+        proxies[id].changed = true;
+        changedDuringBuild.push_back(id);
+    }
+
+    // Internal node boxes only; keeps internalArea in step
+    void setBox(int32_t index, const Bounds& box) {
+        internalArea += area(box) - area(nodes[index].box);
+        nodes[index].box = box;
+    }
+
+    int32_t allocateNode() {
+        int32_t index;
+        if (freeNodes != NONE) {
+            index = freeNodes;
+            freeNodes = nodes[index].parent;
+            nodes[index] = Node();
+        } else {
+            index = (int32_t)nodes.size();
+            nodes.emplace_back();
+        }
+        return index;
+    }
+
+    int32_t allocateLeaf(const Bounds& box, ProxyId proxy) {
+        int32_t index = allocateNode();
+        nodes[index].box = box;
+        nodes[index].proxy = proxy;
+        return index;
+    }
+
+    void freeNode(int32_t index) {
+        if (!nodes[index].isLeaf()) setBox(index, Bounds());
+        nodes[index] = Node();
+        nodes[index].parent = freeNodes;
+        freeNodes = index;
+    }
+
+    void refit(int32_t index) {
+        Node& node = nodes[index];
+        node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+        setBox(index, merge(nodes[node.child1].box, nodes[node.child2].box));
+    }
+
+    // Walks from index to the root, rebalancing and refitting each ancestor
+    void refitUpward(int32_t index) {
+        while (index != NONE) {
+            index = balance(index);
+            refit(index);
+            index = nodes[index].parent;
+        }
+    }
+
+    void replaceChild(int32_t parent, int32_t oldChild, int32_t newChild) {
+        if (parent == NONE) {
+            root = newChild;
+        } else if (nodes[parent].child1 == oldChild) {
+            nodes[parent].child1 = newChild;
+        } else {
+            nodes[parent].child2 = newChild;
+        }
+    }
+
+    void insertLeaf(int32_t leaf) {
+        if (root == NONE) {
+            root = leaf;
+            nodes[leaf].parent = NONE;
+            return;
+        }
+
+        // Descend towards the sibling that grows the tree's area least
+        const Bounds leafBox = nodes[leaf].box;
+        int32_t index = root;
+        while (!nodes[index].isLeaf()) {
+            const Node& node = nodes[index];
+            double nodeArea = area(node.box);
+            double combinedArea = area(merge(node.box, leafBox));
+            // Pairing with this node makes a new parent; descending makes it grow
+            double cost = 2.0 * combinedArea;
+            double inheritance = 2.0 * (combinedArea - nodeArea);
+            double cost1 = descendCost(node.child1, leafBox) + inheritance;
+            double cost2 = descendCost(node.child2, leafBox) + inheritance;
+            if (cost < cost1 && cost < cost2) break;
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+
+        int32_t sibling = index;
+        int32_t oldParent = nodes[sibling].parent;
+        int32_t newParent = allocateNode();
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].child1 = sibling;
+        nodes[newParent].child2 = leaf;
+        nodes[newParent].height = nodes[sibling].height + 1;
+        setBox(newParent, merge(leafBox, nodes[sibling].box));
+        replaceChild(oldParent, sibling, newParent);
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+        refitUpward(oldParent);
+    }
+
+    double descendCost(int32_t child, const Bounds& leafBox) const {
+        double combined = area(merge(nodes[child].box, leafBox));
+        return nodes[child].isLeaf() ? combined : combined - area(nodes[child].box);
+    }
+
+    void removeLeaf(int32_t leaf) {
+        if (leaf == root) {
+            root = NONE;
+            return;
+        }
+        int32_t parent = nodes[leaf].parent;
+        int32_t grandParent = nodes[parent].parent;
+        int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+        replaceChild(grandParent, parent, sibling);
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+        nodes[leaf].parent = NONE;
+        refitUpward(grandParent);
+    }
+
+    // Rotates a grandchild up when one side of a is more than one level
+    // taller than the other. Returns the node now in a's place.
+    int32_t balance(int32_t iA) {
+        Node& a = nodes[iA];
+        if (a.isLeaf() || a.height < 2) return iA;
+
+        int32_t iB = a.child1;
+        int32_t iC = a.child2;
+        Node& b = nodes[iB];
+        Node& c = nodes[iC];
+        int32_t diff = c.height - b.height;
+
+        // Rotate C up
+        if (diff > 1) {
+            int32_t iF = c.child1;
+            int32_t iG = c.child2;
+            Node& f = nodes[iF];
+            Node& g = nodes[iG];
+            c.child1 = iA;
+            c.parent = a.parent;
+            a.parent = iC;
+            replaceChild(c.parent, iA, iC);
+
+            if (f.height > g.height) {
+                c.child2 = iF;
+                a.child2 = iG;
+                g.parent = iA;
+                setBox(iA, merge(b.box, g.box));
+                setBox(iC, merge(a.box, f.box));
+                a.height = 1 + std::max(b.height, g.height);
+                c.height = 1 + std::max(a.height, f.height);
+            } else {
+                c.child2 = iG;
+                a.child2 = iF;
+                f.parent = iA;
+                setBox(iA, merge(b.box, f.box));
+                setBox(iC, merge(a.box, g.box));
+                a.height = 1 + std::max(b.height, f.height);
+                c.height = 1 + std::max(a.height, g.height);
+            }
+            return iC;
+        }
+
+        // Rotate B up
+        if (diff < -1) {
+            int32_t iD = b.child1;
+            int32_t iE = b.child2;
+            Node& d = nodes[iD];
+            Node& e = nodes[iE];
+            b.child1 = iA;
+            b.parent = a.parent;
+            a.parent = iB;
+            replaceChild(b.parent, iA, iB);
+
+            if (d.height > e.height) {
+                b.child2 = iD;
+                a.child1 = iE;
+                e.parent = iA;
+                setBox(iA, merge(c.box, e.box));
+                setBox(iB, merge(a.box, d.box));
+                a.height = 1 + std::max(c.height, e.height);
+                b.height = 1 + std::max(a.height, d.height);
+            } else {
+                b.child2 = iE;
+                a.child1 = iD;
+                d.parent = iA;
+                setBox(iA, merge(c.box, d.box));
+                setBox(iB, merge(a.box, e.box));
+                a.height = 1 + std::max(c.height, d.height);
+                b.height = 1 + std::max(a.height, e.height);
+            }
+            return iB;
+        }
+        return iA;
+    }
+
+    std::vector<BuildItem> snapshot() const {
+        std::vector<BuildItem> items;
+        items.reserve(leafCount);
+        for (ProxyId id = 0; id < (ProxyId)proxies.size(); ++id) {
+            if (!proxies[id].alive) continue;
+            const Bounds& box = nodes[proxies[id].leaf].box;
+            items.push_back({box, box.center(), id});
+        }
+        return items;
+    }
+
+    // Swaps in a finished build, then replays the proxies that were
+    // inserted, moved or removed while it ran
+    void adopt(BuildResult result) {
+        std::vector<Bounds> current(changedDuringBuild.size());
+        for (size_t i = 0; i < changedDuringBuild.size(); ++i) {
+            const Proxy& proxy = proxies[changedDuringBuild[i]];
+            if (proxy.alive) current[i] = nodes[proxy.leaf].box;
+        }
+
+        nodes = std::move(result.nodes);
+        root = result.root;
+        freeNodes = NONE;
+        internalArea = 0.0;
+        for (Proxy& proxy : proxies) proxy.leaf = NONE;
+        for (int32_t i = 0; i < (int32_t)nodes.size(); ++i) {
+            if (nodes[i].isLeaf()) proxies[nodes[i].proxy].leaf = i;
+            else internalArea += area(nodes[i].box);
+        }
+
+        for (size_t i = 0; i < changedDuringBuild.size(); ++i) {
+            Proxy& proxy = proxies[changedDuringBuild[i]];
+            proxy.changed = false;
+            if (proxy.leaf != NONE) {
+                removeLeaf(proxy.leaf);
+                freeNode(proxy.leaf);
+                proxy.leaf = NONE;
+            }
+            if (proxy.alive) {
+                proxy.leaf = allocateLeaf(current[i], changedDuringBuild[i]);
+                insertLeaf(proxy.leaf);
+            }
+        }
+        changedDuringBuild.clear();
+        builtCost = getCost();
+        ++rebuildCount;
+    }
+
+    // Top-down build with binned SAH splits. Runs on a worker, so it only
+    // touches its own data.
+    static BuildResult build(std::vector<BuildItem>& items) {
+        BuildResult result;
+        if (items.empty()) return result;
+        result.nodes.reserve(items.size() * 2 - 1);
+        result.root = buildNode(result.nodes, items, 0, items.size(), NONE, 0);
+        return result;
+    }
+
+    static constexpr int BUILD_BINS = 16;
+    static constexpr int BUILD_MAX_SAH_DEPTH = 64;  // median splits below this
+
+    static int32_t buildNode(std::vector<Node>& out, std::vector<BuildItem>& items, size_t begin, size_t end,
+                             int32_t parent, int depth) {
+        int32_t index = (int32_t)out.size();
+        out.emplace_back();
+        out[index].parent = parent;
+
+        Bounds box = items[begin].box;
+        Bounds centroids;
+        centroids.min = centroids.max = items[begin].centroid;
+        for (size_t i = begin + 1; i < end; ++i) {
+            box = merge(box, items[i].box);
+            centroids.min = glm::min(centroids.min, items[i].centroid);
+            centroids.max = glm::max(centroids.max, items[i].centroid);
+        }
+        out[index].box = box;
+
+        if (end - begin == 1) {
+            out[index].proxy = items[begin].proxy;
+            return index;
+        }
+
+        glm::vec3 spread = centroids.max - centroids.min;
+        int axis = spread.x > spread.y ? (spread.x > spread.z ? 0 : 2) : (spread.y > spread.z ? 1 : 2);
+        size_t mid = begin;
+        if (spread[axis] > 0.0f && depth < BUILD_MAX_SAH_DEPTH) {
+            mid = sahSplit(items, begin, end, axis, centroids.min[axis], spread[axis]);
+        }
+        if (mid == begin || mid == end) {
+            mid = begin + (end - begin) / 2;
+            std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end,
+                             [axis](const BuildItem& a, const BuildItem& b) { return a.centroid[axis] < b.centroid[axis]; });
+        }
+
+        int32_t child1 = buildNode(out, items, begin, mid, index, depth + 1);
+        int32_t child2 = buildNode(out, items, mid, end, index, depth + 1);
+        out[index].child1 = child1;
+        out[index].child2 = child2;
+        out[index].height = 1 + std::max(out[child1].height, out[child2].height);
+        return index;
+    }
+
+    // Partitions items at the cheapest of the bin boundaries along axis and
+    // returns the split point
+    static size_t sahSplit(std::vector<BuildItem>& items, size_t begin, size_t end, int axis, float origin, float spread) {
+        struct Bin {
+            Bounds box;
+            size_t count = 0;
+        };
+        Bin bins[BUILD_BINS];
+        float scale = BUILD_BINS / spread;
+        auto binOf = [&](const BuildItem& item) {
+            return std::min((int)((item.centroid[axis] - origin) * scale), BUILD_BINS - 1);
+        };
+        for (size_t i = begin; i < end; ++i) {
+            Bin& bin = bins[binOf(items[i])];
+            bin.box = bin.count ? merge(bin.box, items[i].box) : items[i].box;
+            ++bin.count;
+        }
+
+        // Area and count of everything right of each boundary
+        double rightCost[BUILD_BINS];
+        Bounds right;
+        size_t rightCount = 0;
+        for (int i = BUILD_BINS - 1; i > 0; --i) {
+            if (bins[i].count) {
+                right = rightCount ? merge(right, bins[i].box) : bins[i].box;
+                rightCount += bins[i].count;
+            }
+            rightCost[i] = rightCount ? area(right) * rightCount : 0.0;
+        }
+
+        Bounds left;
+        size_t leftCount = 0;
+        double bestCost = 0.0;
+        int bestSplit = 0;
+        for (int i = 1; i < BUILD_BINS; ++i) {
+            if (bins[i - 1].count) {
+                left = leftCount ? merge(left, bins[i - 1].box) : bins[i - 1].box;
+                leftCount += bins[i - 1].count;
+            }
+            if (!leftCount || leftCount == end - begin) continue;
+            double cost = area(left) * leftCount + rightCost[i];
+            if (!bestSplit || cost < bestCost) {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+        if (!bestSplit) return begin;
+
+        auto split = std::partition(items.begin() + begin, items.begin() + end,
+                                    [&](const BuildItem& item) { return binOf(item) < bestSplit; });
+        return (size_t)(split - items.begin());
+    }
+};
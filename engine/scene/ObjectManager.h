@@ -11,6 +11,27 @@
 #include <sstream>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <set>
+#include <unordered_map>
+
+#include "../assets/GLBFile.h"
+#include "../assets/HMeshFile.h"
+#include "../assets/ImageDecoder.h"
+#include "../assets/MeshCooker.h"
+#include "../assets/MeshOptimizer.h"
+#include "../assets/MeshSimplifier.h"
+#include "../assets/ResourceRegistry.h"
+#include "../core/JobSystem.h"
+#include "../render/CompressedTexture.h"
+#include "../render/Frustum.h"
+#include "../render/GLHandle.h"
+#include "../render/GPURingBuffer.h"
+#include "../render/RenderQueue.h"
+#include "../render/GLUploadQueue.h"
+#include "../render/ShaderReflection.h"
+#include "DynamicBVH.h"
 
 // Collision types
 enum class CollisionType {
@@ -19,163 +40,429 @@ enum class CollisionType {
     DYNAMIC = 3
 };
 
-// Simple mesh data (supports GLB format)
+// One level of detail: a range of the mesh's index buffer and its
+// object-space error against LOD 0
+struct GLBMeshLOD {
+    uint32_t indexOffset = 0;  // in indices
+    GLsizei indexCount = 0;
+    float error = 0.0f;
+};
+
+// Per-instance transform read by the INSTANCING shader keyword: the top
+// three rows of an affine model matrix, in vertex attributes 3-5 (48 bytes
+// per instance instead of 64 for a full matrix)
+struct InstanceTransform {
+    glm::vec4 rows[3];
+    
+    static InstanceTransform fromMatrix(const glm::mat4& m) {
+        InstanceTransform t;
+        for (int r = 0; r < 3; ++r) t.rows[r] = glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+        return t;
+    }
+};
+
+static constexpr GLuint INSTANCE_ATTRIBUTE = 3;
+
+// Instanced arrays are core in GL 3.3 and an extension before that
+inline bool instancingSupported() {
+    return GLEW_VERSION_3_3 || (GLEW_ARB_instanced_arrays && GLEW_ARB_draw_instanced);
+}
+
+// CPU arrays a mesh keeps after its GL upload
+enum class MeshRetention {
+    NONE,       // drop everything
+    COLLISION,  // positions and LOD 0 indices only
+    ALL
+};
+
+// Material textures are immutable once uploaded and shared, through the
+// resource registry, by every mesh whose material uses the same image
+using TextureHandle = std::shared_ptr<const GLTexture>;
+
+// Simple mesh data (supports GLB format). Owns its GL objects, so it can be
+// moved but not copied; scenes share uploaded meshes through MeshHandle.
 struct GLBMeshData {
     std::vector<glm::vec3> positions;
     std::vector<glm::vec3> normals;
     std::vector<glm::vec2> texCoords;
+    std::vector<glm::vec4> tangents;  // normal-mapped meshes only, else empty
     std::vector<unsigned int> indices;
-    GLuint VAO = 0, VBO = 0, EBO = 0;
-    GLuint baseColorTex = 0, metallicRoughnessTex = 0, normalTex = 0;
+    GLVertexArray VAO;
+    GLBuffer VBO, EBO, tangentVBO;
+    TextureHandle baseColorTex, metallicRoughnessTex, normalTex;
+    
+    // Draw parameters (u16 indices whenever the vertex count allows; direct
+    // GLB uploads keep the file's index type)
+    GLenum indexType = GL_UNSIGNED_INT;
+    GLsizei indexCount = 0;
+    
+    // LOD chain, finest first; indices holds every level back to back.
+    std::vector<GLBMeshLOD> lods;
+    
+    // Mesh-space box (before nodeTransform), set at import; objects derive
+    // their world bounds from it for culling and LOD selection
+    Bounds bounds;
+    
+    // Direct GLB uploads: one VBO per vertex bufferView, plus the node
+    // transform that the CPU path would otherwise bake into the positions
+    std::vector<GLBuffer> vertexBuffers;
+    glm::mat4 nodeTransform = glm::mat4(1.0f);
+    
+    // GPU vertex layout and the shader-side dequantization it needs
+    VertexFormat vertexFormat = VERTEX_FLOAT32;
+    VertexQuantization quantization;
+    
+    // Small number identifying the mesh in draw sort keys
+    uint32_t sortId = nextSortId();
+    
+    static uint32_t nextSortId() {
+        static std::atomic<uint32_t> next{1};
+        return next++;
+    }
+    
+    // Stores a MeshSimplifier chain as the index buffer and LOD table
+    void setLODs(const std::vector<MeshLODLevel>& chain) {
+        indices.clear();
+        lods.clear();
+        for (const MeshLODLevel& level : chain) {
+            lods.push_back({(uint32_t)indices.size(), (GLsizei)level.indices.size(), level.error});
+            indices.insert(indices.end(), level.indices.begin(), level.indices.end());
+        }
+    }
     
     void setupGL() {
         if (positions.empty() || indices.empty()) return;
+        if (lods.empty()) lods.push_back({0, (GLsizei)indices.size(), 0.0f});
+        indexCount = lods[0].indexCount;
+        
+        bounds = Bounds::fromPoints(positions.data(), positions.size());
+        
+        VAO = GLVertexArray::create();
+        VBO = GLBuffer::create();
+        EBO = GLBuffer::create();
         
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
+        glBindVertexArray(VAO.get());
         
-        glBindVertexArray(VAO);
+        // Interleave into the most compact layout that stays within tolerance
+        std::vector<uint8_t> vertexData;
+        vertexFormat = VertexPacker::chooseFormat(positions, texCoords);
+        VertexPacker::pack(vertexFormat, positions, normals, texCoords, vertexData, quantization);
         
-        // Combine position, normal and texcoord data into single vertex buffer
-        std::vector<float> vertexData;
-        for (size_t i = 0; i < positions.size(); ++i) {
-            vertexData.push_back(positions[i].x);
-            vertexData.push_back(positions[i].y);
-            vertexData.push_back(positions[i].z);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
+        glBufferData(GL_ARRAY_BUFFER, vertexData.size(), vertexData.data(), GL_STATIC_DRAW);
+        
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.get());
+        if (MeshOptimizer::fitsShortIndices(positions.size())) {
+            std::vector<uint16_t> shortIndices = MeshOptimizer::toShortIndices(indices);
+            indexType = GL_UNSIGNED_SHORT;
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+        } else {
+            indexType = GL_UNSIGNED_INT;
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        }
+        
+        VertexPacker::setupAttributes(vertexFormat);
+        
+        if (tangents.size() == positions.size()) {
+            std::vector<int16_t> tangentData;
+            VertexPacker::packTangents(tangents, tangentData);
+            tangentVBO = GLBuffer::create();
+            glBindBuffer(GL_ARRAY_BUFFER, tangentVBO.get());
+            glBufferData(GL_ARRAY_BUFFER, tangentData.size() * sizeof(int16_t), tangentData.data(), GL_STATIC_DRAW);
+            VertexPacker::setupTangentAttribute();
+        }
+        
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        
+        // Create default textures
+        createDefaultTextures();
+    }
+    
+    // Whether a single-primitive GLB can be uploaded as stored (CPU only, so
+    // it runs on the loader thread). False means the primitive needs CPU work.
+    static bool canSetupFromGLB(const GLBFile& file, const GLTFPrimitive& prim, const glm::mat4& transform) {
+        const GLTFDocument& doc = file.document();
+        std::string error;
+        
+        if (prim.indices < 0 || prim.normal < 0) return false;
+        if (glm::determinant(glm::mat3(transform)) <= 0.0f) return false;
+        // A normal map needs tangents, which the CPU path generates
+        if (prim.tangent < 0 && GLTFLoader::normalMapped(doc, prim.material)) return false;
+        
+        const GLTFAccessor* positions = doc.accessor(prim.position, error);
+        if (!positions) return false;
+        const int attributes[] = {prim.position, prim.normal, prim.texCoord0, prim.tangent};
+        const int sizes[] = {3, 3, 2, 4};
+        size_t vertexCount = positions->count;
+        for (int i = 0; i < 4; ++i) {
+            if (attributes[i] < 0) continue;
+            if (!doc.validateAccessor(attributes[i], error)) return false;
+            const GLTFAccessor& acc = doc.accessors[attributes[i]];
+            if (acc.components != sizes[i] || acc.componentType == GLTF_UNSIGNED_INT) return false;
+            vertexCount = std::min(vertexCount, acc.count);
+        }
+        
+        if (!doc.validateAccessor(prim.indices, error)) return false;
+        const GLTFAccessor& indexAcc = doc.accessors[prim.indices];
+        size_t indexSize = GLTFDocument::componentSize(indexAcc.componentType);
+        const GLTFBufferView& indexView = doc.bufferViews[indexAcc.bufferView];
+        if (indexAcc.components != 1 || indexAcc.componentType == GLTF_FLOAT ||
+            indexAcc.componentType == GLTF_BYTE || indexAcc.componentType == GLTF_SHORT ||
+            (indexView.byteStride != 0 && indexView.byteStride != indexSize)) {
+            return false;
+        }
+        ByteSpan indexData = file.bufferView(indexAcc.bufferView).subspan(indexAcc.byteOffset, indexAcc.count * indexSize);
+        
+        // The GPU must never fetch past the vertex buffers
+        for (size_t i = 0; i < indexAcc.count; ++i) {
+            uint32_t index = 0;
+            std::memcpy(&index, indexData.data + i * indexSize, indexSize);  // little-endian
+            if (index >= vertexCount) return false;
+        }
+        return true;
+    }
+    
+    // Uploads a primitive accepted by canSetupFromGLB straight from its file
+    // mapping: each vertex bufferView goes to glBufferData as stored and the
+    // attribute pointers follow the accessor layout, so no CPU vertex copy is made.
+    void setupGLFromGLB(const GLBFile& file, const GLTFPrimitive& prim, const glm::mat4& transform) {
+        const GLTFDocument& doc = file.document();
+        const int attributes[] = {prim.position, prim.normal, prim.texCoord0, prim.tangent};
+        const int sizes[] = {3, 3, 2, 4};
+        const GLuint locations[] = {0, 1, 2, VERTEX_TANGENT_ATTRIBUTE};
+        const GLTFAccessor& indexAcc = doc.accessors[prim.indices];
+        size_t indexSize = GLTFDocument::componentSize(indexAcc.componentType);
+        ByteSpan indexData = file.bufferView(indexAcc.bufferView).subspan(indexAcc.byteOffset, indexAcc.count * indexSize);
+        
+        VAO = GLVertexArray::create();
+        glBindVertexArray(VAO.get());
+        
+        std::map<int, GLuint> viewBuffers;
+        for (int i = 0; i < 4; ++i) {
+            if (attributes[i] < 0) continue;
+            const GLTFAccessor& acc = doc.accessors[attributes[i]];
             
-            if (i < normals.size()) {
-                vertexData.push_back(normals[i].x);
-                vertexData.push_back(normals[i].y);
-                vertexData.push_back(normals[i].z);
-            } else {
-                vertexData.push_back(0.0f);
-                vertexData.push_back(1.0f);
-                vertexData.push_back(0.0f);
+            GLuint& buffer = viewBuffers[acc.bufferView];
+            if (buffer == 0) {
+                ByteSpan view = file.bufferView(acc.bufferView);
+                vertexBuffers.push_back(GLBuffer::create());
+                buffer = vertexBuffers.back().get();
+                glBindBuffer(GL_ARRAY_BUFFER, buffer);
+                glBufferData(GL_ARRAY_BUFFER, view.size, view.data, GL_STATIC_DRAW);
             }
             
-            if (i < texCoords.size()) {
-                vertexData.push_back(texCoords[i].x);
-                vertexData.push_back(texCoords[i].y);
-            } else {
-                vertexData.push_back(0.0f);
-                vertexData.push_back(0.0f);
-            }
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glVertexAttribPointer(locations[i], sizes[i], acc.componentType, acc.normalized ? GL_TRUE : GL_FALSE,
+                                  (GLsizei)doc.bufferViews[acc.bufferView].byteStride, (void*)acc.byteOffset);
+            glEnableVertexAttribArray(locations[i]);
         }
         
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(float), vertexData.data(), GL_STATIC_DRAW);
+        EBO = GLBuffer::create();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.get());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexData.size, indexData.data, GL_STATIC_DRAW);
+        
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        
+        indexType = (GLenum)indexAcc.componentType;
+        indexCount = (GLsizei)indexAcc.count;
+        lods.assign(1, {0, indexCount, 0.0f});
+        nodeTransform = transform;
+    }
+    
+    // Uploads a cooked mesh from its mapping. The vertex section is already in
+    // its GPU layout, so no per-vertex work is done.
+    void setupGLFromHMesh(const HMeshFile& file) {
+        ByteSpan vertices = file.vertices();
+        const HMeshHeader& header = file.getHeader();
+        ByteSpan indexData = file.indices();
         
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        VAO = GLVertexArray::create();
+        VBO = GLBuffer::create();
+        EBO = GLBuffer::create();
+        glBindVertexArray(VAO.get());
         
-        // Position (3 floats)
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
+        glBufferData(GL_ARRAY_BUFFER, vertices.size, vertices.data, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.get());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexData.size, indexData.data, GL_STATIC_DRAW);
         
-        // Normal (3 floats)
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
+        vertexFormat = file.vertexFormat();
+        quantization = file.quantization();
+        VertexPacker::setupAttributes(vertexFormat);
         
-        // TexCoord (2 floats)
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-        glEnableVertexAttribArray(2);
+        ByteSpan tangentData = file.tangents();
+        if (tangentData.size) {
+            tangentVBO = GLBuffer::create();
+            glBindBuffer(GL_ARRAY_BUFFER, tangentVBO.get());
+            glBufferData(GL_ARRAY_BUFFER, tangentData.size, tangentData.data, GL_STATIC_DRAW);
+            VertexPacker::setupTangentAttribute();
+        }
         
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
         
-        // Create default textures
-        createDefaultTextures();
+        indexType = header.indexSize == sizeof(uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        lods.clear();
+        for (uint32_t i = 0; i < header.lodCount; ++i) {
+            HMeshLOD level = file.lod(i);
+            lods.push_back({level.indexOffset, (GLsizei)level.indexCount, level.error});
+        }
+        indexCount = lods[0].indexCount;
+        
+        bounds.min = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+        bounds.max = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
     }
     
-    void render() const {
-        if (VAO == 0) return;
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+    void render(size_t lod = 0) const {
+        if (!VAO) return;
+        glBindVertexArray(VAO.get());
+        GLsizei count;
+        const void* offset;
+        indexRange(lod, count, offset);
+        glDrawElements(GL_TRIANGLES, count, indexType, offset);
     }
     
-    void createDefaultTextures() {
-        // Create gray texture for base color (visible material)
-        if (baseColorTex == 0) {
-            glGenTextures(1, &baseColorTex);
-            glBindTexture(GL_TEXTURE_2D, baseColorTex);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, 4.0f);
-            
-            unsigned char grayPixel[] = {180, 180, 180, 255};  // Visible gray
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grayPixel);
-            glGenerateMipmap(GL_TEXTURE_2D);
+    // Draws instanceCount copies whose InstanceTransforms start at byte
+    // instanceOffset of instanceBuffer; needs instancingSupported()
+    void renderInstanced(size_t lod, GLuint instanceBuffer, size_t instanceOffset, GLsizei instanceCount) const {
+        if (!VAO || instanceCount <= 0) return;
+        glBindVertexArray(VAO.get());
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        for (GLuint row = 0; row < 3; ++row) {
+            GLuint attribute = INSTANCE_ATTRIBUTE + row;
+            size_t byteOffset = instanceOffset + row * sizeof(glm::vec4);
+            glVertexAttribPointer(attribute, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform), (void*)byteOffset);
+            glEnableVertexAttribArray(attribute);
+            if (GLEW_VERSION_3_3) glVertexAttribDivisor(attribute, 1);
+            else glVertexAttribDivisorARB(attribute, 1);
         }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
         
-        // Create metallic/roughness texture (smooth and less metallic)
-        if (metallicRoughnessTex == 0) {
-            glGenTextures(1, &metallicRoughnessTex);
-            glBindTexture(GL_TEXTURE_2D, metallicRoughnessTex);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, 4.0f);
-            
-            // R: unused, G: roughness (0.7), B: metallic (0.2), A: AO
-            unsigned char mrPixel[] = {255, 178, 51, 255};
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, mrPixel);
-            glGenerateMipmap(GL_TEXTURE_2D);
+        GLsizei count;
+        const void* offset;
+        indexRange(lod, count, offset);
+        if (GLEW_VERSION_3_1) glDrawElementsInstanced(GL_TRIANGLES, count, indexType, offset, instanceCount);
+        else glDrawElementsInstancedARB(GL_TRIANGLES, count, indexType, offset, instanceCount);
+    }
+    
+    void indexRange(size_t lod, GLsizei& count, const void*& offset) const {
+        if (lods.empty()) {
+            count = indexCount;
+            offset = nullptr;
+            return;
         }
+        const GLBMeshLOD& level = lods[std::min(lod, lods.size() - 1)];
+        size_t indexSize = indexType == GL_UNSIGNED_SHORT ? 2 : indexType == GL_UNSIGNED_BYTE ? 1 : 4;
+        count = level.indexCount;
+        offset = (const void*)(level.indexOffset * indexSize);
+    }
+    
+    // Slots without a material texture get 1x1 defaults shared by every mesh
+    void createDefaultTextures() {
+        static const uint8_t grayPixel[] = {180, 180, 180, 255};  // Visible gray
+        // R: unused, G: roughness (0.7), B: metallic (0.2), A: AO
+        static const uint8_t mrPixel[] = {255, 178, 51, 255};
+        static const uint8_t normalPixel[] = {128, 128, 255, 255};  // Neutral blue
         
-        // Create normal texture (neutral blue)
-        if (normalTex == 0) {
-            glGenTextures(1, &normalTex);
-            glBindTexture(GL_TEXTURE_2D, normalTex);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, 4.0f);
-            
-            unsigned char normalPixel[] = {128, 128, 255, 255};
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, normalPixel);
+        if (!baseColorTex) baseColorTex = solidTexture(grayPixel);
+        if (!metallicRoughnessTex) metallicRoughnessTex = solidTexture(mrPixel);
+        if (!normalTex) normalTex = solidTexture(normalPixel);
+    }
+    
+    static TextureHandle solidTexture(const uint8_t* pixel) {
+        return ResourceRegistry::getInstance().acquire<const GLTexture>(ContentHash::hash(pixel, 4), [pixel]() {
+            GLTexture texture = createMaterialTexture();
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
             glGenerateMipmap(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            return std::make_shared<const GLTexture>(std::move(texture));
+        });
+    }
+    
+    // Uploads a decoded image with its CPU-built mip chain (no glGenerateMipmap)
+    static TextureHandle uploadTexture(const DecodedImage& image) {
+        if (!image.valid()) return nullptr;
+        
+        GLTexture texture = createMaterialTexture();
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image.levels.size() - 1);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (size_t i = 0; i < image.levels.size(); ++i) {
+            glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_RGBA, image.levels[i].width, image.levels[i].height, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, image.level(i));
         }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return std::make_shared<const GLTexture>(std::move(texture));
     }
     
-    void loadTextureFromPNG(GLuint& textureId, const std::vector<char>& pngData) {
-        if (textureId != 0) return;
+    // Uploads a cooked, block-compressed mip chain
+    static TextureHandle uploadTexture(const HTexView& cooked) {
+        if (!cooked.valid()) return nullptr;
         
-        // Simple PPM-like approach: save PNG to temp file and use stb_image equivalent
-        // For now, create a placeholder colored texture based on hash
-        glGenTextures(1, &textureId);
-        glBindTexture(GL_TEXTURE_2D, textureId);
+        GLTexture texture = createMaterialTexture();
+        CompressedTexture::upload(cooked);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return std::make_shared<const GLTexture>(std::move(texture));
+    }
+    
+    // New texture, left bound, with the material sampling state
+    static GLTexture createMaterialTexture() {
+        GLTexture texture = GLTexture::create();
+        glBindTexture(GL_TEXTURE_2D, texture.get());
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, 4.0f);
-        
-        // Use a simple color based on PNG data hash
-        unsigned char hash = 0;
-        for (size_t i = 0; i < std::min(size_t(100), pngData.size()); ++i) {
-            hash = hash * 31 + (unsigned char)pngData[i];
-        }
-        
-        unsigned char colorPixel[] = {hash, (unsigned char)(hash * 2), (unsigned char)(hash * 3), 255};
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, colorPixel);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        return texture;
     }
     
-    void cleanup() {
-        if (VAO) glDeleteVertexArrays(1, &VAO);
-        if (VBO) glDeleteBuffers(1, &VBO);
-        if (EBO) glDeleteBuffers(1, &EBO);
-        if (baseColorTex) glDeleteTextures(1, &baseColorTex);
-        if (metallicRoughnessTex) glDeleteTextures(1, &metallicRoughnessTex);
-        if (normalTex) glDeleteTextures(1, &normalTex);
+    // Frees CPU arrays the GPU copy has made redundant
+    void releaseCPUData(MeshRetention retention) {
+        if (retention == MeshRetention::ALL) return;
+        std::vector<glm::vec3>().swap(normals);
+        std::vector<glm::vec2>().swap(texCoords);
+        std::vector<glm::vec4>().swap(tangents);
+        if (retention == MeshRetention::COLLISION && !lods.empty()) {
+            indices.resize(std::min(indices.size(), (size_t)lods[0].indexOffset + lods[0].indexCount));
+            indices.shrink_to_fit();
+            return;
+        }
+        std::vector<glm::vec3>().swap(positions);
+        std::vector<unsigned int>().swap(indices);
     }
 };
 
+// Uploaded meshes are immutable and shared by every object using the model
+using MeshHandle = std::shared_ptr<const GLBMeshData>;
+
+// One material slot of a prepared model: its source bytes, what the workers
+// made of them and the content hash the texture is registered under.
+// resident is set when an identical texture was already on the GPU, in which
+// case the workers decode nothing. Only the hash is kept, never a handle:
+// workers own this, and must not drop the last reference to a GL object.
+struct PreparedTexture {
+    GLTFImageRef encoded;
+    HTexView cooked;
+    DecodedImage pixels;
+    uint64_t hash = 0;
+    bool resident = false;
+};
+
+// CPU half of a model load, built on a worker thread and uploaded on the GL
+// thread. cooked or directPrimitive is set when the data can go to the GPU
+// as stored; otherwise mesh holds the flattened arrays.
+struct PreparedModel {
+    std::shared_ptr<HMeshFile> cooked;
+    std::shared_ptr<GLBFile> file;
+    const GLTFPrimitive* directPrimitive = nullptr;
+    glm::mat4 directTransform = glm::mat4(1.0f);
+    GLBMeshData mesh;
+    PreparedTexture textures[HMESH_TEXTURE_SLOTS];  // indexed by HMeshTextureSlot
+};
+
 // 3D Object in scene
 struct SceneObject {
     int id;
@@ -184,11 +471,38 @@ struct SceneObject {
     glm::vec3 rotation;
     glm::vec3 scale;
     CollisionType collisionType;
-    GLBMeshData mesh;
+    MeshHandle mesh;
+    size_t lod = 0;  // LOD drawn last frame, for hysteresis
+    
+    // World transform and bounds, as of the last updateWorld()
+    glm::mat4 worldMatrix = glm::mat4(1.0f);
+    Bounds worldBounds;
+    float worldRadius = 0.0f;  // of a sphere around worldBounds.center()
+    float worldScale = 1.0f;   // largest axis scale
+    DynamicBVH::ProxyId bvhProxy = DynamicBVH::NONE;
+    bool tracked = false;      // handed out by getObject, so it may move
     
     SceneObject(int id_, const std::string& path, const glm::vec3& pos, CollisionType col)
         : id(id_), modelPath(path), position(pos), rotation(0.0f), scale(1.0f), collisionType(col) {}
     
+    // Recomputes the world values only if the transform or mesh changed;
+    // returns true if it did
+    bool updateWorld() {
+        if (mesh.get() == worldMesh && position == worldPosition && rotation == worldRotation && scale == worldScaleXYZ) return false;
+        worldMesh = mesh.get();
+        worldPosition = position;
+        worldRotation = rotation;
+        worldScaleXYZ = scale;
+        
+        worldMatrix = getModelMatrix() * mesh->nodeTransform;
+        worldBounds = mesh->bounds.transformed(worldMatrix);
+        worldScale = std::max(glm::length(glm::vec3(worldMatrix[0])),
+                              std::max(glm::length(glm::vec3(worldMatrix[1])), glm::length(glm::vec3(worldMatrix[2]))));
+        // Both spheres share the box center; keep the smaller
+        worldRadius = std::min(worldBounds.radius(), mesh->bounds.radius() * worldScale);
+        return true;
+    }
+    
     glm::mat4 getModelMatrix() const {
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, position);
@@ -198,14 +512,83 @@ struct SceneObject {
         model = glm::scale(model, scale);
         return model;
     }
+    
+private:
+    const GLBMeshData* worldMesh = nullptr;
+    glm::vec3 worldPosition, worldRotation, worldScaleXYZ;
 };
 
 // Scene manager - handles object placement and rendering
 class SceneManager {
 private:
     std::vector<SceneObject> objects;
-    std::map<std::string, GLBMeshData> meshCache;
+    std::unordered_map<int, size_t> objectIndex;  // id -> position in objects
     int nextObjectId = 1;
+    MeshRetention cpuRetention = MeshRetention::COLLISION;
+
+    // Largest screen-space error, in pixels, a LOD may show before a finer one is used
+    float lodPixelError = 1.0f;
+    static constexpr float LOD_HYSTERESIS = 0.75f;
+    static constexpr float LOD_MIN_DISTANCE = 0.1f;
+
+    // Models being prepared on worker threads; their objects draw the
+    // placeholder until the upload task runs on the GL thread
+    std::set<std::string> pendingModels;
+    MeshHandle placeholderMesh;
+    
+    // Preloaded models no object uses yet, kept resident until one does
+    std::map<std::string, MeshHandle> preloads;
+    
+    // Upload tasks hold a weak reference so they are dropped once the scene
+    // is cleaned up or destroyed
+    std::shared_ptr<bool> alive = std::make_shared<bool>(true);
+    
+    // Per-frame draw list, reused across frames. With an instanced program,
+    // objects sharing a mesh and LOD become one instanced draw whose
+    // transforms are streamed through the GPURingBuffer.
+    struct ObjectDraw {
+        const GLBMeshData* mesh;
+        size_t lod;
+        size_t object;
+    };
+    std::vector<ObjectDraw> drawList;
+    
+    // World boxes of all objects, indexed by position in objects. Only
+    // objects given out by getObject can move, so only those are re-checked.
+    DynamicBVH bvh;
+    std::vector<int> trackedObjects;
+    
+    // Visibility and draw generation run on the JobSystem, one part of the
+    // BVH per CullPart; parts write only their own lists, which are merged
+    // into drawQueue and sorted on the GL thread. Objects whose BVH leaf
+    // straddles the frustum go through the part's sphere culler, then boxes.
+    struct CullPart {
+        DynamicBVH::FrustumPart subtree;
+        std::vector<ObjectDraw> draws;
+        std::vector<uint64_t> keys;
+        std::vector<int32_t> stack;
+        FrustumCuller culler;
+        std::vector<uint32_t> partial;
+        std::vector<uint32_t> hits;
+    };
+    struct CullView {
+        Frustum frustum;
+        glm::vec3 cameraPos;
+        float pixelScale;
+        float depthScale;  // 1 / far plane distance
+    };
+    std::vector<DynamicBVH::FrustumPart> frustumParts;
+    std::vector<CullPart> cullParts;
+    std::vector<ObjectDraw> mergedDraws;
+    RenderQueue drawQueue;
+    CullStats cullStats;
+    
+    // Smaller scenes are culled on the calling thread alone
+    static constexpr size_t PARALLEL_CULL_MIN_OBJECTS = 4096;
+    static constexpr size_t CULL_PARTS_PER_THREAD = 4;
+    // Instance transforms written per job
+    static constexpr size_t TRANSFORM_BATCH = 8192;
+    size_t drawCalls = 0;
     
 public:
     SceneManager() = default;
@@ -232,15 +615,17 @@ public:
         obj.rotation = rot;
         obj.scale = scl;
         
-        // Load or use cached mesh
-        if (meshCache.find(modelPath) == meshCache.end()) {
-            std::cout << "[*] Loading model: " << modelPath << "\n";
-            GLBMeshData mesh = loadModel(modelPath);
-            mesh.setupGL();
-            meshCache[modelPath] = mesh;
+        // Use the resident mesh, or the placeholder while the model streams in
+        if (MeshHandle resident = ResourceRegistry::getInstance().findPath<const GLBMeshData>(modelPath)) {
+            obj.mesh = resident;
+        } else {
+            obj.mesh = getPlaceholderMesh();
+            requestModel(modelPath);
         }
-        
-        obj.mesh = meshCache[modelPath];
+        preloads.erase(modelPath);
+        obj.updateWorld();
+        obj.bvhProxy = bvh.insert(obj.worldBounds, (uint32_t)objects.size());
+        objectIndex[obj.id] = objects.size();
         objects.push_back(obj);
         
         std::cout << "[OK] Object #" << (nextObjectId - 1) << " placed at (" 
@@ -252,389 +637,616 @@ public:
         return nextObjectId - 1;
     }
     
+    // Starts loading a model before any object is placed with it, e.g.
+    // while the window and GL context are still being created. Needs no GL;
+    // the mesh stays resident until an object uses it or the scene is cleaned up.
+    void preloadModel(const std::string& modelPath) {
+        if (ResourceRegistry::getInstance().findPath<const GLBMeshData>(modelPath)) return;
+        preloads[modelPath];
+        requestModel(modelPath);
+    }
+    
     void renderAll(GLuint shaderProgram, const glm::mat4& view, const glm::mat4& projection, float time) {
-        glUseProgram(shaderProgram);
+        renderAll(shaderProgram, 0, view, projection, time);
+    }
+    
+    // instancedProgram is a variant of shaderProgram with the INSTANCING
+    // keyword; when given (and the driver has instanced arrays) it draws
+    // every object, one draw call per mesh and LOD. Otherwise each object
+    // is drawn on its own with shaderProgram.
+    void renderAll(GLuint shaderProgram, GLuint instancedProgram, const glm::mat4& view, const glm::mat4& projection, float time) {
+        // Screen pixels covered by one world unit at distance 1
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        CullView cullView;
+        cullView.frustum = Frustum::fromViewProjection(projection * view);
+        cullView.cameraPos = glm::vec3(glm::inverse(view)[3]);
+        cullView.pixelScale = projection[1][1] * viewport[3] * 0.5f;
+        // Far plane distance, from the projection's depth terms
+        float farDistance = projection[3][2] / (projection[2][2] + 1.0f);
+        cullView.depthScale = farDistance > 0.0f && std::isfinite(farDistance) ? 1.0f / farDistance : 0.0f;
         
-        GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
-        GLint viewLoc = glGetUniformLocation(shaderProgram, "view");
-        GLint projLoc = glGetUniformLocation(shaderProgram, "projection");
-        GLint timeLoc = glGetUniformLocation(shaderProgram, "time");
+        // Only the BVH edits stay serial; everything up to the GL calls
+        // runs on the workers
+        refreshTracked();
+        bvh.update();
+        buildDrawList(cullView);
+        cullStats.visible = drawList.size();
+        cullStats.culled = objects.size() - drawList.size();
         
-        GLint baseColorTexLoc = glGetUniformLocation(shaderProgram, "baseColorTex");
-        GLint metallicRoughnessTexLoc = glGetUniformLocation(shaderProgram, "metallicRoughnessTex");
-        GLint normalTexLoc = glGetUniformLocation(shaderProgram, "normalTex");
+        drawCalls = 0;
+        bool instanced = instancedProgram && instancingSupported() && renderInstanced(instancedProgram, view, projection, time);
+        if (!instanced) renderSingle(shaderProgram, view, projection, time);
+    }
+    
+    size_t getObjectCount() const {
+        return objects.size();
+    }
+    
+    // Draw calls issued by the last renderAll
+    size_t getDrawCalls() const {
+        return drawCalls;
+    }
+    
+    // Objects drawn and frustum-culled by the last renderAll
+    CullStats getCullStats() const {
+        return cullStats;
+    }
+    
+    // Spatial index over the objects' world boxes, for its statistics
+    const DynamicBVH& getSpatialIndex() const {
+        return bvh;
+    }
+    
+    // Id of the nearest object whose world box the ray hits within
+    // maxDistance (in units of direction), or 0 if none does
+    int raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float* hitDistance = nullptr) {
+        refreshTracked();
+        glm::vec3 invDir = 1.0f / direction;
+        int hitId = 0;
+        bvh.raycast(origin, direction, maxDistance, [&](uint32_t i, float) {
+            float entry;
+            if (objects[i].worldBounds.intersectsRay(origin, invDir, maxDistance, entry)) {
+                maxDistance = entry;
+                hitId = objects[i].id;
+            }
+            return maxDistance;
+        });
+        if (hitId && hitDistance) *hitDistance = maxDistance;
+        return hitId;
+    }
+    
+    // Ids of the objects whose world boxes overlap box
+    std::vector<int> queryBox(const Bounds& box) {
+        refreshTracked();
+        std::vector<int> ids;
+        bvh.queryBox(box, [&](uint32_t i) {
+            if (objects[i].worldBounds.overlaps(box)) ids.push_back(objects[i].id);
+        });
+        return ids;
+    }
+    
+    // Coarsest LOD whose error projects to at most lodPixelError pixels.
+    // Switching to a coarser LOD needs the error to be LOD_HYSTERESIS below
+    // the threshold, so objects near a boundary do not flicker between levels.
+    // Uses the world bounds from the object's last updateWorld().
+    size_t selectLOD(const SceneObject& obj, const glm::vec3& cameraPos, float pixelScale) const {
+        const std::vector<GLBMeshLOD>& lods = obj.mesh->lods;
+        if (lods.size() < 2) return 0;
         
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-        glUniform1f(timeLoc, time);
+        float distance = std::max(glm::length(obj.worldBounds.center() - cameraPos) - obj.worldRadius, LOD_MIN_DISTANCE);
+        float pixelsPerUnit = pixelScale * obj.worldScale / distance;
         
-        for (auto& obj : objects) {
-            glm::mat4 modelMat = obj.getModelMatrix();
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(modelMat));
-            
-            // Bind textures
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, obj.mesh.baseColorTex);
-            glUniform1i(baseColorTexLoc, 0);
-            
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, obj.mesh.metallicRoughnessTex);
-            glUniform1i(metallicRoughnessTexLoc, 1);
-            
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, obj.mesh.normalTex);
-            glUniform1i(normalTexLoc, 2);
-            
-            obj.mesh.render();
+        size_t target = 0;
+        for (size_t i = lods.size() - 1; i > 0; --i) {
+            if (lods[i].error * pixelsPerUnit <= lodPixelError) {
+                target = i;
+                break;
+            }
         }
+        while (target > obj.lod && lods[target].error * pixelsPerUnit > lodPixelError * LOD_HYSTERESIS) --target;
+        return target;
     }
     
+    void setLODPixelError(float pixels) {
+        lodPixelError = pixels;
+    }
+    
+    // CPU arrays kept by meshes uploaded from now on
+    void setMeshRetention(MeshRetention retention) {
+        cpuRetention = retention;
+    }
+    
+    // Number of models still loading in the background
+    size_t pendingModelCount() const {
+        return pendingModels.size();
+    }
+    
+    // The pointer is valid until the next placeObject or removeObject.
+    // Changes to the transform are picked up by the next renderAll or query.
     SceneObject* getObject(int id) {
-        for (auto& obj : objects) {
-            if (obj.id == id) return &obj;
+        auto found = objectIndex.find(id);
+        if (found == objectIndex.end()) return nullptr;
+        SceneObject& obj = objects[found->second];
+        if (!obj.tracked) {
+            obj.tracked = true;
+            trackedObjects.push_back(id);
         }
-        return nullptr;
+        return &obj;
     }
     
+    // The last object takes the removed one's place
     void removeObject(int id) {
-        objects.erase(std::remove_if(objects.begin(), objects.end(),
-            [id](const SceneObject& obj) { return obj.id == id; }), objects.end());
+        auto found = objectIndex.find(id);
+        if (found == objectIndex.end()) return;
+        size_t index = found->second;
+        objectIndex.erase(found);
+        bvh.remove(objects[index].bvhProxy);
+        if (index + 1 != objects.size()) {
+            objects[index] = std::move(objects.back());
+            objectIndex[objects[index].id] = index;
+            bvh.setUserData(objects[index].bvhProxy, (uint32_t)index);
+        }
+        objects.pop_back();
     }
     
     void cleanup() {
-        for (auto& [path, mesh] : meshCache) {
-            mesh.cleanup();
-        }
+        bvh.clear();
+        objectIndex.clear();
+        trackedObjects.clear();
+        placeholderMesh.reset();
         objects.clear();
-        meshCache.clear();
+        pendingModels.clear();
+        preloads.clear();
+        alive = std::make_shared<bool>(true);
     }
     
 private:
-    GLBMeshData loadModel(const std::string& filePath) {
-        // Load GLB format
-        if (filePath.substr(filePath.find_last_of(".") + 1) != "glb") {
-            std::cerr << "[ERROR] Only GLB format is supported. Expected .glb file: " << filePath << "\n";
-            return createDefaultCube();
+    // Culls the parts of the BVH in parallel and merges what each found
+    // into drawList, ordered by sort key: grouped by mesh, then LOD, so both
+    // render paths bind each mesh's textures once, and front to back within
+    // a group
+    void buildDrawList(const CullView& cullView) {
+        JobSystem& jobs = JobSystem::getInstance();
+        size_t threads = objects.size() < PARALLEL_CULL_MIN_OBJECTS ? 1 : jobs.workerCount() + 1;
+        bvh.splitFrustumQuery(cullView.frustum, threads * CULL_PARTS_PER_THREAD, frustumParts);
+        if (cullParts.size() < frustumParts.size()) cullParts.resize(frustumParts.size());
+        for (size_t i = 0; i < frustumParts.size(); ++i) cullParts[i].subtree = frustumParts[i];
+        
+        if (threads == 1) {
+            for (size_t i = 0; i < frustumParts.size(); ++i) cullPart(cullParts[i], cullView);
+        } else {
+            jobs.parallelFor(frustumParts.size(), [this, &cullView](size_t i) { cullPart(cullParts[i], cullView); });
         }
         
-        return loadGLB(filePath);
+        // Merged in part order, so equal keys keep a stable order
+        mergedDraws.clear();
+        drawQueue.clear();
+        for (size_t p = 0; p < frustumParts.size(); ++p) {
+            const CullPart& part = cullParts[p];
+            for (size_t i = 0; i < part.draws.size(); ++i) {
+                drawQueue.push(part.keys[i], (uint32_t)mergedDraws.size());
+                mergedDraws.push_back(part.draws[i]);
+            }
+        }
+        drawQueue.sort();
+        drawList.clear();
+        for (const RenderQueue::Entry& entry : drawQueue.getEntries()) drawList.push_back(mergedDraws[entry.command]);
     }
     
-    GLBMeshData loadGLB(const std::string& filePath) {
-        GLBMeshData mesh;
+    // Worker thread: visibility, LOD and sort key for the objects of one
+    // part. Each object is in exactly one part, so writing its lod is safe.
+    void cullPart(CullPart& part, const CullView& cullView) {
+        part.draws.clear();
+        part.keys.clear();
+        part.partial.clear();
+        part.culler.clear();
         
-        std::cout << "[*] Loading GLB file: " << filePath << "\n";
-        
-        // GLB format: 12-byte header + JSON chunk + BIN chunk
-        std::ifstream file(filePath, std::ios::binary);
-        if (!file.is_open()) {
-            std::cerr << "[ERROR] Could not open GLB file: " << filePath << "\n";
-            return createDefaultCube();
-        }
-        
-        // Read header
-        uint32_t magic, version, length;
-        file.read(reinterpret_cast<char*>(&magic), 4);
-        file.read(reinterpret_cast<char*>(&version), 4);
-        file.read(reinterpret_cast<char*>(&length), 4);
+        auto emit = [&](uint32_t i) {
+            SceneObject& obj = objects[i];
+            obj.lod = selectLOD(obj, cullView.cameraPos, cullView.pixelScale);
+            float depth = glm::length(obj.worldBounds.center() - cullView.cameraPos) * cullView.depthScale;
+            // A GLB mesh carries its own textures, so it takes the material
+            // slot; each LOD is its own index range, so it takes the mesh slot
+            part.keys.push_back(RenderSortKey::make(RenderPass::SOLID, 0, obj.mesh->sortId, 0, (uint32_t)obj.lod, depth));
+            part.draws.push_back({obj.mesh.get(), obj.lod, i});
+        };
         
-        if (magic != 0x46546C67) { // "glTF" in little-endian
-            std::cerr << "[ERROR] Invalid GLB magic number\n";
-            return createDefaultCube();
+        // The BVH accepts or rejects whole subtrees; objects on the frustum's
+        // edge go through the spheres, four at a time, then their boxes
+        bvh.queryFrustum(cullView.frustum, part.subtree, part.stack, [&](uint32_t i, bool fullyInside) {
+            if (fullyInside) {
+                emit(i);
+                return;
+            }
+            part.partial.push_back(i);
+            part.culler.add(objects[i].worldBounds.center(), objects[i].worldRadius);
+        });
+        part.hits.clear();
+        part.culler.cull(cullView.frustum, part.hits);
+        for (uint32_t hit : part.hits) {
+            uint32_t i = part.partial[hit];
+            if (cullView.frustum.intersectsBox(objects[i].worldBounds)) emit(i);
         }
-        
-        if (version != 2) {
-            std::cerr << "[ERROR] Unsupported GLB version: " << version << "\n";
-            return createDefaultCube();
+    }
+    
+    void refreshBounds(SceneObject& obj) {
+        if (obj.updateWorld()) bvh.move(obj.bvhProxy, obj.worldBounds);
+    }
+    
+    // Moves the BVH leaves of objects edited through getObject; ids of
+    // removed objects are dropped
+    void refreshTracked() {
+        for (size_t i = 0; i < trackedObjects.size();) {
+            auto found = objectIndex.find(trackedObjects[i]);
+            if (found == objectIndex.end()) {
+                trackedObjects[i] = trackedObjects.back();
+                trackedObjects.pop_back();
+                continue;
+            }
+            refreshBounds(objects[found->second]);
+            ++i;
         }
-        
-        // Read JSON chunk
-        uint32_t jsonChunkLength, jsonChunkType;
-        file.read(reinterpret_cast<char*>(&jsonChunkLength), 4);
-        file.read(reinterpret_cast<char*>(&jsonChunkType), 4);
-        
-        std::string jsonContent(jsonChunkLength, '\0');
-        file.read(&jsonContent[0], jsonChunkLength);
-        
-        // Read BIN chunk
-        uint32_t binChunkLength, binChunkType;
-        file.read(reinterpret_cast<char*>(&binChunkLength), 4);
-        file.read(reinterpret_cast<char*>(&binChunkType), 4);
-        
-        std::vector<char> binaryData(binChunkLength);
-        file.read(binaryData.data(), binChunkLength);
-        file.close();
-        
-        return loadBinaryData(binaryData, jsonContent);
     }
     
-    GLBMeshData loadBinaryData(const std::vector<char>& binaryData, const std::string& jsonContent) {
-        GLBMeshData mesh;
+    // Binds the program and sets what every draw of the frame shares
+    static ParameterBlock& beginPass(GLuint program, const glm::mat4& view, const glm::mat4& projection, float time) {
+        static const UniformId viewId = UniformNames::id("view");
+        static const UniformId projectionId = UniformNames::id("projection");
+        static const UniformId timeId = UniformNames::id("time");
+        static const UniformId baseColorTexId = UniformNames::id("baseColorTex");
+        static const UniformId metallicRoughnessTexId = UniformNames::id("metallicRoughnessTex");
+        static const UniformId normalTexId = UniformNames::id("normalTex");
         
-        std::cout << "[*] Binary size: " << binaryData.size() << " bytes\n";
-        
-        // Parse JSON to extract accessor and bufferView information
-        // Find position accessor (usually first one with VEC3 type)
-        size_t posAccessorIdx = 0;
-        size_t indAccessorIdx = 4;  // Usually indices are at index 4
-        
-        // Extract position count
-        size_t acc0Pos = jsonContent.find("\"accessors\":[");
-        size_t countPos = jsonContent.find("\"count\":", acc0Pos);
-        int positionCount = std::stoi(jsonContent.substr(countPos + 8));
-        
-        std::cout << "[*] Position count: " << positionCount << "\n";
-        
-        // Find index count (look for SCALAR type accessor)
-        size_t scalarPos = jsonContent.find("\"type\":\"SCALAR\"");
-        if (scalarPos != std::string::npos) {
-            size_t countBefore = jsonContent.rfind("\"count\":", scalarPos);
-            if (countBefore != std::string::npos) {
-                size_t countEnd = jsonContent.find(",", countBefore);
-                std::string countStr = jsonContent.substr(countBefore + 8, countEnd - countBefore - 8);
-                int indexCount = std::stoi(countStr);
-                std::cout << "[*] Index count: " << indexCount << "\n";
+        glUseProgram(program);
+        ParameterBlock& params = ShaderReflection::getInstance().parameters(program);
+        params.set(viewId, view);
+        params.set(projectionId, projection);
+        params.set(timeId, time);
+        params.set(baseColorTexId, 0);
+        params.set(metallicRoughnessTexId, 1);
+        params.set(normalTexId, 2);
+        return params;
+    }
+    
+    // Material textures and vertex dequantization of a mesh
+    static void bindMesh(ParameterBlock& params, const GLBMeshData& mesh) {
+        VertexPacker::applyQuantization(params, mesh.quantization);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, mesh.baseColorTex->get());
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, mesh.metallicRoughnessTex->get());
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, mesh.normalTex->get());
+    }
+    
+    void renderSingle(GLuint program, const glm::mat4& view, const glm::mat4& projection, float time) {
+        static const UniformId modelId = UniformNames::id("model");
+        ParameterBlock& params = beginPass(program, view, projection, time);
+        const GLBMeshData* boundMesh = nullptr;
+        for (const ObjectDraw& draw : drawList) {
+            if (draw.mesh != boundMesh) {
+                bindMesh(params, *draw.mesh);
+                boundMesh = draw.mesh;
             }
+            params.set(modelId, objects[draw.object].worldMatrix);
+            params.apply();
+            draw.mesh->render(draw.lod);
+            ++drawCalls;
         }
+    }
+    
+    // Returns false, having drawn nothing, when the frame's ring buffer
+    // region has no room for the transforms
+    bool renderInstanced(GLuint program, const glm::mat4& view, const glm::mat4& projection, float time) {
+        if (drawList.empty()) return true;
         
-        // Find bufferView indices
-        // Position uses bufferView 2
-        // Indices use bufferView 0
-        size_t bufferViewPos = jsonContent.find("\"bufferViews\":[");
-        
-        int positionByteOffset = -1;
-        int indicesByteOffset = -1;
-        
-        // Extract all byteOffsets from bufferViews
-        size_t offsetSearch = bufferViewPos;
-        std::vector<int> byteOffsets;
+        // Every transform of the frame is written straight into the ring,
+        // in batches across the workers
+        GPURingBuffer& ring = GPURingBuffer::getInstance();
+        GPURingBuffer::Allocation transforms = ring.allocate(drawList.size() * sizeof(InstanceTransform));
+        if (!transforms) return false;
+        InstanceTransform* out = static_cast<InstanceTransform*>(transforms.data);
+        size_t batches = (drawList.size() + TRANSFORM_BATCH - 1) / TRANSFORM_BATCH;
+        JobSystem::getInstance().parallelFor(batches, [this, out](size_t batch) {
+            size_t end = std::min(drawList.size(), (batch + 1) * TRANSFORM_BATCH);
+            for (size_t i = batch * TRANSFORM_BATCH; i < end; ++i) {
+                out[i] = InstanceTransform::fromMatrix(objects[drawList[i].object].worldMatrix);
+            }
+        });
+        ring.commit(transforms);
         
-        while (true) {
-            size_t offset = jsonContent.find("\"byteOffset\":", offsetSearch);
-            if (offset == std::string::npos || offset > jsonContent.find("\"buffers\":[")) break;
+        ParameterBlock& params = beginPass(program, view, projection, time);
+        size_t first = 0;
+        while (first < drawList.size()) {
+            const ObjectDraw& head = drawList[first];
+            size_t end = first + 1;
+            while (end < drawList.size() && drawList[end].mesh == head.mesh && drawList[end].lod == head.lod) ++end;
             
-            std::string offsetStr = jsonContent.substr(offset + 13);
-            size_t commaPos = offsetStr.find_first_of(",}");
-            int byteOffset = std::stoi(offsetStr.substr(0, commaPos));
-            byteOffsets.push_back(byteOffset);
-            
-            offsetSearch = offset + 50;
-        }
-        
-        // Handle missing first offset (defaults to 0)
-        if (!byteOffsets.empty()) {
-            indicesByteOffset = 0;  // BufferView 0 starts at 0
-            if (byteOffsets.size() > 2) {
-                positionByteOffset = byteOffsets[1];  // BufferView 2 second in list
-            }
+            if (first == 0 || drawList[first - 1].mesh != head.mesh) bindMesh(params, *head.mesh);
+            params.apply();
+            head.mesh->renderInstanced(head.lod, transforms.buffer, transforms.offset + first * sizeof(InstanceTransform),
+                                       (GLsizei)(end - first));
+            ++drawCalls;
+            first = end;
         }
-        
-        std::cout << "[*] Indices offset: " << indicesByteOffset << ", Position offset: " << positionByteOffset << "\n";
-        
-        if (positionByteOffset < 0) {
-            std::cerr << "[ERROR] Could not determine buffer offsets\n";
-            return createDefaultCube();
+        return true;
+    }
+    
+    const MeshHandle& getPlaceholderMesh() {
+        if (!placeholderMesh) {
+            GLBMeshData cube = createDefaultCube();
+            cube.setupGL();
+            cube.releaseCPUData(MeshRetention::NONE);
+            placeholderMesh = std::make_shared<const GLBMeshData>(std::move(cube));
         }
+        return placeholderMesh;
+    }
+    
+    // Prepares the model on a worker and queues its GL upload; each path is
+    // only requested once no matter how many objects use it. Meshes live in
+    // the resource registry under their file's content hash, so a model that
+    // is already resident (under this or another path) is not loaded again,
+    // and it is unloaded when the last object using it goes away. Workers
+    // only ever hold hashes; handles are taken on the GL thread, so the last
+    // reference to a mesh or texture is never dropped anywhere else.
+    void requestModel(const std::string& modelPath) {
+        if (!pendingModels.insert(modelPath).second) return;
+        std::cout << "[*] Loading model: " << modelPath << "\n";
         
-        int indexCount = 4542;  // Will refine this later
-        
-        // Extract indices (uint32) from bufferView 0
-        if (indicesByteOffset >= 0 && indicesByteOffset + indexCount * 4 <= (int)binaryData.size()) {
-            for (int i = 0; i < indexCount; ++i) {
-                int offset = indicesByteOffset + i * 4;
-                unsigned int idx = *reinterpret_cast<const unsigned int*>(binaryData.data() + offset);
-                mesh.indices.push_back(idx);
+        std::weak_ptr<bool> owner = alive;
+        JobSystem::getInstance().enqueue([this, owner, modelPath]() {
+            uint64_t hash = modelHash(modelPath);
+            if (ResourceRegistry::getInstance().contains<const GLBMeshData>(hash)) {
+                GLUploadQueue::getInstance().push([this, owner, modelPath, hash]() {
+                    if (owner.expired()) return;
+                    MeshHandle resident = ResourceRegistry::getInstance().find<const GLBMeshData>(hash);
+                    if (!resident) {
+                        // Unloaded since the worker looked; load it after all
+                        pendingModels.erase(modelPath);
+                        requestModel(modelPath);
+                        return;
+                    }
+                    onModelReady(modelPath, hash, resident);
+                });
+                return;
             }
-            std::cout << "[OK] Loaded " << mesh.indices.size() << " indices\n";
-        } else {
-            std::cerr << "[ERROR] Not enough data for indices (offset: " << indicesByteOffset << ")\n";
-            return createDefaultCube();
-        }
-        
-        // Extract positions (float3, stride 12) from bufferView 2
-        if (positionByteOffset >= 0 && positionByteOffset + positionCount * 12 <= (int)binaryData.size()) {
-            for (int i = 0; i < positionCount; ++i) {
-                int offset = positionByteOffset + i * 12;
-                float x = *reinterpret_cast<const float*>(binaryData.data() + offset);
-                float y = *reinterpret_cast<const float*>(binaryData.data() + offset + 4);
-                float z = *reinterpret_cast<const float*>(binaryData.data() + offset + 8);
-                mesh.positions.push_back(glm::vec3(x, y, z));
+            
+            auto prepared = std::make_shared<PreparedModel>(prepareModel(modelPath));
+            resolveTextures(*prepared);
+            
+            // Material images decode in parallel; the last one queues the upload
+            JobSystem::getInstance().enqueueBatch(decodeJobs(prepared), [this, owner, modelPath, hash, prepared]() {
+                GLUploadQueue::getInstance().push([this, owner, modelPath, hash, prepared]() {
+                    if (owner.expired()) return;
+                    MeshHandle mesh = ResourceRegistry::getInstance().acquire<const GLBMeshData>(hash, [this, prepared]() {
+                        GLBMeshData mesh = finishModel(*prepared);
+                        mesh.releaseCPUData(cpuRetention);
+                        return std::make_shared<const GLBMeshData>(std::move(mesh));
+                    });
+                    onModelReady(modelPath, hash, mesh);
+                });
+            });
+        });
+    }
+    
+    // Content hash of the file prepareModel will read. Unreadable files are
+    // keyed by path, so a missing model still resolves to one placeholder.
+    static uint64_t modelHash(const std::string& filePath) {
+        std::string source = MeshCooker::isCookedCurrent(filePath) ? MeshCooker::cookedPath(filePath) : filePath;
+        uint64_t hash = 0;
+        if (!ContentHash::hashFile(source, hash)) hash = ContentHash::hash(filePath);
+        return hash;
+    }
+    
+    // Material images decode differently per slot (sRGB color, linear data,
+    // normal map), so the slot seeds the hash
+    static ImageColorSpace textureColorSpace(size_t slot) {
+        if (slot == HMESH_TEXTURE_BASE_COLOR) return ImageColorSpace::SRGB;
+        if (slot == HMESH_TEXTURE_NORMAL) return ImageColorSpace::NORMAL;
+        return ImageColorSpace::LINEAR;
+    }
+    
+    static uint64_t textureHash(ByteSpan source, size_t slot) {
+        return ContentHash::hash(source, slot + 1);
+    }
+    
+    // Hashes each material image and picks up identical textures that are
+    // already resident, so images shared between models (or repeated in
+    // one) are decoded and uploaded once
+    static void resolveTextures(PreparedModel& prepared) {
+        for (size_t slot = 0; slot < HMESH_TEXTURE_SLOTS; ++slot) {
+            PreparedTexture& texture = prepared.textures[slot];
+            if (!texture.hash && texture.encoded.valid()) {
+                texture.hash = textureHash(ByteSpan{texture.encoded.data, texture.encoded.size}, slot);
             }
-            std::cout << "[OK] Loaded " << mesh.positions.size() << " positions\n";
-        } else {
-            std::cerr << "[ERROR] Not enough data for positions (offset: " << positionByteOffset << ")\n";
-            return createDefaultCube();
+            if (texture.hash) texture.resident = ResourceRegistry::getInstance().contains<const GLTexture>(texture.hash);
         }
-        
-        // Extract texCoords (TEXCOORD_0) - usually bufferView 1 with stride 8
-        // From JSON: TEXCOORD_0 is accessor 3, uses bufferView 1
-        int texCoordByteOffset = -1;
-        int texCoordCount = positionCount;  // Same count as positions
-        
-        if (byteOffsets.size() > 1) {
-            texCoordByteOffset = byteOffsets[0];  // BufferView 1 offset
-            
-            // For old_television, TEXCOORD_0 is in bufferView 1 with stride 8 (vec2, 2 bytes per component)
-            // Try to extract with different stride values
-            if (texCoordByteOffset >= 0 && texCoordByteOffset + texCoordCount * 8 <= (int)binaryData.size()) {
-                for (int i = 0; i < texCoordCount; ++i) {
-                    int offset = texCoordByteOffset + i * 8;
-                    float u = *reinterpret_cast<const float*>(binaryData.data() + offset);
-                    float v = *reinterpret_cast<const float*>(binaryData.data() + offset + 4);
-                    mesh.texCoords.push_back(glm::vec2(u, v));
-                }
-                std::cout << "[OK] Loaded " << mesh.texCoords.size() << " texCoords\n";
-            } else if (texCoordByteOffset >= 0 && texCoordByteOffset + texCoordCount * 4 <= (int)binaryData.size()) {
-                // Try with stride 4 (in case of half-float)
-                for (int i = 0; i < texCoordCount; ++i) {
-                    int offset = texCoordByteOffset + i * 4;
-                    float u = *reinterpret_cast<const float*>(binaryData.data() + offset);
-                    float v = *reinterpret_cast<const float*>(binaryData.data() + offset + 2);
-                    mesh.texCoords.push_back(glm::vec2(u, v));
+    }
+    
+    static std::vector<std::function<void()>> decodeJobs(const std::shared_ptr<PreparedModel>& prepared) {
+        std::vector<std::function<void()>> jobs;
+        for (size_t slot = 0; slot < HMESH_TEXTURE_SLOTS; ++slot) {
+            PreparedTexture* texture = &prepared->textures[slot];
+            if (texture->resident || !texture->encoded.valid()) continue;
+            ImageColorSpace space = textureColorSpace(slot);
+            jobs.push_back([prepared, texture, space]() {
+                std::string error;
+                if (!ImageDecoder::decode(texture->encoded.data, texture->encoded.size, space, texture->pixels, error)) {
+                    std::cerr << "[ERROR] Failed to decode material image: " << error << "\n";
                 }
-                std::cout << "[OK] Loaded " << mesh.texCoords.size() << " texCoords (half-float)\n";
+            });
+        }
+        return jobs;
+    }
+    
+    void onModelReady(const std::string& modelPath, uint64_t hash, const MeshHandle& mesh) {
+        pendingModels.erase(modelPath);
+        ResourceRegistry::getInstance().alias<const GLBMeshData>(modelPath, hash);
+        auto preload = preloads.find(modelPath);
+        if (preload != preloads.end()) preload->second = mesh;
+        for (auto& obj : objects) {
+            if (obj.modelPath == modelPath) {
+                obj.mesh = mesh;
+                obj.lod = 0;
+                refreshBounds(obj);
             }
         }
+    }
+    
+    // Worker thread: file mapping, parsing, validation and any CPU
+    // flattening. Must not touch GL.
+    static PreparedModel prepareModel(const std::string& filePath) {
+        PreparedModel prepared;
         
-        // Fill with default UVs if not loaded
-        if (mesh.texCoords.empty()) {
-            std::cout << "[WARNING] No texCoords loaded, using default UVs\n";
-            for (int i = 0; i < positionCount; ++i) {
-                mesh.texCoords.push_back(glm::vec2(0.0f, 0.0f));
-            }
+        // Load GLB format
+        if (filePath.substr(filePath.find_last_of(".") + 1) != "glb") {
+            std::cerr << "[ERROR] Only GLB format is supported. Expected .glb file: " << filePath << "\n";
+            prepared.mesh = createDefaultCube();
+            return prepared;
         }
         
-        // Extract images from bufferViews (images are in bufferView 4, 5, 6 for old_television)
-        // Parse images array from JSON
-        size_t imagesPos = jsonContent.find("\"images\":[");
-        if (imagesPos != std::string::npos) {
-            std::vector<int> imageBufferViews;
-            size_t imageSearch = imagesPos;
-            
-            // Find all image bufferView references
-            for (int imgIdx = 0; imgIdx < 10; ++imgIdx) {
-                size_t bufViewRef = jsonContent.find("\"bufferView\":", imageSearch);
-                if (bufViewRef == std::string::npos || bufViewRef > jsonContent.find("\"materials\":[")) break;
-                
-                std::string bufViewStr = jsonContent.substr(bufViewRef + 13);
-                size_t commaPos = bufViewStr.find_first_of(",}");
-                int bufViewIdx = std::stoi(bufViewStr.substr(0, commaPos));
-                imageBufferViews.push_back(bufViewIdx);
-                
-                std::cout << "[*] Image " << imgIdx << " uses bufferView " << bufViewIdx << "\n";
-                
-                imageSearch = bufViewRef + 50;
-            }
-            
-            // Now extract the actual image data from byteOffsets
-            // For old_television: bufferView 4 (baseColor), 5 (metallicRoughness), 6 (normal)
-            std::vector<int> imageByteLengths;
-            offsetSearch = bufferViewPos;
-            int currentBufferView = 0;
-            
-            while (true) {
-                size_t byteLength = jsonContent.find("\"byteLength\":", offsetSearch);
-                if (byteLength == std::string::npos || byteLength > jsonContent.find("\"buffers\":[")) break;
-                
-                std::string byteLengthStr = jsonContent.substr(byteLength + 13);
-                size_t commaPos = byteLengthStr.find_first_of(",}");
-                int length = std::stoi(byteLengthStr.substr(0, commaPos));
-                imageByteLengths.push_back(length);
-                
-                offsetSearch = byteLength + 50;
-                currentBufferView++;
-            }
-            
-            // Load base color image
-            if (imageBufferViews.size() > 0) {
-                int bufViewIdx = imageBufferViews[0];
-                if (bufViewIdx < (int)byteOffsets.size() && bufViewIdx + 1 < (int)imageByteLengths.size()) {
-                    int imgOffset = byteOffsets[bufViewIdx];
-                    int imgLength = imageByteLengths[bufViewIdx];
-                    std::cout << "[*] BaseColor: offset=" << imgOffset << ", length=" << imgLength << "\n";
-                    
-                    if (imgOffset >= 0 && imgOffset + imgLength <= (int)binaryData.size()) {
-                        std::vector<char> pngData(binaryData.begin() + imgOffset, binaryData.begin() + imgOffset + imgLength);
-                        mesh.loadTextureFromPNG(mesh.baseColorTex, pngData);
-                        std::cout << "[OK] Loaded baseColor texture\n";
-                    }
-                }
-            }
-            
-            // Load metallic/roughness image
-            if (imageBufferViews.size() > 1) {
-                int bufViewIdx = imageBufferViews[1];
-                if (bufViewIdx < (int)byteOffsets.size() && bufViewIdx + 1 < (int)imageByteLengths.size()) {
-                    int imgOffset = byteOffsets[bufViewIdx];
-                    int imgLength = imageByteLengths[bufViewIdx];
-                    std::cout << "[*] MetallicRoughness: offset=" << imgOffset << ", length=" << imgLength << "\n";
-                    
-                    if (imgOffset >= 0 && imgOffset + imgLength <= (int)binaryData.size()) {
-                        std::vector<char> pngData(binaryData.begin() + imgOffset, binaryData.begin() + imgOffset + imgLength);
-                        mesh.loadTextureFromPNG(mesh.metallicRoughnessTex, pngData);
-                        std::cout << "[OK] Loaded metallicRoughness texture\n";
-                    }
-                }
-            }
-            
-            // Load normal image
-            if (imageBufferViews.size() > 2) {
-                int bufViewIdx = imageBufferViews[2];
-                if (bufViewIdx < (int)byteOffsets.size() && bufViewIdx + 1 < (int)imageByteLengths.size()) {
-                    int imgOffset = byteOffsets[bufViewIdx];
-                    int imgLength = imageByteLengths[bufViewIdx];
-                    std::cout << "[*] Normal: offset=" << imgOffset << ", length=" << imgLength << "\n";
-                    
-                    if (imgOffset >= 0 && imgOffset + imgLength <= (int)binaryData.size()) {
-                        std::vector<char> pngData(binaryData.begin() + imgOffset, binaryData.begin() + imgOffset + imgLength);
-                        mesh.loadTextureFromPNG(mesh.normalTex, pngData);
-                        std::cout << "[OK] Loaded normal texture\n";
+        // Cooked meshes skip glTF parsing entirely
+        std::string error;
+        if (MeshCooker::isCookedCurrent(filePath)) {
+            std::string cookedPath = MeshCooker::cookedPath(filePath);
+            auto cooked = std::make_shared<HMeshFile>();
+            if (cooked->open(cookedPath, error)) {
+                prepared.cooked = cooked;
+                if (cooked->getHeader().materialCount > 0) {
+                    for (size_t slot = 0; slot < HMESH_TEXTURE_SLOTS; ++slot) {
+                        cookedTexture(cooked->texture(0, (HMeshTextureSlot)slot), slot, prepared.textures[slot]);
                     }
                 }
+                return prepared;
             }
+            std::cerr << "[ERROR] Ignoring cooked mesh (" << error << "): " << cookedPath << "\n";
         }
         
-        // If textures weren't loaded from PNG, create defaults
-        if (mesh.baseColorTex == 0 || mesh.metallicRoughnessTex == 0 || mesh.normalTex == 0) {
-            std::cout << "[OK] Using default textures (gray material)\n";
-            mesh.createDefaultTextures();
+        auto file = std::make_shared<GLBFile>();
+        if (!file->open(filePath, error)) {
+            std::cerr << "[ERROR] Failed to open GLB (" << error << "): " << filePath << "\n";
+            prepared.mesh = createDefaultCube();
+            return prepared;
         }
+        const GLTFDocument& doc = file->document();
+        prepared.file = file;
         
-        // Compute normals
-        mesh.normals.resize(mesh.positions.size(), glm::vec3(0.0f));
-        for (size_t i = 0; i < mesh.indices.size(); i += 3) {
-            unsigned int i0 = mesh.indices[i];
-            unsigned int i1 = mesh.indices[i + 1];
-            unsigned int i2 = mesh.indices[i + 2];
+        // Fast path: vertex and index data go from the mapping to the GPU as-is
+        const GLTFPrimitive* prim = nullptr;
+        glm::mat4 world(1.0f);
+        if (GLTFLoader::singlePrimitive(doc, prim, world) && GLBMeshData::canSetupFromGLB(*file, *prim, world)) {
+            prepared.directPrimitive = prim;
+            prepared.directTransform = world;
             
-            if (i0 < mesh.positions.size() && i1 < mesh.positions.size() && i2 < mesh.positions.size()) {
-                glm::vec3 v0 = mesh.positions[i0];
-                glm::vec3 v1 = mesh.positions[i1];
-                glm::vec3 v2 = mesh.positions[i2];
-                
-                glm::vec3 edge1 = v1 - v0;
-                glm::vec3 edge2 = v2 - v0;
-                glm::vec3 normal = glm::cross(edge1, edge2);
-                
-                mesh.normals[i0] += normal;
-                mesh.normals[i1] += normal;
-                mesh.normals[i2] += normal;
+            // Positions are only decoded for the bounds; the GPU gets the file's bytes
+            const GLTFAccessor* positionAccessor = doc.accessor(prim->position, error);
+            std::vector<glm::vec3> positions(positionAccessor ? positionAccessor->count : 0);
+            if (!positions.empty() && doc.readFloats(prim->position, &positions[0].x, 3, error)) {
+                prepared.mesh.bounds = Bounds::fromPoints(positions.data(), positions.size());
             }
+            GLTFLoader::materialImages(doc, prim->material, prepared.textures[HMESH_TEXTURE_BASE_COLOR].encoded,
+                                       prepared.textures[HMESH_TEXTURE_METALLIC_ROUGHNESS].encoded,
+                                       prepared.textures[HMESH_TEXTURE_NORMAL].encoded);
+            return prepared;
         }
-        for (auto& n : mesh.normals) {
-            if (glm::length(n) > 0.0f) {
-                n = glm::normalize(n);
-            } else {
-                n = glm::vec3(0.0f, 1.0f, 0.0f);
-            }
+        
+        // General path: flatten every primitive on the CPU
+        GLTFModel model;
+        if (!GLTFLoader::buildModel(doc, model, error)) {
+            std::cerr << "[ERROR] Failed to import GLB (" << error << "): " << filePath << "\n";
+            prepared.file.reset();
+            prepared.mesh = createDefaultCube();
+            return prepared;
+        }
+        
+        MeshOptimizeReport report = MeshOptimizer::optimizeMesh(model.indices, model.positions, model.normals,
+                                                                model.texCoords, model.tangents);
+        std::cout << "[*] Optimized " << filePath << ": " << report.summary() << "\n";
+        prepared.mesh.setLODs(MeshSimplifier::buildLODChain(model.indices, model.positions));
+        
+        prepared.mesh.positions = std::move(model.positions);
+        prepared.mesh.normals = std::move(model.normals);
+        prepared.mesh.texCoords = std::move(model.texCoords);
+        prepared.mesh.tangents = std::move(model.tangents);
+        prepared.textures[HMESH_TEXTURE_BASE_COLOR].encoded = model.baseColorImage;
+        prepared.textures[HMESH_TEXTURE_METALLIC_ROUGHNESS].encoded = model.metallicRoughnessImage;
+        prepared.textures[HMESH_TEXTURE_NORMAL].encoded = model.normalImage;
+        return prepared;
+    }
+    
+    // GL thread: buffer and texture uploads for a prepared model
+    static GLBMeshData finishModel(PreparedModel& prepared) {
+        GLBMeshData mesh;
+        if (prepared.cooked) {
+            mesh.setupGLFromHMesh(*prepared.cooked);
+            loadMaterialTextures(mesh, prepared);
+            mesh.createDefaultTextures();
+            std::cout << "[OK] Cooked mesh uploaded: " << prepared.cooked->getHeader().vertexCount
+                      << " vertices, " << mesh.indexCount << " indices\n";
+            return mesh;
+        }
+        if (prepared.directPrimitive) {
+            mesh.setupGLFromGLB(*prepared.file, *prepared.directPrimitive, prepared.directTransform);
+            mesh.bounds = prepared.mesh.bounds;
+            loadMaterialTextures(mesh, prepared);
+            mesh.createDefaultTextures();
+            std::cout << "[OK] GLB uploaded directly from mapping: "
+                      << prepared.file->document().accessors[prepared.directPrimitive->position].count
+                      << " vertices, " << mesh.indexCount << " indices\n";
+            return mesh;
         }
         
-        std::cout << "[OK] GLB mesh loaded successfully: " << mesh.positions.size() << " vertices, " 
-                  << mesh.indices.size() << " indices\n";
+        mesh = std::move(prepared.mesh);
+        loadMaterialTextures(mesh, prepared);
+        mesh.setupGL();
+        if (prepared.file) {
+            std::cout << "[OK] GLB mesh loaded successfully: " << mesh.positions.size() << " vertices, "
+                      << mesh.indexCount << " indices, " << mesh.lods.size() << " LODs\n";
+        }
         return mesh;
     }
     
-    GLBMeshData createDefaultCube() {
+    // htex blobs upload as-is; older cooks stored PNG/JPEG, which still get decoded
+    static void cookedTexture(ByteSpan blob, size_t slot, PreparedTexture& texture) {
+        std::string error;
+        if (HTexView::isContainer(blob)) {
+            if (!texture.cooked.parse(blob, error)) {
+                std::cerr << "[ERROR] Bad cooked texture: " << error << "\n";
+                return;
+            }
+            texture.hash = textureHash(blob, slot);
+            return;
+        }
+        texture.encoded.data = blob.data;
+        texture.encoded.size = blob.size;
+    }
+    
+    // Resident textures are reused; the rest upload as cooked or as decoded
+    // on the workers and are registered for the next material that uses
+    // them. Slots that failed keep the default textures.
+    static void loadMaterialTextures(GLBMeshData& mesh, const PreparedModel& prepared) {
+        TextureHandle* targets[HMESH_TEXTURE_SLOTS] = {&mesh.baseColorTex, &mesh.metallicRoughnessTex, &mesh.normalTex};
+        for (size_t slot = 0; slot < HMESH_TEXTURE_SLOTS; ++slot) {
+            const PreparedTexture& texture = prepared.textures[slot];
+            if (!texture.hash) continue;
+            *targets[slot] = ResourceRegistry::getInstance().acquire<const GLTexture>(texture.hash, [&texture, slot]() {
+                if (texture.cooked.valid()) return GLBMeshData::uploadTexture(texture.cooked);
+                if (!texture.resident) return GLBMeshData::uploadTexture(texture.pixels);
+                
+                // Resident when the workers looked, so never decoded; rare
+                // enough to decode here
+                DecodedImage pixels;
+                std::string error;
+                if (!ImageDecoder::decode(texture.encoded.data, texture.encoded.size, textureColorSpace(slot), pixels, error)) {
+                    std::cerr << "[ERROR] Failed to decode material image: " << error << "\n";
+                }
+                return GLBMeshData::uploadTexture(pixels);
+            });
+        }
+    }
+    
+    static GLBMeshData createDefaultCube() {
         GLBMeshData mesh;
         
         mesh.positions = {
@@ -0,0 +1,725 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../core/JobSystem.h"
+#include "../render/Frustum.h"
+#include "../render/GLHandle.h"
+#include "../render/GLUploadQueue.h"
+#include "../render/ShaderReflection.h"
+
+// Heights of one chunk, samples x samples values in rows along x. The last
+// row and column lie on the next chunk's first, so neighbours meet exactly.
+// Normals come in the same layout, and must take the slope from the heights
+// past the chunk's edges for lighting to match across them.
+struct TerrainChunkData {
+    int chunkX = 0;
+    int chunkZ = 0;
+    int samples = 0;
+    float spacing = 0.0f;            // metres between samples
+    glm::vec2 origin = glm::vec2(0.0f);
+    std::vector<float> heights;
+    std::vector<uint32_t> normals;   // RGBA8, xyz * 0.5 + 0.5
+};
+
+// Fills data.heights, and data.normals if it can, for the chunk described
+// by the other fields. Runs on worker threads, several chunks at once;
+// false leaves the chunk a hole.
+using TerrainHeightSource = std::function<bool(TerrainChunkData& data)>;
+
+struct TerrainSettings {
+    float chunkSize = 1024.0f;   // metres per chunk edge
+    int chunkSamples = 257;      // height samples per chunk edge, 2^n + 1
+    int gridSize = 32;           // quads per edge of the shared node mesh, even
+    int lodLevels = 6;           // quadtree depth per chunk; the root is the whole chunk
+    float lodDistance = 192.0f;  // range of the finest level; each coarser one doubles it
+    float morphRatio = 0.67f;    // how far into its range a level starts morphing
+    float evictMargin = 1.25f;   // chunks past viewRadius() times this are freed
+    size_t maxLoading = 0;       // chunks generating at once; 0 for two per worker
+};
+
+struct TerrainStats {
+    size_t resident = 0;     // chunks with heights on the GPU
+    size_t loading = 0;
+    size_t drawnChunks = 0;  // this frame
+    size_t drawnNodes = 0;
+    size_t triangles = 0;
+    size_t evicted = 0;      // since creation
+};
+
+// Streaming heightfield terrain with CDLOD (Strugar, "Continuous
+// Distance-Dependent Level of Detail for Rendering Heightmaps").
+//
+// The world is cut into fixed-size chunks, each a quadtree of lodLevels
+// levels over one height texture. Every node, at any level, is drawn with
+// the same gridSize x gridSize mesh scaled to the node; the vertex shader
+// reads heights from the chunk's texture. Each level covers a distance
+// range twice the previous one, and vertices in the outer part of their
+// level's range morph onto the next coarser grid, so levels, and chunks,
+// meet without cracks or popping. A node whose children are only partly in
+// range draws its remaining quadrants itself; the mesh's indices are
+// stored quadrant by quadrant, so that is a draw of an index sub-range.
+//
+// Reading float textures in the vertex shader needs ARB_texture_float,
+// ARB_texture_rg and a vertex texture unit, none of which GL 2.1 promises.
+// Without them (vertexTexturesSupported) the heights and normals a node's
+// vertices would sample are computed on the CPU instead, into a small
+// buffer per drawn node, and terrain.vert's CPU_HEIGHTS variant reads them
+// as attributes; morphing stays on the GPU.
+//
+// Chunks inside viewRadius() are generated on the JobSystem from a
+// TerrainHeightSource and uploaded through the GLUploadQueue; chunks past
+// it are not drawn, and past evictMargin times it they are freed.
+class Terrain {
+public:
+    // A chunk's heights and the height range of each of its quadtree
+    // nodes, built off the GL thread
+    struct PreparedChunk {
+        TerrainChunkData data;
+        std::vector<glm::vec2> nodeRanges;  // min/max height, level by level
+        bool valid = false;
+    };
+
+    explicit Terrain(const TerrainSettings& terrainSettings = TerrainSettings())
+        : settings(terrainSettings) {
+        settings.gridSize = std::max(2, settings.gridSize & ~1);
+        settings.lodLevels = std::max(1, settings.lodLevels);
+        while (settings.lodLevels > 1 && (settings.chunkSamples - 1) % (1 << (settings.lodLevels - 1)) != 0) {
+            --settings.lodLevels;
+        }
+        if (settings.lodLevels != terrainSettings.lodLevels) {
+            std::cerr << "[ERROR] Terrain: " << terrainSettings.lodLevels << " LOD levels do not divide "
+                      << settings.chunkSamples << " samples, using " << settings.lodLevels << "\n";
+        }
+        if (settings.maxLoading == 0) settings.maxLoading = 2 * JobSystem::defaultThreadCount();
+
+        for (int lod = 0; lod < settings.lodLevels; ++lod) {
+            ranges.push_back(settings.lodDistance * (float)(1 << lod));
+            float previous = lod > 0 ? ranges[lod - 1] : 0.0f;
+            float start = previous + (ranges[lod] - previous) * settings.morphRatio;
+            float span = std::max(ranges[lod] - start, 1e-3f);
+            morphs.push_back(glm::vec2(ranges[lod] / span, 1.0f / span));
+        }
+    }
+
+    ~Terrain() { destroy(); }
+
+    Terrain(const Terrain&) = delete;
+    Terrain& operator=(const Terrain&) = delete;
+
+    // Set before the first update(); workers call it from then on
+    void setSource(TerrainHeightSource heightSource) { source = std::move(heightSource); }
+
+    // Whether terrain.vert can read the height and normal textures. GL
+    // thread, context current.
+    static bool vertexTexturesSupported() {
+        if (!GLEW_VERSION_3_0 && !(GLEW_ARB_texture_float && GLEW_ARB_texture_rg)) return false;
+        GLint units = 0;
+        glGetIntegerv(GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS, &units);
+        return units > 0;
+    }
+
+    // The shared node mesh, and the choice between vertex textures and CPU
+    // heights. GL thread, before any install().
+    void create() {
+        vertexTextures = vertexTexturesSupported();
+        if (!vertexTextures) std::cout << "[INFO] Terrain: no float vertex textures, heights computed on the CPU\n";
+
+        int grid = settings.gridSize;
+        std::vector<glm::vec2> vertices;
+        vertices.reserve((grid + 1) * (grid + 1));
+        for (int z = 0; z <= grid; ++z) {
+            for (int x = 0; x <= grid; ++x) vertices.push_back(glm::vec2(x, z) / (float)grid);
+        }
+
+        // Quadrant by quadrant (x half in bit 0, z half in bit 1), so each
+        // quarter of a node is a contiguous range
+        int half = grid / 2;
+        std::vector<uint16_t> indices;
+        indices.reserve(grid * grid * 6);
+        for (int quadrant = 0; quadrant < 4; ++quadrant) {
+            int x0 = (quadrant & 1) * half;
+            int z0 = (quadrant >> 1) * half;
+            for (int z = z0; z < z0 + half; ++z) {
+                for (int x = x0; x < x0 + half; ++x) {
+                    uint16_t a = (uint16_t)(z * (grid + 1) + x);
+                    uint16_t b = (uint16_t)(a + 1);
+                    uint16_t c = (uint16_t)(a + grid + 1);
+                    uint16_t d = (uint16_t)(c + 1);
+                    indices.insert(indices.end(), {a, c, b, b, c, d});
+                }
+            }
+        }
+        quadrantIndexCount = (GLsizei)(indices.size() / 4);
+
+        vertexArray = GLVertexArray::create();
+        vertexBuffer = GLBuffer::create();
+        indexBuffer = GLBuffer::create();
+        glBindVertexArray(vertexArray.get());
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer.get());
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer.get());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+        glEnableVertexAttribArray(0);
+        if (!vertexTextures) {
+            // Pointed at each node's buffer as it is drawn
+            for (GLuint attribute = 1; attribute <= 3; ++attribute) glEnableVertexAttribArray(attribute);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // Frees the mesh and every chunk. Queued loads are cancelled and running
+    // ones waited for, since they call the source. GL thread, context current.
+    void destroy() {
+        {
+            std::unique_lock<std::mutex> lock(loads->mutex);
+            loads->cancelled = true;
+            loads->idle.wait(lock, [this]() { return loads->pending == 0; });
+        }
+        loads = std::make_shared<LoadTracker>();
+        alive = std::make_shared<bool>(true);
+        chunks.clear();
+        vertexArray.reset();
+        vertexBuffer.reset();
+        indexBuffer.reset();
+        stats = TerrainStats();
+    }
+
+    // Builds one chunk; touches nothing but the settings and the source, so
+    // any thread may call it
+    std::shared_ptr<PreparedChunk> prepare(int chunkX, int chunkZ) const {
+        auto prepared = std::make_shared<PreparedChunk>();
+        TerrainChunkData& data = prepared->data;
+        data.chunkX = chunkX;
+        data.chunkZ = chunkZ;
+        data.samples = settings.chunkSamples;
+        data.spacing = settings.chunkSize / (settings.chunkSamples - 1);
+        data.origin = glm::vec2(chunkX, chunkZ) * settings.chunkSize;
+        size_t count = (size_t)data.samples * data.samples;
+        data.heights.assign(count, 0.0f);
+        if (!source || !source(data) || data.heights.size() != count) {
+            data.heights.clear();
+            data.normals.clear();
+            return prepared;
+        }
+        if (data.normals.size() != count) computeNormals(data);
+        computeNodeRanges(*prepared);
+        prepared->valid = true;
+        return prepared;
+    }
+
+    // Builds the chunks within radius of position, for a caller that needs
+    // the ground before streaming has run (startup); any thread
+    std::vector<std::shared_ptr<PreparedChunk>> prepareAround(const glm::vec3& position, float radius) const {
+        std::vector<std::shared_ptr<PreparedChunk>> prepared;
+        forChunksWithin(glm::vec2(position.x, position.z), radius, [&](int x, int z, float) {
+            prepared.push_back(prepare(x, z));
+        });
+        return prepared;
+    }
+
+    // Makes a prepared chunk resident; its normals are dropped once on the
+    // GPU, or kept for the node buffers without vertex textures. GL thread.
+    void install(const std::shared_ptr<PreparedChunk>& prepared) {
+        TerrainChunkData& data = prepared->data;
+        Chunk& chunk = chunks[chunkKey(data.chunkX, data.chunkZ)];
+        chunk.x = data.chunkX;
+        chunk.z = data.chunkZ;
+        chunk.ticket = 0;
+        chunk.heightMap.reset();
+        chunk.normalMap.reset();
+        chunk.nodeMeshes.clear();
+        chunk.prepared = prepared;
+        if (!prepared->valid) {
+            chunk.state = ChunkState::EMPTY;
+            return;
+        }
+
+        if (vertexTextures) {
+            chunk.heightMap = createChunkTexture(data.samples, GL_R32F, GL_RED, GL_FLOAT, data.heights.data());
+            chunk.normalMap = createChunkTexture(data.samples, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, data.normals.data());
+            std::vector<uint32_t>().swap(data.normals);
+        }
+        chunk.state = ChunkState::READY;
+    }
+
+    // Once per frame on the GL thread: frees chunks that fell out of range
+    // and starts loading the nearest missing ones
+    void update(const glm::vec3& cameraPosition) {
+        glm::vec2 center(cameraPosition.x, cameraPosition.z);
+        float evictRadius = viewRadius() * settings.evictMargin;
+        size_t loading = 0;
+        for (auto it = chunks.begin(); it != chunks.end();) {
+            if (chunkDistance(it->second.x, it->second.z, center) > evictRadius) {
+                if (it->second.state != ChunkState::LOADING) ++stats.evicted;
+                it = chunks.erase(it);
+                continue;
+            }
+            if (it->second.state == ChunkState::LOADING) ++loading;
+            auto& meshes = it->second.nodeMeshes;
+            for (auto mesh = meshes.begin(); mesh != meshes.end();) {
+                if (frame - mesh->second.lastFrame > NODE_MESH_FRAMES) mesh = meshes.erase(mesh);
+                else ++mesh;
+            }
+            ++it;
+        }
+
+        if (loading < settings.maxLoading) {
+            missing.clear();
+            forChunksWithin(center, viewRadius(), [&](int x, int z, float distance) {
+                if (!chunks.count(chunkKey(x, z))) missing.push_back({distance, {x, z}});
+            });
+            size_t count = std::min(missing.size(), settings.maxLoading - loading);
+            std::partial_sort(missing.begin(), missing.begin() + count, missing.end(),
+                              [](const MissingChunk& a, const MissingChunk& b) { return a.first < b.first; });
+            for (size_t i = 0; i < count; ++i) request(missing[i].second.first, missing[i].second.second);
+            loading += count;
+        }
+
+        stats.loading = loading;
+        stats.resident = 0;
+        for (const auto& entry : chunks) {
+            if (entry.second.state == ChunkState::READY) ++stats.resident;
+        }
+    }
+
+    // Selects and draws the visible nodes with program, which must take the
+    // uniforms terrain.vert declares, in its CPU_HEIGHTS variant when
+    // vertexTexturesSupported() is false. GL thread.
+    void render(GLuint program, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPosition) {
+        ++frame;
+        stats.drawnChunks = 0;
+        stats.drawnNodes = 0;
+        stats.triangles = 0;
+        if (!program || !vertexArray) return;
+
+        SelectContext context;
+        context.frustum = Frustum::fromViewProjection(projection * view);
+        context.camera = cameraPosition;
+        selection.clear();
+        for (auto& entry : chunks) {
+            Chunk& chunk = entry.second;
+            if (chunk.state != ChunkState::READY) continue;
+            size_t before = selection.size();
+            context.chunk = &chunk;
+            selectNode(context, 0, 0, 0, false);
+            if (selection.size() > before) ++stats.drawnChunks;
+        }
+        if (selection.empty()) return;
+
+        glUseProgram(program);
+        ParameterBlock& params = ShaderReflection::getInstance().parameters(program);
+        params.set(viewId, view);
+        params.set(projectionId, projection);
+        params.set(cameraId, cameraPosition);
+        params.set(gridSizeId, (float)settings.gridSize);
+        params.set(heightMapId, 0);
+        params.set(normalMapId, 1);
+        glBindVertexArray(vertexArray.get());
+
+        const Chunk* bound = nullptr;  // whose textures are bound
+        for (const SelectedNode& node : selection) {
+            if (node.chunk != bound && vertexTextures) {
+                bound = node.chunk;
+                const TerrainChunkData& data = bound->prepared->data;
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, bound->normalMap.get());
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, bound->heightMap.get());
+                params.set(chunkId, glm::vec4(data.origin, 1.0f / settings.chunkSize, (float)data.samples));
+            }
+            params.set(nodeId, glm::vec3(node.origin, node.size));
+            params.set(morphId, morphs[node.lod]);
+            params.apply();
+            if (!vertexTextures) {
+                glBindBuffer(GL_ARRAY_BUFFER, nodeMesh(node).buffer.get());
+                glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(NodeVertex), (void*)offsetof(NodeVertex, height));
+                glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(NodeVertex), (void*)offsetof(NodeVertex, normal));
+                glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(NodeVertex),
+                                      (void*)offsetof(NodeVertex, morphNormal));
+            }
+
+            if (node.quadrants == 0xF) {
+                glDrawElements(GL_TRIANGLES, quadrantIndexCount * 4, GL_UNSIGNED_SHORT, (void*)0);
+            } else {
+                for (int quadrant = 0; quadrant < 4; ++quadrant) {
+                    if (!(node.quadrants & (1 << quadrant))) continue;
+                    size_t offset = (size_t)quadrant * quadrantIndexCount * sizeof(uint16_t);
+                    glDrawElements(GL_TRIANGLES, quadrantIndexCount, GL_UNSIGNED_SHORT, (void*)offset);
+                }
+            }
+            ++stats.drawnNodes;
+            stats.triangles += (size_t)quadrantIndexCount / 3 * popCount(node.quadrants);
+        }
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // Ground height under (x, z), bilinear like the vertex shader; false
+    // where no chunk is resident yet
+    bool heightAt(float x, float z, float& height) const {
+        int chunkX = (int)std::floor(x / settings.chunkSize);
+        int chunkZ = (int)std::floor(z / settings.chunkSize);
+        auto it = chunks.find(chunkKey(chunkX, chunkZ));
+        if (it == chunks.end() || it->second.state != ChunkState::READY) return false;
+
+        height = sampleHeight(it->second.prepared->data, glm::vec2(x, z));
+        return true;
+    }
+
+    // Distance out to which chunks are loaded and drawn: the coarsest range
+    float viewRadius() const { return ranges.back(); }
+
+    const TerrainSettings& getSettings() const { return settings; }
+    const TerrainStats& getStats() const { return stats; }
+
+private:
+    enum class ChunkState { LOADING, READY, EMPTY };
+
+    // Without vertex textures: what terrain.vert would have sampled at a
+    // node vertex, and at the coarser grid vertex it morphs onto
+    struct NodeVertex {
+        float height;
+        float morphHeight;
+        uint32_t normal;       // RGBA8, xyz * 0.5 + 0.5
+        uint32_t morphNormal;
+    };
+
+    struct NodeMesh {
+        GLBuffer buffer;
+        uint64_t lastFrame = 0;
+    };
+
+    // Node buffers not drawn for this many frames are freed
+    static constexpr uint64_t NODE_MESH_FRAMES = 120;
+
+    struct Chunk {
+        int x = 0;
+        int z = 0;
+        ChunkState state = ChunkState::LOADING;
+        uint64_t ticket = 0;  // the load in flight; a stale upload is dropped
+        GLTexture heightMap;
+        GLTexture normalMap;
+        std::unordered_map<uint32_t, NodeMesh> nodeMeshes;  // by node index, CPU heights only
+        std::shared_ptr<const PreparedChunk> prepared;
+    };
+
+    struct SelectedNode {
+        Chunk* chunk;
+        glm::vec2 origin;
+        float size;
+        int lod;
+        uint32_t index;     // into the chunk's nodeRanges
+        uint8_t quadrants;  // the ones this node draws itself
+    };
+
+    struct SelectContext {
+        Frustum frustum;
+        glm::vec3 camera;
+        Chunk* chunk = nullptr;
+    };
+
+    // Loads handed to the JobSystem and not yet finished
+    struct LoadTracker {
+        std::mutex mutex;
+        std::condition_variable idle;
+        size_t pending = 0;
+        bool cancelled = false;
+    };
+
+    using MissingChunk = std::pair<float, std::pair<int, int>>;
+
+    TerrainSettings settings;
+    TerrainHeightSource source;
+    std::vector<float> ranges;     // per LOD, finest first
+    std::vector<glm::vec2> morphs; // per LOD: end / (end - start), 1 / (end - start)
+
+    GLVertexArray vertexArray;
+    GLBuffer vertexBuffer;
+    GLBuffer indexBuffer;
+    GLsizei quadrantIndexCount = 0;
+    bool vertexTextures = true;
+    uint64_t frame = 0;
+    std::vector<NodeVertex> nodeVertices;
+
+    std::unordered_map<uint64_t, Chunk> chunks;
+    std::vector<SelectedNode> selection;
+    std::vector<MissingChunk> missing;
+    uint64_t nextTicket = 0;
+    std::shared_ptr<bool> alive = std::make_shared<bool>(true);
+    std::shared_ptr<LoadTracker> loads = std::make_shared<LoadTracker>();
+    TerrainStats stats;
+
+    const UniformId viewId = UniformNames::id("view");
+    const UniformId projectionId = UniformNames::id("projection");
+    const UniformId cameraId = UniformNames::id("cameraPos");
+    const UniformId gridSizeId = UniformNames::id("gridSize");
+    const UniformId heightMapId = UniformNames::id("heightMap");
+    const UniformId normalMapId = UniformNames::id("normalMap");
+    const UniformId chunkId = UniformNames::id("chunk");
+    const UniformId nodeId = UniformNames::id("node");
+    const UniformId morphId = UniformNames::id("morph");
+
+    static uint64_t chunkKey(int x, int z) { return ((uint64_t)(uint32_t)x << 32) | (uint32_t)z; }
+
+    static int popCount(uint8_t bits) {
+        int count = 0;
+        for (; bits; bits &= bits - 1) ++count;
+        return count;
+    }
+
+    // Distance from a point to the chunk's square on the ground plane
+    float chunkDistance(int x, int z, const glm::vec2& point) const {
+        glm::vec2 low = glm::vec2(x, z) * settings.chunkSize;
+        glm::vec2 nearest = glm::clamp(point, low, low + settings.chunkSize);
+        return glm::length(point - nearest);
+    }
+
+    template <typename Fn>
+    void forChunksWithin(const glm::vec2& center, float radius, Fn&& fn) const {
+        int x0 = (int)std::floor((center.x - radius) / settings.chunkSize);
+        int x1 = (int)std::floor((center.x + radius) / settings.chunkSize);
+        int z0 = (int)std::floor((center.y - radius) / settings.chunkSize);
+        int z1 = (int)std::floor((center.y + radius) / settings.chunkSize);
+        for (int z = z0; z <= z1; ++z) {
+            for (int x = x0; x <= x1; ++x) {
+                float distance = chunkDistance(x, z, center);
+                if (distance <= radius) fn(x, z, distance);
+            }
+        }
+    }
+
+    void request(int x, int z) {
+        Chunk& chunk = chunks[chunkKey(x, z)];
+        chunk.x = x;
+        chunk.z = z;
+        chunk.state = ChunkState::LOADING;
+        chunk.ticket = ++nextTicket;
+
+        std::weak_ptr<bool> owner = alive;
+        std::shared_ptr<LoadTracker> tracker = loads;
+        uint64_t ticket = chunk.ticket;
+        {
+            std::lock_guard<std::mutex> lock(tracker->mutex);
+            ++tracker->pending;
+        }
+        // The terrain is only touched while the load counts as pending:
+        // destroy() waits for that, and a cancelled load returns untouched
+        JobSystem::getInstance().enqueue([this, owner, tracker, x, z, ticket]() {
+            bool cancelled;
+            {
+                std::lock_guard<std::mutex> lock(tracker->mutex);
+                cancelled = tracker->cancelled;
+            }
+            if (!cancelled) {
+                std::shared_ptr<PreparedChunk> prepared = prepare(x, z);
+                GLUploadQueue::getInstance().push([this, owner, ticket, prepared]() {
+                    if (owner.expired()) return;
+                    auto it = chunks.find(chunkKey(prepared->data.chunkX, prepared->data.chunkZ));
+                    if (it == chunks.end() || it->second.ticket != ticket) return;
+                    install(prepared);
+                });
+            }
+            std::lock_guard<std::mutex> lock(tracker->mutex);
+            if (--tracker->pending == 0) tracker->idle.notify_all();
+        });
+    }
+
+    // Normals for a source that gave none, from the chunk's own heights.
+    // Edges can only use one-sided differences, so lighting there may not
+    // match the neighbour's; sources that see past the chunk should fill them.
+    static void computeNormals(TerrainChunkData& data) {
+        int last = data.samples - 1;
+        data.normals.resize((size_t)data.samples * data.samples);
+        for (int z = 0; z <= last; ++z) {
+            int back = std::max(z - 1, 0), front = std::min(z + 1, last);
+            for (int x = 0; x <= last; ++x) {
+                int left = std::max(x - 1, 0), right = std::min(x + 1, last);
+                float dx = (data.heights[(size_t)z * data.samples + left] - data.heights[(size_t)z * data.samples + right]) /
+                           ((right - left) * data.spacing);
+                float dz = (data.heights[(size_t)back * data.samples + x] - data.heights[(size_t)front * data.samples + x]) /
+                           ((front - back) * data.spacing);
+                glm::vec3 unit = glm::normalize(glm::vec3(dx, 1.0f, dz)) * 127.5f + 128.0f;
+                data.normals[(size_t)z * data.samples + x] =
+                    (uint32_t)unit.x | ((uint32_t)unit.y << 8) | ((uint32_t)unit.z << 16) | (255u << 24);
+            }
+        }
+    }
+
+    // Bilinear between samples, as the GPU filters the chunk textures
+    static void sampleCell(const TerrainChunkData& data, const glm::vec2& world, size_t& first, float& fu, float& fv) {
+        float u = (world.x - data.origin.x) / data.spacing;
+        float v = (world.y - data.origin.y) / data.spacing;
+        int i = std::min(std::max((int)u, 0), data.samples - 2);
+        int j = std::min(std::max((int)v, 0), data.samples - 2);
+        fu = std::min(std::max(u - i, 0.0f), 1.0f);
+        fv = std::min(std::max(v - j, 0.0f), 1.0f);
+        first = (size_t)j * data.samples + i;
+    }
+
+    static float sampleHeight(const TerrainChunkData& data, const glm::vec2& world) {
+        size_t first;
+        float fu, fv;
+        sampleCell(data, world, first, fu, fv);
+        const float* row = &data.heights[first];
+        const float* next = row + data.samples;
+        float top = row[0] + (row[1] - row[0]) * fu;
+        float bottom = next[0] + (next[1] - next[0]) * fu;
+        return top + (bottom - top) * fv;
+    }
+
+    static uint32_t sampleNormal(const TerrainChunkData& data, const glm::vec2& world) {
+        size_t first;
+        float fu, fv;
+        sampleCell(data, world, first, fu, fv);
+        const uint32_t* row = &data.normals[first];
+        const uint32_t* next = row + data.samples;
+        uint32_t packed = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            auto channel = [shift](uint32_t texel) { return (float)((texel >> shift) & 0xFF); };
+            float top = channel(row[0]) + (channel(row[1]) - channel(row[0])) * fu;
+            float bottom = channel(next[0]) + (channel(next[1]) - channel(next[0])) * fu;
+            packed |= (uint32_t)(top + (bottom - top) * fv + 0.5f) << shift;
+        }
+        return packed;
+    }
+
+    // The node's CPU heights, built the first time it is drawn. GL thread.
+    const NodeMesh& nodeMesh(const SelectedNode& node) {
+        NodeMesh& mesh = node.chunk->nodeMeshes[node.index];
+        mesh.lastFrame = frame;
+        if (mesh.buffer) return mesh;
+
+        // Odd vertices morph onto the grid vertex below them (terrain.vert)
+        const TerrainChunkData& data = node.chunk->prepared->data;
+        int grid = settings.gridSize;
+        float step = node.size / (float)grid;
+        nodeVertices.resize((size_t)(grid + 1) * (grid + 1));
+        for (int z = 0; z <= grid; ++z) {
+            for (int x = 0; x <= grid; ++x) {
+                glm::vec2 at = node.origin + glm::vec2(x, z) * step;
+                glm::vec2 to = node.origin + glm::vec2(x & ~1, z & ~1) * step;
+                nodeVertices[(size_t)z * (grid + 1) + x] = {sampleHeight(data, at), sampleHeight(data, to),
+                                                            sampleNormal(data, at), sampleNormal(data, to)};
+            }
+        }
+        mesh.buffer = GLBuffer::create();
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.buffer.get());
+        glBufferData(GL_ARRAY_BUFFER, nodeVertices.size() * sizeof(NodeVertex), nodeVertices.data(), GL_STATIC_DRAW);
+        return mesh;
+    }
+
+    // One of a chunk's samples x samples maps, filtered between samples
+    static GLTexture createChunkTexture(int samples, GLint internalFormat, GLenum format, GLenum type, const void* pixels) {
+        GLTexture texture = GLTexture::create();
+        glBindTexture(GL_TEXTURE_2D, texture.get());
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, samples, samples, 0, format, type, pixels);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+    // Min/max height of every node: the finest level from the samples each
+    // covers (edges included), then each level from its four children
+    void computeNodeRanges(PreparedChunk& prepared) const {
+        const TerrainChunkData& data = prepared.data;
+        int levels = settings.lodLevels;
+        prepared.nodeRanges.resize(levelOffset(levels));
+
+        int finest = levels - 1;
+        int count = 1 << finest;
+        int cell = (data.samples - 1) / count;
+        for (int nz = 0; nz < count; ++nz) {
+            for (int nx = 0; nx < count; ++nx) {
+                glm::vec2 range(data.heights[(size_t)nz * cell * data.samples + nx * cell]);
+                for (int z = nz * cell; z <= (nz + 1) * cell; ++z) {
+                    const float* row = &data.heights[(size_t)z * data.samples];
+                    for (int x = nx * cell; x <= (nx + 1) * cell; ++x) {
+                        range.x = std::min(range.x, row[x]);
+                        range.y = std::max(range.y, row[x]);
+                    }
+                }
+                prepared.nodeRanges[levelOffset(finest) + nz * count + nx] = range;
+            }
+        }
+
+        for (int level = finest - 1; level >= 0; --level) {
+            int size = 1 << level;
+            for (int nz = 0; nz < size; ++nz) {
+                for (int nx = 0; nx < size; ++nx) {
+                    const glm::vec2* child = &prepared.nodeRanges[levelOffset(level + 1)];
+                    int stride = size * 2;
+                    glm::vec2 a = child[(nz * 2) * stride + nx * 2], b = child[(nz * 2) * stride + nx * 2 + 1];
+                    glm::vec2 c = child[(nz * 2 + 1) * stride + nx * 2], d = child[(nz * 2 + 1) * stride + nx * 2 + 1];
+                    prepared.nodeRanges[levelOffset(level) + nz * size + nx] =
+                        glm::vec2(std::min(std::min(a.x, b.x), std::min(c.x, d.x)),
+                                  std::max(std::max(a.y, b.y), std::max(c.y, d.y)));
+                }
+            }
+        }
+    }
+
+    // Nodes above level: 1 + 4 + 16 + ...
+    static size_t levelOffset(int level) { return ((size_t(1) << (2 * level)) - 1) / 3; }
+
+    static bool withinRange(const Bounds& box, const glm::vec3& point, float range) {
+        glm::vec3 nearest = glm::clamp(point, box.min, box.max);
+        glm::vec3 offset = point - nearest;
+        return glm::dot(offset, offset) <= range * range;
+    }
+
+    // CDLOD selection. Returns false when the node is beyond its level's
+    // range, leaving its area to the parent; culled nodes count as handled.
+    bool selectNode(const SelectContext& context, int level, int nx, int nz, bool parentInside) {
+        Chunk& chunk = *context.chunk;
+        int lod = settings.lodLevels - 1 - level;
+        float size = settings.chunkSize / (float)(1 << level);
+        glm::vec2 origin = chunk.prepared->data.origin + glm::vec2(nx, nz) * size;
+        uint32_t index = (uint32_t)(levelOffset(level) + (nz << level) + nx);
+        glm::vec2 heights = chunk.prepared->nodeRanges[index];
+        Bounds box;
+        box.min = glm::vec3(origin.x, heights.x, origin.y);
+        box.max = glm::vec3(origin.x + size, heights.y, origin.y + size);
+
+        if (!withinRange(box, context.camera, ranges[lod])) return false;
+        Frustum::Containment containment = parentInside ? Frustum::INSIDE : context.frustum.classifyBox(box);
+        if (containment == Frustum::OUTSIDE) return true;
+
+        uint8_t quadrants = 0xF;
+        if (lod > 0 && withinRange(box, context.camera, ranges[lod - 1])) {
+            quadrants = 0;
+            for (int quadrant = 0; quadrant < 4; ++quadrant) {
+                int childX = nx * 2 + (quadrant & 1);
+                int childZ = nz * 2 + (quadrant >> 1);
+                if (!selectNode(context, level + 1, childX, childZ, containment == Frustum::INSIDE)) {
+                    quadrants |= (uint8_t)(1 << quadrant);
+                }
+            }
+        }
+        if (quadrants) selection.push_back({&chunk, origin, size, lod, index, quadrants});
+        return true;
+    }
+};
@@ -0,0 +1,541 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "Terrain.h"
+#include "TerrainNoise.h"
+#include "../assets/CookedAsset.h"
+#include "../assets/ResourceRegistry.h"
+#include "../core/AssetFile.h"
+#include "../core/JobSystem.h"
+#include "../core/Json.h"
+#include "../core/LZ4.h"
+#include "../core/MappedFile.h"
+
+// One entry of game/definitions/climates.json, as far as terrain needs it
+struct TerrainClimate {
+    std::string id;
+    float temperature = 15.0f;  // degrees C at sea level
+    float humidity = 50.0f;     // percent
+};
+
+struct TerrainGeneratorSettings {
+    uint32_t seed = 1337;
+    float tileSize = 1024.0f;      // metres per tile edge (TerrainSettings::chunkSize)
+    int samples = 257;             // samples per tile edge (TerrainSettings::chunkSamples)
+
+    // Shape: warped fBm continents, ridged mountains where a low-frequency
+    // mask allows them, and fine fBm detail for the ground underfoot
+    float featureSize = 2400.0f;   // metres per unit of the base noise
+    float heightScale = 420.0f;    // metres from the lowest valleys to the ridges
+    float warpStrength = 0.6f;     // in base noise units
+    NoiseOctaves warp = {3, 2.0f, 0.5f};
+    NoiseOctaves continents = {5, 2.0f, 0.5f};
+    NoiseOctaves mountainMask = {3, 2.0f, 0.5f};
+    NoiseOctaves mountains = {6, 2.1f, 0.5f};
+    float detailSize = 48.0f;
+    float detailHeight = 1.5f;
+    NoiseOctaves detail = {3, 2.0f, 0.5f};
+
+    // Biomes: each climate's mask peaks where the temperature and humidity
+    // fields match its own values
+    float climateSize = 9000.0f;   // metres per unit of the temperature and humidity noise
+    NoiseOctaves climate = {3, 2.0f, 0.5f};
+    float lapseRate = 6.5f;        // degrees C lost per 1000 m of altitude
+    float temperatureSpread = 8.0f;
+    float humiditySpread = 20.0f;
+
+    std::string cacheDirectory = "cache/terrain";  // empty to disable
+};
+
+// A generated tile: heights and the maps derived from them, all samples x
+// samples in rows along x, sharing their edge samples with the neighbours
+struct TerrainTile {
+    int x = 0;
+    int z = 0;
+    uint32_t seed = 0;                // TerrainGenerator::tileSeed, for per-tile scatter
+    int samples = 0;
+    float spacing = 0.0f;
+    glm::vec2 origin = glm::vec2(0.0f);
+    std::vector<float> heights;
+    std::vector<uint32_t> normals;    // RGBA8, xyz * 0.5 + 0.5
+    std::vector<uint8_t> slopes;      // 0..255 for 0..90 degrees
+    std::vector<uint8_t> biomes;      // one mask per climate, the masks summing to 255
+
+    size_t sampleCount() const { return (size_t)samples * samples; }
+    const uint8_t* biomeMask(size_t climate) const { return biomes.data() + climate * sampleCount(); }
+};
+
+// On-disk header of a cached tile; an LZ4 block of the tile's maps follows
+struct TerrainTileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;          // TerrainGenerator::getKey() of the generator that wrote it
+    int32_t x;
+    int32_t z;
+    uint32_t samples;
+    uint32_t climates;
+    uint32_t seed;
+    uint32_t rawSize;
+    uint32_t packedSize;
+    uint32_t reserved;
+};
+
+static constexpr uint32_t TERRAIN_TILE_MAGIC = 0x52455448;  // "HTER"
+static constexpr uint32_t TERRAIN_TILE_VERSION = 1;
+
+// Procedural terrain tiles. Every tile is a pure function of the settings,
+// the climates and its coordinates: the noise field is seeded once for the
+// world, so tiles meet seamlessly, and each tile also gets its own seed
+// derived from the world seed and its coordinates for whatever is scattered
+// on it. The noise runs four samples at a time (TerrainNoise). Tiles are
+// cached under cacheDirectory keyed by a hash of the settings, so changing
+// any of them, or the climates, regenerates instead of loading stale tiles.
+//
+// tile() may run on any thread and tiles generate independently, so the
+// JobSystem runs many at once: Terrain streaming calls it through
+// heightSource(), and generateBatch() spreads a list over all workers.
+// Only one caller should ask for a given tile at a time.
+class TerrainGenerator {
+public:
+    struct Stats {
+        size_t generated = 0;
+        size_t loaded = 0;            // from the cache
+        double generateSeconds = 0.0; // summed over threads
+        double loadSeconds = 0.0;
+
+        // Per thread, for sizing streaming radii: a ring of N chunks takes
+        // N / (tilesPerSecond() * workers) seconds to fill
+        double tilesPerSecond() const { return generateSeconds > 0.0 ? generated / generateSeconds : 0.0; }
+    };
+
+    struct BatchReport {
+        size_t tiles = 0;
+        size_t generated = 0;
+        size_t loaded = 0;
+        double seconds = 0.0;  // wall clock
+
+        double tilesPerSecond() const { return seconds > 0.0 ? tiles / seconds : 0.0; }
+    };
+
+    TerrainGenerator(const TerrainGeneratorSettings& generatorSettings, std::vector<TerrainClimate> climateList)
+        : settings(generatorSettings), climates(std::move(climateList)) {
+        settings.samples = std::max(settings.samples, 2);
+        key = computeKey();
+        if (!climates.empty()) {
+            auto coldest = std::min_element(climates.begin(), climates.end(), byTemperature);
+            auto warmest = std::max_element(climates.begin(), climates.end(), byTemperature);
+            auto driest = std::min_element(climates.begin(), climates.end(), byHumidity);
+            auto wettest = std::max_element(climates.begin(), climates.end(), byHumidity);
+            temperatureRange = glm::vec2(coldest->temperature, warmest->temperature) +
+                               glm::vec2(-settings.temperatureSpread, settings.temperatureSpread);
+            humidityRange = glm::vec2(driest->humidity, wettest->humidity) +
+                            glm::vec2(-settings.humiditySpread, settings.humiditySpread);
+        }
+        if (!settings.cacheDirectory.empty()) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+            cacheDirectory = settings.cacheDirectory + "/" + name;
+            std::error_code ec;
+            std::filesystem::create_directories(cacheDirectory, ec);
+        }
+    }
+
+    // The climates of a definitions file (game/definitions/climates.json)
+    static bool loadClimates(const std::string& path, std::vector<TerrainClimate>& climates, std::string& error) {
+        AssetFile file;
+        if (!file.open(path)) {
+            error = "cannot open " + path;
+            return false;
+        }
+        JsonValue root;
+        if (!JsonValue::parse(reinterpret_cast<const char*>(file.data()), file.size(), root, &error)) {
+            error = path + ": " + error;
+            return false;
+        }
+        const JsonValue& list = root["climates"];
+        climates.clear();
+        for (size_t i = 0; i < list.size(); ++i) {
+            TerrainClimate climate;
+            climate.id = list[i]["id"].asString();
+            climate.temperature = list[i]["temperature"].asFloat(climate.temperature);
+            climate.humidity = list[i]["humidity"].asFloat(climate.humidity);
+            climates.push_back(climate);
+        }
+        if (climates.empty()) {
+            error = path + ": no climates";
+            return false;
+        }
+        return true;
+    }
+
+    static uint32_t tileSeed(uint32_t worldSeed, int x, int z) {
+        return TerrainNoise::mixSeed(TerrainNoise::mixSeed(worldSeed, (uint32_t)x), (uint32_t)z);
+    }
+
+    // The tile from the cache, or generated (and cached) when it is not there
+    std::shared_ptr<const TerrainTile> tile(int x, int z) {
+        if (!cacheDirectory.empty()) {
+            auto start = std::chrono::high_resolution_clock::now();
+            std::shared_ptr<TerrainTile> cached = load(x, z);
+            if (cached) {
+                ++counters.loaded;
+                counters.loadNanos += elapsedNanos(start);
+                return cached;
+            }
+        }
+        std::shared_ptr<TerrainTile> generated = generate(x, z);
+        if (!cacheDirectory.empty()) store(*generated);
+        return generated;
+    }
+
+    // Generates the tile without looking at the cache
+    std::shared_ptr<TerrainTile> generate(int x, int z) {
+        auto start = std::chrono::high_resolution_clock::now();
+        auto result = std::make_shared<TerrainTile>();
+        TerrainTile& out = *result;
+        out.x = x;
+        out.z = z;
+        out.seed = tileSeed(settings.seed, x, z);
+        out.samples = settings.samples;
+        out.spacing = settings.tileSize / (settings.samples - 1);
+        out.origin = glm::vec2(x, z) * settings.tileSize;
+
+        // Heights with a one-sample border, so normals at the edges see the
+        // neighbours' slopes; rows padded to whole groups of four and then some
+        int bordered = settings.samples + 2;
+        int stride = ((bordered + 3) & ~3) + 4;
+        std::vector<float> grid((size_t)bordered * stride);
+        for (int row = 0; row < bordered; ++row) {
+            NoiseFloat4 worldZ = NoiseFloat4::set(out.origin.y + (row - 1) * out.spacing);
+            for (int column = 0; column < bordered; column += 4) {
+                float xs[4];
+                for (int lane = 0; lane < 4; ++lane) xs[lane] = out.origin.x + (column + lane - 1) * out.spacing;
+                height(NoiseFloat4::load(xs), worldZ).store(&grid[(size_t)row * stride + column]);
+            }
+        }
+
+        size_t count = out.sampleCount();
+        out.heights.resize(count);
+        out.normals.resize(count);
+        out.slopes.resize(count);
+        for (int j = 0; j < out.samples; ++j) {
+            const float* below = &grid[(size_t)j * stride];
+            const float* row = below + stride;
+            const float* above = row + stride;
+            for (int i = 0; i < out.samples; ++i) {
+                size_t index = (size_t)j * out.samples + i;
+                out.heights[index] = row[i + 1];
+                // Central differences over the bordered grid, so edge
+                // normals match the neighbouring tile's
+                glm::vec3 normal = glm::normalize(glm::vec3(row[i] - row[i + 2], 2.0f * out.spacing, below[i + 1] - above[i + 1]));
+                out.normals[index] = packNormal(normal);
+                float angle = std::acos(std::min(normal.y, 1.0f)) * (2.0f / 3.14159265f);
+                out.slopes[index] = (uint8_t)std::lround(std::min(angle, 1.0f) * 255.0f);
+            }
+        }
+
+        computeBiomes(out);
+        ++counters.generated;
+        counters.generateNanos += elapsedNanos(start);
+        return result;
+    }
+
+    // Every tile of the list, spread over the JobSystem with the caller
+    // helping; the report gives the wall-clock throughput
+    std::vector<std::shared_ptr<const TerrainTile>> generateBatch(const std::vector<glm::ivec2>& coords,
+                                                                  BatchReport* report = nullptr) {
+        std::vector<std::shared_ptr<const TerrainTile>> tiles(coords.size());
+        Stats before = getStats();
+        auto start = std::chrono::high_resolution_clock::now();
+        JobSystem::getInstance().parallelFor(coords.size(), [this, &tiles, &coords](size_t i) {
+            tiles[i] = tile(coords[i].x, coords[i].y);
+        });
+        if (report) {
+            Stats after = getStats();
+            report->tiles = coords.size();
+            report->generated = after.generated - before.generated;
+            report->loaded = after.loaded - before.loaded;
+            report->seconds = elapsedNanos(start) * 1e-9;
+        }
+        return tiles;
+    }
+
+    // Feeds Terrain chunks from tiles, heights and normals; the terrain's
+    // chunk size and samples must match the tiles'. Slopes and biome masks
+    // stay in the cached tile for whatever scatters on it.
+    TerrainHeightSource heightSource() {
+        return [this](TerrainChunkData& data) {
+            if (data.samples != settings.samples ||
+                std::abs(data.spacing * (data.samples - 1) - settings.tileSize) > 1e-3f) {
+                return false;
+            }
+            std::shared_ptr<const TerrainTile> generated = tile(data.chunkX, data.chunkZ);
+            data.heights = generated->heights;
+            data.normals = generated->normals;
+            return true;
+        };
+    }
+
+    Stats getStats() const {
+        Stats stats;
+        stats.generated = counters.generated;
+        stats.loaded = counters.loaded;
+        stats.generateSeconds = counters.generateNanos * 1e-9;
+        stats.loadSeconds = counters.loadNanos * 1e-9;
+        return stats;
+    }
+
+    const TerrainGeneratorSettings& getSettings() const { return settings; }
+    const std::vector<TerrainClimate>& getClimates() const { return climates; }
+    uint64_t getKey() const { return key; }
+
+    std::string cachePath(int x, int z) const {
+        char name[48];
+        std::snprintf(name, sizeof(name), "/%d_%d.tile", x, z);
+        return cacheDirectory + name;
+    }
+
+private:
+    struct Counters {
+        std::atomic<size_t> generated{0};
+        std::atomic<size_t> loaded{0};
+        std::atomic<uint64_t> generateNanos{0};
+        std::atomic<uint64_t> loadNanos{0};
+    };
+
+    TerrainGeneratorSettings settings;
+    std::vector<TerrainClimate> climates;
+    glm::vec2 temperatureRange = glm::vec2(0.0f);
+    glm::vec2 humidityRange = glm::vec2(0.0f);
+    uint64_t key = 0;
+    std::string cacheDirectory;
+    Counters counters;
+
+    static bool byTemperature(const TerrainClimate& a, const TerrainClimate& b) { return a.temperature < b.temperature; }
+    static bool byHumidity(const TerrainClimate& a, const TerrainClimate& b) { return a.humidity < b.humidity; }
+
+    static uint64_t elapsedNanos(std::chrono::high_resolution_clock::time_point start) {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    uint32_t seedFor(uint32_t salt) const { return TerrainNoise::mixSeed(settings.seed, salt); }
+
+    NoiseFloat4 height(NoiseFloat4 x, NoiseFloat4 z) const {
+        using F4 = NoiseFloat4;
+        F4 baseX = x * F4::set(1.0f / settings.featureSize);
+        F4 baseZ = z * F4::set(1.0f / settings.featureSize);
+        TerrainNoise::warp(baseX, baseZ, seedFor(1), settings.warpStrength, settings.warp);
+
+        F4 continent = TerrainNoise::fbm(baseX, baseZ, seedFor(2), settings.continents);
+        F4 half = F4::set(0.5f);
+        F4 mask = TerrainNoise::smoothstep(-0.2f, 0.4f,
+            TerrainNoise::fbm(baseX * half, baseZ * half, seedFor(3), settings.mountainMask));
+        F4 ridgeScale = F4::set(1.7f);
+        F4 mountain = TerrainNoise::ridged(baseX * ridgeScale, baseZ * ridgeScale, seedFor(4), settings.mountains);
+        F4 detail = TerrainNoise::fbm(x * F4::set(1.0f / settings.detailSize), z * F4::set(1.0f / settings.detailSize),
+                                      seedFor(5), settings.detail);
+
+        F4 shape = continent * F4::set(0.3f) + mask * mountain * F4::set(0.9f);
+        return shape * F4::set(settings.heightScale) + detail * F4::set(settings.detailHeight);
+    }
+
+    // Temperature (falling with altitude) and humidity from two
+    // low-frequency fields, then one weight per climate by how close the
+    // sample is to the climate's own values, normalized to 255
+    void computeBiomes(TerrainTile& out) const {
+        if (climates.empty()) return;
+        using F4 = NoiseFloat4;
+        size_t count = out.sampleCount();
+        out.biomes.assign(count * climates.size(), 0);
+        std::vector<float> weights(climates.size());
+
+        F4 one = F4::set(1.0f);
+        F4 scale = F4::set(1.0f / settings.climateSize);
+        for (int j = 0; j < out.samples; ++j) {
+            F4 z = F4::set(out.origin.y + j * out.spacing) * scale;
+            for (int i = 0; i < out.samples; i += 4) {
+                float xs[4];
+                for (int lane = 0; lane < 4; ++lane) xs[lane] = out.origin.x + (i + lane) * out.spacing;
+                F4 x = F4::load(xs) * scale;
+                // fbm rarely leaves -0.5..0.5; stretch that over the climates' range
+                F4 warmth = F4::min(F4::max(TerrainNoise::fbm(x, z, seedFor(10), settings.climate) * F4::set(2.0f), F4::set(-1.0f)), one);
+                F4 wetness = F4::min(F4::max(TerrainNoise::fbm(x + F4::set(17.3f), z - F4::set(8.1f), seedFor(11), settings.climate) * F4::set(2.0f), F4::set(-1.0f)), one);
+                float temperatures[4], humidities[4];
+                warmth.store(temperatures);
+                wetness.store(humidities);
+
+                int lanes = std::min(4, out.samples - i);
+                for (int lane = 0; lane < lanes; ++lane) {
+                    size_t index = (size_t)j * out.samples + i + lane;
+                    float altitude = std::max(out.heights[index], 0.0f);
+                    float temperature = mixRange(temperatureRange, temperatures[lane]) - settings.lapseRate * altitude * 0.001f;
+                    float humidity = mixRange(humidityRange, humidities[lane]);
+                    writeBiomeWeights(out, index, temperature, humidity, weights);
+                }
+            }
+        }
+    }
+
+    static float mixRange(const glm::vec2& range, float signedAmount) {
+        return range.x + (range.y - range.x) * (signedAmount * 0.5f + 0.5f);
+    }
+
+    void writeBiomeWeights(TerrainTile& out, size_t index, float temperature, float humidity,
+                           std::vector<float>& weights) const {
+        float total = 0.0f;
+        size_t nearest = 0;
+        for (size_t c = 0; c < climates.size(); ++c) {
+            float dt = (temperature - climates[c].temperature) / settings.temperatureSpread;
+            float dh = (humidity - climates[c].humidity) / settings.humiditySpread;
+            weights[c] = std::exp(-(dt * dt + dh * dh));
+            total += weights[c];
+            if (weights[c] > weights[nearest]) nearest = c;
+        }
+
+        // Rounding leftovers go to the strongest climate so masks sum to 255
+        size_t count = out.sampleCount();
+        int assigned = 0;
+        for (size_t c = 0; c < climates.size(); ++c) {
+            int value = total > 1e-20f ? (int)(weights[c] / total * 255.0f + 0.5f) : 0;
+            if (c == nearest) continue;
+            out.biomes[c * count + index] = (uint8_t)value;
+            assigned += value;
+        }
+        out.biomes[nearest * count + index] = (uint8_t)std::max(0, 255 - assigned);
+    }
+
+    static uint32_t packNormal(const glm::vec3& normal) {
+        glm::vec3 unit = glm::clamp(normal * 0.5f + 0.5f, 0.0f, 1.0f) * 255.0f + 0.5f;
+        return (uint32_t)unit.x | ((uint32_t)unit.y << 8) | ((uint32_t)unit.z << 16) | (255u << 24);
+    }
+
+    // Hash of everything a tile depends on besides its coordinates
+    uint64_t computeKey() const {
+        std::vector<uint8_t> bytes;
+        auto add = [&bytes](const void* data, size_t size) { CookedAsset::append(bytes, data, size); };
+        auto addOctaves = [&add](const NoiseOctaves& octaves) {
+            add(&octaves.octaves, sizeof(octaves.octaves));
+            add(&octaves.lacunarity, sizeof(octaves.lacunarity));
+            add(&octaves.gain, sizeof(octaves.gain));
+        };
+        add(&TERRAIN_TILE_VERSION, sizeof(TERRAIN_TILE_VERSION));
+        add(&settings.seed, sizeof(settings.seed));
+        add(&settings.tileSize, sizeof(settings.tileSize));
+        add(&settings.samples, sizeof(settings.samples));
+        add(&settings.featureSize, sizeof(settings.featureSize));
+        add(&settings.heightScale, sizeof(settings.heightScale));
+        add(&settings.warpStrength, sizeof(settings.warpStrength));
+        addOctaves(settings.warp);
+        addOctaves(settings.continents);
+        addOctaves(settings.mountainMask);
+        addOctaves(settings.mountains);
+        add(&settings.detailSize, sizeof(settings.detailSize));
+        add(&settings.detailHeight, sizeof(settings.detailHeight));
+        addOctaves(settings.detail);
+        add(&settings.climateSize, sizeof(settings.climateSize));
+        addOctaves(settings.climate);
+        add(&settings.lapseRate, sizeof(settings.lapseRate));
+        add(&settings.temperatureSpread, sizeof(settings.temperatureSpread));
+        add(&settings.humiditySpread, sizeof(settings.humiditySpread));
+        for (const TerrainClimate& climate : climates) {
+            add(climate.id.data(), climate.id.size() + 1);
+            add(&climate.temperature, sizeof(climate.temperature));
+            add(&climate.humidity, sizeof(climate.humidity));
+        }
+        return ContentHash::hash(bytes.data(), bytes.size());
+    }
+
+    size_t rawSize() const {
+        size_t count = (size_t)settings.samples * settings.samples;
+        return count * (sizeof(float) + sizeof(uint32_t) + 1 + climates.size());
+    }
+
+    std::shared_ptr<TerrainTile> load(int x, int z) const {
+        std::string path = cachePath(x, z);
+        MappedFile file;
+        if (!file.open(path)) return nullptr;
+
+        TerrainTileHeader header = {};
+        if (file.size() >= sizeof(header)) std::memcpy(&header, file.data(), sizeof(header));
+        std::vector<uint8_t> raw(rawSize());
+        bool valid = header.magic == TERRAIN_TILE_MAGIC && header.version == TERRAIN_TILE_VERSION &&
+                     header.key == key && header.x == x && header.z == z &&
+                     header.samples == (uint32_t)settings.samples && header.climates == climates.size() &&
+                     header.rawSize == raw.size() && header.packedSize == file.size() - sizeof(header) &&
+                     LZ4::decompress(file.data() + sizeof(header), header.packedSize, raw.data(), raw.size());
+        if (!valid) {
+            // Stale or corrupt; the regenerated tile replaces it
+            file.close();
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+            return nullptr;
+        }
+
+        auto result = std::make_shared<TerrainTile>();
+        TerrainTile& out = *result;
+        out.x = x;
+        out.z = z;
+        out.seed = header.seed;
+        out.samples = settings.samples;
+        out.spacing = settings.tileSize / (settings.samples - 1);
+        out.origin = glm::vec2(x, z) * settings.tileSize;
+        size_t count = out.sampleCount();
+        const uint8_t* cursor = raw.data();
+        out.heights.resize(count);
+        std::memcpy(out.heights.data(), cursor, count * sizeof(float));
+        cursor += count * sizeof(float);
+        out.normals.resize(count);
+        std::memcpy(out.normals.data(), cursor, count * sizeof(uint32_t));
+        cursor += count * sizeof(uint32_t);
+        out.slopes.assign(cursor, cursor + count);
+        cursor += count;
+        out.biomes.assign(cursor, cursor + count * climates.size());
+        return result;
+    }
+
+    // A failed write only costs regenerating the tile next time
+    void store(const TerrainTile& tile) const {
+        std::vector<uint8_t> raw;
+        raw.reserve(rawSize());
+        CookedAsset::append(raw, tile.heights.data(), tile.heights.size() * sizeof(float));
+        CookedAsset::append(raw, tile.normals.data(), tile.normals.size() * sizeof(uint32_t));
+        CookedAsset::append(raw, tile.slopes.data(), tile.slopes.size());
+        CookedAsset::append(raw, tile.biomes.data(), tile.biomes.size());
+
+        std::vector<uint8_t> packed;
+        LZ4::compress(raw.data(), raw.size(), packed);
+
+        TerrainTileHeader header = {};
+        header.magic = TERRAIN_TILE_MAGIC;
+        header.version = TERRAIN_TILE_VERSION;
+        header.key = key;
+        header.x = tile.x;
+        header.z = tile.z;
+        header.samples = (uint32_t)tile.samples;
+        header.climates = (uint32_t)climates.size();
+        header.seed = tile.seed;
+        header.rawSize = (uint32_t)raw.size();
+        header.packedSize = (uint32_t)packed.size();
+
+        std::vector<uint8_t> out;
+        out.reserve(sizeof(header) + packed.size());
+        CookedAsset::append(out, &header, sizeof(header));
+        CookedAsset::append(out, packed.data(), packed.size());
+        std::string error;
+        CookedAsset::write(cachePath(tile.x, tile.z), out, error);
+    }
+};
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TERRAIN_NOISE_SSE2 1
+#endif
+
+// Four lanes of float / uint32 math: SSE2 registers where available, plain
+// arrays otherwise. Both do the same IEEE operations in the same order, so a
+// tile comes out bit-identical either way.
+#ifdef TERRAIN_NOISE_SSE2
+struct NoiseInt4 {
+    __m128i v;
+
+    static NoiseInt4 set(uint32_t value) { return {_mm_set1_epi32((int)value)}; }
+    NoiseInt4 operator+(NoiseInt4 o) const { return {_mm_add_epi32(v, o.v)}; }
+    NoiseInt4 operator^(NoiseInt4 o) const { return {_mm_xor_si128(v, o.v)}; }
+    NoiseInt4 operator&(NoiseInt4 o) const { return {_mm_and_si128(v, o.v)}; }
+    NoiseInt4 operator>>(int bits) const { return {_mm_srli_epi32(v, bits)}; }
+
+    // Low 32 bits of each product; SSE2 only multiplies lanes 0 and 2
+    NoiseInt4 operator*(NoiseInt4 o) const {
+        __m128i even = _mm_mul_epu32(v, o.v);
+        __m128i odd = _mm_mul_epu32(_mm_srli_si128(v, 4), _mm_srli_si128(o.v, 4));
+        return {_mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                   _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)))};
+    }
+};
+
+struct NoiseFloat4 {
+    __m128 v;
+
+    static NoiseFloat4 set(float value) { return {_mm_set1_ps(value)}; }
+    static NoiseFloat4 load(const float* values) { return {_mm_loadu_ps(values)}; }
+    void store(float* values) const { _mm_storeu_ps(values, v); }
+
+    NoiseFloat4 operator+(NoiseFloat4 o) const { return {_mm_add_ps(v, o.v)}; }
+    NoiseFloat4 operator-(NoiseFloat4 o) const { return {_mm_sub_ps(v, o.v)}; }
+    NoiseFloat4 operator*(NoiseFloat4 o) const { return {_mm_mul_ps(v, o.v)}; }
+
+    static NoiseFloat4 min(NoiseFloat4 a, NoiseFloat4 b) { return {_mm_min_ps(a.v, b.v)}; }
+    static NoiseFloat4 max(NoiseFloat4 a, NoiseFloat4 b) { return {_mm_max_ps(a.v, b.v)}; }
+    static NoiseFloat4 abs(NoiseFloat4 a) { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)}; }
+
+    // Floor of values within int range; truncation rounds negatives up, so
+    // those are stepped down by one
+    static NoiseFloat4 floor(NoiseFloat4 a, NoiseInt4& asInt) {
+        __m128i truncated = _mm_cvttps_epi32(a.v);
+        __m128 t = _mm_cvtepi32_ps(truncated);
+        __m128i above = _mm_castps_si128(_mm_cmpgt_ps(t, a.v));
+        asInt = {_mm_add_epi32(truncated, above)};
+        return {_mm_sub_ps(t, _mm_and_ps(_mm_castsi128_ps(above), _mm_set1_ps(1.0f)))};
+    }
+
+    // Lanes below 2^31
+    static NoiseFloat4 fromInt(NoiseInt4 a) { return {_mm_cvtepi32_ps(a.v)}; }
+};
+#else
+struct NoiseInt4 {
+    uint32_t v[4];
+
+    static NoiseInt4 set(uint32_t value) { return {{value, value, value, value}}; }
+    template <typename Op>
+    NoiseInt4 map(NoiseInt4 o, Op op) const {
+        return {{op(v[0], o.v[0]), op(v[1], o.v[1]), op(v[2], o.v[2]), op(v[3], o.v[3])}};
+    }
+    NoiseInt4 operator+(NoiseInt4 o) const { return map(o, [](uint32_t a, uint32_t b) { return a + b; }); }
+    NoiseInt4 operator^(NoiseInt4 o) const { return map(o, [](uint32_t a, uint32_t b) { return a ^ b; }); }
+    NoiseInt4 operator&(NoiseInt4 o) const { return map(o, [](uint32_t a, uint32_t b) { return a & b; }); }
+    NoiseInt4 operator*(NoiseInt4 o) const { return map(o, [](uint32_t a, uint32_t b) { return a * b; }); }
+    NoiseInt4 operator>>(int bits) const { return {{v[0] >> bits, v[1] >> bits, v[2] >> bits, v[3] >> bits}}; }
+};
+
+struct NoiseFloat4 {
+    float v[4];
+
+    static NoiseFloat4 set(float value) { return {{value, value, value, value}}; }
+    static NoiseFloat4 load(const float* values) { return {{values[0], values[1], values[2], values[3]}}; }
+    void store(float* values) const { std::copy(v, v + 4, values); }
+
+    template <typename Op>
+    NoiseFloat4 map(NoiseFloat4 o, Op op) const {
+        return {{op(v[0], o.v[0]), op(v[1], o.v[1]), op(v[2], o.v[2]), op(v[3], o.v[3])}};
+    }
+    NoiseFloat4 operator+(NoiseFloat4 o) const { return map(o, [](float a, float b) { return a + b; }); }
+    NoiseFloat4 operator-(NoiseFloat4 o) const { return map(o, [](float a, float b) { return a - b; }); }
+    NoiseFloat4 operator*(NoiseFloat4 o) const { return map(o, [](float a, float b) { return a * b; }); }
+
+    static NoiseFloat4 min(NoiseFloat4 a, NoiseFloat4 b) { return a.map(b, [](float x, float y) { return y < x ? y : x; }); }
+    static NoiseFloat4 max(NoiseFloat4 a, NoiseFloat4 b) { return a.map(b, [](float x, float y) { return y > x ? y : x; }); }
+    static NoiseFloat4 abs(NoiseFloat4 a) { return a.map(a, [](float x, float) { return std::fabs(x); }); }
+
+    static NoiseFloat4 floor(NoiseFloat4 a, NoiseInt4& asInt) {
+        NoiseFloat4 out;
+        for (int i = 0; i < 4; ++i) {
+            int32_t truncated = (int32_t)a.v[i];
+            float t = (float)truncated;
+            if (t > a.v[i]) {
+                --truncated;
+                t -= 1.0f;
+            }
+            asInt.v[i] = (uint32_t)truncated;
+            out.v[i] = t;
+        }
+        return out;
+    }
+
+    static NoiseFloat4 fromInt(NoiseInt4 a) {
+        return {{(float)(int32_t)a.v[0], (float)(int32_t)a.v[1], (float)(int32_t)a.v[2], (float)(int32_t)a.v[3]}};
+    }
+};
+#endif
+
+// Octave parameters shared by the fractal sums
+struct NoiseOctaves {
+    int octaves = 6;
+    float lacunarity = 2.0f;  // frequency step per octave
+    float gain = 0.5f;        // amplitude step per octave
+};
+
+// Gradient noise and fractals over it, four points per call. Lattice
+// gradients come from an integer hash of the cell and seed, so there are no
+// tables and any seed gives an independent field.
+class TerrainNoise {
+public:
+    using F4 = NoiseFloat4;
+    using I4 = NoiseInt4;
+
+    // Seed for a sub-field (octave, warp axis, biome channel)
+    static uint32_t mixSeed(uint32_t seed, uint32_t salt) {
+        uint32_t h = seed ^ (salt * 0x9E3779B9u);
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+    // Perlin-style gradient noise, roughly -1..1, 0 on lattice points
+    static F4 gradient(F4 x, F4 z, uint32_t seed) {
+        I4 ix, iz;
+        F4 fx = F4::floor(x, ix);
+        F4 fz = F4::floor(z, iz);
+        F4 dx = x - fx;
+        F4 dz = z - fz;
+        F4 one = F4::set(1.0f);
+        F4 u = fade(dx);
+        F4 v = fade(dz);
+
+        I4 s = I4::set(seed);
+        I4 ix1 = ix + I4::set(1);
+        I4 iz1 = iz + I4::set(1);
+        F4 n00 = lattice(hash(ix, iz, s), dx, dz);
+        F4 n10 = lattice(hash(ix1, iz, s), dx - one, dz);
+        F4 n01 = lattice(hash(ix, iz1, s), dx, dz - one);
+        F4 n11 = lattice(hash(ix1, iz1, s), dx - one, dz - one);
+        F4 bottom = n00 + (n10 - n00) * u;
+        F4 top = n01 + (n11 - n01) * u;
+        return (bottom + (top - bottom) * v) * F4::set(1.4f);
+    }
+
+    // Fractional Brownian motion: octaves of gradient noise, normalized to
+    // roughly -1..1
+    static F4 fbm(F4 x, F4 z, uint32_t seed, const NoiseOctaves& params) {
+        F4 sum = F4::set(0.0f);
+        float amplitude = 1.0f;
+        float total = 0.0f;
+        for (int octave = 0; octave < params.octaves; ++octave) {
+            sum = sum + gradient(x, z, mixSeed(seed, octave)) * F4::set(amplitude);
+            total += amplitude;
+            amplitude *= params.gain;
+            x = x * F4::set(params.lacunarity);
+            z = z * F4::set(params.lacunarity);
+        }
+        return sum * F4::set(1.0f / total);
+    }
+
+    // Ridged multifractal (Musgrave): folded octaves make sharp crests, and
+    // each octave is weighted by the last so detail gathers on the ridges.
+    // Roughly 0..1.
+    static F4 ridged(F4 x, F4 z, uint32_t seed, const NoiseOctaves& params) {
+        F4 one = F4::set(1.0f);
+        F4 zero = F4::set(0.0f);
+        F4 sum = zero;
+        F4 weight = one;
+        float amplitude = 1.0f;
+        float total = 0.0f;
+        for (int octave = 0; octave < params.octaves; ++octave) {
+            F4 ridge = one - F4::abs(gradient(x, z, mixSeed(seed, octave)));
+            ridge = ridge * ridge * weight;
+            weight = F4::min(F4::max(ridge * F4::set(2.0f), zero), one);
+            sum = sum + ridge * F4::set(amplitude);
+            total += amplitude;
+            amplitude *= params.gain;
+            x = x * F4::set(params.lacunarity);
+            z = z * F4::set(params.lacunarity);
+        }
+        return sum * F4::set(1.0f / total);
+    }
+
+    // Offsets the point by two fbm fields (Quilez's domain warping), which
+    // bends straight noise features into folds and meanders
+    static void warp(F4& x, F4& z, uint32_t seed, float strength, const NoiseOctaves& params) {
+        F4 offsetX = fbm(x, z, mixSeed(seed, 101), params);
+        F4 offsetZ = fbm(x + F4::set(5.2f), z + F4::set(1.3f), mixSeed(seed, 202), params);
+        x = x + offsetX * F4::set(strength);
+        z = z + offsetZ * F4::set(strength);
+    }
+
+    static F4 smoothstep(float edge0, float edge1, F4 x) {
+        F4 t = F4::min(F4::max((x - F4::set(edge0)) * F4::set(1.0f / (edge1 - edge0)), F4::set(0.0f)), F4::set(1.0f));
+        return t * t * (F4::set(3.0f) - t * F4::set(2.0f));
+    }
+
+private:
+    // 6t^5 - 15t^4 + 10t^3
+    static F4 fade(F4 t) {
+        return t * t * t * (t * (t * F4::set(6.0f) - F4::set(15.0f)) + F4::set(10.0f));
+    }
+
+    static I4 hash(I4 x, I4 z, I4 seed) {
+        I4 h = (x * I4::set(0x27D4EB2Du)) ^ (z * I4::set(0x165667B1u)) ^ seed;
+        h = h ^ (h >> 15);
+        h = h * I4::set(0x2C1B3C6Du);
+        h = h ^ (h >> 12);
+        h = h * I4::set(0x297A2D39u);
+        return h ^ (h >> 15);
+    }
+
+    // Dot of the cell corner's gradient, both components from 16 hash bits,
+    // with the offset to the point
+    static F4 lattice(I4 h, F4 dx, F4 dz) {
+        F4 scale = F4::set(1.0f / 32767.5f);
+        F4 one = F4::set(1.0f);
+        F4 gx = F4::fromInt(h & I4::set(0xFFFF)) * scale - one;
+        F4 gz = F4::fromInt(h >> 16) * scale - one;
+        return gx * dx + gz * dz;
+    }
+};
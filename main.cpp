@@ -2,6 +2,7 @@
 #include <memory>
 #include <vector>
 #include <chrono>
+#include <cmath>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -10,7 +11,11 @@
 #include <GL/gl.h>
 
 #include "engine/render/FirstPersonCamera.h"
-#include "engine/render/PlaneGenerator.h"
+#include "engine/render/ShaderLibrary.h"
+#include "engine/render/GLUploadQueue.h"
+#include "engine/terrain/Terrain.h"
+#include "engine/terrain/TerrainGenerator.h"
+#include "engine/core/StartupGraph.h"
 
 class FirstPersonApp {
 private:
@@ -19,17 +24,39 @@ private:
     bool running = true;
     
     FirstPersonCamera camera;
-    GLuint VAO = 0, VBO = 0, EBO = 0;
-    GLuint shaderProgram = 0;
-    unsigned int planeIndexCount = 0;
+    std::unique_ptr<TerrainGenerator> terrainGenerator;
+    Terrain terrain;
+    ShaderLibrary::ShaderId terrainShader = 0;
+    GLuint terrainProgram = 0;
+    const UniformId fogColorId = UniformNames::id("fogColor");
+    const UniformId fogDensityId = UniformNames::id("fogDensity");
+    
+    // Chunks under the start position, generated on a worker during
+    // startup; the rest stream in from the render loop
+    std::vector<std::shared_ptr<Terrain::PreparedChunk>> startChunks;
+    
+    StartupGraph startup;
     
     const int WINDOW_WIDTH = 1280;
     const int WINDOW_HEIGHT = 720;
-    const float PLANE_WIDTH = 100.0f;
-    const float PLANE_HEIGHT = 100.0f;
+    const float EYE_HEIGHT = 1.7f;
+    const float START_RADIUS = 64.0f;
+    const char* CLIMATES_PATH = "game/definitions/climates.json";
     
 public:
-    FirstPersonApp() : camera(glm::vec3(0.0f, 2.0f, 10.0f)) {}
+    FirstPersonApp() : camera(glm::vec3(0.0f, 2.0f, 10.0f)) {
+        // Tiles the size of the terrain's chunks; biomes need the climates
+        std::vector<TerrainClimate> climates;
+        std::string error;
+        if (!TerrainGenerator::loadClimates(CLIMATES_PATH, climates, error)) {
+            std::cerr << "[ERROR] Terrain climates: " << error << "\n";
+        }
+        TerrainGeneratorSettings generatorSettings;
+        generatorSettings.tileSize = terrain.getSettings().chunkSize;
+        generatorSettings.samples = terrain.getSettings().chunkSamples;
+        terrainGenerator = std::make_unique<TerrainGenerator>(generatorSettings, std::move(climates));
+        terrain.setSource(terrainGenerator->heightSource());
+    }
     
     ~FirstPersonApp() {
         cleanup();
@@ -38,14 +65,42 @@ public:
     bool initialize() {
         std::cout << "[START] First-Person Camera Demo\n";
         
-        // Initialize SDL
+        // The ground under the camera is generated on a worker while the
+        // window, context and shaders come up here; only its upload waits
+        using Thread = StartupGraph::Thread;
+        auto sdl = startup.add("sdl-init", Thread::MAIN, [this]() { return initSDL(); });
+        auto windowTask = startup.add("window", Thread::MAIN, [this]() { return createWindow(); }, {sdl});
+        auto glew = startup.add("glew", Thread::MAIN, [this]() { return initGL(); }, {windowTask});
+        startup.add("shaders", Thread::MAIN, [this]() { return createShaders(); }, {glew});
+        auto ground = startup.add("terrain-generate", Thread::WORKER, [this]() { return generateTerrain(); });
+        startup.add("terrain-upload", Thread::MAIN, [this]() { return uploadTerrain(); }, {glew, ground});
+        
+        bool ok = startup.run();
+        startup.printReport(std::cout);
+        if (!ok) {
+            return false;
+        }
+        
+        std::cout << "[INFO] Controls:\n";
+        std::cout << "  W/A/S/D - Move forward/left/back/right\n";
+        std::cout << "  Space/Ctrl - Move up/down\n";
+        std::cout << "  Mouse - Look around\n";
+        std::cout << "  ESC - Exit\n";
+        
+        return true;
+    }
+    
+    bool initSDL() {
         if (SDL_Init(SDL_INIT_VIDEO) < 0) {
             std::cerr << "[ERROR] SDL Init failed: " << SDL_GetError() << "\n";
             return false;
         }
         std::cout << "[OK] SDL initialized\n";
-        
-        // Create window
+        return true;
+    }
+    
+    // Window and OpenGL context; cleanup() releases whichever was created
+    bool createWindow() {
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
         SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
@@ -61,29 +116,24 @@ public:
         
         if (!window) {
             std::cerr << "[ERROR] Window creation failed: " << SDL_GetError() << "\n";
-            SDL_Quit();
             return false;
         }
         std::cout << "[OK] Window created\n";
         
-        // Create OpenGL context
         glContext = SDL_GL_CreateContext(window);
         if (!glContext) {
             std::cerr << "[ERROR] OpenGL context failed: " << SDL_GetError() << "\n";
-            SDL_DestroyWindow(window);
-            SDL_Quit();
             return false;
         }
         std::cout << "[OK] OpenGL context created\n";
-        
-        // Initialize GLEW
+        return true;
+    }
+    
+    bool initGL() {
         glewExperimental = GL_TRUE;
         GLenum err = glewInit();
         if (GLEW_OK != err) {
             std::cerr << "[ERROR] GLEW init failed\n";
-            SDL_GL_DeleteContext(glContext);
-            SDL_DestroyWindow(window);
-            SDL_Quit();
             return false;
         }
         std::cout << "[OK] GLEW initialized\n";
@@ -93,138 +143,55 @@ public:
         glEnable(GL_DEPTH_TEST);
         glEnable(GL_CULL_FACE);
         SDL_GL_SetSwapInterval(1);
-        
-        // Create shaders
-        if (!createShaders()) {
-            return false;
-        }
-        
-        // Create plane
-        if (!createPlane()) {
-            return false;
-        }
-        
-        std::cout << "[INFO] Controls:\n";
-        std::cout << "  W/A/S/D - Move forward/left/back/right\n";
-        std::cout << "  Space/Ctrl - Move up/down\n";
-        std::cout << "  Mouse - Look around\n";
-        std::cout << "  ESC - Exit\n";
-        
         return true;
     }
     
     bool createShaders() {
-        // Vertex shader
-        const char* vertexShaderSource = R"glsl(
-            #version 330 core
-            layout (location = 0) in vec3 aPosition;
-            layout (location = 1) in vec3 aColor;
-            
-            uniform mat4 view;
-            uniform mat4 projection;
-            
-            out vec3 vertexColor;
-            
-            void main() {
-                gl_Position = projection * view * vec4(aPosition, 1.0);
-                vertexColor = aColor;
-            }
-        )glsl";
-        
-        // Fragment shader
-        const char* fragmentShaderSource = R"glsl(
-            #version 330 core
-            in vec3 vertexColor;
-            out vec4 FragColor;
-            
-            void main() {
-                FragColor = vec4(vertexColor, 1.0);
-            }
-        )glsl";
-        
-        // Compile vertex shader
-        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-        glCompileShader(vertexShader);
-        
-        // Check for errors
-        int success;
-        char infoLog[512];
-        glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-            std::cerr << "[ERROR] Vertex shader compilation failed: " << infoLog << "\n";
+        // engine/render/shaders/terrain.*, loaded from the program binary
+        // cache after the first run
+        ShaderProgramDesc terrainDesc;
+        terrainDesc.name = "terrain";
+        terrainDesc.vertexPath = "engine/render/shaders/terrain.vert";
+        terrainDesc.fragmentPath = "engine/render/shaders/terrain.frag";
+        terrainDesc.keywords = {"FOG", "CPU_HEIGHTS"};
+        terrainDesc.attributes = {{0, "aGrid"}, {1, "aHeight"}, {2, "aNormal"}, {3, "aMorphNormal"}};
+        ShaderLibrary& library = ShaderLibrary::getInstance();
+        terrainShader = library.add(terrainDesc);
+        std::vector<std::string> keywords = {"FOG"};
+        if (!Terrain::vertexTexturesSupported()) keywords.push_back("CPU_HEIGHTS");
+        terrainProgram = library.variant(terrainShader, library.mask(terrainShader, keywords));
+        if (!terrainProgram) {
+            std::cerr << "[ERROR] Terrain shader failed\n";
             return false;
         }
         
-        // Compile fragment shader
-        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-        glCompileShader(fragmentShader);
+        // Fog that reaches the clear colour at the edge of the view radius
+        glUseProgram(terrainProgram);
+        ParameterBlock& params = ShaderReflection::getInstance().parameters(terrainProgram);
+        params.set(fogColorId, glm::vec3(0.1f, 0.15f, 0.2f));
+        params.set(fogDensityId, 2.0f / terrain.viewRadius());
+        params.apply();
+        glUseProgram(0);
         
-        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-            std::cerr << "[ERROR] Fragment shader compilation failed: " << infoLog << "\n";
-            return false;
-        }
-        
-        // Link shaders
-        shaderProgram = glCreateProgram();
-        glAttachShader(shaderProgram, vertexShader);
-        glAttachShader(shaderProgram, fragmentShader);
-        glLinkProgram(shaderProgram);
-        
-        glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-        if (!success) {
-            glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-            std::cerr << "[ERROR] Shader program linking failed: " << infoLog << "\n";
-            return false;
-        }
-        
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        
-        std::cout << "[OK] Shaders compiled successfully\n";
+        ProgramCache::Stats cache = ProgramCache::getInstance().stats();
+        std::cout << "[OK] Shaders ready (" << cache.loaded << " from cache, " << cache.compiled << " compiled)\n";
         return true;
     }
     
-    bool createPlane() {
-        // Generate plane
-        auto vertices = PlaneGenerator::generatePlane(PLANE_WIDTH, PLANE_HEIGHT, 50);
-        auto indices = PlaneGenerator::generatePlaneIndices(50);
-        planeIndexCount = indices.size();
-        
-        std::cout << "[INFO] Plane: " << vertices.size() << " vertices, " 
-                  << planeIndexCount << " indices\n";
-        
-        // Create VAO, VBO, EBO
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-        
-        glBindVertexArray(VAO);
-        
-        // VBO
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
-        
-        // EBO
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-        
-        // Position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
-        glEnableVertexAttribArray(0);
-        
-        // Color attribute
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
-        glEnableVertexAttribArray(1);
-        
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
-        
-        std::cout << "[OK] Plane created\n";
+    // Worker thread: heights of the chunks around the camera, no GL
+    bool generateTerrain() {
+        startChunks = terrain.prepareAround(camera.position, START_RADIUS);
+        TerrainGenerator::Stats generated = terrainGenerator->getStats();
+        std::cout << "[INFO] Terrain: " << startChunks.size() << " start chunks (" << generated.generated
+                  << " generated, " << generated.loaded << " from cache), view radius " << terrain.viewRadius() << " m\n";
+        return true;
+    }
+    
+    bool uploadTerrain() {
+        terrain.create();
+        for (const auto& chunk : startChunks) terrain.install(chunk);
+        startChunks.clear();
+        std::cout << "[OK] Terrain created\n";
         return true;
     }
     
@@ -282,38 +249,41 @@ public:
             if (keys[SDL_SCANCODE_SPACE]) camera.moveUp(deltaTime);
             if (keys[SDL_SCANCODE_LCTRL] || keys[SDL_SCANCODE_RCTRL]) camera.moveDown(deltaTime);
             
-            // Collision detection with ground (plane at y=0)
-            const float GROUND_LEVEL = 0.5f;  // Player eye height above ground
-            if (camera.position.y < GROUND_LEVEL) {
-                camera.position.y = GROUND_LEVEL;
+            // Terrain chunks finished on workers, then the ones to load next
+            GLUploadQueue::getInstance().drain();
+            terrain.update(camera.position);
+            
+            // Keep the eye above the ground (where it is loaded)
+            float ground = 0.0f;
+            if (terrain.heightAt(camera.position.x, camera.position.z, ground) &&
+                camera.position.y < ground + EYE_HEIGHT) {
+                camera.position.y = ground + EYE_HEIGHT;
             }
             
             // Render
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
             
-            glUseProgram(shaderProgram);
-            
             glm::mat4 view = camera.getViewMatrix();
-            glm::mat4 projection = camera.getProjectionMatrix(45.0f, (float)WINDOW_WIDTH / WINDOW_HEIGHT, 0.1f, 1000.0f);
-            
-            GLint viewLoc = glGetUniformLocation(shaderProgram, "view");
-            GLint projLoc = glGetUniformLocation(shaderProgram, "projection");
-            
-            glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-            glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-            
-            glBindVertexArray(VAO);
-            glDrawElements(GL_TRIANGLES, planeIndexCount, GL_UNSIGNED_INT, 0);
+            glm::mat4 projection = camera.getProjectionMatrix(45.0f, (float)WINDOW_WIDTH / WINDOW_HEIGHT, 0.1f, terrain.viewRadius());
+            terrain.render(terrainProgram, view, projection, camera.position);
             
             SDL_GL_SwapWindow(window);
             
             frameCount++;
+            if (frameCount == 1) {
+                reportFirstFrame();
+            }
             
             // Performance output
             if (frameCount % 60 == 0) {
                 auto pos = camera.getPosition();
+                const TerrainStats& stats = terrain.getStats();
                 std::cout << "[FRAME " << frameCount << "] FPS: ~60 | "
-                          << "Pos: (" << (int)pos.x << ", " << (int)pos.y << ", " << (int)pos.z << ")\n";
+                          << "Pos: (" << (int)pos.x << ", " << (int)pos.y << ", " << (int)pos.z << ") | "
+                          << "Terrain: " << stats.drawnNodes << " nodes in " << stats.drawnChunks << "/"
+                          << stats.resident << " chunks, " << stats.triangles << " tris, "
+                          << stats.loading << " loading, "
+                          << (int)terrainGenerator->getStats().tilesPerSecond() << " tiles/s per worker\n";
             }
         }
         
@@ -321,11 +291,18 @@ public:
     }
     
 private:
+    void reportFirstFrame() {
+        std::cout << "[INFO] First frame after " << (int)startup.markFirstFrame() << " ms\n";
+        if (startup.writeReport("startup_timing.json")) {
+            std::cout << "[INFO] Startup timing written to startup_timing.json\n";
+        }
+    }
+    
     void cleanup() {
-        if (VAO) glDeleteVertexArrays(1, &VAO);
-        if (VBO) glDeleteBuffers(1, &VBO);
-        if (EBO) glDeleteBuffers(1, &EBO);
-        if (shaderProgram) glDeleteProgram(shaderProgram);
+        if (glContext) {
+            terrain.destroy();
+            ShaderLibrary::getInstance().clear();
+        }
         
         if (glContext) SDL_GL_DeleteContext(glContext);
         if (window) SDL_DestroyWindow(window);
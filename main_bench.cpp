@@ -0,0 +1,520 @@
+// Asset pipeline benchmarks (CPU only, no window or GL context needed)
+//
+//   bench.exe                 run every benchmark
+//   bench.exe glb-loader      run the named benchmarks only
+//
+// hmesh-loader needs the cooked model (run cook.exe first)
+// terrain-generator reports tiles per second, for sizing streaming radii
+
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <string>
+#include <vector>
+
+#include "engine/assets/GLBFile.h"
+#include "engine/assets/MeshCooker.h"
+#include "engine/assets/MeshGeometry.h"
+#include "engine/assets/MeshOptimizer.h"
+#include "engine/assets/PackCooker.h"
+#include "engine/render/PlaneGenerator.h"
+#include "engine/terrain/TerrainGenerator.h"
+
+static const char* BENCH_MODEL = "game/assets/shared/models/old_television.glb";
+
+// Folds bytes into a value so the compiler cannot skip touching them
+static uint64_t checksum(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; i += 64) sum += bytes[i];
+    return sum;
+}
+
+static double timeMs(int iterations, const std::function<void()>& fn) {
+    fn();  // warm the page cache and allocator
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) fn();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+static void printResult(const std::string& name, double ms, size_t bytesCopied) {
+    std::cout << "  " << std::left << std::setw(28) << name
+              << std::right << std::fixed << std::setprecision(3) << std::setw(9) << ms << " ms/load  "
+              << std::setw(9) << std::setprecision(2) << bytesCopied / (1024.0 * 1024.0) << " MB copied\n";
+}
+
+// Legacy ifstream path: JSON into a std::string, BIN into a std::vector<char>,
+// every embedded image into its own vector, then a CPU-interleaved vertex
+// buffer as GLBMeshData::setupGL builds it.
+static bool legacyLoad(const std::string& path, size_t& bytesCopied, uint64_t& sum) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    uint32_t header[3];
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+    uint32_t chunk[2];
+    file.read(reinterpret_cast<char*>(chunk), sizeof(chunk));
+    std::string json(chunk[0], '\0');
+    file.read(&json[0], chunk[0]);
+
+    file.read(reinterpret_cast<char*>(chunk), sizeof(chunk));
+    std::vector<char> bin(chunk[0]);
+    file.read(bin.data(), chunk[0]);
+    bytesCopied = json.size() + bin.size();
+
+    GLTFDocument doc;
+    std::string error;
+    if (!doc.parse(json.data(), json.size(), reinterpret_cast<const uint8_t*>(bin.data()), bin.size(), error)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < doc.images.size(); ++i) {
+        GLTFImageRef ref = doc.imageRef((int)i);
+        std::vector<char> png(ref.data, ref.data + ref.size);
+        bytesCopied += png.size();
+        sum += checksum(png.data(), png.size());
+    }
+
+    GLTFModel model;
+    if (!GLTFLoader::buildModel(doc, model, error)) return false;
+
+    std::vector<float> vertexData;
+    vertexData.reserve(model.positions.size() * 8);
+    for (size_t i = 0; i < model.positions.size(); ++i) {
+        vertexData.insert(vertexData.end(), {model.positions[i].x, model.positions[i].y, model.positions[i].z,
+                                             model.normals[i].x, model.normals[i].y, model.normals[i].z,
+                                             model.texCoords[i].x, model.texCoords[i].y});
+    }
+    bytesCopied += model.positions.size() * (sizeof(glm::vec3) * 2 + sizeof(glm::vec2));
+    bytesCopied += model.indices.size() * sizeof(unsigned int);
+    bytesCopied += vertexData.size() * sizeof(float);
+
+    sum += checksum(vertexData.data(), vertexData.size() * sizeof(float));
+    sum += checksum(model.indices.data(), model.indices.size() * sizeof(unsigned int));
+    return true;
+}
+
+// Mapped path: the spans handed to glBufferData and the image decoder are
+// read straight from the mapping.
+static bool mappedLoad(const std::string& path, size_t& bytesCopied, uint64_t& sum) {
+    GLBFile file;
+    std::string error;
+    if (!file.open(path, error)) return false;
+    bytesCopied = 0;
+
+    const GLTFDocument& doc = file.document();
+    const GLTFPrimitive* prim = nullptr;
+    glm::mat4 world(1.0f);
+    if (!GLTFLoader::singlePrimitive(doc, prim, world)) return false;
+
+    const int accessors[] = {prim->position, prim->normal, prim->texCoord0, prim->indices};
+    int lastView = -1;
+    for (int accessor : accessors) {
+        if (accessor < 0) continue;
+        const GLTFAccessor* acc = doc.accessor(accessor, error);
+        if (!acc || acc->bufferView < 0) return false;
+        int view = acc->bufferView;
+        if (view == lastView) continue;  // position and normal share a view
+        ByteSpan span = file.bufferView(view);
+        sum += checksum(span.data, span.size);
+        lastView = view;
+    }
+
+    for (size_t i = 0; i < doc.images.size(); ++i) {
+        ByteSpan png = file.image((int)i);
+        sum += checksum(png.data, png.size);
+    }
+    return true;
+}
+
+static bool benchGLBLoader() {
+    const int iterations = 50;
+    std::cout << "[*] glb-loader: " << BENCH_MODEL << " (" << iterations << " iterations)\n";
+
+    size_t legacyBytes = 0, mappedBytes = 0;
+    uint64_t sum = 0;
+    bool ok = true;
+
+    double legacyMs = timeMs(iterations, [&]() { ok &= legacyLoad(BENCH_MODEL, legacyBytes, sum); });
+    double mappedMs = timeMs(iterations, [&]() { ok &= mappedLoad(BENCH_MODEL, mappedBytes, sum); });
+
+    if (!ok) {
+        std::cerr << "[ERROR] glb-loader: could not load " << BENCH_MODEL << "\n";
+        return false;
+    }
+
+    printResult("ifstream + copies", legacyMs, legacyBytes);
+    printResult("mmap + spans", mappedMs, mappedBytes);
+    std::cout << "  speedup: " << std::setprecision(2) << legacyMs / mappedMs << "x  (checksum " << sum << ")\n";
+    return true;
+}
+
+// Source path: parse the GLB, flatten it and interleave, as an uncooked load does
+static bool sourceMeshLoad(const std::string& path, size_t& bytesCopied, uint64_t& sum) {
+    GLTFModel model;
+    std::string error;
+    if (!GLBFile::loadModel(path, model, error)) return false;
+
+    std::vector<float> vertexData(model.positions.size() * 8);
+    for (size_t i = 0; i < model.positions.size(); ++i) {
+        float* v = &vertexData[i * 8];
+        v[0] = model.positions[i].x; v[1] = model.positions[i].y; v[2] = model.positions[i].z;
+        v[3] = model.normals[i].x;   v[4] = model.normals[i].y;   v[5] = model.normals[i].z;
+        v[6] = model.texCoords[i].x; v[7] = model.texCoords[i].y;
+    }
+    bytesCopied = model.positions.size() * (sizeof(glm::vec3) * 2 + sizeof(glm::vec2)) +
+                  model.indices.size() * sizeof(unsigned int) + vertexData.size() * sizeof(float);
+    sum += checksum(vertexData.data(), vertexData.size() * sizeof(float));
+    sum += checksum(model.indices.data(), model.indices.size() * sizeof(unsigned int));
+    return true;
+}
+
+// Cooked path: header validation, then the spans handed to glBufferData
+static bool cookedMeshLoad(const std::string& path, uint64_t& sum) {
+    HMeshFile file;
+    std::string error;
+    if (!file.open(path, error)) return false;
+    ByteSpan vertices = file.vertices();
+    ByteSpan indices = file.indices();
+    sum += checksum(vertices.data, vertices.size);
+    sum += checksum(indices.data, indices.size);
+    return true;
+}
+
+static bool benchHMeshLoader() {
+    const int iterations = 50;
+    std::string cooked = MeshCooker::cookedPath(BENCH_MODEL);
+    std::cout << "[*] hmesh-loader: " << cooked << " (" << iterations << " iterations)\n";
+
+    size_t sourceBytes = 0;
+    uint64_t sum = 0;
+    bool ok = true;
+    double sourceMs = timeMs(iterations, [&]() { ok &= sourceMeshLoad(BENCH_MODEL, sourceBytes, sum); });
+    double cookedMs = timeMs(iterations, [&]() { ok &= cookedMeshLoad(cooked, sum); });
+
+    if (!ok) {
+        std::cerr << "[ERROR] hmesh-loader: could not load " << cooked << " (run cook.exe)\n";
+        return false;
+    }
+
+    printResult("glb parse + interleave", sourceMs, sourceBytes);
+    printResult("hmesh mapping", cookedMs, 0);
+    std::cout << "  speedup: " << std::setprecision(2) << sourceMs / cookedMs << "x  (checksum " << sum << ")\n";
+    return true;
+}
+
+// One optimizer pass over a copy of the indices, timed, with cache stats after it
+static void benchOptimizerPass(const char* name, const std::vector<uint32_t>& input, size_t vertexCount,
+                               const std::function<void(std::vector<uint32_t>&)>& pass) {
+    const int iterations = 10;
+    std::vector<uint32_t> indices;
+    double ms = timeMs(iterations, [&]() {
+        indices = input;
+        pass(indices);
+    });
+    VertexCacheStats stats = MeshOptimizer::analyzeVertexCache(indices, vertexCount);
+    std::cout << "  " << std::left << std::setw(28) << name
+              << std::right << std::fixed << std::setprecision(3) << std::setw(9) << ms << " ms/mesh  "
+              << "ACMR " << stats.acmr << "  ATVR " << stats.atvr << "\n";
+}
+
+static void benchOptimizerMesh(const std::string& name, std::vector<uint32_t> indices, std::vector<glm::vec3> positions) {
+    const size_t vertexCount = positions.size();
+    VertexCacheStats input = MeshOptimizer::analyzeVertexCache(indices, vertexCount);
+    std::cout << "  " << name << ": " << vertexCount << " vertices, " << indices.size() / 3 << " triangles, input ACMR "
+              << std::fixed << std::setprecision(3) << input.acmr << "  ATVR " << input.atvr << "\n";
+
+    std::vector<uint32_t> cacheOrdered = indices;
+    MeshOptimizer::optimizeVertexCache(cacheOrdered, vertexCount);
+
+    benchOptimizerPass("vertex cache", indices, vertexCount, [&](std::vector<uint32_t>& out) {
+        MeshOptimizer::optimizeVertexCache(out, vertexCount);
+    });
+    benchOptimizerPass("overdraw (after cache)", cacheOrdered, vertexCount, [&](std::vector<uint32_t>& out) {
+        MeshOptimizer::optimizeOverdraw(out, positions);
+    });
+    benchOptimizerPass("vertex fetch (after cache)", cacheOrdered, vertexCount, [&](std::vector<uint32_t>& out) {
+        size_t uniqueCount = 0;
+        MeshOptimizer::optimizeVertexFetch(out, vertexCount, uniqueCount);
+    });
+
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    MeshOptimizeReport report = MeshOptimizer::optimizeMesh(indices, positions, normals, texCoords);
+    std::cout << "  all passes: " << report.summary() << "\n";
+}
+
+static bool benchMeshOptimizer() {
+    std::cout << "[*] mesh-optimizer: " << BENCH_MODEL << " and a 256x256 plane\n";
+
+    GLTFModel model;
+    std::string error;
+    if (!GLBFile::loadModel(BENCH_MODEL, model, error)) {
+        std::cerr << "[ERROR] mesh-optimizer: " << error << "\n";
+        return false;
+    }
+    benchOptimizerMesh("model", model.indices, model.positions);
+
+    const int subdivisions = 256;
+    std::vector<glm::vec3> planePositions;
+    for (const Vertex& v : PlaneGenerator::generatePlane(100.0f, 100.0f, subdivisions)) planePositions.push_back(v.position);
+    std::vector<unsigned int> planeIndices = PlaneGenerator::generatePlaneIndices(subdivisions, false);
+    benchOptimizerMesh("plane", planeIndices, planePositions);
+    return true;
+}
+
+// The scatter loop MeshGeometry replaced: one read-modify-write per corner
+static void scatterNormals(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+                           std::vector<glm::vec3>& normals) {
+    normals.assign(positions.size(), glm::vec3(0.0f));
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        uint32_t i0 = indices[i], i1 = indices[i + 1], i2 = indices[i + 2];
+        glm::vec3 normal = glm::cross(positions[i1] - positions[i0], positions[i2] - positions[i0]);
+        normals[i0] += normal;
+        normals[i1] += normal;
+        normals[i2] += normal;
+    }
+    for (glm::vec3& n : normals) {
+        float len = glm::length(n);
+        n = len > 0.0f ? n / len : glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+}
+
+static bool benchGeometryMesh(const std::string& name, const std::vector<uint32_t>& indices,
+                              const std::vector<glm::vec3>& positions, const std::vector<glm::vec2>& texCoords) {
+    const int iterations = 5;
+    const size_t threads = JobSystem::getInstance().workerCount() + 1;
+    std::cout << "  " << name << ": " << positions.size() << " vertices, " << indices.size() / 3 << " triangles\n";
+
+    std::vector<glm::vec3> reference, single, parallel;
+    std::vector<glm::vec4> singleTangents(positions.size()), parallelTangents(positions.size());
+    single.resize(positions.size());
+    parallel.resize(positions.size());
+
+    auto print = [](const std::string& label, double ms) {
+        std::cout << "    " << std::left << std::setw(26) << label
+                  << std::right << std::fixed << std::setprecision(3) << std::setw(9) << ms << " ms/mesh\n";
+    };
+    print("normals, scalar scatter", timeMs(iterations, [&]() { scatterNormals(positions, indices, reference); }));
+    print("normals, 1 thread", timeMs(iterations, [&]() {
+        MeshGeometry::computeNormals(positions, indices, 0, indices.size(), single, false);
+    }));
+    print("normals, " + std::to_string(threads) + " threads", timeMs(iterations, [&]() {
+        MeshGeometry::computeNormals(positions, indices, 0, indices.size(), parallel, true);
+    }));
+    print("tangents, 1 thread", timeMs(iterations, [&]() {
+        MeshGeometry::computeTangents(positions, single, texCoords, indices, 0, indices.size(), singleTangents, false);
+    }));
+    print("tangents, " + std::to_string(threads) + " threads", timeMs(iterations, [&]() {
+        MeshGeometry::computeTangents(positions, parallel, texCoords, indices, 0, indices.size(), parallelTangents, true);
+    }));
+
+    float maxDeviation = 0.0f;
+    for (size_t i = 0; i < reference.size(); ++i) maxDeviation = std::max(maxDeviation, glm::length(reference[i] - single[i]));
+    bool deterministic = std::memcmp(single.data(), parallel.data(), single.size() * sizeof(glm::vec3)) == 0 &&
+                         std::memcmp(singleTangents.data(), parallelTangents.data(), singleTangents.size() * sizeof(glm::vec4)) == 0;
+    std::cout << "    max deviation from scatter " << std::scientific << std::setprecision(2) << maxDeviation
+              << std::fixed << ", thread counts agree: " << (deterministic ? "yes" : "NO") << "\n";
+    return deterministic;
+}
+
+static bool benchMeshGeometry() {
+    std::cout << "[*] mesh-geometry: " << BENCH_MODEL << " and a displaced 1024x1024 plane\n";
+
+    GLTFModel model;
+    std::string error;
+    if (!GLBFile::loadModel(BENCH_MODEL, model, error)) {
+        std::cerr << "[ERROR] mesh-geometry: " << error << "\n";
+        return false;
+    }
+    bool ok = benchGeometryMesh("model", model.indices, model.positions, model.texCoords);
+
+    const int subdivisions = 1024;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texCoords;
+    for (const Vertex& v : PlaneGenerator::generatePlane(100.0f, 100.0f, subdivisions)) {
+        positions.push_back(v.position + glm::vec3(0.0f, std::sin(v.position.x * 0.7f) * std::cos(v.position.z * 0.5f), 0.0f));
+        texCoords.push_back(glm::vec2(v.position.x, v.position.z) * 0.1f);
+    }
+    std::vector<unsigned int> indices = PlaneGenerator::generatePlaneIndices(subdivisions, false);
+    ok &= benchGeometryMesh("plane", indices, positions, texCoords);
+    return ok;
+}
+
+// Opens every file of a generated tree, once loose and once through a
+// mounted pack. The page cache is warm here, so this only measures the
+// per-file open and lookup cost; cold disks add a seek per loose file.
+static bool benchAssetPack() {
+    const int fileCount = 2000;
+    const int iterations = 5;
+    std::error_code ec;
+    std::filesystem::path root = std::filesystem::temp_directory_path(ec) / "hiking_bench_pack";
+    std::filesystem::remove_all(root, ec);
+    std::cout << "[*] asset-pack: " << fileCount << " small files (" << iterations << " iterations)\n";
+
+    // JSON-like text of 1-16 KB per file, so some entries compress
+    std::vector<std::string> paths;
+    std::vector<PackCooker::Input> inputs;
+    uint32_t seed = 12345;
+    for (int i = 0; i < fileCount; ++i) {
+        std::string name = "dir" + std::to_string(i % 20) + "/asset" + std::to_string(i) + ".json";
+        std::filesystem::path path = root / name;
+        std::filesystem::create_directories(path.parent_path(), ec);
+
+        std::ofstream file(path, std::ios::binary);
+        seed = seed * 1664525u + 1013904223u;
+        size_t size = 1024 + (seed >> 8) % (15 * 1024);
+        std::string text = "{\n";
+        while (text.size() < size) {
+            seed = seed * 1664525u + 1013904223u;
+            text += "  \"key" + std::to_string(seed % 97) + "\": " + std::to_string(seed >> 12) + ",\n";
+        }
+        file << text << "}\n";
+        paths.push_back(path.generic_string());
+        inputs.push_back({path.generic_string(), name});
+    }
+
+    std::string packPath = (root / "bench.hpak").generic_string();
+    std::string error;
+    PackReport report;
+    if (!PackCooker::cook(inputs, packPath, error, &report)) {
+        std::cerr << "[ERROR] asset-pack: " << error << "\n";
+        return false;
+    }
+
+    bool ok = true;
+    uint64_t sum = 0;
+    auto openAll = [&]() {
+        for (const std::string& path : paths) {
+            AssetFile file;
+            ok &= file.open(path);
+            sum += checksum(file.data(), file.size());
+        }
+    };
+    double looseMs = timeMs(iterations, openAll);
+
+    ok &= AssetPacks::mount(packPath, root.generic_string(), error);
+    double packedMs = timeMs(iterations, openAll);
+
+    // Every entry must read back exactly as the loose file
+    size_t inflatedBytes = 0;
+    for (const std::string& path : paths) {
+        const PackEntry* entry = nullptr;
+        if (AssetPacks::find(path, entry) && entry->compression != PACK_STORED) inflatedBytes += entry->size;
+        AssetFile packed;
+        MappedFile loose;
+        ok &= packed.open(path) && packed.fromPack() && loose.open(path) && packed.size() == loose.size() &&
+              std::memcmp(packed.data(), loose.data(), loose.size()) == 0;
+    }
+    AssetPacks::unmountAll();
+    std::filesystem::remove_all(root, ec);
+
+    if (!ok) {
+        std::cerr << "[ERROR] asset-pack: packed files do not match the loose ones " << error << "\n";
+        return false;
+    }
+
+    printResult("loose files", looseMs, 0);
+    printResult("mounted pack", packedMs, inflatedBytes);
+    std::cout << "  speedup: " << std::setprecision(2) << looseMs / packedMs << "x  (" << report.summary()
+              << ", checksum " << sum << ")\n";
+    return true;
+}
+
+static uint64_t tileHash(const std::vector<std::shared_ptr<const TerrainTile>>& tiles) {
+    uint64_t hash = 0;
+    for (const auto& tile : tiles) {
+        hash = ContentHash::hash(tile->heights.data(), tile->heights.size() * sizeof(float), hash);
+        hash = ContentHash::hash(tile->normals.data(), tile->normals.size() * sizeof(uint32_t), hash);
+        hash = ContentHash::hash(tile->biomes.data(), tile->biomes.size(), hash);
+    }
+    return hash;
+}
+
+// Procedural terrain tiles: one thread, every worker, and the disk cache.
+// Tiles per second here set how far ahead Terrain can stream.
+static bool benchTerrainGenerator() {
+    const int side = 4;
+    std::vector<TerrainClimate> climates;
+    std::string error;
+    if (!TerrainGenerator::loadClimates("game/definitions/climates.json", climates, error)) {
+        std::cerr << "[ERROR] terrain-generator: " << error << "\n";
+        return false;
+    }
+    TerrainGeneratorSettings settings;
+    std::cout << "[*] terrain-generator: " << side * side << " tiles of " << settings.samples << "x"
+              << settings.samples << " samples, " << climates.size() << " climates, "
+              << JobSystem::getInstance().workerCount() << " workers\n";
+
+    std::vector<glm::ivec2> coords;
+    for (int z = 0; z < side; ++z) {
+        for (int x = 0; x < side; ++x) coords.push_back(glm::ivec2(x, z));
+    }
+    auto printRate = [](const std::string& name, double seconds, size_t tiles) {
+        std::cout << "  " << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(9) << tiles / seconds << " tiles/s  " << std::setw(9) << std::setprecision(2)
+                  << seconds * 1000.0 / tiles << " ms/tile\n";
+    };
+
+    settings.cacheDirectory.clear();
+    TerrainGenerator uncached(settings, climates);
+    std::vector<std::shared_ptr<const TerrainTile>> serial;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const glm::ivec2& coord : coords) serial.push_back(uncached.generate(coord.x, coord.y));
+    double serialSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    printRate("generate, 1 thread", serialSeconds, coords.size());
+
+    TerrainGenerator::BatchReport parallel;
+    std::vector<std::shared_ptr<const TerrainTile>> batch = uncached.generateBatch(coords, &parallel);
+    printRate("generate, all workers", parallel.seconds, parallel.tiles);
+
+    std::error_code ec;
+    std::filesystem::path root = std::filesystem::temp_directory_path(ec) / "hiking_bench_terrain";
+    std::filesystem::remove_all(root, ec);
+    settings.cacheDirectory = root.generic_string();
+    TerrainGenerator::BatchReport written, loaded;
+    TerrainGenerator(settings, climates).generateBatch(coords, &written);
+    std::vector<std::shared_ptr<const TerrainTile>> cached = TerrainGenerator(settings, climates).generateBatch(coords, &loaded);
+    std::filesystem::remove_all(root, ec);
+    printRate("generate and cache", written.seconds, written.tiles);
+    printRate("load from cache", loaded.seconds, loaded.tiles);
+
+    bool deterministic = tileHash(serial) == tileHash(batch) && tileHash(serial) == tileHash(cached) &&
+                         loaded.loaded == coords.size();
+    std::cout << "  speedup: " << std::setprecision(2) << serialSeconds / parallel.seconds
+              << "x, tiles identical across threads and cache: " << (deterministic ? "yes" : "NO") << "\n";
+    return deterministic;
+}
+
+struct Benchmark {
+    const char* name;
+    bool (*run)();
+};
+
+static const Benchmark BENCHMARKS[] = {
+    {"glb-loader", benchGLBLoader},
+    {"hmesh-loader", benchHMeshLoader},
+    {"mesh-optimizer", benchMeshOptimizer},
+    {"mesh-geometry", benchMeshGeometry},
+    {"asset-pack", benchAssetPack},
+    {"terrain-generator", benchTerrainGenerator},
+};
+
+int main(int argc, char* argv[]) {
+    bool success = true;
+    for (const Benchmark& bench : BENCHMARKS) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], bench.name) == 0) selected = true;
+        }
+        if (selected) success &= bench.run();
+    }
+    return success ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// Offline asset cooker: converts GLB models into .hmesh files and PNG/JPEG
+// images into block-compressed .htex files, which the runtime maps and
+// uploads without parsing or decoding (see engine/assets/HMeshFile.h, HTexFile.h)
+//
+//   cook.exe                  cook everything under game/assets (if stale)
+//   cook.exe --force          re-cook everything
+//   cook.exe --bc7            use BC7 instead of BC1/BC3 for colour textures
+//   cook.exe --pack           also pack game/assets into game/assets.hpak
+//   cook.exe a.glb [b.png]    cook the given files
+
+#include <filesystem>
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "engine/assets/MeshCooker.h"
+#include "engine/assets/PackCooker.h"
+#include "engine/assets/TextureCooker.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "dependencies/stb_image.h"
+
+static const char* ASSET_ROOT = "game/assets";
+static const char* ASSET_PACK = "game/assets.hpak";
+
+static bool isModel(const std::filesystem::path& path) {
+    return path.extension() == ".glb";
+}
+
+static bool isImage(const std::filesystem::path& path) {
+    std::string ext = path.extension().string();
+    return ext == ".png" || ext == ".jpg" || ext == ".jpeg";
+}
+
+// Standalone images are colour unless the name marks them as normal maps
+static ImageColorSpace imageColorSpace(const std::filesystem::path& path) {
+    return path.stem().string().find("normal") != std::string::npos ? ImageColorSpace::NORMAL : ImageColorSpace::SRGB;
+}
+
+static bool cookFile(const std::string& source, bool force, bool preferBC7, int& cooked, int& skipped) {
+    std::filesystem::path path(source);
+    bool model = isModel(path);
+    std::string output = model ? MeshCooker::cookedPath(source) : TextureCooker::cookedPath(source);
+    bool current = model ? MeshCooker::isCookedCurrent(source) : TextureCooker::isCookedCurrent(source);
+    if (!force && current) {
+        ++skipped;
+        return true;
+    }
+
+    std::string error;
+    MeshOptimizeReport report;
+    bool ok = model ? MeshCooker::cook(source, output, preferBC7, error, &report)
+                    : TextureCooker::cook(source, output, imageColorSpace(path), preferBC7, error);
+    if (!ok) {
+        std::cerr << "[ERROR] " << source << ": " << error << "\n";
+        return false;
+    }
+
+    std::cout << "[OK] " << source << " -> " << output << " ("
+              << CookedAsset::fileSize(source) / 1024 << " KB -> " << CookedAsset::fileSize(output) / 1024 << " KB)\n";
+    if (model) {
+        std::cout << "     " << report.summary() << "\n";
+        HMeshFile cookedMesh;
+        if (cookedMesh.open(output, error)) {
+            for (uint32_t i = 0; i < cookedMesh.getHeader().lodCount; ++i) {
+                HMeshLOD lod = cookedMesh.lod(i);
+                std::cout << "     LOD " << i << ": " << lod.indexCount / 3 << " triangles, error " << lod.error << "\n";
+            }
+        }
+    }
+    ++cooked;
+    return true;
+}
+
+// Packs every file under ASSET_ROOT, leaving out sources whose cooked
+// output exists (the runtime only reads those) and temporary files
+static bool packAssets() {
+    std::vector<PackCooker::Input> inputs;
+    std::error_code ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(ASSET_ROOT, ec);
+         it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (ec) break;
+        if (!it->is_regular_file()) continue;
+        const std::filesystem::path& path = it->path();
+        std::string source = path.generic_string();
+        if (path.extension() == ".tmp") continue;
+        if (isModel(path) && std::filesystem::exists(MeshCooker::cookedPath(source), ec)) continue;
+        if (isImage(path) && std::filesystem::exists(TextureCooker::cookedPath(source), ec)) continue;
+        inputs.push_back({source, std::filesystem::relative(path, ASSET_ROOT, ec).generic_string()});
+    }
+
+    std::string error;
+    PackReport report;
+    if (!PackCooker::cook(inputs, ASSET_PACK, error, &report)) {
+        std::cerr << "[ERROR] " << ASSET_PACK << ": " << error << "\n";
+        return false;
+    }
+    std::cout << "[OK] " << ASSET_ROOT << " -> " << ASSET_PACK << " (" << report.summary() << ")\n";
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    bool force = false, preferBC7 = false, pack = false;
+    std::vector<std::string> sources;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--force") == 0) force = true;
+        else if (std::strcmp(argv[i], "--bc7") == 0) preferBC7 = true;
+        else if (std::strcmp(argv[i], "--pack") == 0) pack = true;
+        else sources.push_back(argv[i]);
+    }
+
+    if (sources.empty()) {
+        std::error_code ec;
+        for (auto it = std::filesystem::recursive_directory_iterator(ASSET_ROOT, ec);
+             it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            if (ec) break;
+            if (it->is_regular_file() && (isModel(it->path()) || isImage(it->path()))) {
+                sources.push_back(it->path().generic_string());
+            }
+        }
+    }
+
+    int cooked = 0, skipped = 0;
+    bool success = true;
+    for (const std::string& source : sources) {
+        success &= cookFile(source, force, preferBC7, cooked, skipped);
+    }
+
+    std::cout << "[*] " << cooked << " cooked, " << skipped << " up to date\n";
+    if (pack) success &= packAssets();
+    return success ? 0 : 1;
+}
@@ -11,24 +11,67 @@
 #include <GL/glew.h>
 #include <GL/gl.h>
 
+#include "engine/render/FirstPersonCamera.h"
+#include "engine/render/GPURingBuffer.h"
+#include "engine/scene/ObjectManager.h"
+#include "engine/assets/TextureCooker.h"
+#include "engine/core/StartupGraph.h"
+#include "engine/render/ShaderLibrary.h"
+
+// After the engine headers, which include the stb_image declarations
 #define STB_IMAGE_IMPLEMENTATION
 #include "dependencies/stb_image.h"
 
-#include "engine/render/FirstPersonCamera.h"
-#include "engine/scene/ObjectManager.h"
 
+// Image read for a sky texture: the cooked mip chain (kept mapped) when it
+// is current, else pixels decoded with stb_image. CPU only, so it can be
+// filled on a worker while the GL context is still being created.
+struct LoadedImage {
+    std::string path;
+    HTexFile cooked;
+    bool useCooked = false;
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0, channels = 0;
+    
+    LoadedImage() = default;
+    LoadedImage(const LoadedImage&) = delete;
+    LoadedImage& operator=(const LoadedImage&) = delete;
+    
+    ~LoadedImage() {
+        if (pixels) stbi_image_free(pixels);
+    }
+};
 
-// Simple texture loader using stb_image
-GLuint loadTexture(const std::string& path) {
-    int width, height, channels;
-    unsigned char *data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+bool readImage(const std::string& path, LoadedImage& image) {
+    image.path = path;
+    if (TextureCooker::isCookedCurrent(path)) {
+        std::string error;
+        if (image.cooked.open(TextureCooker::cookedPath(path), error)) {
+            image.useCooked = true;
+            std::cout << "[INFO] Loaded cooked image: " << TextureCooker::cookedPath(path) << "\n";
+            return true;
+        }
+        std::cout << "[ERROR] Ignoring cooked image (" << error << "): " << path << "\n";
+    }
     
-    if (!data) {
+    AssetFile file;
+    image.pixels = file.open(path) ? stbi_load_from_memory(file.data(), (int)file.size(), &image.width, &image.height, &image.channels, 4)
+                                   : nullptr;
+    
+    if (!image.pixels) {
         std::cout << "[ERROR] Failed to load image: " << path << "\n";
-        return 0;
+        return false;
     }
     
-    std::cout << "[INFO] Loaded image: " << path << " (" << width << "x" << height << ", " << channels << " channels)\n";
+    std::cout << "[INFO] Loaded image: " << path << " (" << image.width << "x" << image.height << ", " << image.channels << " channels)\n";
+    return true;
+}
+
+// GL thread; 0 if the image could not be read
+GLuint uploadImage(const LoadedImage& image) {
+    if (!image.useCooked && !image.pixels) {
+        return 0;
+    }
     
     GLuint texture = 0;
     glGenTextures(1, &texture);
@@ -36,16 +79,37 @@ GLuint loadTexture(const std::string& path) {
     
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    if (image.useCooked) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        CompressedTexture::upload(image.cooked.getView());
+    } else {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels);
+    }
     glBindTexture(GL_TEXTURE_2D, 0);
-    
-    stbi_image_free(data);
     return texture;
 }
 
+// Object shader variants on keys 1-9
+struct ShaderPreset {
+    const char* name;
+    std::vector<std::string> keywords;
+};
+
+static const ShaderPreset SHADER_PRESETS[] = {
+    {"lit", {"NORMAL_MAP", "ALPHA_TEST", "FOG"}},
+    {"lit, no normal map", {"ALPHA_TEST", "FOG"}},
+    {"lit, no fog", {"NORMAL_MAP", "ALPHA_TEST"}},
+    {"lit, no alpha test", {"NORMAL_MAP", "FOG"}},
+    {"lit, no features", {}},
+    {"normals", {"DEBUG_NORMALS", "NORMAL_MAP"}},
+    {"vertex normals", {"DEBUG_NORMALS"}},
+    {"texture coordinates", {"DEBUG_UV"}},
+    {"base color", {"DEBUG_BASE_COLOR"}},
+};
+
 class ShaderDevApp {
 private:
     static constexpr int WINDOW_WIDTH = 1280;
@@ -58,7 +122,10 @@ private:
     FirstPersonCamera camera;
     SceneManager scene;
     
-    GLuint shaderProgram = 0;
+    ShaderLibrary::ShaderId objectShader = 0;
+    std::vector<uint32_t> presetMasks;
+    uint32_t instancingMask = 0;
+    size_t currentPreset = 0;
     GLuint skyboxVAO = 0, skyboxVBO = 0;
     GLuint sunTexture = 0, moonTexture = 0;
     GLuint skyShaderProgram = 0;
@@ -66,6 +133,13 @@ private:
     GLuint moonVAO = 0, moonVBO = 0;
     GLuint sunShader = 0, moonShader = 0;
     
+    // Read on workers during startup, released once uploaded
+    std::unique_ptr<LoadedImage> sunImage, moonImage;
+    
+    StartupGraph startup;
+    
+    static constexpr const char* TV_MODEL = "game/assets/shared/models/old_television.glb";
+    
 public:
     ShaderDevApp() 
         : camera(glm::vec3(0.0f, 2.0f, 3.0f))
@@ -79,14 +153,88 @@ public:
     bool initialize() {
         std::cout << "[START] Shader Development Tool\n";
         
-        // Initialize SDL
+        // Once the pack is mounted the model and sky images load on workers
+        // while the window, context and shaders come up here; GL uploads wait
+        // for both
+        using Thread = StartupGraph::Thread;
+        auto pack = startup.add("mount-pack", Thread::MAIN, [this]() { return mountPack(); });
+        auto model = startup.add("model-prefetch", Thread::MAIN, [this]() {
+            scene.preloadModel(TV_MODEL);
+            return true;
+        }, {pack});
+        auto sun = startup.add("sun-image", Thread::WORKER, [this]() {
+            sunImage.reset(new LoadedImage());
+            readImage("game/assets/environment/sky/sun.png", *sunImage);
+            return true;
+        }, {pack});
+        auto moon = startup.add("moon-image", Thread::WORKER, [this]() {
+            moonImage.reset(new LoadedImage());
+            readImage("game/assets/environment/sky/moon.png", *moonImage);
+            return true;
+        }, {pack});
+        auto sdl = startup.add("sdl-init", Thread::MAIN, [this]() { return initSDL(); });
+        auto windowTask = startup.add("window", Thread::MAIN, [this]() { return createWindow(); }, {sdl});
+        auto glew = startup.add("glew", Thread::MAIN, [this]() { return initGL(); }, {windowTask});
+        startup.add("shaders", Thread::MAIN, [this]() { return compileShaders(); }, {glew});
+        startup.add("sky-geometry", Thread::MAIN, [this]() {
+            setupSkybox();
+            setupSkyObjects();
+            return true;
+        }, {glew});
+        startup.add("sky-textures", Thread::MAIN, [this]() {
+            loadSkyTextures();
+            return true;
+        }, {glew, sun, moon});
+        startup.add("scene", Thread::MAIN, [this]() {
+            // Node transforms from the GLB already make the TV Y-up
+            scene.placeObject(TV_MODEL, 0.0f, -10.0f, -50.0f,
+                     glm::radians(0.0f), glm::radians(0.0f), glm::radians(0.0f),
+                     0.2f, 0.2f, 0.2f, 1);
+            return true;
+        }, {glew, model});
+        
+        bool ok = startup.run();
+        startup.printReport(std::cout);
+        if (!ok) {
+            return false;
+        }
+        
+        std::cout << "[INFO] TV Position: (0, -10, -50)\n";
+        std::cout << "  W/A/S/D - Move camera\n";
+        std::cout << "  Space/Ctrl - Move up/down\n";
+        std::cout << "  Mouse - Look around\n";
+        std::cout << "  1-9 - Switch shader variants\n";
+        std::cout << "  R - Reload shaders\n";
+        std::cout << "  ESC - Exit\n";
+        
+        return true;
+    }
+    
+    // Packed assets (cook.exe --pack) take priority over the loose files
+    bool mountPack() {
+        std::error_code packMissing;
+        if (std::filesystem::exists("game/assets.hpak", packMissing)) {
+            std::string error;
+            if (AssetPacks::mount("game/assets.hpak", "game/assets", error)) {
+                std::cout << "[OK] Mounted game/assets.hpak\n";
+            } else {
+                std::cerr << "[ERROR] Ignoring game/assets.hpak (" << error << ")\n";
+            }
+        }
+        return true;
+    }
+    
+    bool initSDL() {
         if (SDL_Init(SDL_INIT_VIDEO) < 0) {
             std::cerr << "[ERROR] SDL Init failed: " << SDL_GetError() << "\n";
             return false;
         }
         std::cout << "[OK] SDL initialized\n";
-        
-        // Create window
+        return true;
+    }
+    
+    // Window and OpenGL context; cleanup() releases whichever was created
+    bool createWindow() {
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
         SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
@@ -102,29 +250,24 @@ public:
         
         if (!window) {
             std::cerr << "[ERROR] Window creation failed: " << SDL_GetError() << "\n";
-            SDL_Quit();
             return false;
         }
         std::cout << "[OK] Window created\n";
         
-        // Create OpenGL context
         glContext = SDL_GL_CreateContext(window);
         if (!glContext) {
             std::cerr << "[ERROR] OpenGL context failed: " << SDL_GetError() << "\n";
-            SDL_DestroyWindow(window);
-            SDL_Quit();
             return false;
         }
         std::cout << "[OK] OpenGL context created\n";
-        
-        // Initialize GLEW
+        return true;
+    }
+    
+    bool initGL() {
         glewExperimental = GL_TRUE;
         GLenum err = glewInit();
         if (GLEW_OK != err) {
             std::cerr << "[ERROR] GLEW init failed\n";
-            SDL_GL_DeleteContext(glContext);
-            SDL_DestroyWindow(window);
-            SDL_Quit();
             return false;
         }
         std::cout << "[OK] GLEW initialized\n";
@@ -137,187 +280,112 @@ public:
         glEnable(GL_DEPTH_TEST);
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        
-        // Compile shaders
-        if (!compileShaders()) {
-            return false;
-        }
-        
-        // Setup skybox
-        setupSkybox();
-        
-        // Setup sun and moon geometry
-        setupSkyObjects();
-        
-        // Load textures for sky
-        loadSkyTextures();
-        
-        // Load old television model
-        scene.placeObject("game/assets/shared/models/old_television.glb", 0.0f, -10.0f, -50.0f,
-                 glm::radians(-90.0f), glm::radians(0.0f), glm::radians(0.0f),
-                 0.2f, 0.2f, 0.2f, 1);
-        
-        std::cout << "[INFO] TV Position: (0, -10, -50)\n";
-        std::cout << "  W/A/S/D - Move camera\n";
-        std::cout << "  Space/Ctrl - Move up/down\n";
-        std::cout << "  Mouse - Look around\n";
-        std::cout << "  1-9 - Switch shader variants\n";
-        std::cout << "  R - Reload shaders\n";
-        std::cout << "  ESC - Exit\n";
-        
         return true;
     }
     
     bool compileShaders() {
-        // Vertex shader
-        const char* vertexShaderSource = R"(
+        // Scene objects: engine/render/shaders/object.*, one program per keyword set
+        ShaderLibrary& library = ShaderLibrary::getInstance();
+        ShaderProgramDesc objectDesc;
+        objectDesc.name = "object";
+        objectDesc.vertexPath = "engine/render/shaders/object.vert";
+        objectDesc.fragmentPath = "engine/render/shaders/object.frag";
+        objectDesc.keywords = {"NORMAL_MAP", "ALPHA_TEST", "FOG", "INSTANCING",
+                               "DEBUG_NORMALS", "DEBUG_UV", "DEBUG_BASE_COLOR"};
+        objectDesc.attributes = {{0, "aPosition"}, {1, "aNormal"}, {2, "aTexCoord"},
+                                 {3, "aModel0"}, {4, "aModel1"}, {5, "aModel2"},
+                                 {VERTEX_TANGENT_ATTRIBUTE, "aTangent"}};
+        objectShader = library.add(objectDesc);
+        
+        presetMasks.clear();
+        for (const ShaderPreset& preset : SHADER_PRESETS) {
+            presetMasks.push_back(library.mask(objectShader, preset.keywords));
+        }
+        instancingMask = library.mask(objectShader, {"INSTANCING"});
+        
+        // Sun and moon billboards
+        const char* skyVertexShader = R"(
             #version 120
             
+            attribute vec3 aPos;
+            attribute vec2 aTexCoord;
+            
             uniform mat4 view;
             uniform mat4 projection;
             uniform mat4 model;
-            uniform float time;
             
-            varying vec3 fragPos;
-            varying vec3 fragNormal;
-            varying vec2 fragTexCoord;
+            varying vec2 TexCoord;
             
             void main() {
-                fragPos = vec3(model * gl_Vertex);
-                fragNormal = normalize(mat3(model) * gl_Normal);
-                fragTexCoord = vec2(gl_MultiTexCoord0);
-                
-                gl_Position = projection * view * vec4(fragPos, 1.0);
+                gl_Position = projection * view * model * vec4(aPos, 1.0);
+                TexCoord = aTexCoord;
             }
         )";
         
-        // Fragment shader - PBR with textures
-        const char* fragmentShaderSource = R"(
+        // Sun shader - with texture
+        const char* sunFragShader = R"(
             #version 120
             
-            uniform float time;
-            uniform sampler2D baseColorTex;
-            uniform sampler2D metallicRoughnessTex;
-            uniform sampler2D normalTex;
+            uniform sampler2D texture1;
+            varying vec2 TexCoord;
             
-            varying vec3 fragPos;
-            varying vec3 fragNormal;
-            varying vec2 fragTexCoord;
-            
-            vec3 fresnelSchlick(float cosTheta, vec3 F0) {
-                return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
-            }
-            
-            float DistributionGGX(vec3 N, vec3 H, float roughness) {
-                float a = roughness * roughness;
-                a = a * a;
-                float NdotH = max(dot(N, H), 0.0);
-                float NdotH2 = NdotH * NdotH;
-                float nom = a;
-                float denom = (NdotH2 * (a - 1.0) + 1.0);
-                denom = 3.14159 * denom * denom;
-                return nom / max(denom, 0.0000001);
+            void main() {
+                gl_FragColor = texture2D(texture1, TexCoord);
             }
+        )";
+        
+        // Moon shader - with texture
+        const char* moonFragShader = R"(
+            #version 120
             
-            float GeometrySchlickGGX(float NdotV, float roughness) {
-                float r = (roughness + 1.0);
-                float k = (r * r) / 8.0;
-                float nom = NdotV;
-                float denom = NdotV * (1.0 - k) + k;
-                return nom / max(denom, 0.0000001);
-            }
+            uniform sampler2D texture1;
+            varying vec2 TexCoord;
             
             void main() {
-                vec4 baseColor = texture2D(baseColorTex, fragTexCoord);
-                vec4 mrTex = texture2D(metallicRoughnessTex, fragTexCoord);
-                vec3 normalMap = texture2D(normalTex, fragTexCoord).rgb;
-                
-                vec3 norm = normalize(fragNormal);
-                vec3 viewDir = normalize(-fragPos);
-                
-                float metallic = mrTex.b;
-                float roughness = mrTex.g;
-                
-                vec3 F0 = mix(vec3(0.04), baseColor.rgb, metallic);
-                
-                vec3 lightDir = normalize(vec3(1.0, 1.0, 1.0));
-                vec3 H = normalize(viewDir + lightDir);
-                
-                float distance = 1.0;
-                float attenuation = 1.0 / (distance * distance);
-                vec3 radiance = vec3(1.0) * attenuation;
-                
-                vec3 F = fresnelSchlick(max(dot(H, viewDir), 0.0), F0);
-                float NDF = DistributionGGX(norm, H, roughness);
-                float G = GeometrySchlickGGX(max(dot(norm, viewDir), 0.0), roughness) * 
-                         GeometrySchlickGGX(max(dot(norm, lightDir), 0.0), roughness);
-                
-                vec3 kS = F;
-                vec3 kD = (vec3(1.0) - kS) * (1.0 - metallic);
-                
-                float NdotL = max(dot(norm, lightDir), 0.0);
-                vec3 numerator = NDF * G * F;
-                float denominator = 4.0 * max(dot(norm, viewDir), 0.0) * max(dot(norm, lightDir), 0.0);
-                vec3 specular = numerator / max(denominator, 0.001);
-                
-                vec3 color = (kD * baseColor.rgb / 3.14159 + specular) * radiance * NdotL;
-                
-                // Add ambient
-                color += baseColor.rgb * 0.1;
-                
-                // Add time animation
-                color += 0.1 * sin(time) * vec3(0.5, 0.2, 0.1);
-                
-                gl_FragColor = vec4(color, 1.0);
+                gl_FragColor = texture2D(texture1, TexCoord);
             }
         )";
         
-        // Compile vertex shader
-        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-        glCompileShader(vertexShader);
-        
-        // Check for vertex shader compile errors
-        int success;
-        char infoLog[512];
-        glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-            std::cerr << "[ERROR] Vertex shader compilation failed:\n" << infoLog << "\n";
-            return false;
-        }
-        
-        // Compile fragment shader
-        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-        glCompileShader(fragmentShader);
-        
-        // Check for fragment shader compile errors
-        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-            std::cerr << "[ERROR] Fragment shader compilation failed:\n" << infoLog << "\n";
-            return false;
+        ProgramSource sunSource;
+        sunSource.name = "sun";
+        sunSource.vertex = {skyVertexShader};
+        sunSource.fragment = {sunFragShader};
+        sunSource.attributes = {{0, "aPos"}, {1, "aTexCoord"}};
+        
+        ProgramSource moonSource = sunSource;
+        moonSource.name = "moon";
+        moonSource.fragment = {moonFragShader};
+        
+        // The sky programs are issued before the first object variant is
+        // checked, so drivers that compile in parallel work on all of them at
+        // once; after the first run they come from the program binary cache
+        ProgramCache& cache = ProgramCache::getInstance();
+        PendingProgram sunPending = cache.begin(sunSource);
+        PendingProgram moonPending = cache.begin(moonSource);
+        
+        GLuint defaultProgram = library.variant(objectShader, presetMasks[currentPreset]);
+        library.variant(objectShader, presetMasks[currentPreset] | instancingMask);
+        
+        // The other presets build over the next frames, instanced first
+        // since that is what draws the scene
+        std::vector<uint32_t> warmMasks;
+        for (uint32_t mask : presetMasks) warmMasks.push_back(mask | instancingMask);
+        warmMasks.insert(warmMasks.end(), presetMasks.begin(), presetMasks.end());
+        library.prewarm(objectShader, warmMasks);
+        
+        // The sky objects are optional; without their programs they are not drawn
+        std::string error;
+        sunShader = cache.finish(sunPending, error);
+        moonShader = cache.finish(moonPending, error);
+        if (!sunShader || !moonShader) {
+            std::cerr << "[ERROR] Sky object shaders failed:\n" << error << "\n";
         }
-        
-        // Link shaders
-        shaderProgram = glCreateProgram();
-        glAttachShader(shaderProgram, vertexShader);
-        glAttachShader(shaderProgram, fragmentShader);
-        glLinkProgram(shaderProgram);
-        
-        // Check for linking errors
-        glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-        if (!success) {
-            glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-            std::cerr << "[ERROR] Shader program linking failed:\n" << infoLog << "\n";
+        if (!defaultProgram) {
             return false;
         }
         
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        
-        std::cout << "[OK] Shaders compiled successfully\n";
+        ProgramCache::Stats stats = cache.stats();
+        std::cout << "[OK] Shaders ready (" << stats.loaded << " from cache, " << stats.compiled << " compiled)\n";
         return true;
     }
     
@@ -346,6 +414,11 @@ public:
                     (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE)) {
                     running = false;
                 }
+                if (event.type == SDL_KEYDOWN && !event.key.repeat) {
+                    SDL_Keycode key = event.key.keysym.sym;
+                    if (key >= SDLK_1 && key <= SDLK_9) selectPreset((size_t)(key - SDLK_1));
+                    if (key == SDLK_r) reloadShaders();
+                }
                 // Mouse look
                 if (event.type == SDL_MOUSEMOTION) {
                     float xoffset = event.motion.xrel * 0.1f;
@@ -370,6 +443,13 @@ public:
             if (keys[SDL_SCANCODE_SPACE]) camera.moveUp(deltaTime);
             if (keys[SDL_SCANCODE_LCTRL] || keys[SDL_SCANCODE_RCTRL]) camera.moveDown(deltaTime);
             
+            // Finish streamed asset uploads (bounded so loading never stalls a frame)
+            GLUploadQueue::getInstance().drain(2.0);
+            ShaderLibrary::getInstance().update();
+            
+            // Per-frame dynamic data (instance transforms) streams through the ring
+            GPURingBuffer::getInstance().beginFrame();
+            
             // Render skybox background
             renderSkybox(appTime);
             
@@ -379,26 +459,57 @@ public:
             glm::mat4 view = camera.getViewMatrix();
             glm::mat4 projection = camera.getProjectionMatrix(45.0f, (float)WINDOW_WIDTH / WINDOW_HEIGHT, 0.1f, 1000.0f);
             
-            scene.renderAll(shaderProgram, view, projection, appTime);
+            scene.renderAll(objectProgram(), instancedObjectProgram(), view, projection, appTime);
             
             // Render sun and moon orbiting around player
             renderSkyObjects(appTime, camera.position);
             
+            GPURingBuffer::getInstance().endFrame();
             SDL_GL_SwapWindow(window);
             
             frameCount++;
+            if (frameCount == 1) {
+                reportFirstFrame();
+            }
             
             if (frameCount % 60 == 0) {
                 std::cout << "[FRAME " << frameCount << "] FPS: ~60 | Pos: (" 
                           << (int)camera.position.x << ", " 
                           << (int)camera.position.y << ", " 
-                          << (int)camera.position.z << ")\n";
+                          << (int)camera.position.z << ") | Objects: " << scene.getCullStats().visible
+                          << " visible, " << scene.getCullStats().culled << " culled, "
+                          << scene.getDrawCalls() << " draws\n";
             }
         }
         
         std::cout << "\n[OK] Render loop finished (" << frameCount << " frames)\n";
     }
     
+    // Current preset's program, or the plain variant if that one does not compile
+    GLuint objectProgram() {
+        ShaderLibrary& library = ShaderLibrary::getInstance();
+        GLuint program = library.variant(objectShader, presetMasks[currentPreset]);
+        return program ? program : library.variant(objectShader, 0);
+    }
+    
+    // Same preset with INSTANCING; 0 (draw objects one by one) if it does not compile
+    GLuint instancedObjectProgram() {
+        return ShaderLibrary::getInstance().variant(objectShader, presetMasks[currentPreset] | instancingMask);
+    }
+    
+    void selectPreset(size_t index) {
+        if (index >= presetMasks.size()) return;
+        currentPreset = index;
+        std::cout << "[INFO] Shader variant " << index + 1 << ": " << SHADER_PRESETS[index].name << "\n";
+    }
+    
+    void reloadShaders() {
+        size_t rebuilt = ShaderLibrary::getInstance().reload();
+        if (rebuilt == 0) {
+            std::cout << "[INFO] No shader changes to reload\n";
+        }
+    }
+    
     void setupSkybox() {
         // Create a simple skybox with a single quad far from camera
         float skySize = 500.0f;
@@ -493,126 +604,18 @@ public:
         glBindVertexArray(0);
     }
     
+    // Uploads the sun and moon images read during startup
     void loadSkyTextures() {
-        // Load sun texture
-        std::cout << "[*] Loading sun texture...\n";
-        sunTexture = loadTexture("game/assets/environment/sky/sun.png");
-        
-        // Load moon texture
-        std::cout << "[*] Loading moon texture...\n";
-        moonTexture = loadTexture("game/assets/environment/sky/moon.png");
+        std::cout << "[*] Uploading sun and moon textures...\n";
+        if (sunImage) sunTexture = uploadImage(*sunImage);
+        if (moonImage) moonTexture = uploadImage(*moonImage);
+        sunImage.reset();
+        moonImage.reset();
     }
     
     void renderSkyObjects(float time, const glm::vec3& playerPos) {
-        // Compile shaders once
-        if (sunShader == 0) {
-            const char* vertexShader = R"(
-                #version 120
-                
-                attribute vec3 aPos;
-                attribute vec2 aTexCoord;
-                
-                uniform mat4 view;
-                uniform mat4 projection;
-                uniform mat4 model;
-                
-                varying vec2 TexCoord;
-                
-                void main() {
-                    gl_Position = projection * view * model * vec4(aPos, 1.0);
-                    TexCoord = aTexCoord;
-                }
-            )";
-            
-            // Sun shader - with texture
-            const char* sunFragShader = R"(
-                #version 120
-                
-                uniform sampler2D texture1;
-                varying vec2 TexCoord;
-                
-                void main() {
-                    gl_FragColor = texture2D(texture1, TexCoord);
-                }
-            )";
-            
-            // Moon shader - with texture
-            const char* moonFragShader = R"(
-                #version 120
-                
-                uniform sampler2D texture1;
-                varying vec2 TexCoord;
-                
-                void main() {
-                    gl_FragColor = texture2D(texture1, TexCoord);
-                }
-            )";
-            
-            // Compile sun shader
-            GLuint vs = glCreateShader(GL_VERTEX_SHADER);
-            glShaderSource(vs, 1, &vertexShader, nullptr);
-            glCompileShader(vs);
-            
-            // Check vertex shader compilation
-            int success;
-            char infoLog[512];
-            glGetShaderiv(vs, GL_COMPILE_STATUS, &success);
-            if (!success) {
-                glGetShaderInfoLog(vs, 512, nullptr, infoLog);
-                std::cerr << "[ERROR] Vertex shader compilation failed:\n" << infoLog << "\n";
-            }
-            
-            GLuint sunFs = glCreateShader(GL_FRAGMENT_SHADER);
-            glShaderSource(sunFs, 1, &sunFragShader, nullptr);
-            glCompileShader(sunFs);
-            
-            glGetShaderiv(sunFs, GL_COMPILE_STATUS, &success);
-            if (!success) {
-                glGetShaderInfoLog(sunFs, 512, nullptr, infoLog);
-                std::cerr << "[ERROR] Sun fragment shader compilation failed:\n" << infoLog << "\n";
-            }
-            
-            sunShader = glCreateProgram();
-            glAttachShader(sunShader, vs);
-            glAttachShader(sunShader, sunFs);
-            glBindAttribLocation(sunShader, 0, "aPos");
-            glBindAttribLocation(sunShader, 1, "aTexCoord");
-            glLinkProgram(sunShader);
-            
-            glGetProgramiv(sunShader, GL_LINK_STATUS, &success);
-            if (!success) {
-                glGetProgramInfoLog(sunShader, 512, nullptr, infoLog);
-                std::cerr << "[ERROR] Sun shader linking failed:\n" << infoLog << "\n";
-            }
-            
-            glDeleteShader(sunFs);
-            
-            // Compile moon shader
-            GLuint moonFs = glCreateShader(GL_FRAGMENT_SHADER);
-            glShaderSource(moonFs, 1, &moonFragShader, nullptr);
-            glCompileShader(moonFs);
-            
-            glGetShaderiv(moonFs, GL_COMPILE_STATUS, &success);
-            if (!success) {
-                glGetShaderInfoLog(moonFs, 512, nullptr, infoLog);
-                std::cerr << "[ERROR] Moon fragment shader compilation failed:\n" << infoLog << "\n";
-            }
-            
-            moonShader = glCreateProgram();
-            glAttachShader(moonShader, vs);
-            glAttachShader(moonShader, moonFs);
-            glBindAttribLocation(moonShader, 0, "aPos");
-            glBindAttribLocation(moonShader, 1, "aTexCoord");
-            glLinkProgram(moonShader);
-            
-            glGetProgramiv(moonShader, GL_LINK_STATUS, &success);
-            if (!success) {
-                glGetProgramInfoLog(moonShader, 512, nullptr, infoLog);
-                std::cerr << "[ERROR] Moon shader linking failed:\n" << infoLog << "\n";
-            }
-            
-            glDeleteShader(vs);
-            glDeleteShader(moonFs);
+        if (!sunShader || !moonShader) {
+            return;
         }
         
         glDisable(GL_DEPTH_TEST);
@@ -669,20 +672,22 @@ public:
             glm::vec4(sunPos, 1.0f)
         );
         
-        glUseProgram(sunShader);
-        GLint viewLoc = glGetUniformLocation(sunShader, "view");
-        GLint projLoc = glGetUniformLocation(sunShader, "projection");
-        GLint modelLoc = glGetUniformLocation(sunShader, "model");
-        GLint texLoc = glGetUniformLocation(sunShader, "texture1");
+        static const UniformId viewId = UniformNames::id("view");
+        static const UniformId projectionId = UniformNames::id("projection");
+        static const UniformId modelId = UniformNames::id("model");
+        static const UniformId textureId = UniformNames::id("texture1");
         
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(sunModel));
+        glUseProgram(sunShader);
+        ParameterBlock& sunParams = ShaderReflection::getInstance().parameters(sunShader);
+        sunParams.set(viewId, view);
+        sunParams.set(projectionId, projection);
+        sunParams.set(modelId, sunModel);
+        sunParams.set(textureId, 0);
+        sunParams.apply();
         
         // Bind texture
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, sunTexture);
-        glUniform1i(texLoc, 0);
         
         // Verify texture is bound
         if (sunTexture == 0) {
@@ -737,14 +742,15 @@ public:
         );
         
         glUseProgram(moonShader);
-        glUniformMatrix4fv(glGetUniformLocation(moonShader, "view"), 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(moonShader, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-        glUniformMatrix4fv(glGetUniformLocation(moonShader, "model"), 1, GL_FALSE, glm::value_ptr(moonModel));
+        ParameterBlock& moonParams = ShaderReflection::getInstance().parameters(moonShader);
+        moonParams.set(viewId, view);
+        moonParams.set(projectionId, projection);
+        moonParams.set(modelId, moonModel);
+        moonParams.set(textureId, 0);
+        moonParams.apply();
         
-        GLint moonTexLoc = glGetUniformLocation(moonShader, "texture1");
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, moonTexture);
-        glUniform1i(moonTexLoc, 0);
         
         if (moonTexture == 0) {
             std::cerr << "[ERROR] Moon texture not loaded! ID = 0\n";
@@ -774,12 +780,23 @@ public:
         glEnable(GL_DEPTH_TEST);
     }
     
+    // The first frame includes whatever streamed in meanwhile (the TV model)
+    void reportFirstFrame() {
+        std::cout << "[INFO] First frame after " << (int)startup.markFirstFrame() << " ms\n";
+        if (startup.writeReport("startup_timing.json")) {
+            std::cout << "[INFO] Startup timing written to startup_timing.json\n";
+        }
+    }
+    
     void cleanup() {
         scene.cleanup();
-        if (shaderProgram) glDeleteProgram(shaderProgram);
-        if (skyShaderProgram) glDeleteProgram(skyShaderProgram);
-        if (sunShader) glDeleteProgram(sunShader);
-        if (moonShader) glDeleteProgram(moonShader);
+        GPURingBuffer::getInstance().destroy();
+        ShaderLibrary::getInstance().clear();
+        for (GLuint program : {skyShaderProgram, sunShader, moonShader}) {
+            if (!program) continue;
+            ShaderReflection::getInstance().forget(program);
+            glDeleteProgram(program);
+        }
         if (skyboxVAO) glDeleteVertexArrays(1, &skyboxVAO);
         if (skyboxVBO) glDeleteBuffers(1, &skyboxVBO);
         if (sunVAO) glDeleteVertexArrays(1, &sunVAO);